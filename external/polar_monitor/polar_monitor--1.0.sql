@@ -97,6 +97,26 @@ RETURNS record
 AS 'MODULE_PATHNAME', 'polar_flushlist'
 LANGUAGE C PARALLEL SAFE;
 
+CREATE FUNCTION polar_flush_write_stat(OUT write int8,
+                                       OUT write_blocks int8,
+                                       OUT avg_io_size int8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_flush_write_stat'
+LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION polar_bgwriter_control_history(OUT sample_time timestamptz,
+                                               OUT consistent_lag int8,
+                                               OUT clean_ratio float8,
+                                               OUT error float8,
+                                               OUT integral float8,
+                                               OUT derivative float8,
+                                               OUT output float8,
+                                               OUT workers int4,
+                                               OUT batch_size int4)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'polar_bgwriter_control_history'
+LANGUAGE C PARALLEL SAFE;
+
 CREATE FUNCTION polar_cbuf(OUT flush int8,
                            OUT copy int8,
                            OUT unavailable int8,
@@ -106,6 +126,16 @@ RETURNS record
 AS 'MODULE_PATHNAME', 'polar_cbuf'
 LANGUAGE C PARALLEL SAFE;
 
+CREATE FUNCTION polar_cbuf_partition(OUT partition int4,
+                                     OUT size int4,
+                                     OUT free int4,
+                                     OUT alloc int8,
+                                     OUT remote int8,
+                                     OUT empty int8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'polar_cbuf_partition'
+LANGUAGE C PARALLEL SAFE;
+
 /* Create backend flush buffer count func */
 CREATE FUNCTION polar_backend_flush()
 RETURNS int8
@@ -121,6 +151,17 @@ RETURNS RECORD
 AS 'MODULE_PATHNAME', 'polar_lru_flush_info'
 LANGUAGE C PARALLEL SAFE;
 
+CREATE FUNCTION polar_prefetch_stat(OUT workers int4,
+                                    OUT requested_blocks int8,
+                                    OUT dropped_blocks int8,
+                                    OUT read_blocks int8,
+                                    OUT hit_blocks int8,
+                                    OUT skipped_blocks int8,
+                                    OUT failed_requests int8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_prefetch_stat'
+LANGUAGE C PARALLEL SAFE;
+
 CREATE FUNCTION polar_node_type()
 RETURNS text
 AS 'MODULE_PATHNAME', 'polar_node_type'
@@ -377,6 +418,30 @@ LANGUAGE C PARALLEL UNSAFE;
 REVOKE ALL ON FUNCTION polar_set_available FROM PUBLIC;
 REVOKE ALL ON FUNCTION polar_is_available FROM PUBLIC;
 
+-- adaptive group commit
+CREATE FUNCTION polar_group_commit_stat(
+    OUT flush_count int8,
+    OUT request_count int8,
+    OUT avg_batch_size float8,
+    OUT max_batch_size int8,
+    OUT delay_count int8,
+    OUT delay_time_us int8,
+    OUT max_delay_us int8,
+    OUT flush_latency_us float8,
+    OUT flush_latency_p99_us float8,
+    OUT request_per_sec float8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_group_commit_stat'
+LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION polar_group_commit_stat_reset()
+RETURNS VOID
+AS 'MODULE_PATHNAME', 'polar_group_commit_stat_reset'
+LANGUAGE C PARALLEL SAFE;
+
+REVOKE ALL ON FUNCTION polar_group_commit_stat FROM PUBLIC;
+REVOKE ALL ON FUNCTION polar_group_commit_stat_reset FROM PUBLIC;
+
 -- proxy monitor
 CREATE FUNCTION polar_stat_get_pid(pid int default NULL)
 RETURNS INT
@@ -418,6 +483,34 @@ RETURNS record
 AS 'MODULE_PATHNAME', 'polar_xlog_queue_stat_detail'
 LANGUAGE C PARALLEL SAFE;
 
+CREATE FUNCTION polar_rel_size_cache_stat(
+	OUT tombstone_num int4,
+	OUT tombstone_overflow bool,
+	OUT skip_search int8,
+	OUT search int8,
+	OUT skip_entry int8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_rel_size_cache_stat'
+LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION polar_record_cache_stat(
+	OUT slot_num int4,
+	OUT hit int8,
+	OUT miss int8,
+	OUT insert int8,
+	OUT evict int8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_record_cache_stat'
+LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION polar_logindex_overflow_stat(
+	OUT mem_tbl_num int8,
+	OUT overflow_tbl_num int8,
+	OUT overflow_count int8)
+RETURNS record
+AS 'MODULE_PATHNAME', 'polar_logindex_overflow_stat'
+LANGUAGE C PARALLEL SAFE;
+
 CREATE FUNCTION polar_get_xlog_queue_ref_info_func(
 	OUT ref_name text,
 	OUT ref_pread int8,
@@ -615,6 +708,14 @@ AS 'MODULE_PATHNAME', 'polar_pg_stat_get_bulk_read_blocks_IO'
 LANGUAGE C PARALLEL SAFE;
 REVOKE ALL ON FUNCTION polar_pg_stat_get_bulk_read_blocks_IO(IN oid, OUT int8) FROM PUBLIC;
 
+CREATE FUNCTION polar_pg_stat_get_bulk_read_blocks_prefetch(
+            IN  oid,
+            OUT int8
+)
+AS 'MODULE_PATHNAME', 'polar_pg_stat_get_bulk_read_blocks_prefetch'
+LANGUAGE C PARALLEL SAFE;
+REVOKE ALL ON FUNCTION polar_pg_stat_get_bulk_read_blocks_prefetch(IN oid, OUT int8) FROM PUBLIC;
+
 CREATE VIEW polar_pg_statio_all_tables AS
     SELECT
             C.oid AS relid,
@@ -623,6 +724,7 @@ CREATE VIEW polar_pg_statio_all_tables AS
 			polar_pg_stat_get_bulk_read_calls(C.oid) AS heap_bulk_read_calls,
 			polar_pg_stat_get_bulk_read_calls_IO(C.oid) AS heap_bulk_read_calls_IO,
 			polar_pg_stat_get_bulk_read_blocks_IO(C.oid) AS heap_bulk_read_blks_IO,
+			polar_pg_stat_get_bulk_read_blocks_prefetch(C.oid) AS heap_bulk_read_blks_prefetch,
 
             sum(polar_pg_stat_get_bulk_read_calls(I.indexrelid))::bigint AS idx_bulk_read_calls,
             sum(polar_pg_stat_get_bulk_read_calls_IO(I.indexrelid))::bigint AS idx_bulk_read_calls_IO,
@@ -658,14 +760,17 @@ CREATE OR REPLACE FUNCTION polar_xlog_buffer_stat_info(
 					OUT hit_count int8,
                     OUT io_count int8,
                     OUT others_append_count int8,
-                    OUT startup_append_count int8)
+                    OUT startup_append_count int8,
+                    OUT conflict_miss_count int8,
+                    OUT read_ahead_count int8)
 RETURNS record
 AS 'MODULE_PATHNAME', 'polar_xlog_buffer_stat_info'
 LANGUAGE C PARALLEL SAFE;
 
 REVOKE ALL ON FUNCTION polar_xlog_buffer_stat_info(OUT hit_count int8,
     OUT io_count int8, OUT others_append_count int8,
-    OUT startup_append_count int8) FROM PUBLIC;
+    OUT startup_append_count int8, OUT conflict_miss_count int8,
+    OUT read_ahead_count int8) FROM PUBLIC;
 
 CREATE FUNCTION polar_xlog_buffer_stat_reset()
 RETURNS VOID
@@ -25,6 +25,7 @@
 
 #include "postgres.h"
 
+#include "access/htup_details.h"
 #include "access/xlog.h"
 #include "fmgr.h"
 #include "access/polar_logindex.h"
@@ -123,6 +124,66 @@ polar_is_available(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(polar_get_available_state());
 }
 
+/*
+ * Return the adaptive group commit statistics
+ */
+PG_FUNCTION_INFO_V1(polar_group_commit_stat);
+Datum
+polar_group_commit_stat(PG_FUNCTION_ARGS)
+{
+#define GROUP_COMMIT_STAT_COL_SIZE 10
+	TupleDesc	tupdesc;
+	Datum		values[GROUP_COMMIT_STAT_COL_SIZE];
+	bool		nulls[GROUP_COMMIT_STAT_COL_SIZE];
+	HeapTuple	tuple;
+	PolarGroupCommitStat stat;
+
+	tupdesc = CreateTemplateTupleDesc(GROUP_COMMIT_STAT_COL_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "flush_count", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "request_count", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "avg_batch_size", FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "max_batch_size", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "delay_count", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "delay_time_us", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "max_delay_us", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "flush_latency_us", FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "flush_latency_p99_us", FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "request_per_sec", FLOAT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	polar_get_group_commit_stat(&stat);
+
+	values[0] = Int64GetDatum(stat.flush_count);
+	values[1] = Int64GetDatum(stat.request_count);
+	values[2] = Float8GetDatum(stat.flush_count > 0 ?
+							   (double) stat.request_count / stat.flush_count : 0);
+	values[3] = Int64GetDatum(stat.max_batch_size);
+	values[4] = Int64GetDatum(stat.delay_count);
+	values[5] = Int64GetDatum(stat.delay_time);
+	values[6] = Int64GetDatum(stat.max_delay);
+	values[7] = Float8GetDatum(stat.flush_latency);
+	values[8] = Float8GetDatum(stat.flush_latency_p99);
+	values[9] = Float8GetDatum(stat.request_rate * 1000000.0);
+
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+/*
+ * Reset the adaptive group commit statistics
+ */
+PG_FUNCTION_INFO_V1(polar_group_commit_stat_reset);
+Datum
+polar_group_commit_stat_reset(PG_FUNCTION_ARGS)
+{
+	polar_reset_group_commit_stat();
+
+	PG_RETURN_VOID();
+}
+
 /* Get fullpage logindex snapshot used mem table size */
 PG_FUNCTION_INFO_V1(polar_used_logindex_fullpage_snapshot_mem_tbl_size);
 Datum
@@ -220,6 +281,22 @@ polar_pg_stat_get_bulk_read_blocks_IO(PG_FUNCTION_ARGS)
 	PG_RETURN_INT64(result);
 }
 
+PG_FUNCTION_INFO_V1(polar_pg_stat_get_bulk_read_blocks_prefetch);
+Datum
+polar_pg_stat_get_bulk_read_blocks_prefetch(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	int64		result;
+	PgStat_StatTabEntry *tabentry;
+
+	if ((tabentry = pgstat_fetch_stat_tabentry(relid)) == NULL)
+		result = 0;
+	else
+		result = (int64) (tabentry->polar_bulk_read_blocks_prefetch);
+
+	PG_RETURN_INT64(result);
+}
+
 /* POLAR: Bulk create index extend stats */
 /* Per table (or index) */
 PG_FUNCTION_INFO_V1(polar_pg_stat_get_bulk_create_index_extend_times);
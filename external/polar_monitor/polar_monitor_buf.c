@@ -18,8 +18,10 @@
 #include "access/xlog.h"
 #include "catalog/pg_type.h"
 #include "funcapi.h"
+#include "postmaster/polar_parallel_bgwriter.h"
 #include "storage/polar_copybuf.h"
 #include "storage/polar_flush.h"
+#include "storage/polar_prefetch.h"
 #include "utils/guc.h"
 #include "utils/pg_lsn.h"
 
@@ -487,6 +489,103 @@ polar_flushlist(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
 }
 
+PG_FUNCTION_INFO_V1(polar_flush_write_stat);
+
+/*
+ * Write calls of buffers got from flush list and the average io size, which
+ * grows when adjacent blocks are coalesced.
+ */
+Datum
+polar_flush_write_stat(PG_FUNCTION_ARGS)
+{
+#define FLUSH_WRITE_COLUMN_SIZE 3
+
+	TupleDesc	tupdesc;
+	Datum		values[FLUSH_WRITE_COLUMN_SIZE];
+	bool		nulls[FLUSH_WRITE_COLUMN_SIZE];
+	uint64		write;
+	uint64		write_blocks;
+
+	if (!polar_flush_list_enabled())
+		PG_RETURN_NULL();
+
+	tupdesc = CreateTemplateTupleDesc(FLUSH_WRITE_COLUMN_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "write", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "write_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "avg_io_size", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	write = pg_atomic_read_u64(&polar_flush_ctl->write);
+	write_blocks = pg_atomic_read_u64(&polar_flush_ctl->write_blocks);
+
+	values[0] = UInt64GetDatum(write);
+	values[1] = UInt64GetDatum(write_blocks);
+	values[2] = UInt64GetDatum(write > 0 ? write_blocks * BLCKSZ / write : 0);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+PG_FUNCTION_INFO_V1(polar_bgwriter_control_history);
+
+/*
+ * The latest decisions of parallel bgwriter controller, from the oldest to
+ * the newest.
+ */
+Datum
+polar_bgwriter_control_history(PG_FUNCTION_ARGS)
+{
+#define BGWRITER_CONTROL_COLUMN_SIZE 9
+
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	ParallelBgwriterInfo *info = polar_parallel_bgwriter_info;
+	polar_bgwriter_control_sample *history;
+	uint64		count;
+	uint64		i;
+
+	InitMaterializedSRF(fcinfo, MAT_SRF_USE_EXPECTED_DESC);
+
+	if (!polar_parallel_bgwriter_enabled() || info == NULL)
+		return (Datum) 0;
+
+	history = palloc(sizeof(info->control_history));
+
+	SpinLockAcquire(&info->control_lock);
+	count = info->control_count;
+	memcpy(history, info->control_history, sizeof(info->control_history));
+	SpinLockRelease(&info->control_lock);
+
+	for (i = count > POLAR_BGWRITER_CONTROL_HISTORY_SIZE ?
+		 count - POLAR_BGWRITER_CONTROL_HISTORY_SIZE : 0; i < count; i++)
+	{
+		polar_bgwriter_control_sample *sample = &history[i % POLAR_BGWRITER_CONTROL_HISTORY_SIZE];
+		Datum		values[BGWRITER_CONTROL_COLUMN_SIZE];
+		bool		nulls[BGWRITER_CONTROL_COLUMN_SIZE];
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = TimestampTzGetDatum(sample->time);
+		values[1] = UInt64GetDatum(sample->consistent_lag);
+		if (sample->clean_ratio < 0)
+			nulls[2] = true;
+		else
+			values[2] = Float8GetDatum(sample->clean_ratio);
+		values[3] = Float8GetDatum(sample->error);
+		values[4] = Float8GetDatum(sample->integral);
+		values[5] = Float8GetDatum(sample->derivative);
+		values[6] = Float8GetDatum(sample->output);
+		values[7] = Int32GetDatum(sample->workers);
+		values[8] = Int32GetDatum(sample->batch_size);
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	pfree(history);
+
+	return (Datum) 0;
+}
+
 PG_FUNCTION_INFO_V1(polar_cbuf);
 
 Datum
@@ -520,6 +619,45 @@ polar_cbuf(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
 }
 
+PG_FUNCTION_INFO_V1(polar_cbuf_partition);
+
+/*
+ * The freelist pressure of every copy buffer partition.
+ */
+Datum
+polar_cbuf_partition(PG_FUNCTION_ARGS)
+{
+#define CBUF_PARTITION_COLUMN_SIZE 6
+
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	int			i;
+
+	InitMaterializedSRF(fcinfo, MAT_SRF_USE_EXPECTED_DESC);
+
+	if (!polar_copy_buffer_enabled() || polar_copy_buffer_ctl == NULL)
+		return (Datum) 0;
+
+	for (i = 0; i < polar_copy_buffer_ctl->partition_num; i++)
+	{
+		CopyBufferPartition *part = &polar_copy_buffer_ctl->partition[i].part;
+		Datum		values[CBUF_PARTITION_COLUMN_SIZE];
+		bool		nulls[CBUF_PARTITION_COLUMN_SIZE];
+
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(i);
+		values[1] = Int32GetDatum(part->size);
+		values[2] = Int32GetDatum(Min(pg_atomic_read_u32(&part->free_count), part->size));
+		values[3] = UInt64GetDatum(pg_atomic_read_u64(&part->alloc_count));
+		values[4] = UInt64GetDatum(pg_atomic_read_u64(&part->remote_count));
+		values[5] = UInt64GetDatum(pg_atomic_read_u64(&part->empty_count));
+
+		tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, nulls);
+	}
+
+	return (Datum) 0;
+}
+
 PG_FUNCTION_INFO_V1(polar_backend_flush);
 Datum
 polar_backend_flush(PG_FUNCTION_ARGS)
@@ -571,3 +709,43 @@ polar_lru_flush_info(PG_FUNCTION_ARGS)
 
 	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
 }
+
+PG_FUNCTION_INFO_V1(polar_prefetch_stat);
+
+/*
+ * Blocks which are queued for the prefetch workers, and how they end up.
+ */
+Datum
+polar_prefetch_stat(PG_FUNCTION_ARGS)
+{
+#define PREFETCH_COLUMN_SIZE 7
+
+	TupleDesc	tupdesc;
+	Datum		values[PREFETCH_COLUMN_SIZE];
+	bool		nulls[PREFETCH_COLUMN_SIZE];
+
+	if (!polar_prefetch_enabled())
+		PG_RETURN_NULL();
+
+	tupdesc = CreateTemplateTupleDesc(PREFETCH_COLUMN_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "workers", INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "requested_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "dropped_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "read_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "hit_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "skipped_blocks", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "failed_requests", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int32GetDatum(polar_prefetch_workers);
+	values[1] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->requested_blocks));
+	values[2] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->dropped_blocks));
+	values[3] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->read_blocks));
+	values[4] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->hit_blocks));
+	values[5] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->skipped_blocks));
+	values[6] = UInt64GetDatum(pg_atomic_read_u64(&polar_prefetch_ctl->failed_requests));
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -43,6 +43,9 @@
 #define XLOG_QUEUE_INFO_COLUMN_SIZE 3
 #define XLOG_QUEUE_STAT_DETIAL_COL_SIZE 10
 #define XLOG_QUEUE_SLOTS_INFO_COLUMN_SIZE 5
+#define REL_SIZE_CACHE_STAT_COL_SIZE 5
+#define RECORD_CACHE_STAT_COL_SIZE 5
+#define LOGINDEX_OVERFLOW_STAT_COL_SIZE 3
 static polar_ringbuf_slot_t *slots_info = NULL;
 static uint64 rbuf_occupied;
 
@@ -263,6 +266,122 @@ polar_xlog_queue_stat_detail(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(result);
 }
 
+/*
+ * return the tombstone statistics of relation size cache
+ */
+PG_FUNCTION_INFO_V1(polar_rel_size_cache_stat);
+Datum
+polar_rel_size_cache_stat(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[REL_SIZE_CACHE_STAT_COL_SIZE];
+	bool		nulls[REL_SIZE_CACHE_STAT_COL_SIZE];
+	HeapTuple	tuple;
+	polar_rel_size_cache_t cache;
+
+	if (polar_logindex_redo_instance == NULL || polar_logindex_redo_instance->rel_size_cache == NULL)
+		PG_RETURN_NULL();
+
+	cache = polar_logindex_redo_instance->rel_size_cache;
+
+	tupdesc = CreateTemplateTupleDesc(REL_SIZE_CACHE_STAT_COL_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "tombstone_num", INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "tombstone_overflow", BOOLOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "skip_search", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "search", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "skip_entry", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	LWLockAcquire(POLAR_REL_SIZE_CACHE_LOCK(cache), LW_SHARED);
+	values[0] = Int32GetDatum(cache->tombstone_num);
+	values[1] = BoolGetDatum(cache->tombstone_overflow);
+	LWLockRelease(POLAR_REL_SIZE_CACHE_LOCK(cache));
+
+	values[2] = Int64GetDatum(pg_atomic_read_u64(&cache->skip_search));
+	values[3] = Int64GetDatum(pg_atomic_read_u64(&cache->search));
+	values[4] = Int64GetDatum(pg_atomic_read_u64(&cache->skip_entry));
+
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+/*
+ * return the statistics of decoded record cache
+ */
+PG_FUNCTION_INFO_V1(polar_record_cache_stat);
+Datum
+polar_record_cache_stat(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[RECORD_CACHE_STAT_COL_SIZE];
+	bool		nulls[RECORD_CACHE_STAT_COL_SIZE];
+	HeapTuple	tuple;
+	polar_record_cache_t cache;
+
+	if (polar_logindex_redo_instance == NULL || polar_logindex_redo_instance->record_cache == NULL)
+		PG_RETURN_NULL();
+
+	cache = polar_logindex_redo_instance->record_cache;
+
+	tupdesc = CreateTemplateTupleDesc(RECORD_CACHE_STAT_COL_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "slot_num", INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "hit", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "miss", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "insert", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "evict", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int32GetDatum(cache->slot_num);
+	values[1] = Int64GetDatum(pg_atomic_read_u64(&cache->hit));
+	values[2] = Int64GetDatum(pg_atomic_read_u64(&cache->miss));
+	values[3] = Int64GetDatum(pg_atomic_read_u64(&cache->insert));
+	values[4] = Int64GetDatum(pg_atomic_read_u64(&cache->evict));
+
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+/*
+ * return the number of wal logindex memory tables and overflow tables
+ */
+PG_FUNCTION_INFO_V1(polar_logindex_overflow_stat);
+Datum
+polar_logindex_overflow_stat(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[LOGINDEX_OVERFLOW_STAT_COL_SIZE];
+	bool		nulls[LOGINDEX_OVERFLOW_STAT_COL_SIZE];
+	HeapTuple	tuple;
+	logindex_snapshot_t snapshot;
+
+	if (polar_logindex_redo_instance == NULL || polar_logindex_redo_instance->wal_logindex_snapshot == NULL)
+		PG_RETURN_NULL();
+
+	snapshot = polar_logindex_redo_instance->wal_logindex_snapshot;
+
+	tupdesc = CreateTemplateTupleDesc(LOGINDEX_OVERFLOW_STAT_COL_SIZE);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "mem_tbl_num", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "overflow_tbl_num", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "overflow_count", INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int64GetDatum(polar_logindex_mem_tbl_size(snapshot));
+	values[1] = Int64GetDatum(polar_logindex_overflow_tbl_size(snapshot));
+	values[2] = Int64GetDatum(polar_logindex_overflow_count(snapshot));
+
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
 /*
  * polar_get_xlog_queue_ref_info_func
  *
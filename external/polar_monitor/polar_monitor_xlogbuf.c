@@ -45,7 +45,7 @@ PG_FUNCTION_INFO_V1(polar_xlog_buffer_stat_info);
 Datum
 polar_xlog_buffer_stat_info(PG_FUNCTION_ARGS)
 {
-#define XLOG_BUFFER_STAT_INFO_COL_SIZE 4
+#define XLOG_BUFFER_STAT_INFO_COL_SIZE 6
 	TupleDesc	tupdesc;
 	Datum		values[XLOG_BUFFER_STAT_INFO_COL_SIZE];
 	bool		nulls[XLOG_BUFFER_STAT_INFO_COL_SIZE];
@@ -56,6 +56,8 @@ polar_xlog_buffer_stat_info(PG_FUNCTION_ARGS)
 	int64		io_count = 0;
 	int64		others_append_count = 0;
 	int64		startup_append_count = 0;
+	int64		conflict_miss_count = 0;
+	int64		read_ahead_count = 0;
 
 	if (!polar_xlog_buffer_ins)
 		PG_RETURN_NULL();
@@ -65,6 +67,8 @@ polar_xlog_buffer_stat_info(PG_FUNCTION_ARGS)
 	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "io_count", INT8OID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "others_append_count", INT8OID, -1, 0);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "startup_append_count", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "conflict_miss_count", INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "read_ahead_count", INT8OID, -1, 0);
 	tupdesc = BlessTupleDesc(tupdesc);
 
 	MemSet(nulls, 0, sizeof(nulls));
@@ -73,11 +77,15 @@ polar_xlog_buffer_stat_info(PG_FUNCTION_ARGS)
 	io_count = pg_atomic_read_u64(&polar_xlog_buffer_ins->io_count);
 	others_append_count = pg_atomic_read_u64(&polar_xlog_buffer_ins->others_append_count);
 	startup_append_count = pg_atomic_read_u64(&polar_xlog_buffer_ins->startup_append_count);
+	conflict_miss_count = pg_atomic_read_u64(&polar_xlog_buffer_ins->conflict_miss_count);
+	read_ahead_count = pg_atomic_read_u64(&polar_xlog_buffer_ins->read_ahead_count);
 
 	values[0] = Int64GetDatum(hit_count);
 	values[1] = Int64GetDatum(io_count);
 	values[2] = Int64GetDatum(others_append_count);
 	values[3] = Int64GetDatum(startup_append_count);
+	values[4] = Int64GetDatum(conflict_miss_count);
+	values[5] = Int64GetDatum(read_ahead_count);
 
 	tuple = heap_form_tuple(tupdesc, values, nulls);
 	result = HeapTupleGetDatum(tuple);
@@ -101,6 +109,8 @@ polar_xlog_buffer_stat_reset(PG_FUNCTION_ARGS)
 	pg_atomic_write_u64(&polar_xlog_buffer_ins->io_count, 0);
 	pg_atomic_write_u64(&polar_xlog_buffer_ins->others_append_count, 0);
 	pg_atomic_write_u64(&polar_xlog_buffer_ins->startup_append_count, 0);
+	pg_atomic_write_u64(&polar_xlog_buffer_ins->conflict_miss_count, 0);
+	pg_atomic_write_u64(&polar_xlog_buffer_ins->read_ahead_count, 0);
 
 	PG_RETURN_VOID();
 }
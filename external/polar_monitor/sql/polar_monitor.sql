@@ -7,9 +7,13 @@ create extension polar_monitor;
 select COUNT(*) >= 0 AS result from polar_normal_buffercache;
 select COUNT(*) >= 0 AS result from polar_copy_buffercache;
 select COUNT(polar_flushlist()) >= 0 As result;
+select COUNT(polar_flush_write_stat()) >= 0 As result;
+select COUNT(*) >= 0 As result FROM polar_bgwriter_control_history();
 select COUNT(polar_cbuf()) >= 0 As result;
+select COUNT(*) >= 0 As result FROM polar_cbuf_partition();
 select COUNT(polar_backend_flush()) >= 0 As result;
 select COUNT(polar_lru_flush_info()) >= 0 As result;
+select COUNT(polar_prefetch_stat()) >= 0 As result;
 
 -- polar_stat_activity
 select a = b is_equal from (select
@@ -86,6 +90,18 @@ select polar_is_available();
 select polar_set_available(true);
 select polar_is_available();
 
+-- check adaptive group commit stat
+select polar_group_commit_stat_reset();
+set polar_group_commit_target_latency = 10000;
+create table group_commit_test(a int);
+insert into group_commit_test values (1);
+insert into group_commit_test values (2);
+select (not current_setting('fsync')::bool or flush_count > 0) as flushed,
+       max_batch_size <= request_count as batch_size
+       from polar_group_commit_stat();
+reset polar_group_commit_target_latency;
+drop table group_commit_test;
+
 -- pfsadm du for unexists path
 select * from pfs_du_with_depth(1, 'mock/du_path');
 
@@ -416,6 +416,10 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 		scan->rs_cbuf = polar_bulk_read_buffer_extended(scan->rs_base.rs_rd, MAIN_FORKNUM, page,
 														RBM_NORMAL, scan->rs_strategy,
 														polar_max_block_count);
+
+		/* Prefetch the blocks ahead of the scan */
+		polar_bulk_read_prefetch(scan->rs_base.rs_rd, MAIN_FORKNUM, page,
+								 polar_max_block_count, scan->rs_nblocks);
 	}							/* POLAR end */
 	else
 	{
@@ -45,6 +45,10 @@
 #include "utils/builtins.h"
 #include "utils/rel.h"
 
+/* POLAR */
+#include "storage/polar_bufmgr.h"
+#include "utils/guc.h"
+
 static void reform_and_rewrite_tuple(HeapTuple tuple,
 									 Relation OldHeap, Relation NewHeap,
 									 Datum *values, bool *isnull, RewriteState rwstate);
@@ -2133,11 +2137,32 @@ heapam_scan_bitmap_next_block(TableScanDesc scan,
 		return false;
 
 	/*
-	 * Acquire pin on the target heap page, trading in any pin we held before.
+	 * POLAR: bulk read the following blocks of the bitmap together with this
+	 * one if they are consecutive. Only the run of the bitmap is read, blocks
+	 * after it are not in the bitmap and are never read ahead.
 	 */
-	hscan->rs_cbuf = ReleaseAndReadBuffer(hscan->rs_cbuf,
-										  scan->rs_rd,
-										  page);
+	if (polar_bulk_read_size > 0 && tbmres->polar_nblocks > 1 &&
+		page < hscan->rs_nblocks)
+	{
+		BlockNumber polar_max_block_count = Min((BlockNumber) tbmres->polar_nblocks,
+												hscan->rs_nblocks - page);
+
+		if (BufferIsValid(hscan->rs_cbuf))
+			ReleaseBuffer(hscan->rs_cbuf);
+		hscan->rs_cbuf = polar_bulk_read_buffer_extended(scan->rs_rd, MAIN_FORKNUM, page,
+														 RBM_NORMAL, NULL,
+														 polar_max_block_count);
+	}							/* POLAR end */
+	else
+	{
+		/*
+		 * Acquire pin on the target heap page, trading in any pin we held
+		 * before.
+		 */
+		hscan->rs_cbuf = ReleaseAndReadBuffer(hscan->rs_cbuf,
+											  scan->rs_rd,
+											  page);
+	}
 	hscan->rs_cblock = page;
 	buffer = hscan->rs_cbuf;
 	snapshot = scan->rs_snapshot;
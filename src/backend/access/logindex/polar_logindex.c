@@ -40,6 +40,7 @@
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "port/pg_crc32c.h"
+#include "port/pg_lfind.h"
 #include "postmaster/startup.h"
 #include "storage/fd.h"
 #include "utils/faultinjector.h"
@@ -48,10 +49,35 @@
 int			polar_logindex_table_batch_size = 1;
 int			polar_max_logindex_files;
 int			polar_trace_logindex_messages = LOG;
+int			polar_logindex_search_fanout = 1;
+bool		polar_logindex_compress_table = false;
+int			polar_logindex_max_overflow_tables = 0;
 
 static log_index_io_err_t logindex_io_err = 0;
 static int	logindex_errno = 0;
 
+/* Buffer to save compressed table */
+static char *logindex_zip_buf = NULL;
+
+/*
+ * Buffers to copy overflow table. They and the attached dsa areas below live
+ * as long as the process, so they are allocated in TopMemoryContext.
+ */
+static log_idx_table_data_t *logindex_overflow_buf = NULL;
+static log_mem_table_t *logindex_overflow_flush_buf = NULL;
+
+/* Dsa areas of overflow tables which are attached by this process */
+#define LOG_INDEX_MAX_OVERFLOW_AREA (8)
+
+typedef struct log_index_overflow_area_t
+{
+	log_index_snapshot_t *logindex_snapshot;
+	dsa_area   *area;
+}			log_index_overflow_area_t;
+
+static log_index_overflow_area_t logindex_overflow_areas[LOG_INDEX_MAX_OVERFLOW_AREA];
+static int	logindex_overflow_area_num = 0;
+
 static void log_index_insert_new_item(log_index_lsn_t * lsn_info, log_mem_table_t * table, uint32 key, log_seg_id_t new_item_id);
 static void log_index_insert_new_seg(log_mem_table_t * table, log_seg_id_t head, log_seg_id_t seg_id, log_index_lsn_t * lsn_info);
 
@@ -81,11 +107,15 @@ XLogRecPtr
 log_index_item_max_lsn(log_idx_table_data_t * table, log_item_head_t * item)
 {
 	log_item_seg_t *seg;
+	log_seg_id_t tail_seg = item->tail_seg;
+
+	/* Read the segment after it's published by tail_seg */
+	pg_read_barrier();
 
-	if (item->head_seg == item->tail_seg)
+	if (item->head_seg == tail_seg)
 		return LOG_INDEX_SEG_MAX_LSN(table, item);
 
-	seg = log_index_item_seg(table, item->tail_seg);
+	seg = log_index_item_seg(table, tail_seg);
 	POLAR_ASSERT_PANIC(seg != NULL);
 
 	return LOG_INDEX_SEG_MAX_LSN(table, seg);
@@ -136,6 +166,8 @@ polar_logindex_shmem_size(uint64 logindex_mem_tbl_size, int bloom_blocks)
 
 	size = add_size(size, log_index_lwlock_shmem_size(logindex_mem_tbl_size));
 
+	size = add_size(size, MAXALIGN(dsa_minimum_size()));
+
 	return CACHELINEALIGN(size);
 }
 
@@ -161,6 +193,241 @@ log_index_table_saved_before_promote(log_index_snapshot_t * logindex_snapshot, l
 	return saved;
 }
 
+static dsa_area *
+log_index_overflow_area(log_index_snapshot_t * logindex_snapshot)
+{
+	MemoryContext oldcontext;
+	dsa_area   *area;
+	int			i;
+
+	for (i = 0; i < logindex_overflow_area_num; i++)
+	{
+		if (logindex_overflow_areas[i].logindex_snapshot == logindex_snapshot)
+			return logindex_overflow_areas[i].area;
+	}
+
+	if (logindex_overflow_area_num >= LOG_INDEX_MAX_OVERFLOW_AREA)
+		elog(PANIC, "Too many logindex snapshots to attach overflow table area");
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+	area = dsa_attach_in_place(logindex_snapshot->overflow_area, NULL);
+	dsa_pin_mapping(area);
+	MemoryContextSwitchTo(oldcontext);
+
+	logindex_overflow_areas[logindex_overflow_area_num].logindex_snapshot = logindex_snapshot;
+	logindex_overflow_areas[logindex_overflow_area_num].area = area;
+	logindex_overflow_area_num++;
+
+	return area;
+}
+
+/*
+ * Move the content of inactive table to an overflow table, then this table
+ * can be reused without waiting for saving it. Caller must hold the table's
+ * lock. Return false if there's no overflow table available.
+ */
+static bool
+log_index_overflow_table(log_index_snapshot_t * logindex_snapshot, log_mem_table_t * table)
+{
+	log_index_overflow_t *overflow = &logindex_snapshot->overflow;
+	log_idx_table_id_t tid = LOG_INDEX_MEM_TBL_TID(table);
+	dsa_area   *area;
+	dsa_pointer dp;
+	bool		succeed = false;
+
+	/*
+	 * The table is saved by this process in replica, and dsm segment can't
+	 * be created in critical section
+	 */
+	if (overflow->num >= polar_logindex_max_overflow_tables || CritSectionCount > 0 ||
+		!polar_logindex_check_state(logindex_snapshot, POLAR_LOGINDEX_STATE_WRITABLE))
+		return false;
+
+	area = log_index_overflow_area(logindex_snapshot);
+	dp = dsa_allocate_extended(area, sizeof(log_mem_table_t), DSA_ALLOC_HUGE | DSA_ALLOC_NO_OOM);
+
+	if (!DsaPointerIsValid(dp))
+		return false;
+
+	memcpy(dsa_get_address(area, dp), table, sizeof(log_mem_table_t));
+
+	LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_EXCLUSIVE);
+
+	/* Overflow tables must be continuous to be saved by table id order */
+	if (overflow->num == 0 || overflow->min_tid + overflow->num == tid)
+	{
+		if (overflow->num == 0)
+			overflow->min_tid = tid;
+
+		overflow->table[(overflow->head + overflow->num) % LOG_INDEX_MAX_OVERFLOW_TBL_NUM] = dp;
+		overflow->num++;
+		overflow->max_lsn = table->data.max_lsn;
+		overflow->overflow_count++;
+		succeed = true;
+	}
+
+	LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+
+	if (!succeed)
+	{
+		dsa_free(area, dp);
+		return false;
+	}
+
+	ereport(polar_trace_logindex(DEBUG4), (errmsg("move logindex tid=%ld to overflow table", tid),
+										   errhidestmt(true),
+										   errhidecontext(true)));
+
+	/* Readers get this table from overflow table until it's saved */
+	LOG_INDEX_MEM_TBL_SET_STATE(table, LOG_INDEX_MEM_TBL_STATE_FLUSHED);
+
+	return true;
+}
+
+/*
+ * Save overflow tables by table id order and free them. Return true if there's
+ * no overflow table left.
+ */
+static bool
+log_index_flush_overflow_table(log_index_snapshot_t * logindex_snapshot, int *flushed)
+{
+	log_index_overflow_t *overflow = &logindex_snapshot->overflow;
+	dsa_area   *area = NULL;
+
+	if (logindex_overflow_flush_buf == NULL)
+		logindex_overflow_flush_buf = MemoryContextAlloc(TopMemoryContext,
+														 sizeof(log_mem_table_t));
+
+	for (;;)
+	{
+		log_mem_table_t *table;
+		log_idx_table_id_t tid;
+		dsa_pointer dp = InvalidDsaPointer;
+		bool		flushable;
+		bool		succeed = false;
+
+		LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_SHARED);
+
+		if (overflow->num == 0)
+		{
+			LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+			break;
+		}
+
+		if (area == NULL)
+			area = log_index_overflow_area(logindex_snapshot);
+
+		tid = overflow->min_tid;
+		table = dsa_get_address(area, overflow->table[overflow->head]);
+
+		/*
+		 * The table can be freed by others once the lock is released, so
+		 * write a copy of it without holding the lock during io.
+		 */
+		flushable = logindex_snapshot->table_flushable(table, logindex_snapshot->extra_data);
+		if (flushable)
+			memcpy(logindex_overflow_flush_buf, table, sizeof(log_mem_table_t));
+
+		LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+
+		if (flushable)
+		{
+			table = logindex_overflow_flush_buf;
+
+			if (log_index_table_saved_before_promote(logindex_snapshot, table))
+				succeed = true;
+			else
+				succeed = log_index_write_table(logindex_snapshot, table);
+		}
+
+		if (!succeed)
+			return false;
+
+		LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_EXCLUSIVE);
+
+		if (overflow->num > 0 && overflow->min_tid == tid)
+		{
+			dp = overflow->table[overflow->head];
+			overflow->head = (overflow->head + 1) % LOG_INDEX_MAX_OVERFLOW_TBL_NUM;
+			overflow->min_tid++;
+			overflow->num--;
+		}
+
+		LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+
+		if (DsaPointerIsValid(dp))
+		{
+			dsa_free(area, dp);
+
+			if (flushed != NULL)
+				(*flushed)++;
+		}
+	}
+
+	/* Return the memory to operating system after all tables are saved */
+	if (area != NULL)
+		dsa_trim(area);
+
+	return true;
+}
+
+/*
+ * Return overflow table whose table id is tid. The table data is copied to
+ * a buffer of this process, and it's valid until next call.
+ */
+log_idx_table_data_t *
+log_index_read_overflow_table(log_index_snapshot_t * logindex_snapshot, log_idx_table_id_t tid)
+{
+	log_index_overflow_t *overflow = &logindex_snapshot->overflow;
+	log_idx_table_data_t *data = NULL;
+
+	if (overflow->num == 0)
+		return NULL;
+
+	if (logindex_overflow_buf == NULL)
+		logindex_overflow_buf = MemoryContextAlloc(TopMemoryContext,
+												   sizeof(log_idx_table_data_t));
+
+	LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_SHARED);
+
+	if (overflow->num > 0 && tid >= overflow->min_tid && tid < overflow->min_tid + overflow->num)
+	{
+		dsa_area   *area = log_index_overflow_area(logindex_snapshot);
+		uint32		idx = (overflow->head + (tid - overflow->min_tid)) % LOG_INDEX_MAX_OVERFLOW_TBL_NUM;
+		log_mem_table_t *table = dsa_get_address(area, overflow->table[idx]);
+
+		memcpy(logindex_overflow_buf, &table->data, sizeof(log_idx_table_data_t));
+		data = logindex_overflow_buf;
+	}
+
+	LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+
+	return data;
+}
+
+/*
+ * Overflow tables can be read as saved tables by log_index_read_table, so
+ * extend the max saved table id and lsn of the copied meta to include them.
+ */
+void
+log_index_overflow_extend_meta(log_index_snapshot_t * logindex_snapshot, log_index_meta_t * meta)
+{
+	log_index_overflow_t *overflow = &logindex_snapshot->overflow;
+
+	if (overflow->num == 0)
+		return;
+
+	LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_SHARED);
+
+	if (overflow->num > 0)
+	{
+		meta->max_idx_table_id = Max(meta->max_idx_table_id, overflow->min_tid + overflow->num - 1);
+		meta->max_lsn = Max(meta->max_lsn, overflow->max_lsn);
+	}
+
+	LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+}
+
 static bool
 log_index_flush_table(log_index_snapshot_t * logindex_snapshot, XLogRecPtr checkpoint_lsn, bool flush_active)
 {
@@ -174,6 +441,13 @@ log_index_flush_table(log_index_snapshot_t * logindex_snapshot, XLogRecPtr check
 	bool		write_done = false;
 	static XLogRecPtr last_flush_max_lsn = InvalidXLogRecPtr;
 
+	/*
+	 * Overflow tables are older than memory tables, so memory tables can't be
+	 * saved until all overflow tables are saved
+	 */
+	if (!log_index_flush_overflow_table(logindex_snapshot, &flushed))
+		return false;
+
 	SpinLockAcquire(LOG_INDEX_SNAPSHOT_LOCK);
 	mid = meta->max_idx_table_id % logindex_snapshot->mem_tbl_size;
 	SpinLockRelease(LOG_INDEX_SNAPSHOT_LOCK);
@@ -600,21 +874,36 @@ log_index_init_lwlock_array(log_index_snapshot_t * logindex_snapshot, int tranch
 	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_MEMTBL_LOCK_OFFSET, logindex_snapshot->mem_tbl_size,
 						  tranche_id++);
 
-	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_HASH_LOCK_OFFSET, LOG_INDEX_MEM_TBL_HASH_LOCK_NUM,
-						  tranche_id++);
-
 	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_IO_LOCK_OFFSET, 1,
 						  tranche_id++);
 
 	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK_OFFSET, 1,
 						  tranche_id++);
 
+	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_OVERFLOW_LOCK_OFFSET, 1,
+						  tranche_id++);
+
 	log_index_init_lwlock(logindex_snapshot, LOG_INDEX_BLOOM_LRU_LOCK_OFFSET, 1,
 						  tranche_id);
 
 	POLAR_ASSERT_PANIC(tranche_id == tranche_id_end);
 }
 
+/*
+ * Create dsa area for overflow tables. The dsa area uses the same tranche id
+ * as LOG_INDEX_OVERFLOW_LOCK, which is the one before bloom tranche id.
+ */
+static void
+log_index_init_overflow_area(log_index_snapshot_t * logindex_snapshot, int tranche_id_end)
+{
+	dsa_area   *area;
+
+	area = dsa_create_in_place(logindex_snapshot->overflow_area, dsa_minimum_size(),
+							   tranche_id_end - 1, NULL);
+	dsa_pin(area);
+	dsa_detach(area);
+}
+
 static bool
 log_index_page_precedes(int page1, int page2)
 {
@@ -628,10 +917,12 @@ polar_logindex_snapshot_shmem_init(const char *name, uint64 logindex_mem_tbl_siz
 #define LOGINDEX_SNAPSHOT_SUFFIX "_snapshot"
 #define LOGINDEX_LOCK_SUFFIX "_lock"
 #define LOGINDEX_BLOOM_SUFFIX "_bloom"
+#define LOGINDEX_OVERFLOW_SUFFIX "_overflow"
 
 	logindex_snapshot_t logindex_snapshot = NULL;
 	bool		found_snapshot;
 	bool		found_locks;
+	bool		found_overflow;
 	Size		size;
 	char		item_name[POLAR_MAX_SHMEM_NAME];
 
@@ -642,6 +933,9 @@ polar_logindex_snapshot_shmem_init(const char *name, uint64 logindex_mem_tbl_siz
 	StaticAssertStmt(sizeof(log_item_seg_t) == LOG_INDEX_TBL_SEG_SIZE,
 					 "log_item_seg_t size is not same as LOG_INDEX_MEM_TBL_SEG_SIZE");
 
+	StaticAssertStmt(sizeof(log_tag_bucket_t) <= LOG_INDEX_TAG_BUCKET_SIZE,
+					 "log_tag_bucket_t size is larger than LOG_INDEX_TAG_BUCKET_SIZE");
+
 	StaticAssertStmt(LOG_INDEX_FILE_TBL_BLOOM_SIZE > sizeof(log_file_table_bloom_t),
 					 "LOG_INDEX_FILE_TBL_BLOOM_SIZE is not enough for log_file_table_bloom_t");
 
@@ -658,6 +952,9 @@ polar_logindex_snapshot_shmem_init(const char *name, uint64 logindex_mem_tbl_siz
 		ShmemInitStruct(item_name, log_index_lwlock_shmem_size(logindex_mem_tbl_size),
 						&found_locks);
 
+	snprintf(item_name, POLAR_MAX_SHMEM_NAME, "%s%s", name, LOGINDEX_OVERFLOW_SUFFIX);
+	logindex_snapshot->overflow_area = ShmemInitStruct(item_name, dsa_minimum_size(), &found_overflow);
+
 	if (!IsUnderPostmaster)
 	{
 		POLAR_ASSERT_PANIC(!found_snapshot && !found_locks);
@@ -666,6 +963,7 @@ polar_logindex_snapshot_shmem_init(const char *name, uint64 logindex_mem_tbl_siz
 		pg_atomic_init_u32(&logindex_snapshot->state, 0);
 
 		log_index_init_lwlock_array(logindex_snapshot, tranche_id_begin, tranche_id_end);
+		log_index_init_overflow_area(logindex_snapshot, tranche_id_end);
 
 		logindex_snapshot->max_allocated_seg_no = 0;
 		logindex_snapshot->table_flushable = table_flushable;
@@ -675,9 +973,11 @@ polar_logindex_snapshot_shmem_init(const char *name, uint64 logindex_mem_tbl_siz
 
 		strlcpy(logindex_snapshot->dir, name, NAMEDATALEN);
 		logindex_snapshot->segment_cache = NULL;
+
+		MemSet(&logindex_snapshot->overflow, 0, sizeof(log_index_overflow_t));
 	}
 	else
-		POLAR_ASSERT_PANIC(found_snapshot && found_locks);
+		POLAR_ASSERT_PANIC(found_snapshot && found_locks && found_overflow);
 
 	logindex_snapshot->bloom_ctl.PagePrecedes = log_index_page_precedes;
 	snprintf(item_name, POLAR_MAX_SHMEM_NAME, " %s%s", name, LOGINDEX_BLOOM_SUFFIX);
@@ -892,7 +1192,9 @@ log_index_force_save_table(log_index_snapshot_t * logindex_snapshot, log_mem_tab
 	}
 	else
 	{
-		if (logindex_snapshot->table_flushable(table, logindex_snapshot->extra_data))
+		/* Overflow tables must be saved before this table */
+		if (log_index_flush_overflow_table(logindex_snapshot, NULL) &&
+			logindex_snapshot->table_flushable(table, logindex_snapshot->extra_data))
 		{
 			bool		succeed = false;
 
@@ -934,10 +1236,11 @@ log_index_wait_active(log_index_snapshot_t * logindex_snapshot, log_mem_table_t
 
 		/*
 		 * We only save table to storage when polar_streaming_xlog_meta is
-		 * true. If the table we are waiting is inactive then force to save it
-		 * in this process.
+		 * true. If the table we are waiting is inactive then move it to
+		 * overflow table, or force to save it in this process.
 		 */
-		if (LOG_INDEX_MEM_TBL_STATE(table) == LOG_INDEX_MEM_TBL_STATE_INACTIVE)
+		if (LOG_INDEX_MEM_TBL_STATE(table) == LOG_INDEX_MEM_TBL_STATE_INACTIVE &&
+			!log_index_overflow_table(logindex_snapshot, table))
 			log_index_force_save_table(logindex_snapshot, table);
 
 		if (LOG_INDEX_MEM_TBL_STATE(table) == LOG_INDEX_MEM_TBL_STATE_FLUSHED)
@@ -971,6 +1274,8 @@ log_index_mem_tbl_exists_page(BufferTag *tag,
 	log_seg_id_t exists = LOG_INDEX_TBL_SLOT_VALUE(table, key);
 	log_item_head_t *item;
 
+	/* Read the item after it's published by hash slot */
+	pg_read_barrier();
 	item = log_index_item_head(table, exists);
 
 	while (item != NULL &&
@@ -983,6 +1288,106 @@ log_index_mem_tbl_exists_page(BufferTag *tag,
 	return exists;
 }
 
+/*
+ * The fingerprint uses 6 bits hash of the page tag, which is independent of
+ * hash slot, and 2 bits of slot position inside its tag bucket. It's never 0,
+ * so empty bucket slot never matches.
+ */
+static inline uint8
+log_index_tag_fingerprint(BufferTag *tag, uint32 key)
+{
+	uint32		h;
+
+	h = murmurhash32(tag->rnode.relNode);
+	h = hash_combine(h, tag->rnode.dbNode ^ tag->rnode.spcNode);
+	h = hash_combine(h, tag->blockNum);
+	h = murmurhash32(hash_combine(h, (uint32) tag->forkNum));
+
+	return (uint8) ((((h % 63) + 1) << 2) | (key / LOG_INDEX_TAG_BUCKET_NUM));
+}
+
+static void
+log_index_tag_bucket_add(log_mem_table_t * table, uint32 key, BufferTag *tag, log_seg_id_t item_id)
+{
+	log_tag_bucket_t *bucket = LOG_INDEX_TAG_BUCKET(table, key);
+
+	if (bucket->number == LOG_INDEX_TAG_BUCKET_SLOTS)
+	{
+		if (!bucket->overflow)
+		{
+			/* Publish hash slot before overflow */
+			pg_write_barrier();
+			bucket->overflow = true;
+		}
+
+		return;
+	}
+
+	bucket->item[bucket->number] = item_id;
+	/* Publish item id before its fingerprint */
+	pg_write_barrier();
+	bucket->fp[bucket->number] = log_index_tag_fingerprint(tag, key);
+	bucket->number++;
+}
+
+static log_seg_id_t
+log_index_mem_tbl_probe_page(BufferTag *tag, log_mem_table_t * table, uint32 key)
+{
+	log_tag_bucket_t *bucket = LOG_INDEX_TAG_BUCKET(table, key);
+	uint8		fp = log_index_tag_fingerprint(tag, key);
+	int			i;
+
+	if (pg_lfind8(fp, bucket->fp, LOG_INDEX_TAG_BUCKET_SLOTS))
+	{
+		/* Read the item id after its fingerprint */
+		pg_read_barrier();
+
+		for (i = 0; i < LOG_INDEX_TAG_BUCKET_SLOTS; i++)
+		{
+			log_item_head_t *item;
+
+			if (bucket->fp[i] != fp)
+				continue;
+
+			item = log_index_item_head(&table->data, bucket->item[i]);
+
+			if (item != NULL && BUFFERTAGS_EQUAL(item->tag, *tag))
+				return bucket->item[i];
+		}
+	}
+
+	/* Items which are not recorded in the bucket are only linked in slot */
+	if (unlikely(bucket->overflow))
+		return log_index_mem_tbl_exists_page(tag, &table->data, key);
+
+	return LOG_INDEX_TBL_INVALID_SEG;
+}
+
+/*
+ * Rebuild all tag buckets from hash slots. It must be called after table data
+ * is replaced, and the caller should hold the memory table lock exclusively.
+ */
+void
+log_index_mem_tbl_build_tag_bucket(log_mem_table_t * table)
+{
+	uint32		key;
+
+	MemSet(table->tag_bucket, 0, sizeof(table->tag_bucket));
+
+	for (key = 0; key < LOG_INDEX_MEM_TBL_HASH_NUM; key++)
+	{
+		log_seg_id_t id = LOG_INDEX_TBL_SLOT_VALUE(&table->data, key);
+		log_item_head_t *item = log_index_item_head(&table->data, id);
+
+		while (item != NULL)
+		{
+			log_index_tag_bucket_add(table, key, &item->tag, id);
+			id = item->next_item;
+			item = log_index_item_head(&table->data, id);
+		}
+	}
+}
+
 static bool
 log_index_mem_seg_full(log_mem_table_t * table, log_seg_id_t head)
 {
@@ -1029,14 +1434,13 @@ log_index_insert_new_item(log_index_lsn_t * lsn_info,
 	new_item->number = 1;
 	new_item->prev_page_lsn = lsn_info->prev_lsn;
 	LOG_INDEX_INSERT_LSN_INFO(new_item, 0, lsn_info);
+	new_item->next_item = *slot;
 
-	if (*slot == LOG_INDEX_TBL_INVALID_SEG)
-		*slot = new_item_id;
-	else
-	{
-		new_item->next_item = *slot;
-		*slot = new_item_id;
-	}
+	/* Publish the new item to readers after it's filled */
+	pg_write_barrier();
+	*slot = new_item_id;
+
+	log_index_tag_bucket_add(table, key, lsn_info->tag, new_item_id);
 }
 
 static void
@@ -1047,6 +1451,16 @@ log_index_insert_new_seg(log_mem_table_t * table, log_seg_id_t head,
 	log_item_seg_t *seg = log_index_item_seg(&table->data, seg_id);
 
 	seg->head_seg = head;
+	seg->prev_seg = item->tail_seg;
+	seg->next_seg = LOG_INDEX_TBL_INVALID_SEG;
+	seg->number = 1;
+	LOG_INDEX_INSERT_LSN_INFO(seg, 0, lsn_info);
+
+	/*
+	 * Readers go through segments from tail_seg, so publish the new segment
+	 * after it's filled.
+	 */
+	pg_write_barrier();
 
 	if (item->tail_seg == head)
 		item->next_seg = seg_id;
@@ -1064,12 +1478,7 @@ log_index_insert_new_seg(log_mem_table_t * table, log_seg_id_t head,
 		pre_seg->next_seg = seg_id;
 	}
 
-	seg->prev_seg = item->tail_seg;
 	item->tail_seg = seg_id;
-
-	seg->next_seg = LOG_INDEX_TBL_INVALID_SEG;
-	seg->number = 1;
-	LOG_INDEX_INSERT_LSN_INFO(seg, 0, lsn_info);
 }
 
 static uint8
@@ -1088,6 +1497,8 @@ log_index_append_lsn(log_mem_table_t * table, log_seg_id_t head, log_index_lsn_t
 		POLAR_ASSERT_PANIC(item->number < LOG_INDEX_ITEM_HEAD_LSN_NUM);
 		idx = item->number;
 		LOG_INDEX_INSERT_LSN_INFO(item, idx, lsn_info);
+		/* Publish the lsn before number */
+		pg_write_barrier();
 		item->number++;
 	}
 	else
@@ -1097,6 +1508,8 @@ log_index_append_lsn(log_mem_table_t * table, log_seg_id_t head, log_index_lsn_t
 		POLAR_ASSERT_PANIC(seg->number < LOG_INDEX_ITEM_SEG_LSN_NUM);
 		idx = seg->number;
 		LOG_INDEX_INSERT_LSN_INFO(seg, idx, lsn_info);
+		/* Publish the lsn before number */
+		pg_write_barrier();
 		seg->number++;
 	}
 
@@ -1156,9 +1569,13 @@ log_index_next_free_seg(log_index_snapshot_t * logindex_snapshot, XLogRecPtr lsn
 
 		if (next_mem_id != -1)
 		{
-			SpinLockAcquire(LOG_INDEX_SNAPSHOT_LOCK);
+			/*
+			 * Only this process changes the active table id, and readers get
+			 * it by one read, so publish it after the new table becomes
+			 * active without the snapshot lock.
+			 */
+			pg_write_barrier();
 			LOG_INDEX_MEM_TBL_ACTIVE_ID = next_mem_id;
-			SpinLockRelease(LOG_INDEX_SNAPSHOT_LOCK);
 		}
 	}
 
@@ -1232,10 +1649,39 @@ log_index_calc_bloom(log_idx_table_data_t * table_data, log_file_table_bloom_t *
 	}
 }
 
+static char *
+log_index_get_zip_buf(void)
+{
+	if (logindex_zip_buf == NULL)
+		logindex_zip_buf = MemoryContextAlloc(polar_logindex_memory_context(),
+											  sizeof(log_idx_table_data_t));
+
+	return logindex_zip_buf;
+}
+
+/*
+ * Decompress table in place if it's saved as compressed table.
+ * The size is the valid data size from the start of table.
+ */
+static bool
+log_index_unzip_table(log_idx_table_data_t * table, uint32 size)
+{
+	log_idx_table_zip_header_t *header = (log_idx_table_zip_header_t *) table;
+	char	   *buf = log_index_get_zip_buf();
+
+	if (size < sizeof(log_idx_table_zip_header_t) || header->size > size)
+		return false;
+
+	memcpy(buf, table, header->size);
+
+	return log_index_decompress_table(buf, header->size, table);
+}
+
 static bool
 log_index_save_table(log_index_snapshot_t * logindex_snapshot, log_idx_table_data_t * table, File fd, log_file_table_bloom_t * bloom)
 {
 	int			ret = -1;
+	int			size = 0;
 	uint64		segno = LOG_INDEX_FILE_TABLE_SEGMENT_NO(table->idx_table_id);
 	off_t		offset = LOG_INDEX_FILE_TABLE_SEGMENT_OFFSET(table->idx_table_id);
 	char		path[MAXPGPATH];
@@ -1246,9 +1692,29 @@ log_index_save_table(log_index_snapshot_t * logindex_snapshot, log_idx_table_dat
 	table->crc = 0;
 	table->crc = log_index_calc_crc((unsigned char *) table, sizeof(log_idx_table_data_t));
 
-	ret = FileWrite(fd, (char *) table, sizeof(*table), offset, WAIT_EVENT_LOGINDEX_TBL_WRITE);
+	if (polar_logindex_compress_table)
+		size = log_index_compress_table(table, log_index_get_zip_buf());
+
+	if (size > 0)
+	{
+		ret = FileWrite(fd, logindex_zip_buf, size, offset, WAIT_EVENT_LOGINDEX_TBL_WRITE);
+
+		/*
+		 * Extend the segment file to its full size when the last table is
+		 * saved, so the whole segment file can be read as before.
+		 */
+		if (ret == size && offset + sizeof(*table) == LOG_INDEX_TABLE_CACHE_SIZE &&
+			FileSize(fd) < LOG_INDEX_TABLE_CACHE_SIZE &&
+			FileTruncate(fd, LOG_INDEX_TABLE_CACHE_SIZE, WAIT_EVENT_LOGINDEX_TBL_WRITE) != 0)
+			ret = -1;
+	}
+	else
+	{
+		size = sizeof(*table);
+		ret = FileWrite(fd, (char *) table, size, offset, WAIT_EVENT_LOGINDEX_TBL_WRITE);
+	}
 
-	if (ret != sizeof(*table))
+	if (ret != size)
 	{
 		logindex_errno = errno;
 		logindex_io_err = LOG_INDEX_WRITE_FAILED;
@@ -1366,6 +1832,25 @@ log_index_read_table_data(log_index_snapshot_t * logindex_snapshot, log_idx_tabl
 
 	bytes = FileRead(fd, (char *) table, sizeof(log_idx_table_data_t), offset, WAIT_EVENT_LOGINDEX_TBL_READ);
 
+	/* Compressed table may be saved in the end of segment file */
+	if (bytes >= (int) sizeof(log_idx_table_zip_header_t) && LOG_INDEX_TABLE_IS_ZIP(table))
+	{
+		FileClose(fd);
+
+		if (!log_index_unzip_table(table, bytes))
+		{
+			logindex_io_err = LOG_INDEX_CRC_FAILED;
+
+			LOG_INDEX_FILE_TABLE_NAME(path, segno);
+			ereport(elevel,
+					(errmsg("Could not decompress table from file \"%s\" at offset %lu, read size %d",
+							path, offset, bytes)));
+			return false;
+		}
+
+		return true;
+	}
+
 	if (bytes != sizeof(log_idx_table_data_t))
 	{
 		logindex_io_err = LOG_INDEX_READ_FAILED;
@@ -1516,10 +2001,75 @@ log_index_report_io_error(log_index_snapshot_t * logindex_snapshot, log_idx_tabl
 	}
 }
 
+/*
+ * Read segment file whose first table is compressed. Only the compressed
+ * part of each table is read, and bytes is the size already read for the
+ * first table. Return the size of tables which are fully read.
+ */
+static int
+log_index_read_zip_seg_file(File fd, char *data, int bytes)
+{
+	int			i;
+
+	for (i = 0; i < LOG_INDEX_TABLE_NUM_PER_FILE; i++)
+	{
+		char	   *table = data + sizeof(log_idx_table_data_t) * i;
+		off_t		offset = sizeof(log_idx_table_data_t) * i;
+		int			need = sizeof(log_idx_table_data_t);
+
+		if (i > 0)
+		{
+			bytes = FileRead(fd, table, LOG_INDEX_TABLE_ZIP_READ_SIZE, offset, WAIT_EVENT_LOGINDEX_TBL_READ);
+
+			if (bytes <= 0)
+				break;
+		}
+
+		if (bytes >= (int) sizeof(log_idx_table_zip_header_t) && LOG_INDEX_TABLE_IS_ZIP(table))
+			need = Min(((log_idx_table_zip_header_t *) table)->size, need);
+
+		if (bytes < need &&
+			FileRead(fd, table + bytes, need - bytes, offset + bytes, WAIT_EVENT_LOGINDEX_TBL_READ) != need - bytes)
+			break;
+	}
+
+	return i * sizeof(log_idx_table_data_t);
+}
+
+/*
+ * Count the tables fully contained in the first bytes of segment data. The
+ * last one may be a compressed table in a segment file which isn't extended
+ * to its full size yet, so it only occupies the head part of its position.
+ */
+static int
+log_index_seg_table_count(char *data, int bytes)
+{
+	int			i;
+
+	for (i = 0; i < LOG_INDEX_TABLE_NUM_PER_FILE; i++)
+	{
+		char	   *table = data + sizeof(log_idx_table_data_t) * i;
+		int			rest = bytes - (int) (sizeof(log_idx_table_data_t) * i);
+
+		if (rest >= (int) sizeof(log_idx_table_data_t))
+			continue;
+
+		if (rest >= (int) sizeof(log_idx_table_zip_header_t) &&
+			LOG_INDEX_TABLE_IS_ZIP(table) &&
+			((log_idx_table_zip_header_t *) table)->size <= rest)
+			i++;
+
+		break;
+	}
+
+	return i;
+}
+
 static bool
 log_index_read_seg_file(log_index_snapshot_t * logindex_snapshot, log_table_cache_t * cache, uint64 segno)
 {
 	int			bytes;
+	int			ntables;
 	int			i;
 	log_index_meta_t meta;
 	uint64_t	delta_table;
@@ -1566,9 +2116,20 @@ log_index_read_seg_file(log_index_snapshot_t * logindex_snapshot, log_table_cach
 			return false;
 		}
 
-		bytes = FileRead(fd, cache->data, LOG_INDEX_TABLE_CACHE_SIZE, 0x0, WAIT_EVENT_LOGINDEX_TBL_READ);
+		bytes = FileRead(fd, cache->data, LOG_INDEX_TABLE_ZIP_READ_SIZE, 0x0, WAIT_EVENT_LOGINDEX_TBL_READ);
 
-		if (bytes < sizeof(log_idx_table_data_t))
+		if (bytes >= (int) sizeof(log_idx_table_zip_header_t) && LOG_INDEX_TABLE_IS_ZIP(cache->data))
+			bytes = log_index_read_zip_seg_file(fd, cache->data, bytes);
+		else if (bytes == LOG_INDEX_TABLE_ZIP_READ_SIZE)
+		{
+			int			rest = FileRead(fd, cache->data + bytes, LOG_INDEX_TABLE_CACHE_SIZE - bytes,
+										bytes, WAIT_EVENT_LOGINDEX_TBL_READ);
+
+			if (rest > 0)
+				bytes += rest;
+		}
+
+		if (log_index_seg_table_count(cache->data, bytes) < 1)
 		{
 			logindex_io_err = LOG_INDEX_READ_FAILED;
 			logindex_errno = errno;
@@ -1582,6 +2143,21 @@ log_index_read_seg_file(log_index_snapshot_t * logindex_snapshot, log_table_cach
 		FileClose(fd);
 	}
 
+	ntables = log_index_seg_table_count(cache->data, bytes);
+
+	for (i = 0; i < ntables; i++)
+	{
+		table_data = (log_idx_table_data_t *) (cache->data + sizeof(log_idx_table_data_t) * i);
+
+		if (LOG_INDEX_TABLE_IS_ZIP(table_data) &&
+			!log_index_unzip_table(table_data, sizeof(log_idx_table_data_t)))
+		{
+			elog(LOG, "Failed to decompress logindex table in segment=%ld file at offset %lu",
+				 segno, i * sizeof(log_idx_table_data_t));
+			table_data->idx_table_id = LOG_INDEX_TABLE_INVALID_ID;
+		}
+	}
+
 	/* segno start from 0, while log_index_table_id_t start from 1 */
 	cache->min_idx_table_id = segno * LOG_INDEX_TABLE_NUM_PER_FILE + 1;
 	table_data = (log_idx_table_data_t *) cache->data;
@@ -1594,7 +2170,7 @@ log_index_read_seg_file(log_index_snapshot_t * logindex_snapshot, log_table_cach
 		return false;
 	}
 
-	i = (bytes / sizeof(log_idx_table_data_t)) - 1;
+	i = ntables - 1;
 
 	/*
 	 * If this segment file is renamed from previous segment file, maybe
@@ -1647,6 +2223,12 @@ log_index_read_table(logindex_snapshot_t logindex_snapshot, log_idx_table_id_t t
 		LWLockRelease(table_lock);
 	}
 
+	/* The table may be not saved yet and kept in overflow table */
+	data = log_index_read_overflow_table(logindex_snapshot, tid);
+
+	if (data != NULL)
+		return data;
+
 	if ((strcmp(table_cache.name, logindex_snapshot->dir) != 0) ||
 		tid < table_cache.min_idx_table_id || tid > table_cache.max_idx_table_id)
 	{
@@ -1672,7 +2254,10 @@ log_index_read_table(logindex_snapshot_t logindex_snapshot, log_idx_table_id_t t
 	if (LWLockConditionalAcquire(table_lock, LW_EXCLUSIVE))
 	{
 		if (LOG_INDEX_MEM_TBL_STATE(table) == LOG_INDEX_MEM_TBL_STATE_FLUSHED && tid != LOG_INDEX_MEM_TBL_TID(table))
+		{
 			memcpy(&table->data, data, sizeof(log_idx_table_data_t));
+			log_index_mem_tbl_build_tag_bucket(table);
+		}
 
 		LWLockRelease(table_lock);
 	}
@@ -1964,7 +2549,7 @@ log_index_insert_lsn(log_index_snapshot_t * logindex_snapshot, log_index_lsn_t *
 	 */
 	if (LOG_INDEX_MEM_TBL_STATE(active) == LOG_INDEX_MEM_TBL_STATE_ACTIVE &&
 		LOG_INDEX_SAME_TABLE_LSN_PREFIX(&active->data, lsn_info->lsn))
-		head = log_index_mem_tbl_exists_page(lsn_info->tag, &active->data, key);
+		head = log_index_mem_tbl_probe_page(lsn_info->tag, active, key);
 
 	new_item = (head == LOG_INDEX_TBL_INVALID_SEG);
 
@@ -1980,11 +2565,9 @@ log_index_insert_lsn(log_index_snapshot_t * logindex_snapshot, log_index_lsn_t *
 		if (need_flush_lock)
 			LWLockAcquire(LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK, LW_EXCLUSIVE);
 
-		LWLockAcquire(LOG_INDEX_HASH_LOCK(key), LW_EXCLUSIVE);
 		idx = log_index_append_lsn(active, head, lsn_info);
 		item = log_index_item_head(&active->data, head);
 		LOG_INDEX_MEM_TBL_ADD_ORDER(&active->data, item->tail_seg, idx);
-		LWLockRelease(LOG_INDEX_HASH_LOCK(key));
 	}
 	else
 	{
@@ -2002,15 +2585,12 @@ log_index_insert_lsn(log_index_snapshot_t * logindex_snapshot, log_index_lsn_t *
 		if (need_flush_lock)
 			LWLockAcquire(LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK, LW_EXCLUSIVE);
 
-		LWLockAcquire(LOG_INDEX_HASH_LOCK(key), LW_EXCLUSIVE);
-
 		if (new_item || active != old_active)
 			log_index_insert_new_item(lsn_info, active, key, dst);
 		else
 			log_index_insert_new_seg(active, head, dst, lsn_info);
 
 		LOG_INDEX_MEM_TBL_ADD_ORDER(&active->data, dst, 0);
-		LWLockRelease(LOG_INDEX_HASH_LOCK(key));
 	}
 
 	SpinLockAcquire(LOG_INDEX_SNAPSHOT_LOCK);
@@ -2108,6 +2688,22 @@ log_index_tbl_find(BufferTag *tag,
 	return log_index_item_head(table, item_id);
 }
 
+/*
+ * Same as log_index_tbl_find, but search the page from tag buckets of memory
+ * table instead of walking the item list of hash slot.
+ */
+log_item_head_t *
+log_index_mem_tbl_find(BufferTag *tag,
+					   log_mem_table_t * table, uint32 key)
+{
+	log_seg_id_t item_id;
+
+	POLAR_ASSERT_PANIC(table != NULL);
+
+	item_id = log_index_mem_tbl_probe_page(tag, table, key);
+	return log_index_item_head(&table->data, item_id);
+}
+
 XLogRecPtr
 polar_get_logindex_snapshot_max_lsn(log_index_snapshot_t * logindex_snapshot)
 {
@@ -2214,6 +2810,7 @@ polar_load_logindex_snapshot_from_storage(log_index_snapshot_t * logindex_snapsh
 						(errmsg("Failed to read log index which tid=%ld when load logindex", tid)));
 			}
 			memcpy(&mem_tbl->data, &table, sizeof(log_idx_table_data_t));
+			log_index_mem_tbl_build_tag_bucket(mem_tbl);
 			LOG_INDEX_MEM_TBL_SET_STATE(mem_tbl, LOG_INDEX_MEM_TBL_STATE_FLUSHED);
 			LOG_INDEX_MEM_TBL_FREE_HEAD(mem_tbl) = LOG_INDEX_MEM_TBL_SEG_NUM;
 			polar_logindex_invalid_bloom_cache(logindex_snapshot, tid);
@@ -2264,6 +2861,7 @@ polar_load_logindex_snapshot_from_storage(log_index_snapshot_t * logindex_snapsh
 		{
 			LWLockAcquire(LOG_INDEX_MEM_TBL_LOCK(active), LW_EXCLUSIVE);
 			memcpy(&active->data, &table, sizeof(log_idx_table_data_t));
+			log_index_mem_tbl_build_tag_bucket(active);
 			LWLockRelease(LOG_INDEX_MEM_TBL_LOCK(active));
 		}
 
@@ -2314,6 +2912,36 @@ polar_logindex_used_mem_tbl_size(logindex_snapshot_t logindex_snapshot)
 	return mem_tbl_size;
 }
 
+uint64
+polar_logindex_overflow_tbl_size(logindex_snapshot_t logindex_snapshot)
+{
+	uint64		overflow_tbl_size = 0;
+
+	if (logindex_snapshot != NULL)
+	{
+		LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_SHARED);
+		overflow_tbl_size = logindex_snapshot->overflow.num;
+		LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+	}
+
+	return overflow_tbl_size;
+}
+
+uint64
+polar_logindex_overflow_count(logindex_snapshot_t logindex_snapshot)
+{
+	uint64		overflow_count = 0;
+
+	if (logindex_snapshot != NULL)
+	{
+		LWLockAcquire(LOG_INDEX_OVERFLOW_LOCK, LW_SHARED);
+		overflow_count = logindex_snapshot->overflow.overflow_count;
+		LWLockRelease(LOG_INDEX_OVERFLOW_LOCK);
+	}
+
+	return overflow_count;
+}
+
 uint64
 polar_logindex_convert_mem_tbl_size(uint64 mem_size)
 {
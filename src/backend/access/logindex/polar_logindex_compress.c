@@ -0,0 +1,381 @@
+/*-------------------------------------------------------------------------
+ *
+ * polar_logindex_compress.c
+ *	  Encode and decode logindex table saved in segment file.
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/logindex/polar_logindex_compress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+ * Most of the segments in a flushed table are unused or save lsn which are
+ * close to each other, so the table is compressed as below:
+ *
+ * idx_order -- the segment id is saved as zigzag delta to the previous one,
+ *		and the lsn index is saved in the low 4 bits.
+ * hash -- each slot is saved as varint, so empty slot takes one byte.
+ * segment -- each segment begins with its type. Segment ids, page tag and
+ *		prev_page_lsn are saved as varint, and suffix lsn is saved as zigzag
+ *		delta to the previous one in the same segment. The first one is
+ *		compared with the suffix of table min_lsn.
+ *
+ * This file is also linked by polar_tools to dump the compressed table, so
+ * don't call any backend only functions here.
+ */
+#include "postgres.h"
+
+#include "access/polar_logindex.h"
+#include "access/polar_logindex_internal.h"
+
+#define LOG_INDEX_ZIP_SEG_EMPTY             0
+#define LOG_INDEX_ZIP_SEG_HEAD              1
+#define LOG_INDEX_ZIP_SEG_ITEM              2
+
+/* The max encoded size of one idx_order, hash slot or segment */
+#define LOG_INDEX_ZIP_MAX_ORDER_SIZE        3
+#define LOG_INDEX_ZIP_MAX_SLOT_SIZE         2
+#define LOG_INDEX_ZIP_MAX_SEG_SIZE          128
+
+static inline char *
+log_index_zip_put_varint(char *p, uint64 v)
+{
+	while (v >= 0x80)
+	{
+		*p++ = (char) ((v & 0x7F) | 0x80);
+		v >>= 7;
+	}
+
+	*p++ = (char) v;
+
+	return p;
+}
+
+static inline char *
+log_index_zip_get_varint(char *p, char *end, uint64 *v)
+{
+	uint64		result = 0;
+	int			shift = 0;
+
+	while (p < end && shift < 64)
+	{
+		uint8		c = (uint8) *p++;
+
+		result |= ((uint64) (c & 0x7F)) << shift;
+
+		if ((c & 0x80) == 0)
+		{
+			*v = result;
+			return p;
+		}
+
+		shift += 7;
+	}
+
+	return NULL;
+}
+
+static inline uint64
+log_index_zip_zigzag(int64 v)
+{
+	return ((uint64) v << 1) ^ (uint64) (v >> 63);
+}
+
+static inline int64
+log_index_zip_unzigzag(uint64 v)
+{
+	return (int64) (v >> 1) ^ -((int64) (v & 1));
+}
+
+static char *
+log_index_zip_put_suffix(char *p, uint32 base, uint32 *suffix_lsn, uint8 number)
+{
+	uint8		i;
+
+	for (i = 0; i < number; i++)
+	{
+		p = log_index_zip_put_varint(p, log_index_zip_zigzag((int64) suffix_lsn[i] - (int64) base));
+		base = suffix_lsn[i];
+	}
+
+	return p;
+}
+
+static char *
+log_index_zip_get_suffix(char *p, char *end, uint32 base, uint32 *suffix_lsn, uint8 number)
+{
+	uint8		i;
+	uint64		v;
+
+	for (i = 0; i < number; i++)
+	{
+		if ((p = log_index_zip_get_varint(p, end, &v)) == NULL)
+			return NULL;
+
+		suffix_lsn[i] = (uint32) ((int64) base + log_index_zip_unzigzag(v));
+		base = suffix_lsn[i];
+	}
+
+	return p;
+}
+
+/*
+ * Compress table into buf, whose size is sizeof(log_idx_table_data_t).
+ * Return the compressed size, or 0 if compressed table is not smaller than
+ * the uncompressed one. The crc of table must be calculated before.
+ */
+uint32
+log_index_compress_table(log_idx_table_data_t * table, char *buf)
+{
+	log_idx_table_zip_header_t *header = (log_idx_table_zip_header_t *) buf;
+	char	   *p = buf + sizeof(log_idx_table_zip_header_t);
+	char	   *end = buf + sizeof(log_idx_table_data_t);
+	uint32		base = (uint32) table->min_lsn;
+	log_seg_id_t prev_seg = 0;
+	uint32		seg_num = 0;
+	uint32		i;
+
+	if (table->last_order > LOG_INDEX_MAX_ORDER_NUM)
+		return 0;
+
+	/* Segments after the last used one are not saved */
+	for (i = LOG_INDEX_MEM_TBL_SEG_NUM; i > 0; i--)
+	{
+		if (table->segment[i - 1].item_seg.head_seg != LOG_INDEX_TBL_INVALID_SEG)
+		{
+			seg_num = i;
+			break;
+		}
+	}
+
+	if (end - p < (long) table->last_order * LOG_INDEX_ZIP_MAX_ORDER_SIZE +
+		LOG_INDEX_MEM_TBL_HASH_NUM * LOG_INDEX_ZIP_MAX_SLOT_SIZE)
+		return 0;
+
+	for (i = 0; i < table->last_order; i++)
+	{
+		uint16		order = table->idx_order[i];
+		log_seg_id_t seg_id = LOG_INDEX_SEG_ORDER(order);
+
+		p = log_index_zip_put_varint(p, (log_index_zip_zigzag((int64) seg_id - prev_seg) << 4) |
+									 LOG_INDEX_ID_ORDER(order));
+		prev_seg = seg_id;
+	}
+
+	for (i = 0; i < LOG_INDEX_MEM_TBL_HASH_NUM; i++)
+		p = log_index_zip_put_varint(p, table->hash[i]);
+
+	for (i = 1; i <= seg_num; i++)
+	{
+		log_tbl_seg_t *seg = &table->segment[i - 1];
+
+		if (end - p < LOG_INDEX_ZIP_MAX_SEG_SIZE)
+			return 0;
+
+		if (seg->item_seg.head_seg == LOG_INDEX_TBL_INVALID_SEG)
+			*p++ = LOG_INDEX_ZIP_SEG_EMPTY;
+		else if (seg->item_head.head_seg == i)
+		{
+			log_item_head_t *item = &seg->item_head;
+
+			if (item->number > LOG_INDEX_ITEM_HEAD_LSN_NUM)
+				return 0;
+
+			*p++ = LOG_INDEX_ZIP_SEG_HEAD;
+			p = log_index_zip_put_varint(p, item->next_item);
+			p = log_index_zip_put_varint(p, item->next_seg);
+			p = log_index_zip_put_varint(p, item->tail_seg);
+			p = log_index_zip_put_varint(p, item->tag.rnode.spcNode);
+			p = log_index_zip_put_varint(p, item->tag.rnode.dbNode);
+			p = log_index_zip_put_varint(p, item->tag.rnode.relNode);
+			p = log_index_zip_put_varint(p, (uint32) item->tag.forkNum);
+			p = log_index_zip_put_varint(p, item->tag.blockNum);
+			p = log_index_zip_put_varint(p, item->prev_page_lsn);
+			*p++ = (char) item->number;
+			p = log_index_zip_put_suffix(p, base, item->suffix_lsn, item->number);
+		}
+		else
+		{
+			log_item_seg_t *item_seg = &seg->item_seg;
+
+			if (item_seg->number > LOG_INDEX_ITEM_SEG_LSN_NUM)
+				return 0;
+
+			*p++ = LOG_INDEX_ZIP_SEG_ITEM;
+			p = log_index_zip_put_varint(p, item_seg->head_seg);
+			p = log_index_zip_put_varint(p, item_seg->next_seg);
+			p = log_index_zip_put_varint(p, item_seg->prev_seg);
+			*p++ = (char) item_seg->number;
+			p = log_index_zip_put_suffix(p, base, item_seg->suffix_lsn, item_seg->number);
+		}
+	}
+
+	header->magic = LOG_INDEX_TABLE_ZIP_MAGIC;
+	header->size = p - buf;
+	header->table_crc = table->crc;
+	header->idx_table_id = table->idx_table_id;
+	header->min_lsn = table->min_lsn;
+	header->max_lsn = table->max_lsn;
+	header->prefix_lsn = table->prefix_lsn;
+	header->last_order = table->last_order;
+	header->seg_num = seg_num;
+	header->crc = 0;
+	header->crc = log_index_calc_crc((unsigned char *) buf, header->size);
+
+	return header->size;
+}
+
+/*
+ * Decompress table from buf whose size is at least the compressed size.
+ * Return false if the compressed data is corrupted.
+ */
+bool
+log_index_decompress_table(char *buf, uint32 size, log_idx_table_data_t * table)
+{
+	log_idx_table_zip_header_t *header = (log_idx_table_zip_header_t *) buf;
+	char	   *p = buf + sizeof(log_idx_table_zip_header_t);
+	char	   *end;
+	pg_crc32	crc;
+	uint32		base;
+	log_seg_id_t prev_seg = 0;
+	uint64		v;
+	uint32		i;
+
+	if (size < sizeof(log_idx_table_zip_header_t) || !LOG_INDEX_TABLE_IS_ZIP(buf) ||
+		header->size > size || header->size < sizeof(log_idx_table_zip_header_t) ||
+		header->last_order > LOG_INDEX_MAX_ORDER_NUM || header->seg_num >= LOG_INDEX_MEM_TBL_SEG_NUM)
+		return false;
+
+	crc = header->crc;
+	header->crc = 0;
+	header->crc = log_index_calc_crc((unsigned char *) buf, header->size);
+
+	if (crc != header->crc)
+	{
+		header->crc = crc;
+		return false;
+	}
+
+	end = buf + header->size;
+	base = (uint32) header->min_lsn;
+
+	memset(table, 0, sizeof(log_idx_table_data_t));
+	table->idx_table_id = header->idx_table_id;
+	table->min_lsn = header->min_lsn;
+	table->max_lsn = header->max_lsn;
+	table->prefix_lsn = header->prefix_lsn;
+	table->crc = header->table_crc;
+	table->last_order = header->last_order;
+
+	for (i = 0; i < table->last_order; i++)
+	{
+		log_seg_id_t seg_id;
+
+		if ((p = log_index_zip_get_varint(p, end, &v)) == NULL)
+			return false;
+
+		seg_id = (log_seg_id_t) (prev_seg + log_index_zip_unzigzag(v >> 4));
+
+		if (seg_id >= LOG_INDEX_MEM_TBL_SEG_NUM)
+			return false;
+
+		table->idx_order[i] = (seg_id & LOG_INDEX_ORDER_SEG_MASK) |
+			((v & 0xF) << LOG_INDEX_ORDER_IDX_SHIFT);
+		prev_seg = seg_id;
+	}
+
+	for (i = 0; i < LOG_INDEX_MEM_TBL_HASH_NUM; i++)
+	{
+		if ((p = log_index_zip_get_varint(p, end, &v)) == NULL || v >= LOG_INDEX_MEM_TBL_SEG_NUM)
+			return false;
+
+		table->hash[i] = (log_seg_id_t) v;
+	}
+
+	for (i = 1; i <= header->seg_num; i++)
+	{
+		log_tbl_seg_t *seg = &table->segment[i - 1];
+		uint64		f[9];
+		int			n,
+					j;
+		uint8		type;
+
+		if (p >= end)
+			return false;
+
+		type = (uint8) *p++;
+
+		if (type == LOG_INDEX_ZIP_SEG_EMPTY)
+			continue;
+
+		n = (type == LOG_INDEX_ZIP_SEG_HEAD) ? 9 : 3;
+
+		if (type != LOG_INDEX_ZIP_SEG_HEAD && type != LOG_INDEX_ZIP_SEG_ITEM)
+			return false;
+
+		for (j = 0; j < n; j++)
+		{
+			if ((p = log_index_zip_get_varint(p, end, &f[j])) == NULL)
+				return false;
+		}
+
+		if (p >= end)
+			return false;
+
+		if (type == LOG_INDEX_ZIP_SEG_HEAD)
+		{
+			log_item_head_t *item = &seg->item_head;
+
+			item->head_seg = i;
+			item->next_item = (log_seg_id_t) f[0];
+			item->next_seg = (log_seg_id_t) f[1];
+			item->tail_seg = (log_seg_id_t) f[2];
+			item->tag.rnode.spcNode = (Oid) f[3];
+			item->tag.rnode.dbNode = (Oid) f[4];
+			item->tag.rnode.relNode = (Oid) f[5];
+			item->tag.forkNum = (ForkNumber) f[6];
+			item->tag.blockNum = (BlockNumber) f[7];
+			item->prev_page_lsn = (XLogRecPtr) f[8];
+			item->number = (uint8) *p++;
+
+			if (item->number > LOG_INDEX_ITEM_HEAD_LSN_NUM)
+				return false;
+
+			p = log_index_zip_get_suffix(p, end, base, item->suffix_lsn, item->number);
+		}
+		else
+		{
+			log_item_seg_t *item_seg = &seg->item_seg;
+
+			item_seg->head_seg = (log_seg_id_t) f[0];
+			item_seg->next_seg = (log_seg_id_t) f[1];
+			item_seg->prev_seg = (log_seg_id_t) f[2];
+			item_seg->number = (uint8) *p++;
+
+			if (item_seg->number > LOG_INDEX_ITEM_SEG_LSN_NUM)
+				return false;
+
+			p = log_index_zip_get_suffix(p, end, base, item_seg->suffix_lsn, item_seg->number);
+		}
+
+		if (p == NULL)
+			return false;
+	}
+
+	return p == end;
+}
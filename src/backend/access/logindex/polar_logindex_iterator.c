@@ -219,6 +219,9 @@ log_index_page_iterate_push_lsn(log_index_page_iter_t iter,
 	else
 		size = seg->number;
 
+	/* Read lsn after number, see log_index_append_lsn */
+	pg_read_barrier();
+
 	for (i = size; i > 0; i--)
 	{
 		idx = i - 1;
@@ -300,6 +303,9 @@ log_index_iterate_table_data(log_index_page_iter_t iter, log_idx_table_data_t *
 
 	POLAR_ASSERT_PANIC(item_id != LOG_INDEX_TBL_INVALID_SEG);
 
+	/* Read the segment after it's published by tail_seg */
+	pg_read_barrier();
+
 	do
 	{
 		item = log_index_item_seg(
@@ -336,12 +342,19 @@ log_index_iterate_table_data(log_index_page_iter_t iter, log_idx_table_data_t *
 #endif
 }
 
+/*
+ * Push lsn of the page from table data. If table data is in memory table, then
+ * mem_table is not NULL and we search the page from its tag buckets.
+ */
 static void
-log_index_push_tbl_lsn(log_index_page_iter_t iter, log_idx_table_data_t * table)
+log_index_push_tbl_lsn(log_index_page_iter_t iter, log_idx_table_data_t * table, log_mem_table_t * mem_table)
 {
 	log_item_head_t *item;
 
-	item = log_index_tbl_find(&iter->tag, table, iter->key);
+	if (mem_table != NULL)
+		item = log_index_mem_tbl_find(&iter->tag, mem_table, iter->key);
+	else
+		item = log_index_tbl_find(&iter->tag, table, iter->key);
 
 	if (item != NULL)
 	{
@@ -400,7 +413,6 @@ log_index_push_mem_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_p
 	log_mem_table_t *table;
 	log_idx_table_id_t tid = iter->max_idx_table_id;
 	bool		done = false;
-	bool		hash_lock_held = false;
 
 	ereport(polar_trace_logindex(DEBUG4), (errmsg(POLAR_LOG_BUFFER_TAG_FORMAT " search mem from tid=%ld",
 												  POLAR_LOG_BUFFER_TAG(&iter->tag), tid),
@@ -421,12 +433,6 @@ log_index_push_mem_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_p
 		LWLockAcquire(table_lock, LW_SHARED);
 		state = LOG_INDEX_MEM_TBL_STATE(table);
 
-		if (state == LOG_INDEX_MEM_TBL_STATE_ACTIVE)
-		{
-			LWLockAcquire(LOG_INDEX_HASH_LOCK(iter->key), LW_SHARED);
-			hash_lock_held = true;
-		}
-
 		/*
 		 * We seach from big to small.If tid is different then this memory
 		 * table data is changed
@@ -435,19 +441,13 @@ log_index_push_mem_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_p
 			&& state != LOG_INDEX_MEM_TBL_STATE_FREE)
 		{
 			if (log_index_table_in_range(iter, table))
-				log_index_push_tbl_lsn(iter, &table->data);
+				log_index_push_tbl_lsn(iter, &table->data, table);
 
 			tid--;
 		}
 		else
 			done = true;
 
-		if (hash_lock_held)
-		{
-			LWLockRelease(LOG_INDEX_HASH_LOCK(iter->key));
-			hash_lock_held = false;
-		}
-
 		LWLockRelease(table_lock);
 
 		mid = LOG_INDEX_MEM_TBL_PREV_ID(mid);
@@ -462,6 +462,38 @@ log_index_push_mem_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_p
 	return tid;
 }
 
+/*
+ * Push lsn from overflow tables which are not saved yet. Return the table id
+ * from which we continue to search saved tables.
+ */
+static log_idx_table_id_t
+log_index_push_overflow_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter, log_idx_table_id_t tid)
+{
+	log_idx_table_data_t *table;
+
+	while (tid != LOG_INDEX_TABLE_INVALID_ID && iter->state == ITERATE_STATE_FORWARD)
+	{
+		table = log_index_read_overflow_table(logindex_snapshot, tid);
+
+		if (table == NULL)
+			break;
+
+		if (table->max_lsn < iter->min_lsn)
+			iter->state = ITERATE_STATE_FINISHED;
+		else if (table->min_lsn <= iter->max_lsn)
+			log_index_push_tbl_lsn(iter, table, NULL);
+
+		tid--;
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	if (tid == LOG_INDEX_TABLE_INVALID_ID)
+		iter->state = ITERATE_STATE_FINISHED;
+
+	return tid;
+}
+
 static log_idx_table_id_t
 log_index_next_search_file_tid(log_idx_table_id_t prev_idx_tid, log_index_meta_t * meta, bool *hollow)
 {
@@ -521,12 +553,34 @@ log_index_check_hollow_table(log_index_snapshot_t * logindex_snapshot, log_index
 	return iter->state == ITERATE_STATE_HOLLOW;
 }
 
+static bool
+log_index_bloom_lacks_tag(log_index_page_iter_t iter, log_file_table_bloom_t * bloom_data)
+{
+	bloom_filter *filter;
+
+	if (bloom_data->max_lsn < iter->min_lsn)
+	{
+		iter->state = ITERATE_STATE_FINISHED;
+
+		/*
+		 * We did not check tag from this bloom table, so return false
+		 * directly, which means it may exists
+		 */
+		return false;
+	}
+
+	filter = polar_bloom_init_struct(bloom_data->bloom_bytes, bloom_data->buf_size,
+									 LOG_INDEX_BLOOM_ELEMS_NUM, 0);
+
+	return bloom_lacks_element(filter, (unsigned char *) &(iter->tag),
+							   sizeof(BufferTag));
+}
+
 static bool
 log_index_check_bloom_not_exists(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter, log_idx_table_id_t tid)
 {
 	log_file_table_bloom_t *bloom,
 			   *bloom_data;
-	bloom_filter *filter;
 	bool		not_exists;
 
 	bloom_data = palloc(LOG_INDEX_FILE_TBL_BLOOM_SIZE);
@@ -555,34 +609,168 @@ log_index_check_bloom_not_exists(log_index_snapshot_t * logindex_snapshot, log_i
 	if (unlikely(tid != bloom_data->idx_table_id))
 		elog(PANIC, "Failed to get logindex bloom data,dest_tid %lu, got %lu", tid, bloom_data->idx_table_id);
 
-	if (bloom_data->max_lsn < iter->min_lsn)
+	not_exists = log_index_bloom_lacks_tag(iter, bloom_data);
+
+	pfree(bloom_data);
+
+	return not_exists;
+}
+
+/*
+ * Check bloom data of tables from max_tid down to (max_tid - ntables + 1).
+ * Bloom data in the same bloom page is copied out with one page read, and
+ * the check result is saved in bloom_state which is indexed by
+ * (max_tid - tid).
+ */
+static void
+log_index_check_bloom_batch(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter,
+							log_idx_table_id_t max_tid, int ntables, log_index_iter_state_t *bloom_state,
+							bool *not_exists)
+{
+	char	   *page_data = palloc(BLCKSZ);
+	int			i = 0;
+
+	while (i < ntables)
 	{
-		iter->state = ITERATE_STATE_FINISHED;
+		log_idx_table_id_t tid = max_tid - i;
+		int			offset = LOG_INDEX_TBL_BLOOM_PAGE_OFFSET(tid);
+		log_idx_table_id_t page_min_tid = tid - offset / LOG_INDEX_FILE_TBL_BLOOM_SIZE;
+		log_file_table_bloom_t *bloom;
+		bool		retried = false;
 
 		/*
-		 * We did not check tag from this bloom table, so return false
-		 * directly, which means it may exists
+		 * Notice: We will acquire LOG_INDEX_BLOOM_LRU_LOCK in
+		 * log_index_get_tbl_bloom function
 		 */
-		not_exists = false;
+		bloom = log_index_get_tbl_bloom(logindex_snapshot, tid);
+
+		/*
+		 * The bloom data of the biggest table in this page may be still zero
+		 * when the page is cached, so invalid bloom cache and try again.
+		 */
+		if (bloom->idx_table_id == LOG_INDEX_TABLE_INVALID_ID)
+		{
+			LWLockRelease(LOG_INDEX_BLOOM_LRU_LOCK);
+			polar_logindex_invalid_bloom_cache(logindex_snapshot, tid);
+			bloom = log_index_get_tbl_bloom(logindex_snapshot, tid);
+			retried = true;
+		}
+
+		memcpy(page_data, (char *) bloom - offset, BLCKSZ);
+		LWLockRelease(LOG_INDEX_BLOOM_LRU_LOCK);
+
+		for (; i < ntables && max_tid - i >= page_min_tid; i++)
+		{
+			tid = max_tid - i;
+			bloom = (log_file_table_bloom_t *) (page_data + LOG_INDEX_TBL_BLOOM_PAGE_OFFSET(tid));
+
+			if (unlikely(tid != bloom->idx_table_id))
+			{
+				if (bloom->idx_table_id == LOG_INDEX_TABLE_INVALID_ID && !retried)
+					break;
+
+				elog(PANIC, "Failed to get logindex bloom data,dest_tid %lu, got %lu", tid, bloom->idx_table_id);
+			}
+
+			iter->state = ITERATE_STATE_FORWARD;
+			not_exists[i] = log_index_bloom_lacks_tag(iter, bloom);
+			bloom_state[i] = iter->state;
+		}
 	}
-	else
+
+	iter->state = ITERATE_STATE_FORWARD;
+	pfree(page_data);
+}
+
+static bool
+log_index_push_mem_file_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter, log_idx_table_id_t tid)
+{
+	int			mid = (tid - 1) % logindex_snapshot->mem_tbl_size;
+	log_mem_table_t *mem_table = LOG_INDEX_MEM_TBL(mid);
+	LWLock	   *table_lock = LOG_INDEX_MEM_TBL_LOCK(mem_table);
+	bool		pushed = false;
+
+	/*
+	 * Try to push data if this table is already readed in the shared memory
+	 * table
+	 */
+	if (LWLockConditionalAcquire(table_lock, LW_SHARED))
 	{
-		filter = polar_bloom_init_struct(bloom_data->bloom_bytes, bloom_data->buf_size,
-										 LOG_INDEX_BLOOM_ELEMS_NUM, 0);
+		if ((LOG_INDEX_MEM_TBL_STATE(mem_table) == LOG_INDEX_MEM_TBL_STATE_FLUSHED)
+			&& (tid == LOG_INDEX_MEM_TBL_TID(mem_table)))
+		{
+			log_index_push_tbl_lsn(iter, &mem_table->data, mem_table);
+			pushed = true;
+		}
 
-		not_exists = bloom_lacks_element(filter, (unsigned char *) &(iter->tag),
-										 sizeof(BufferTag));
+		LWLockRelease(table_lock);
 	}
 
-	pfree(bloom_data);
+	return pushed;
+}
 
-	return not_exists;
+static void
+log_index_push_saved_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter, log_idx_table_id_t tid)
+{
+	log_idx_table_data_t *table;
+	log_mem_table_t *mem_table;
+
+	/*
+	 * The mem_table will not be NULL if we read this table data from memory
+	 * table
+	 */
+	table = log_index_read_table(logindex_snapshot, tid, &mem_table);
+
+	if (!table)
+		elog(PANIC, "Failed to read table which id is %ld", tid);
+
+	log_index_push_tbl_lsn(iter, table, mem_table);
+
+	/*
+	 * If mem_table is not NULL, then this table is returned with mem_table's
+	 * lock. So we have to release its lock
+	 */
+	if (mem_table)
+		LWLockRelease(LOG_INDEX_MEM_TBL_LOCK(mem_table));
+}
+
+/*
+ * Search file tables from max_tid down to (max_tid - ntables + 1) in one batch.
+ * The bloom data of these tables is checked first, then lsn is pushed from
+ * big table id to small one as the serial search does, and only the matched
+ * tables are read.
+ */
+static void
+log_index_push_file_tbl_lsn_batch(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter,
+								  log_idx_table_id_t max_tid, int ntables)
+{
+	log_index_iter_state_t bloom_state[POLAR_LOGINDEX_MAX_SEARCH_FANOUT];
+	bool		not_exists[POLAR_LOGINDEX_MAX_SEARCH_FANOUT];
+	int			i;
+
+	Assert(ntables > 0 && ntables <= POLAR_LOGINDEX_MAX_SEARCH_FANOUT);
+
+	log_index_check_bloom_batch(logindex_snapshot, iter, max_tid, ntables, bloom_state, not_exists);
+
+	for (i = 0; i < ntables && iter->state == ITERATE_STATE_FORWARD; i++)
+	{
+		log_idx_table_id_t tid = max_tid - i;
+
+		if (log_index_push_mem_file_tbl_lsn(logindex_snapshot, iter, tid))
+			continue;
+
+		if (bloom_state[i] != ITERATE_STATE_FORWARD)
+			iter->state = bloom_state[i];
+		else if (!not_exists[i])
+			log_index_push_saved_tbl_lsn(logindex_snapshot, iter, tid);
+
+		CHECK_FOR_INTERRUPTS();
+	}
 }
 
 static void
 log_index_push_file_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_page_iter_t iter, log_idx_table_id_t tid)
 {
-	log_idx_table_data_t *table;
 	log_index_meta_t meta;
 	log_index_file_segment_t *min_seg = &meta.min_segment_info;
 
@@ -596,53 +784,23 @@ log_index_push_file_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_index_
 	while (tid != LOG_INDEX_TABLE_INVALID_ID &&
 		   tid >= min_seg->min_idx_table_id && iter->state == ITERATE_STATE_FORWARD)
 	{
-		int			mid = (tid - 1) % logindex_snapshot->mem_tbl_size;
-		log_mem_table_t *mem_table = LOG_INDEX_MEM_TBL(mid);
-		LWLock	   *table_lock = LOG_INDEX_MEM_TBL_LOCK(mem_table);
-		bool		pushed = false;
-
-		/*
-		 * Try to push data if this table is already readed in the shared
-		 * memory table
-		 */
-		if (LWLockConditionalAcquire(table_lock, LW_SHARED))
+		if (polar_logindex_search_fanout > 1)
 		{
-			if ((LOG_INDEX_MEM_TBL_STATE(mem_table) == LOG_INDEX_MEM_TBL_STATE_FLUSHED)
-				&& (tid == LOG_INDEX_MEM_TBL_TID(mem_table)))
-			{
-				log_index_push_tbl_lsn(iter, &mem_table->data);
-				pushed = true;
-			}
+			int			ntables = Min(polar_logindex_search_fanout, tid - min_seg->min_idx_table_id + 1);
 
-			LWLockRelease(table_lock);
+			log_index_push_file_tbl_lsn_batch(logindex_snapshot, iter, tid, ntables);
+			tid -= ntables;
+			continue;
 		}
 
 		/*
 		 * If this table does not in shared memory,then we check whether this
 		 * tag exists in this table from bloom data
 		 */
-		if (!pushed &&
+		if (!log_index_push_mem_file_tbl_lsn(logindex_snapshot, iter, tid) &&
 			!log_index_check_bloom_not_exists(logindex_snapshot, iter, tid)
 			&& iter->state == ITERATE_STATE_FORWARD)
-		{
-			/*
-			 * The mem_table will not be NULL if we read this table data from
-			 * memory table
-			 */
-			table = log_index_read_table(logindex_snapshot, tid, &mem_table);
-
-			if (!table)
-				elog(PANIC, "Failed to read table which id is %ld", tid);
-
-			log_index_push_tbl_lsn(iter, table);
-
-			/*
-			 * If mem_table is not NULL, then this table is returned with
-			 * mem_table's lock. So we have to release its lock
-			 */
-			if (mem_table)
-				LWLockRelease(LOG_INDEX_MEM_TBL_LOCK(mem_table));
-		}
+			log_index_push_saved_tbl_lsn(logindex_snapshot, iter, tid);
 
 		tid--;
 
@@ -700,6 +858,9 @@ polar_logindex_create_page_iterator(log_index_snapshot_t * logindex_snapshot, Bu
 
 	tid = log_index_push_mem_tbl_lsn(logindex_snapshot, iter);
 
+	if (iter->state == ITERATE_STATE_FORWARD)
+		tid = log_index_push_overflow_tbl_lsn(logindex_snapshot, iter, tid);
+
 	if (iter->state == ITERATE_STATE_FORWARD)
 	{
 		log_index_push_file_tbl_lsn(logindex_snapshot, iter, tid);
@@ -942,6 +1103,7 @@ log_index_search_file_tbl_lsn(log_index_snapshot_t * logindex_snapshot, log_inde
 	log_index_file_segment_t *min_seg = &meta.min_segment_info;
 
 	LOG_INDEX_COPY_META(&meta);
+	log_index_overflow_extend_meta(logindex_snapshot, &meta);
 
 	if (iter->start_lsn > meta.max_lsn)
 	{
@@ -1049,6 +1211,7 @@ log_index_get_table_data(log_index_snapshot_t * logindex_snapshot, log_index_lsn
 	LWLockRelease(LOG_INDEX_MEM_TBL_LOCK(table));
 
 	LOG_INDEX_COPY_META(&meta);
+	log_index_overflow_extend_meta(logindex_snapshot, &meta);
 
 	if (iter->idx_table_id > meta.max_idx_table_id)
 		return NULL;
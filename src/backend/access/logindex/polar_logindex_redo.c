@@ -47,6 +47,7 @@
 #include "storage/buf_internals.h"
 #include "storage/ipc.h"
 #include "storage/polar_fd.h"
+#include "storage/polar_prefetch.h"
 #include "storage/procarray.h"
 #include "utils/faultinjector.h"
 #include "utils/memutils.h"
@@ -59,8 +60,10 @@
 
 bool		polar_enable_replica_prewarm = false;
 bool		polar_enable_parallel_replay_standby_mode = false;
+bool		polar_enable_parallel_replay_work_steal = true;
 int			polar_parallel_replay_task_queue_depth = 0;
 int			polar_parallel_replay_proc_num = 0;
+int			polar_parallel_replay_prefetch_distance = 256;
 int			polar_logindex_max_local_cache_segments = 0;
 bool		polar_enable_fullpage_snapshot = true;
 int			polar_write_logindex_active_table_delay = 200;
@@ -72,6 +75,7 @@ bool		polar_enable_resolve_conflict = false;
 int			polar_logindex_mem_size = 0;
 int			polar_logindex_bloom_blocks = 0;
 int			polar_rel_size_cache_blocks = 0;
+int			polar_logindex_record_cache_size = 8;
 int			polar_xlog_queue_buffers = 0;
 bool		polar_force_change_checkpoint = false;
 bool		polar_enable_standby_instant_recovery = false;
@@ -247,6 +251,41 @@ polar_logindex_apply_one_record(polar_logindex_redo_ctl_t instance, XLogReaderSt
 	MemoryContextReset(redo_ctx);
 }
 
+/*
+ * Copy the record which starts at lsn from the shared record cache into the
+ * reader, return false if it's not cached.
+ */
+static bool
+polar_logindex_record_cache_read(XLogReaderState *state, XLogRecPtr lsn)
+{
+	if (polar_logindex_redo_instance == NULL || polar_logindex_redo_instance->record_cache == NULL)
+		return false;
+
+	return polar_record_cache_read(polar_logindex_redo_instance->record_cache, state, lsn);
+}
+
+static void
+polar_logindex_record_cache_insert(XLogReaderState *state)
+{
+	if (polar_logindex_redo_instance != NULL && polar_logindex_redo_instance->record_cache != NULL)
+		polar_record_cache_insert(polar_logindex_redo_instance->record_cache, state);
+}
+
+/*
+ * Drop the records kept in the shared record cache, they are looked up by
+ * lsn, which may point to another record on the new timeline.
+ */
+void
+polar_logindex_record_cache_invalidate(polar_logindex_redo_ctl_t instance)
+{
+	if (instance != NULL && instance->record_cache != NULL)
+		polar_record_cache_invalidate(instance->record_cache);
+}
+
+/*
+ * Read and decode the record which start at lsn. If the reader already
+ * decoded this record, then it's reused.
+ */
 XLogRecord *
 polar_logindex_read_xlog(XLogReaderState *state, XLogRecPtr lsn)
 {
@@ -254,6 +293,18 @@ polar_logindex_read_xlog(XLogReaderState *state, XLogRecPtr lsn)
 	char	   *errormsg = NULL;
 	int			i = 1;
 
+	/*
+	 * The pages which modified by the same record could be applied one after
+	 * another, e.g. the left and right pages of btree split, so don't decode
+	 * it again.
+	 */
+	if (state->record != NULL && state->ReadRecPtr == lsn)
+		return &state->record->header;
+
+	/* The record could be decoded by other process */
+	if (polar_logindex_record_cache_read(state, lsn))
+		return &state->record->header;
+
 	while (record == NULL)
 	{
 		XLogBeginRead(state, lsn);
@@ -270,6 +321,8 @@ polar_logindex_read_xlog(XLogReaderState *state, XLogRecPtr lsn)
 		}
 	}
 
+	polar_logindex_record_cache_insert(state);
+
 	return record;
 }
 
@@ -982,9 +1035,11 @@ polar_create_bg_redo_ctl(polar_logindex_redo_ctl_t instance, bool enable_process
 
 	ctl->instance = instance;
 	ctl->lsn_iter = polar_logindex_create_lsn_iterator(instance->wal_logindex_snapshot, bg_replayed_lsn);
+	ctl->prefetch_iter = polar_logindex_create_lsn_iterator(instance->wal_logindex_snapshot, bg_replayed_lsn);
 
 	ctl->state = polar_allocate_xlog_reader();
 	ctl->replay_batch_size = polar_bg_replay_batch_size;
+	ctl->dispatched_proc = -1;
 
 	if (enable_processes_pool)
 	{
@@ -1004,6 +1059,7 @@ polar_release_bg_redo_ctl(polar_logindex_bg_redo_ctl_t *ctl)
 		polar_release_task_sched_ctl(ctl->sched_ctl);
 
 	polar_logindex_release_lsn_iterator(ctl->lsn_iter);
+	polar_logindex_release_lsn_iterator(ctl->prefetch_iter);
 	XLogReaderFree(ctl->state);
 
 	pfree(ctl);
@@ -1165,8 +1221,18 @@ polar_bg_redo_read_record(XLogReaderState *state, XLogRecPtr lsn)
 		 */
 		MemoryContext oldcontext = MemoryContextSwitchTo(polar_logindex_memory_context());
 
+		if (polar_logindex_record_cache_read(state, lsn))
+		{
+			MemoryContextSwitchTo(oldcontext);
+			return;
+		}
+
 		XLogBeginRead(state, lsn);
 		record = XLogReadRecord(state, &errormsg);
+
+		if (record != NULL)
+			polar_logindex_record_cache_insert(state);
+
 		MemoryContextSwitchTo(oldcontext);
 
 		if (record == NULL)
@@ -1237,7 +1303,7 @@ polar_bg_redo_apply_read_record(polar_logindex_redo_ctl_t instance, XLogReaderSt
 			LWLockAcquire(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache), LW_SHARED);
 
 			/* Don't replay this block if it's truncated or dropped */
-			if (polar_check_rel_block_valid_only(instance->rel_size_cache, lsn, tag))
+			if (polar_check_rel_block_valid_for_replay(instance->rel_size_cache, lsn, tag))
 			{
 				*buffer = XLogReadBufferExtended(tag->rnode, tag->forkNum, tag->blockNum, RBM_ZERO_ON_ERROR,
 												 XLogRecGetBlock(state, blk_id)->prefetch_buffer);
@@ -1368,7 +1434,7 @@ polar_buffer_need_replay(polar_logindex_redo_ctl_t instance, Buffer buffer, XLog
 		bool		in_range;
 
 		LWLockAcquire(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache), LW_SHARED);
-		in_range = polar_check_rel_block_valid_only(instance->rel_size_cache, lsn, &buf_desc->tag);
+		in_range = polar_check_rel_block_valid_for_replay(instance->rel_size_cache, lsn, &buf_desc->tag);
 		LWLockRelease(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache));
 
 		if (!in_range)
@@ -1535,6 +1601,9 @@ polar_logindex_redo_shmem_size(void)
 	if (polar_rel_size_cache_blocks > 0)
 		size = add_size(size, polar_rel_size_shmem_size(polar_rel_size_cache_blocks));
 
+	if (polar_logindex_record_cache_size > 0)
+		size = add_size(size, polar_record_cache_shmem_size(polar_logindex_record_cache_size));
+
 	if (polar_xlog_queue_buffers > 0)
 		size = add_size(size, polar_xlog_queue_size(polar_xlog_queue_buffers));
 
@@ -1612,6 +1681,8 @@ polar_logindex_redo_shmem_init(void)
 		elog(FATAL, "%s: PolarDB relation size cache use wrong block size %d",
 			 PG_FUNCNAME_MACRO, polar_rel_size_cache_blocks);
 
+	instance->record_cache = polar_record_cache_shmem_init("polar_record_cache", polar_logindex_record_cache_size);
+
 	if (polar_xlog_queue_buffers > 0)
 		instance->xlog_queue = polar_xlog_queue_init("polar_xlog_queue", LWTRANCHE_POLAR_XLOG_QUEUE,
 													 polar_xlog_queue_buffers);
@@ -1755,6 +1826,80 @@ polar_logindex_redo_bg_flush_data(polar_logindex_redo_ctl_t instance)
 	return write_done;
 }
 
+/*
+ * POLAR: Ask the prefetch workers to read the page which will be read by the
+ * parallel replay process into buffer pool.
+ */
+static void
+polar_bg_redo_prefetch_buffer(polar_logindex_redo_ctl_t instance, BufferTag *tag, XLogRecPtr lsn)
+{
+	uint32		hash = BufTableHashCode(tag);
+	LWLock	   *partition_lock = BufMappingPartitionLock(hash);
+	int			buf_id;
+	bool		valid;
+
+	/*
+	 * A page is modified by many records one after another, so it's mostly
+	 * in buffer pool already. It's only a hint, the page may be evicted later.
+	 */
+	LWLockAcquire(partition_lock, LW_SHARED);
+	buf_id = BufTableLookup(tag, hash);
+	LWLockRelease(partition_lock);
+
+	if (buf_id >= 0)
+		return;
+
+	LWLockAcquire(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache), LW_SHARED);
+	valid = polar_check_rel_block_valid_only(instance->rel_size_cache, lsn, tag);
+	LWLockRelease(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache));
+
+	/* Don't prefetch the block which is truncated or dropped */
+	if (valid)
+		(void) polar_prefetch_buffers(NULL, tag->rnode, tag->forkNum, tag->blockNum, 1);
+}
+
+/*
+ * POLAR: Walk the logindex along with the dispatched tasks and prefetch the
+ * pages they will replay, so the parallel replay processes don't wait for the
+ * synchronous read from storage. The prefetch iterator goes through the same
+ * pages as lsn_iter, and it's at most polar_parallel_replay_prefetch_distance
+ * pages ahead of the dispatched ones. Consecutive blocks of a relation are
+ * merged in the prefetch queue, so the workers read them by one bulk read.
+ */
+static void
+polar_logindex_bg_prefetch(polar_logindex_bg_redo_ctl_t *ctl)
+{
+	XLogRecPtr	replayed_lsn,
+				consist_lsn;
+
+	if (polar_parallel_replay_prefetch_distance <= 0 || !polar_prefetch_enabled())
+		return;
+
+	replayed_lsn = polar_get_last_replayed_read_ptr();
+	consist_lsn = polar_get_primary_consistent_lsn();
+
+	while (ctl->prefetched_num < ctl->dispatched_num + polar_parallel_replay_prefetch_distance)
+	{
+		if (!ctl->prefetch_page)
+			ctl->prefetch_page = polar_logindex_lsn_iterator_next(ctl->instance->wal_logindex_snapshot,
+																  ctl->prefetch_iter);
+
+		if (!ctl->prefetch_page || ctl->prefetch_page->lsn > replayed_lsn)
+			break;
+
+		/*
+		 * The page which is flushed by primary will not be replayed. The page
+		 * which is dispatched already is prefetched too, because it waits in
+		 * the task queue until the parallel replay process reaches it.
+		 */
+		if (ctl->prefetch_page->lsn >= consist_lsn)
+			polar_bg_redo_prefetch_buffer(ctl->instance, ctl->prefetch_page->tag, ctl->prefetch_page->lsn);
+
+		ctl->prefetched_num++;
+		ctl->prefetch_page = NULL;
+	}
+}
+
 static bool
 polar_logindex_bg_dispatch(polar_logindex_bg_redo_ctl_t *ctl, bool *can_hold)
 {
@@ -1771,6 +1916,9 @@ polar_logindex_bg_dispatch(polar_logindex_bg_redo_ctl_t *ctl, bool *can_hold)
 
 	*can_hold = false;
 
+	if (polar_sched_work_steal_enabled(sched_ctl->sched) != polar_enable_parallel_replay_work_steal)
+		polar_sched_enable_work_steal(sched_ctl->sched, polar_enable_parallel_replay_work_steal);
+
 	/* Remove finished task from running queue */
 	if (!polar_sched_empty_running_task(sched_ctl))
 		polar_sched_remove_finished_task(sched_ctl);
@@ -1821,13 +1969,21 @@ polar_logindex_bg_dispatch(polar_logindex_bg_redo_ctl_t *ctl, bool *can_hold)
 		node.lsn = ctl->replay_page->lsn;
 		node.prev_lsn = ctl->replay_page->prev_lsn;
 
-		dst_node = (parallel_replay_task_node_t *) polar_sched_add_task(sched_ctl, (polar_task_node_t *) &node);
+		/*
+		 * Pages modified by the same record are dispatched to the same
+		 * process if possible, so the record is decoded once and applied to
+		 * all of these pages.
+		 */
+		dst_node = (parallel_replay_task_node_t *) polar_sched_add_task_prefer(sched_ctl, (polar_task_node_t *) &node,
+																			   node.lsn == ctl->max_dispatched_lsn ? ctl->dispatched_proc : -1);
 
 		if (dst_node != NULL)
 		{
 			int			proc = POLAR_TASK_NODE_PROC((polar_task_node_t *) dst_node);
 
 			ctl->max_dispatched_lsn = node.lsn;
+			ctl->dispatched_proc = proc;
+			ctl->dispatched_num++;
 			ctl->replay_page = NULL;
 
 			ereport(polar_trace_logindex(DEBUG2), (errmsg("Dispatch lsn=%lX, " POLAR_LOG_BUFFER_TAG_FORMAT " to proc=%d",
@@ -1849,6 +2005,8 @@ polar_logindex_bg_dispatch(polar_logindex_bg_redo_ctl_t *ctl, bool *can_hold)
 	}
 	while (true);
 
+	polar_logindex_bg_prefetch(ctl);
+
 	/*
 	 * Set dispatch_done to be true when there's no running task and no new
 	 * WAL to dispatch.
@@ -2411,7 +2569,7 @@ polar_xlog_need_replay(polar_logindex_redo_ctl_t instance, BufferTag *tag, XLogR
 			LWLockAcquire(POLAR_REL_SIZE_CACHE_LOCK(instance->rel_size_cache), LW_SHARED);
 
 			/* Don't replay this block if it's truncated or dropped */
-			if (polar_check_rel_block_valid_only(instance->rel_size_cache, lsn, tag))
+			if (polar_check_rel_block_valid_for_replay(instance->rel_size_cache, lsn, tag))
 			{
 				buffer = XLogReadBufferExtended(tag->rnode, tag->forkNum, tag->blockNum, RBM_NORMAL_NO_LOG, InvalidBuffer);
 				*buf_stat = BUF_NEED_REPLAY;
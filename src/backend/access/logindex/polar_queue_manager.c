@@ -728,6 +728,71 @@ polar_xlog_send_queue_raw_data_pop(polar_ringbuf_ref_t *ref,
 	return copy_size;
 }
 
+/*
+ * Like polar_xlog_send_queue_raw_data_pop(), but point iov to the packets in
+ * the queue memory instead of copying them, so they can be sent directly.
+ * The packets are not popped yet: the reference must stay strong until the
+ * caller is done with iov, then call polar_xlog_send_queue_raw_data_release()
+ * with *npkts and *next_pread.
+ */
+ssize_t
+polar_xlog_send_queue_raw_data_peek(polar_ringbuf_ref_t *ref, struct iovec *iov,
+									int max_iov, int *iovcnt, size_t size,
+									XLogRecPtr *max_lsn, int *npkts, size_t *next_pread)
+{
+	polar_ringbuf_t queue = ref->rbuf;
+	size_t		idx = queue->slot[ref->slot].pread;
+	size_t		pwrite = pg_atomic_read_u64(&queue->pwrite);
+	uint32		pktlen;
+	ssize_t		send_size = 0;
+	XLogRecPtr	lsn = InvalidXLogRecPtr;
+
+	*iovcnt = 0;
+	*npkts = 0;
+
+	while (idx != pwrite && *iovcnt + 2 <= max_iov
+		   && polar_ringbuf_ready_pkt(queue, idx, &pktlen) != POLAR_RINGBUF_PKT_INVALID_TYPE)
+	{
+		/* Same as polar_xlog_send_queue_raw_data_pop() */
+		if (pktlen + sizeof(uint32) > size - send_size)
+			break;
+
+		polar_ringbuf_read_pkt(queue, idx, 0, (uint8 *) &lsn, sizeof(XLogRecPtr));
+
+		if (lsn > POLAR_LOGINDEX_FLUSHABLE_LSN())
+			break;
+
+		if (unlikely(polar_enable_debug))
+		{
+			uint32		xlog_len;
+
+			polar_ringbuf_read_pkt(queue, idx, sizeof(lsn), (uint8 *) &xlog_len, sizeof(xlog_len));
+
+			elog(LOG, "%s lsn=%X/%X", PG_FUNCNAME_MACRO, LSN_FORMAT_ARGS(lsn - xlog_len));
+		}
+
+		*iovcnt += polar_ringbuf_pkt_iov(queue, idx, &iov[*iovcnt]);
+		(*npkts)++;
+		send_size += pktlen + sizeof(uint32);
+		idx = polar_ringbuf_next_pkt_pos(queue, idx, pktlen);
+
+		*max_lsn = lsn;
+	}
+
+	*next_pread = idx;
+
+	return send_size;
+}
+
+/*
+ * Pop the packets which are sent by polar_xlog_send_queue_raw_data_peek().
+ */
+void
+polar_xlog_send_queue_raw_data_release(polar_ringbuf_ref_t *ref, int npkts, size_t next_pread)
+{
+	polar_ringbuf_advance_ref(ref, next_pread, npkts);
+}
+
 /* TODO: recheck logical */
 bool
 polar_xlog_send_queue_check(polar_ringbuf_ref_t *ref, XLogRecPtr start_point)
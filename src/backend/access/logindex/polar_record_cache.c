@@ -0,0 +1,402 @@
+/*-------------------------------------------------------------------------
+ *
+ * polar_record_cache.c
+ *	  Shared cache of decoded xlog records used to replay pages.
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/logindex/polar_record_cache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/polar_record_cache.h"
+#include "common/hashfn.h"
+#include "miscadmin.h"
+#include "storage/shmem.h"
+#include "utils/polar_log.h"
+
+#define RECORD_CACHE_SLOT_HEAD_SIZE     MAXALIGN(sizeof(polar_record_cache_slot_t))
+#define RECORD_CACHE_SLOT_STRIDE        (RECORD_CACHE_SLOT_HEAD_SIZE + POLAR_RECORD_CACHE_SLOT_SIZE)
+#define RECORD_CACHE_SLOTS_OFFSET(slot_num) \
+	MAXALIGN(offsetof(polar_record_cache_data_t, bucket) + sizeof(int32) * (slot_num))
+
+#define RECORD_CACHE_SLOT(cache, id) \
+	((polar_record_cache_slot_t *)(((char *)(cache)) + RECORD_CACHE_SLOTS_OFFSET((cache)->slot_num) + \
+								   (Size) (id) * RECORD_CACHE_SLOT_STRIDE))
+#define RECORD_CACHE_SLOT_DATA(slot)    (((char *)(slot)) + RECORD_CACHE_SLOT_HEAD_SIZE)
+
+#define RECORD_CACHE_LOCK(part)         (&((part)->lock.lock))
+
+static int32
+record_cache_slot_num(int cache_size_mb)
+{
+	Size		slot_num;
+
+	if (cache_size_mb <= 0)
+		return 0;
+
+	slot_num = ((Size) cache_size_mb * 1024 * 1024) / RECORD_CACHE_SLOT_STRIDE;
+	slot_num = Max(slot_num - slot_num % POLAR_RECORD_CACHE_PARTITIONS, POLAR_RECORD_CACHE_PARTITIONS);
+
+	return (int32) Min(slot_num, PG_INT32_MAX / 2);
+}
+
+Size
+polar_record_cache_shmem_size(int cache_size_mb)
+{
+	int32		slot_num = record_cache_slot_num(cache_size_mb);
+	Size		size;
+
+	if (slot_num <= 0)
+		return 0;
+
+	size = RECORD_CACHE_SLOTS_OFFSET(slot_num);
+	size = add_size(size, mul_size(slot_num, RECORD_CACHE_SLOT_STRIDE));
+
+	return size;
+}
+
+/* Put all slots of the partition into its free list */
+static void
+record_cache_reset_partition(polar_record_cache_t cache, polar_record_cache_partition_t *part)
+{
+	int32		end = part->first_slot + part->slot_num;
+	int32		id;
+
+	part->lru_head = POLAR_RECORD_CACHE_INVALID_SLOT;
+	part->lru_tail = POLAR_RECORD_CACHE_INVALID_SLOT;
+	part->free_head = part->first_slot;
+
+	for (id = part->first_slot; id < end; id++)
+	{
+		polar_record_cache_slot_t *slot = RECORD_CACHE_SLOT(cache, id);
+
+		slot->lsn = InvalidXLogRecPtr;
+		slot->hash_next = POLAR_RECORD_CACHE_INVALID_SLOT;
+		slot->lru_prev = POLAR_RECORD_CACHE_INVALID_SLOT;
+		slot->lru_next = (id + 1 < end) ? id + 1 : POLAR_RECORD_CACHE_INVALID_SLOT;
+		slot->size = 0;
+
+		cache->bucket[id] = POLAR_RECORD_CACHE_INVALID_SLOT;
+	}
+}
+
+polar_record_cache_t
+polar_record_cache_shmem_init(const char *name, int cache_size_mb)
+{
+	bool		found;
+	polar_record_cache_t cache;
+	int32		slot_num = record_cache_slot_num(cache_size_mb);
+
+	if (slot_num <= 0)
+		return NULL;
+
+	cache = (polar_record_cache_t) ShmemInitStruct(name,
+												   polar_record_cache_shmem_size(cache_size_mb), &found);
+
+	if (!IsUnderPostmaster)
+	{
+		int32		part_slots = slot_num / POLAR_RECORD_CACHE_PARTITIONS;
+		int			i;
+
+		Assert(!found);
+
+		cache->slot_num = slot_num;
+		pg_atomic_init_u64(&cache->hit, 0);
+		pg_atomic_init_u64(&cache->miss, 0);
+		pg_atomic_init_u64(&cache->insert, 0);
+		pg_atomic_init_u64(&cache->evict, 0);
+
+		for (i = 0; i < POLAR_RECORD_CACHE_PARTITIONS; i++)
+		{
+			polar_record_cache_partition_t *part = &cache->partition[i];
+
+			LWLockInitialize(RECORD_CACHE_LOCK(part), LWTRANCHE_POLAR_RECORD_CACHE);
+			part->first_slot = i * part_slots;
+			part->slot_num = part_slots;
+			record_cache_reset_partition(cache, part);
+		}
+	}
+	else
+		Assert(found);
+
+	return cache;
+}
+
+static uint32
+record_cache_hash(XLogRecPtr lsn)
+{
+	return murmurhash32((uint32) (lsn ^ (lsn >> 32)));
+}
+
+static polar_record_cache_partition_t *
+record_cache_partition(polar_record_cache_t cache, uint32 hash)
+{
+	return &cache->partition[hash % POLAR_RECORD_CACHE_PARTITIONS];
+}
+
+static int32 *
+record_cache_bucket(polar_record_cache_t cache, polar_record_cache_partition_t *part, uint32 hash)
+{
+	return &cache->bucket[part->first_slot + (hash / POLAR_RECORD_CACHE_PARTITIONS) % part->slot_num];
+}
+
+static int32
+record_cache_lookup(polar_record_cache_t cache, int32 *bucket, XLogRecPtr lsn)
+{
+	int32		id = *bucket;
+
+	while (id != POLAR_RECORD_CACHE_INVALID_SLOT)
+	{
+		polar_record_cache_slot_t *slot = RECORD_CACHE_SLOT(cache, id);
+
+		if (slot->lsn == lsn)
+			break;
+
+		id = slot->hash_next;
+	}
+
+	return id;
+}
+
+static void
+record_cache_lru_remove(polar_record_cache_t cache, polar_record_cache_partition_t *part, int32 id)
+{
+	polar_record_cache_slot_t *slot = RECORD_CACHE_SLOT(cache, id);
+
+	if (slot->lru_prev != POLAR_RECORD_CACHE_INVALID_SLOT)
+		RECORD_CACHE_SLOT(cache, slot->lru_prev)->lru_next = slot->lru_next;
+	else
+		part->lru_head = slot->lru_next;
+
+	if (slot->lru_next != POLAR_RECORD_CACHE_INVALID_SLOT)
+		RECORD_CACHE_SLOT(cache, slot->lru_next)->lru_prev = slot->lru_prev;
+	else
+		part->lru_tail = slot->lru_prev;
+
+	slot->lru_prev = slot->lru_next = POLAR_RECORD_CACHE_INVALID_SLOT;
+}
+
+static void
+record_cache_lru_push_head(polar_record_cache_t cache, polar_record_cache_partition_t *part, int32 id)
+{
+	polar_record_cache_slot_t *slot = RECORD_CACHE_SLOT(cache, id);
+
+	slot->lru_prev = POLAR_RECORD_CACHE_INVALID_SLOT;
+	slot->lru_next = part->lru_head;
+
+	if (part->lru_head != POLAR_RECORD_CACHE_INVALID_SLOT)
+		RECORD_CACHE_SLOT(cache, part->lru_head)->lru_prev = id;
+	else
+		part->lru_tail = id;
+
+	part->lru_head = id;
+}
+
+/* Remove the least recently used slot from hash bucket and LRU list */
+static int32
+record_cache_evict(polar_record_cache_t cache, polar_record_cache_partition_t *part)
+{
+	int32		id = part->lru_tail;
+	polar_record_cache_slot_t *slot;
+	int32	   *prev;
+
+	POLAR_ASSERT_PANIC(id != POLAR_RECORD_CACHE_INVALID_SLOT);
+	slot = RECORD_CACHE_SLOT(cache, id);
+	prev = record_cache_bucket(cache, part, record_cache_hash(slot->lsn));
+
+	while (*prev != id)
+	{
+		POLAR_ASSERT_PANIC(*prev != POLAR_RECORD_CACHE_INVALID_SLOT);
+		prev = &RECORD_CACHE_SLOT(cache, *prev)->hash_next;
+	}
+
+	*prev = slot->hash_next;
+	slot->hash_next = POLAR_RECORD_CACHE_INVALID_SLOT;
+	slot->lsn = InvalidXLogRecPtr;
+
+	record_cache_lru_remove(cache, part, id);
+	pg_atomic_fetch_add_u64(&cache->evict, 1);
+
+	return id;
+}
+
+static inline char *
+record_cache_relocate_ptr(char *ptr, const char *src, Size size, char *dst)
+{
+	if (ptr == NULL || ptr < src || ptr >= src + size)
+		return NULL;
+
+	return dst + (ptr - src);
+}
+
+/*
+ * The pointers in DecodedXLogRecord point to its own memory, so change them
+ * to the new address after it's copied from src to dst.
+ */
+static void
+record_cache_relocate(DecodedXLogRecord *dst, const char *src)
+{
+	Size		size = dst->size;
+	int			i;
+
+	dst->main_data = record_cache_relocate_ptr(dst->main_data, src, size, (char *) dst);
+	dst->polar_xlog_meta = record_cache_relocate_ptr(dst->polar_xlog_meta, src, size, (char *) dst);
+
+	for (i = 0; i <= dst->max_block_id; i++)
+	{
+		DecodedBkpBlock *blk = &dst->blocks[i];
+
+		blk->bkp_image = record_cache_relocate_ptr(blk->bkp_image, src, size, (char *) dst);
+		blk->data = record_cache_relocate_ptr(blk->data, src, size, (char *) dst);
+		blk->prefetch_buffer = InvalidBuffer;
+	}
+
+	dst->next = NULL;
+}
+
+/*
+ * Copy the decoded record which starts at lsn from cache and make it the
+ * current record of the reader, as if it's read by XLogReadRecord.
+ * Return false if it's not cached.
+ */
+bool
+polar_record_cache_read(polar_record_cache_t cache, XLogReaderState *state, XLogRecPtr lsn)
+{
+	uint32		hash = record_cache_hash(lsn);
+	polar_record_cache_partition_t *part = record_cache_partition(cache, hash);
+	DecodedXLogRecord *decoded;
+	polar_record_cache_slot_t *slot;
+	int32		id;
+
+	LWLockAcquire(RECORD_CACHE_LOCK(part), LW_EXCLUSIVE);
+
+	id = record_cache_lookup(cache, record_cache_bucket(cache, part, hash), lsn);
+
+	if (id == POLAR_RECORD_CACHE_INVALID_SLOT)
+	{
+		LWLockRelease(RECORD_CACHE_LOCK(part));
+		pg_atomic_fetch_add_u64(&cache->miss, 1);
+
+		return false;
+	}
+
+	slot = RECORD_CACHE_SLOT(cache, id);
+	decoded = palloc(slot->size);
+	memcpy(decoded, RECORD_CACHE_SLOT_DATA(slot), slot->size);
+
+	if (part->lru_head != id)
+	{
+		record_cache_lru_remove(cache, part, id);
+		record_cache_lru_push_head(cache, part, id);
+	}
+
+	record_cache_relocate(decoded, RECORD_CACHE_SLOT_DATA(slot));
+	LWLockRelease(RECORD_CACHE_LOCK(part));
+
+	/*
+	 * The copied record is released by the reader like the oversized record
+	 * which is decoded outside of its decode buffer.
+	 */
+	XLogBeginRead(state, lsn);
+	decoded->oversized = true;
+	state->decode_queue_head = decoded;
+	state->decode_queue_tail = decoded;
+	state->record = decoded;
+	state->DecodeRecPtr = decoded->lsn;
+	state->NextRecPtr = decoded->next_lsn;
+	state->ReadRecPtr = decoded->lsn;
+	state->EndRecPtr = decoded->next_lsn;
+
+	pg_atomic_fetch_add_u64(&cache->hit, 1);
+
+	return true;
+}
+
+/*
+ * Save the current decoded record of the reader. The record which is larger
+ * than slot size is not saved, it's usually a full page image record which
+ * is only replayed on one page.
+ */
+void
+polar_record_cache_insert(polar_record_cache_t cache, XLogReaderState *state)
+{
+	DecodedXLogRecord *decoded = state->record;
+	uint32		hash;
+	polar_record_cache_partition_t *part;
+	polar_record_cache_slot_t *slot;
+	int32	   *bucket;
+	int32		id;
+
+	if (decoded == NULL || decoded->size > POLAR_RECORD_CACHE_SLOT_SIZE)
+		return;
+
+	hash = record_cache_hash(decoded->lsn);
+	part = record_cache_partition(cache, hash);
+	bucket = record_cache_bucket(cache, part, hash);
+
+	LWLockAcquire(RECORD_CACHE_LOCK(part), LW_EXCLUSIVE);
+
+	if (record_cache_lookup(cache, bucket, decoded->lsn) != POLAR_RECORD_CACHE_INVALID_SLOT)
+	{
+		LWLockRelease(RECORD_CACHE_LOCK(part));
+		return;
+	}
+
+	if (part->free_head != POLAR_RECORD_CACHE_INVALID_SLOT)
+	{
+		id = part->free_head;
+		part->free_head = RECORD_CACHE_SLOT(cache, id)->lru_next;
+	}
+	else
+		id = record_cache_evict(cache, part);
+
+	slot = RECORD_CACHE_SLOT(cache, id);
+	memcpy(RECORD_CACHE_SLOT_DATA(slot), decoded, decoded->size);
+	record_cache_relocate((DecodedXLogRecord *) RECORD_CACHE_SLOT_DATA(slot), (char *) decoded);
+
+	slot->lsn = decoded->lsn;
+	slot->size = decoded->size;
+	slot->hash_next = *bucket;
+	*bucket = id;
+	record_cache_lru_push_head(cache, part, id);
+
+	LWLockRelease(RECORD_CACHE_LOCK(part));
+
+	pg_atomic_fetch_add_u64(&cache->insert, 1);
+}
+
+/*
+ * Drop all cached records. Records are looked up by lsn only, so they must
+ * be dropped when the lsn may point to another record, i.e. when the
+ * timeline is switched.
+ */
+void
+polar_record_cache_invalidate(polar_record_cache_t cache)
+{
+	int			i;
+
+	for (i = 0; i < POLAR_RECORD_CACHE_PARTITIONS; i++)
+	{
+		polar_record_cache_partition_t *part = &cache->partition[i];
+
+		LWLockAcquire(RECORD_CACHE_LOCK(part), LW_EXCLUSIVE);
+		record_cache_reset_partition(cache, part);
+		LWLockRelease(RECORD_CACHE_LOCK(part));
+	}
+}
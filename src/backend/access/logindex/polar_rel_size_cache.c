@@ -27,6 +27,7 @@
 
 #include "access/polar_logindex.h"
 #include "access/polar_rel_size_cache.h"
+#include "common/hashfn.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/fd.h"
@@ -54,7 +55,7 @@ polar_rel_size_shmem_size(int blocks)
 	if (blocks <= 0)
 		return size;
 
-	size = offsetof(polar_rel_size_cache_data_t, table_size);
+	size = offsetof(polar_rel_size_cache_data_t, table_data);
 
 	size = add_size(size, mul_size(POLAR_REL_CACHE_TABLE_SIZE, blocks));
 
@@ -119,6 +120,10 @@ polar_rel_size_shmem_init(const char *name, int blocks)
 		polar_init_rel_size_table(REL_SIZE_CACHE_TABLE(cache, 0), 1);
 		cache->min_tid = 1;
 
+		pg_atomic_init_u64(&cache->skip_search, 0);
+		pg_atomic_init_u64(&cache->search, 0);
+		pg_atomic_init_u64(&cache->skip_entry, 0);
+
 		LWLockInitialize(POLAR_REL_SIZE_CACHE_LOCK(cache), LWTRANCHE_RELATION_SIZE_CACHE);
 	}
 	else
@@ -194,6 +199,82 @@ polar_update_lsn_range(polar_rel_size_table_t *table, XLogRecPtr lsn)
 	}
 }
 
+static void
+polar_record_tombstone(polar_rel_size_cache_t cache, Oid spc, Oid db, Oid rel, XLogRecPtr lsn)
+{
+	RelFileNode node;
+	uint32		pos;
+	int			i;
+
+	node.spcNode = spc;
+	node.dbNode = db;
+	node.relNode = rel;
+
+	pos = hash_bytes((const unsigned char *) &node, sizeof(RelFileNode));
+
+	for (i = 0; i < POLAR_REL_TOMBSTONE_PROBE; i++)
+	{
+		polar_rel_tombstone_t *tombstone = &cache->tombstone[(pos + i) % POLAR_REL_TOMBSTONE_NUM];
+
+		if (XLogRecPtrIsInvalid(tombstone->lsn))
+		{
+			tombstone->node = node;
+			tombstone->lsn = lsn;
+			cache->tombstone_num++;
+			return;
+		}
+
+		if (RelFileNodeEquals(tombstone->node, node))
+		{
+			tombstone->lsn = Max(tombstone->lsn, lsn);
+			return;
+		}
+	}
+
+	cache->tombstone_overflow = true;
+}
+
+static XLogRecPtr
+polar_get_tombstone_lsn(polar_rel_size_cache_t cache, Oid spc, Oid db, Oid rel)
+{
+	RelFileNode node;
+	uint32		pos;
+	int			i;
+
+	node.spcNode = spc;
+	node.dbNode = db;
+	node.relNode = rel;
+
+	pos = hash_bytes((const unsigned char *) &node, sizeof(RelFileNode));
+
+	for (i = 0; i < POLAR_REL_TOMBSTONE_PROBE; i++)
+	{
+		polar_rel_tombstone_t *tombstone = &cache->tombstone[(pos + i) % POLAR_REL_TOMBSTONE_NUM];
+
+		if (XLogRecPtrIsInvalid(tombstone->lsn))
+			break;
+
+		if (RelFileNodeEquals(tombstone->node, node))
+			return tombstone->lsn;
+	}
+
+	return InvalidXLogRecPtr;
+}
+
+/*
+ * Return true if neither the relation nor its database has truncate info or
+ * state recorded after lsn, which means the block is valid for this lsn.
+ */
+static bool
+polar_check_tombstone_valid(polar_rel_size_cache_t cache, XLogRecPtr lsn, BufferTag *tag)
+{
+	if (cache->tombstone_overflow)
+		return false;
+
+	return polar_get_tombstone_lsn(cache, tag->rnode.spcNode, tag->rnode.dbNode, tag->rnode.relNode) <= lsn &&
+		polar_get_tombstone_lsn(cache, tag->rnode.spcNode, tag->rnode.dbNode, InvalidOid) <= lsn;
+}
+
 void
 polar_record_db_state(polar_rel_size_cache_t cache, XLogRecPtr lsn, Oid spc, Oid db, polar_db_state_t state)
 {
@@ -215,6 +296,7 @@ polar_record_db_state(polar_rel_size_cache_t cache, XLogRecPtr lsn, Oid spc, Oid
 	active_table->db_tail = pos;
 
 	polar_update_lsn_range(active_table, lsn);
+	polar_record_tombstone(cache, spc, db, InvalidOid, lsn);
 
 	if (unlikely(polar_enable_debug))
 	{
@@ -254,6 +336,7 @@ polar_record_rel_size(polar_rel_size_cache_t cache, XLogRecPtr lsn, RelFileNode
 	active_table->rel_tail = pos + sizeof(polar_relation_size_t);
 
 	polar_update_lsn_range(active_table, lsn);
+	polar_record_tombstone(cache, node->spcNode, node->dbNode, node->relNode, lsn);
 
 	if (unlikely(polar_enable_debug))
 	{
@@ -437,6 +520,17 @@ polar_check_rel_block_valid_internal(polar_rel_size_cache_t cache, XLogRecPtr ls
 	else
 		result.ignore_error = true;
 
+	if (polar_check_tombstone_valid(cache, lsn, tag))
+	{
+		pg_atomic_fetch_add_u64(&cache->skip_search, 1);
+
+		if (lsn_changed)
+			*lsn_changed = lsn;
+
+		return true;
+	}
+
+	pg_atomic_fetch_add_u64(&cache->search, 1);
 	table = REL_SIZE_CACHE_TABLE(cache, cache->active_mid);
 
 	if (!XLogRecPtrIsInvalid(table->max_lsn))
@@ -517,6 +611,24 @@ polar_check_rel_block_valid_and_lsn(polar_rel_size_cache_t cache, XLogRecPtr lsn
 	return polar_check_rel_block_valid_internal(cache, lsn, tag, lsn_changed);
 }
 
+/*
+ * Check the block of a logindex entry which background replay is going to
+ * replay, like polar_check_rel_block_valid_only. The entry is counted as
+ * skipped if its block is truncated or dropped after lsn.
+ *
+ * Must acquire cache lock before call this function.
+ */
+bool
+polar_check_rel_block_valid_for_replay(polar_rel_size_cache_t cache, XLogRecPtr lsn, BufferTag *tag)
+{
+	bool		valid = polar_check_rel_block_valid_internal(cache, lsn, tag, NULL);
+
+	if (!valid)
+		pg_atomic_fetch_add_u64(&cache->skip_entry, 1);
+
+	return valid;
+}
+
 static void
 polar_unlink_rel_size_table(polar_rel_size_cache_t cache, uint64 tid)
 {
@@ -529,6 +641,46 @@ polar_unlink_rel_size_table(polar_rel_size_cache_t cache, uint64 tid)
 		elog(WARNING, "Could not remove file \"%s\":%m", path);
 }
 
+/*
+ * Rebuild tombstone index from the relation size tables which are not
+ * truncated. Must acquire cache lock in exclusive mode.
+ */
+static void
+polar_rebuild_tombstone(polar_rel_size_cache_t cache)
+{
+	uint64		max_tid = REL_SIZE_CACHE_TABLE(cache, cache->active_mid)->tid;
+	uint64		tid;
+
+	MemSet(cache->tombstone, 0, sizeof(cache->tombstone));
+	cache->tombstone_num = 0;
+	cache->tombstone_overflow = false;
+
+	for (tid = cache->min_tid; tid <= max_tid; tid++)
+	{
+		polar_rel_size_table_t *table = polar_get_rel_size_table(cache, tid);
+		int			pos;
+
+		for (pos = 0; pos < table->rel_tail; pos += sizeof(polar_relation_size_t))
+		{
+			polar_relation_size_t rel;
+
+			memcpy(&rel, &table->info[pos], sizeof(polar_relation_size_t));
+			polar_record_tombstone(cache, rel.node.spcNode, rel.node.dbNode, rel.node.relNode, rel.lsn);
+		}
+
+		for (pos = table->db_tail; pos < REL_INFO_TOTAL_SIZE; pos += sizeof(polar_database_state_t))
+		{
+			polar_database_state_t db_state;
+
+			memcpy(&db_state, &table->info[pos], sizeof(polar_database_state_t));
+			polar_record_tombstone(cache, db_state.spc, db_state.db, InvalidOid, db_state.lsn);
+		}
+
+		if (!REL_TABLE_IN_SHARED_MEM(cache, table))
+			pfree(table);
+	}
+}
+
 void
 polar_truncate_rel_size_cache(polar_rel_size_cache_t cache, XLogRecPtr lsn)
 {
@@ -566,5 +718,7 @@ polar_truncate_rel_size_cache(polar_rel_size_cache_t cache, XLogRecPtr lsn)
 		tid++;
 	}
 
+	polar_rebuild_tombstone(cache);
+
 	LWLockRelease(POLAR_REL_SIZE_CACHE_LOCK(cache));
 }
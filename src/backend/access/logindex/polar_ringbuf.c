@@ -36,6 +36,9 @@
  *
  * polar_ringbuf_read_next_pkt() -- Read data from ring buffer sequentially
  *
+ * polar_ringbuf_pkt_iov() -- Get the ring buffer memory of a packet to send it
+ *          without copying
+ *
  */
 
 #include "postgres.h"
@@ -257,12 +260,22 @@ polar_ringbuf_clear_ref(polar_ringbuf_ref_t *ref)
 ssize_t
 polar_ringbuf_read_next_pkt(polar_ringbuf_ref_t *ref,
 							int offset, uint8 *buf, size_t len)
+{
+	return polar_ringbuf_read_pkt(ref->rbuf, ref->rbuf->slot[ref->slot].pread,
+								  offset, buf, len);
+}
+
+/*
+ * Read data of the packet which starts from idx.
+ * Support read from the offset of packet
+ */
+ssize_t
+polar_ringbuf_read_pkt(polar_ringbuf_t rbuf, size_t idx,
+					   int offset, uint8 *buf, size_t len)
 {
 	size_t		todo;
 	size_t		split;
 	size_t		pktlen;
-	polar_ringbuf_t rbuf = ref->rbuf;
-	size_t		idx = rbuf->slot[ref->slot].pread;
 
 	pktlen = polar_ringbuf_pkt_len(rbuf, idx);
 
@@ -289,6 +302,35 @@ polar_ringbuf_read_next_pkt(polar_ringbuf_ref_t *ref,
 	return len;
 }
 
+/*
+ * Point iov to the packet length and data of the packet which starts from
+ * idx, in the ring buffer memory.  Return the number of iovec used, which is
+ * 2 if the packet wraps around the end of the ring buffer.  The memory can be
+ * overwritten as soon as the reader moves past the packet, so the caller must
+ * hold a strong reference and not update it until it's done with iov.
+ */
+int
+polar_ringbuf_pkt_iov(polar_ringbuf_t rbuf, size_t idx, struct iovec *iov)
+{
+	size_t		len = sizeof(uint32) + polar_ringbuf_pkt_len(rbuf, idx);
+
+	/* The packet length is saved after 1 byte flag */
+	idx = (idx + 1) % rbuf->size;
+
+	iov[0].iov_base = rbuf->data + idx;
+
+	if (unlikely(idx + len > rbuf->size))
+	{
+		iov[0].iov_len = rbuf->size - idx;
+		iov[1].iov_base = rbuf->data;
+		iov[1].iov_len = len - iov[0].iov_len;
+		return 2;
+	}
+
+	iov[0].iov_len = len;
+	return 1;
+}
+
 /*
  * Write packet data and the idx is the start position of the packet.
  * Support write from the offset of packet.
@@ -379,6 +421,24 @@ polar_ringbuf_update_ref(polar_ringbuf_ref_t *ref)
 	LWLockRelease(&rbuf->lock);
 }
 
+/*
+ * Move the reference's read position past npkts packets at once, pread is
+ * the start position of the packet after them.
+ */
+void
+polar_ringbuf_advance_ref(polar_ringbuf_ref_t *ref, size_t pread, int npkts)
+{
+	polar_ringbuf_t rbuf = ref->rbuf;
+
+	if (npkts <= 0)
+		return;
+
+	LWLockAcquire(&rbuf->lock, LW_SHARED);
+	rbuf->slot[ref->slot].pread = pread;
+	rbuf->slot[ref->slot].visit += npkts;
+	LWLockRelease(&rbuf->lock);
+}
+
 /*
  * No enouth space to write and eliminate one weak reference with least read position
  */
@@ -371,6 +371,7 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
+	so->polar_nblocks = InvalidBlockNumber;
 
 	/*
 	 * We don't know yet whether the scan will be index-only, so we do not
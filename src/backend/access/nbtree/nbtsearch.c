@@ -24,6 +24,10 @@
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 
+/* POLAR: index bulk read */
+#include "storage/polar_bufmgr.h"
+#include "utils/guc.h"
+
 
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 static OffsetNumber _bt_binsrch(Relation rel, BTScanInsert key, Buffer buf);
@@ -46,6 +50,8 @@ static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
 static Buffer _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static inline void _bt_initialize_more_data(BTScanOpaque so, ScanDirection dir);
+static Buffer polar_bt_getbuf_next(IndexScanDesc scan, BlockNumber blkno,
+								   BlockNumber prev_blkno);
 
 
 /*
@@ -1979,6 +1985,43 @@ _bt_steppage(IndexScanDesc scan, ScanDirection dir)
 	return true;
 }
 
+/*
+ * POLAR: Read and lock the right sibling page for a forward scan.
+ *
+ * Leaf pages are usually laid out in key order after the index is built, so
+ * when the right sibling is the next block of the previous page, the chain
+ * is likely to go on with the following blocks. Bulk read them together in
+ * that case. Parallel scans hand pages to other workers, so they always read
+ * one page. No blocks are read ahead of the bulk read itself, which stops at
+ * the first block already in buffers.
+ */
+static Buffer
+polar_bt_getbuf_next(IndexScanDesc scan, BlockNumber blkno, BlockNumber prev_blkno)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	Buffer		buf;
+
+	if (polar_bulk_read_size <= 0 || scan->parallel_scan != NULL ||
+		prev_blkno == InvalidBlockNumber || blkno != prev_blkno + 1)
+		return _bt_getbuf(rel, blkno, BT_READ);
+
+	/* The index never shrinks while we scan it */
+	if (so->polar_nblocks == InvalidBlockNumber)
+		so->polar_nblocks = RelationGetNumberOfBlocks(rel);
+
+	if (blkno >= so->polar_nblocks)
+		return _bt_getbuf(rel, blkno, BT_READ);
+
+	buf = polar_bulk_read_buffer_extended(rel, MAIN_FORKNUM, blkno,
+										  RBM_NORMAL, NULL,
+										  so->polar_nblocks - blkno);
+	_bt_lockbuf(rel, buf, BT_READ);
+	_bt_checkpage(rel, buf);
+
+	return buf;
+}
+
 /*
  *	_bt_readnextpage() -- Read next page containing valid data for scan
  *
@@ -1997,6 +2040,7 @@ _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir)
 	Page		page;
 	BTPageOpaque opaque;
 	bool		status;
+	BlockNumber prev_blkno = so->currPos.currPage;
 
 	rel = scan->indexRelation;
 
@@ -2017,7 +2061,8 @@ _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir)
 			/* check for interrupts while we're not holding any buffer lock */
 			CHECK_FOR_INTERRUPTS();
 			/* step right one page */
-			so->currPos.buf = _bt_getbuf(rel, blkno, BT_READ);
+			so->currPos.buf = polar_bt_getbuf_next(scan, blkno, prev_blkno);
+			prev_blkno = blkno;
 			page = BufferGetPage(so->currPos.buf);
 			TestForOldSnapshot(scan->xs_snapshot, rel, page);
 			opaque = BTPageGetOpaque(page);
@@ -113,6 +113,7 @@
 #include "storage/polar_bufmgr.h"
 #include "storage/polar_fd.h"
 #include "storage/polar_flush.h"
+#include "storage/polar_io_stat.h"
 #include "utils/faultinjector.h"
 #include "utils/polar_local_cache.h"
 /* POLAR end */
@@ -154,6 +155,7 @@ bool		XLOG_DEBUG = false;
 
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 int			polar_wal_init_set_size = POLAR_DEFAULT_XLOG_FILL_ZERO_SIZE;
+int			polar_group_commit_target_latency = 0;	/* in microseconds */
 
 /*
  * Number of WAL insertion locks to use. A higher value allows more insertions
@@ -467,6 +469,27 @@ typedef struct XLogCtlInsert
 	WALInsertLockPadded *WALInsertLocks;
 } XLogCtlInsert;
 
+/*
+ * POLAR: Shared state of adaptive group commit.
+ *
+ * Every XLogFlush that has to wait for a flush bumps request_count, so the
+ * requests covered by one flush are request_count minus the value recorded
+ * at the previous flush. Flush latency and request rate are kept as
+ * exponentially weighted moving averages and drive the commit delay.
+ */
+typedef struct PolarGroupCommitCtl
+{
+	pg_atomic_uint64 request_count; /* flush requests seen so far */
+
+	slock_t		lock;			/* protects the fields below */
+	uint64		flushed_request_count;	/* request_count at last flush */
+	instr_time	last_flush_time;	/* start time of last flush */
+	double		latency_avg;	/* flush latency in microseconds */
+	double		latency_var;	/* variance of flush latency */
+	double		request_rate;	/* flush requests per microsecond */
+	PolarGroupCommitStat stat;
+} PolarGroupCommitCtl;
+
 /*
  * Total shared-memory state for XLOG.
  */
@@ -593,10 +616,18 @@ typedef struct XLogCtlData
 	 * to storage.
 	 */
 	XLogRecPtr	consistent_lsn;
+
+	/* POLAR: adaptive group commit state, see polar_group_commit_delay() */
+	PolarGroupCommitCtl group_commit;
 } XLogCtlData;
 
 static XLogCtlData *XLogCtl = NULL;
 
+/* POLAR: smoothing factor of the group commit moving averages */
+#define POLAR_GROUP_COMMIT_EWMA_ALPHA	0.125
+/* POLAR: p99 of a normal distribution is about mean + 2.33 * stddev */
+#define POLAR_GROUP_COMMIT_P99_SIGMA	2.33
+
 /* a private copy of XLogCtl->Insert.WALInsertLocks, for convenience */
 static WALInsertLockPadded *WALInsertLocks = NULL;
 
@@ -738,6 +769,10 @@ static void WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt);
 static bool polar_should_check_checkpoint(void);
 static bool polar_is_checkpoint_legal(XLogRecPtr check_point_lsn);
 static void polar_wait_consistent_lsn(XLogRecPtr redo, int flags);
+static long polar_group_commit_delay(void);
+static uint64 polar_group_commit_io_time(void);
+static void polar_group_commit_update(uint64 batch_end, instr_time start,
+									  uint64 io_start, long delay);
 static void polar_flush_buffer_for_shutdown(XLogRecPtr redo, int flags);
 static void polar_accept_signal_for_checkpoint(int flags);
 static void polar_exit_archive_recovery(EndOfWalRecoveryInfo *endOfRecoveryInfo);
@@ -1137,6 +1172,12 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	 * positions (XLogRecPtrs) can be done outside the locked region, and
 	 * because the usable byte position doesn't include any headers, reserving
 	 * X bytes from WAL is almost as simple as "CurrBytePos += X".
+	 *
+	 * POLAR: the xlog queue space is reserved here too, so that packets in
+	 * the queue are in the same order as the records in WAL, which the
+	 * readers of the queue depend on. Only the write position of the queue
+	 * is moved while holding the lock, the packet length and statistics are
+	 * set after releasing it.
 	 */
 	for (;;)
 	{
@@ -1150,7 +1191,7 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 				POLAR_XLOG_QUEUE_FREE_UP(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);;
 				continue;
 			}
-			*polar_rbuf_pos = POLAR_XLOG_QUEUE_RESERVE(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);
+			*polar_rbuf_pos = POLAR_XLOG_QUEUE_RESERVE_NOSTAT(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);
 		}
 
 		startbytepos = Insert->CurrBytePos;
@@ -1164,8 +1205,12 @@ ReserveXLogInsertLocation(int size, XLogRecPtr *StartPos, XLogRecPtr *EndPos,
 	}
 
 	if (likely(polar_logindex_redo_instance))
+	{
 		POLAR_XLOG_QUEUE_SET_PKT_LEN(polar_logindex_redo_instance->xlog_queue,
 									 *polar_rbuf_pos, polar_rbuf_len);
+		POLAR_XLOG_QUEUE_RESERVE_STAT(polar_logindex_redo_instance->xlog_queue,
+									  polar_rbuf_len);
+	}
 
 	*StartPos = XLogBytePosToRecPtr(startbytepos);
 	*EndPos = XLogBytePosToEndRecPtr(endbytepos);
@@ -1229,7 +1274,7 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr,
 				POLAR_XLOG_QUEUE_FREE_UP(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);
 				continue;
 			}
-			*polar_rbuf_pos = POLAR_XLOG_QUEUE_RESERVE(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);
+			*polar_rbuf_pos = POLAR_XLOG_QUEUE_RESERVE_NOSTAT(polar_logindex_redo_instance->xlog_queue, polar_rbuf_len);
 		}
 
 		endbytepos = startbytepos + size;
@@ -1253,8 +1298,12 @@ ReserveXLogSwitch(XLogRecPtr *StartPos, XLogRecPtr *EndPos, XLogRecPtr *PrevPtr,
 	}
 
 	if (likely(polar_logindex_redo_instance))
+	{
 		POLAR_XLOG_QUEUE_SET_PKT_LEN(polar_logindex_redo_instance->xlog_queue,
 									 *polar_rbuf_pos, polar_rbuf_len);
+		POLAR_XLOG_QUEUE_RESERVE_STAT(polar_logindex_redo_instance->xlog_queue,
+									  polar_rbuf_len);
+	}
 
 	*PrevPtr = XLogBytePosToRecPtr(prevbytepos);
 
@@ -2654,6 +2703,7 @@ XLogFlush(XLogRecPtr record)
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
 	TimeLineID	insertTLI = XLogCtl->InsertTimeLineID;
+	bool		group_commit;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2680,6 +2730,11 @@ XLogFlush(XLogRecPtr record)
 			 LSN_FORMAT_ARGS(LogwrtResult.Flush));
 #endif
 
+	/* POLAR: count the request so the flush can learn its batch size */
+	group_commit = polar_group_commit_target_latency > 0 && enableFsync;
+	if (group_commit)
+		pg_atomic_fetch_add_u64(&XLogCtl->group_commit.request_count, 1);
+
 	START_CRIT_SECTION();
 
 	/*
@@ -2700,6 +2755,10 @@ XLogFlush(XLogRecPtr record)
 	for (;;)
 	{
 		XLogRecPtr	insertpos;
+		long		delay = 0;
+		uint64		batch_end = 0;
+		uint64		io_start = 0;
+		instr_time	start;
 
 		/* read LogwrtResult and update local state */
 		SpinLockAcquire(&XLogCtl->info_lck);
@@ -2751,11 +2810,19 @@ XLogFlush(XLogRecPtr record)
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
+		 *
+		 * POLAR: With polar_group_commit_target_latency set, the delay is
+		 * derived from the measured flush latency and request rate instead.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
-			MinimumActiveBackends(CommitSiblings))
+		if (group_commit)
+			delay = polar_group_commit_delay();
+		else if (CommitDelay > 0 && enableFsync &&
+				 MinimumActiveBackends(CommitSiblings))
+			delay = CommitDelay;
+
+		if (delay > 0)
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -2774,8 +2841,18 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		if (group_commit)
+		{
+			batch_end = pg_atomic_read_u64(&XLogCtl->group_commit.request_count);
+			io_start = polar_group_commit_io_time();
+			INSTR_TIME_SET_CURRENT(start);
+		}
+
 		XLogWrite(WriteRqst, insertTLI, false);
 
+		if (group_commit)
+			polar_group_commit_update(batch_end, start, io_start, delay);
+
 		LWLockRelease(WALWriteLock);
 		/* done */
 		break;
@@ -4732,6 +4809,10 @@ XLOGShmemInit(void)
 	SpinLockInit(&XLogCtl->Insert.insertpos_lck);
 	SpinLockInit(&XLogCtl->info_lck);
 	SpinLockInit(&XLogCtl->ulsn_lck);
+
+	/* POLAR: Init group commit state */
+	pg_atomic_init_u64(&XLogCtl->group_commit.request_count, 0);
+	SpinLockInit(&XLogCtl->group_commit.lock);
 }
 
 /*
@@ -5845,6 +5926,12 @@ StartupXLOG(void)
 	else if (polar_is_standby() && polar_logindex_redo_instance)
 		polar_logindex_promote_xlog_queue(polar_logindex_redo_instance);
 
+	/*
+	 * POLAR: records are cached by lsn, the new timeline will write other
+	 * records after the end of recovery.
+	 */
+	polar_logindex_record_cache_invalidate(polar_logindex_redo_instance);
+
 	/* Enable WAL writes for this backend only. */
 	LocalSetXLogInsertAllowed();
 
@@ -10009,4 +10096,186 @@ polar_get_control_file(void)
 	return ControlFile;
 }
 
+/*
+ * polar_group_commit_delay - How long the flusher should wait for followers.
+ *
+ * Called with WALWriteLock held. A request arriving just after a flush starts
+ * waits for that flush, then for our delay and its own flush, so the delay is
+ * bounded by polar_group_commit_target_latency minus two p99 flush latencies.
+ * Within that budget we only wait for the followers that would have arrived
+ * during one flush anyway; once the batch is that large, waiting longer only
+ * adds latency. Under light load less than one follower is expected and we
+ * don't wait at all.
+ */
+static long
+polar_group_commit_delay(void)
+{
+	PolarGroupCommitCtl *gc = &XLogCtl->group_commit;
+	uint64		pending;
+	double		latency;
+	double		p99;
+	double		rate;
+	double		expected;
+	double		budget;
+
+	SpinLockAcquire(&gc->lock);
+	pending = pg_atomic_read_u64(&gc->request_count) - gc->flushed_request_count;
+	latency = gc->latency_avg;
+	p99 = latency + POLAR_GROUP_COMMIT_P99_SIGMA * sqrt(gc->latency_var);
+	rate = gc->request_rate;
+	SpinLockRelease(&gc->lock);
+
+	/* Nothing measured yet */
+	if (latency <= 0 || rate <= 0)
+		return 0;
+
+	budget = polar_group_commit_target_latency - 2 * p99;
+	if (budget < 1)
+		return 0;
+
+	expected = rate * latency;
+	if ((double) pending >= expected)
+		return 0;
+
+	return (long) Min(budget, (expected - pending) / rate);
+}
+
+/*
+ * polar_group_commit_io_time - WAL write and fsync time of this process.
+ *
+ * Taken from the polar vfs io statistics in microseconds, or 0 when they are
+ * not collected.
+ */
+static uint64
+polar_group_commit_io_time(void)
+{
+	PolarProcIOStat *io_stat;
+	instr_time	io_time;
+	int			index;
+	int			loc;
+
+	if (PolarIOStatArray == NULL)
+		return 0;
+
+	index = MyBackendId == InvalidBackendId ?
+		(MyAuxProcType == NotAnAuxProcess ? -1 : MaxBackends + MyAuxProcType + 1)
+		: MyBackendId;
+	if (index < 0)
+		return 0;
+
+	INSTR_TIME_SET_ZERO(io_time);
+	for (loc = 0; loc < POLARIO_LOC_SIZE; loc++)
+	{
+		io_stat = &PolarIOStatArray[index].polar_proc_io_stat_dist[POLARIO_WAL][loc];
+		INSTR_TIME_ADD(io_time, io_stat->io_latency_write);
+		INSTR_TIME_ADD(io_time, io_stat->io_fsync_time);
+	}
+
+	return INSTR_TIME_GET_MICROSEC(io_time);
+}
+
+/*
+ * polar_group_commit_update - Account a flush done by XLogFlush.
+ *
+ * batch_end is request_count sampled right before the flush and start is the
+ * time the flush began. The flush latency prefers the io time reported by the
+ * vfs io statistics, which excludes the time spent waiting for CPU, and falls
+ * back to the elapsed time when they are not collected. Flushes done by
+ * XLogBackgroundFlush are not seen here, their requests are accounted to the
+ * next XLogFlush.
+ */
+static void
+polar_group_commit_update(uint64 batch_end, instr_time start,
+						  uint64 io_start, long delay)
+{
+	PolarGroupCommitCtl *gc = &XLogCtl->group_commit;
+	instr_time	now;
+	instr_time	elapsed;
+	uint64		io_time;
+	uint64		batch;
+	double		latency;
+	double		err;
+
+	INSTR_TIME_SET_CURRENT(now);
+	elapsed = now;
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	io_time = polar_group_commit_io_time();
+	io_time = io_time > io_start ? io_time - io_start : 0;
+	latency = io_time > 0 ? (double) io_time : INSTR_TIME_GET_DOUBLE(elapsed) * 1000000.0;
+
+	SpinLockAcquire(&gc->lock);
+
+	batch = batch_end > gc->flushed_request_count ?
+		batch_end - gc->flushed_request_count : 0;
+	gc->flushed_request_count = batch_end;
+
+	if (gc->latency_avg <= 0)
+		gc->latency_avg = latency;
+	else
+	{
+		err = latency - gc->latency_avg;
+		gc->latency_avg += POLAR_GROUP_COMMIT_EWMA_ALPHA * err;
+		gc->latency_var = (1 - POLAR_GROUP_COMMIT_EWMA_ALPHA) *
+			(gc->latency_var + POLAR_GROUP_COMMIT_EWMA_ALPHA * err * err);
+	}
+
+	if (!INSTR_TIME_IS_ZERO(gc->last_flush_time))
+	{
+		elapsed = start;
+		INSTR_TIME_SUBTRACT(elapsed, gc->last_flush_time);
+		if (INSTR_TIME_GET_MICROSEC(elapsed) > 0)
+		{
+			double		rate = batch / (INSTR_TIME_GET_DOUBLE(elapsed) * 1000000.0);
+
+			gc->request_rate += POLAR_GROUP_COMMIT_EWMA_ALPHA * (rate - gc->request_rate);
+		}
+	}
+	gc->last_flush_time = start;
+
+	gc->stat.flush_count++;
+	gc->stat.request_count += batch;
+	gc->stat.max_batch_size = Max(gc->stat.max_batch_size, batch);
+	if (delay > 0)
+	{
+		gc->stat.delay_count++;
+		gc->stat.delay_time += delay;
+		gc->stat.max_delay = Max(gc->stat.max_delay, delay);
+	}
+
+	SpinLockRelease(&gc->lock);
+}
+
+/*
+ * polar_get_group_commit_stat - Get a snapshot of group commit statistics.
+ */
+void
+polar_get_group_commit_stat(PolarGroupCommitStat *stat)
+{
+	PolarGroupCommitCtl *gc = &XLogCtl->group_commit;
+
+	SpinLockAcquire(&gc->lock);
+	*stat = gc->stat;
+	stat->flush_latency = gc->latency_avg;
+	stat->flush_latency_p99 = gc->latency_avg +
+		POLAR_GROUP_COMMIT_P99_SIGMA * sqrt(gc->latency_var);
+	stat->request_rate = gc->request_rate;
+	SpinLockRelease(&gc->lock);
+}
+
+/*
+ * polar_reset_group_commit_stat - Reset group commit counters.
+ *
+ * The moving averages are kept, they drive the commit delay.
+ */
+void
+polar_reset_group_commit_stat(void)
+{
+	PolarGroupCommitCtl *gc = &XLogCtl->group_commit;
+
+	SpinLockAcquire(&gc->lock);
+	MemSet(&gc->stat, 0, sizeof(PolarGroupCommitStat));
+	SpinLockRelease(&gc->lock);
+}
+
 /* POLAR end */
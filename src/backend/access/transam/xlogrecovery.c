@@ -2082,6 +2082,9 @@ ApplyWalRecord(XLogReaderState *xlogreader, XLogRecord *record,
 			/* Following WAL records should be run with new TLI */
 			*replayTLI = newReplayTLI;
 			switchedTLI = true;
+
+			/* POLAR: the same lsn may be another record on the new TLI */
+			polar_logindex_record_cache_invalidate(polar_logindex_redo_instance);
 		}
 	}
 
@@ -5410,8 +5413,13 @@ polar_set_receipt_time(TimestampTz rtime, bool from_stream)
 static int
 polar_xlog_page_read_internal(XLogRecPtr targetPagePtr, char *readBuf, uint32 size)
 {
+	static char *read_ahead_buf = NULL;
 	int			read_rc;
 	int			save_errno;
+	char	   *read_buf = readBuf;
+	uint32		read_size = size;
+	bool		enable_xlog_buffer = POLAR_ENABLE_XLOG_BUFFER();
+	XLogRecPtr	max_expected_lsn = InvalidXLogRecPtr;
 
 	/*
 	 * readLen is valid needed record's length, but size may be xlog page's
@@ -5424,22 +5432,8 @@ polar_xlog_page_read_internal(XLogRecPtr targetPagePtr, char *readBuf, uint32 si
 					   (targetPagePtr + size - 1) / wal_segment_size);
 	POLAR_ASSERT_PANIC(readOff == XLogSegmentOffset(targetPagePtr, wal_segment_size));
 
-	read_rc = polar_pread(readFile, readBuf, size, (off_t) readOff);
-	save_errno = errno;
-
-	if (read_rc != size)
+	if (enable_xlog_buffer)
 	{
-		ereport(LOG,
-				(errmsg("Read size %d is not equal to size %d for xlog page %X/%X",
-						read_rc, size, LSN_FORMAT_ARGS(targetPagePtr))));
-	}
-	else if (POLAR_ENABLE_XLOG_BUFFER())
-	{
-		XLogRecPtr	max_expected_lsn = InvalidXLogRecPtr;
-		XLogRecPtr	cur_page_lsn = targetPagePtr;
-		XLogRecPtr	end_page_lsn = targetPagePtr + size;
-		char	   *buffer = readBuf;
-
 		if (polar_logindex_redo_instance &&
 			(polar_is_replica() || POLAR_ENABLE_PARALLEL_REPLAY_STANDBY_MODE()))
 		{
@@ -5448,6 +5442,55 @@ polar_xlog_page_read_internal(XLogRecPtr targetPagePtr, char *readBuf, uint32 si
 			max_expected_lsn += XLOG_BLCKSZ * (uint64) (POLAR_XLOG_BUFFER_TOTAL_COUNT());
 		}
 
+		/*
+		 * The page may be read ahead before. Only the whole page is matched,
+		 * because we always read the whole page from file.
+		 */
+		if (size == XLOG_BLCKSZ)
+		{
+			XLogRecPtr	end_lsn;
+			int			depth;
+
+			if (polar_xlog_buffer_lookup(targetPagePtr, XLOG_BLCKSZ, readBuf))
+				return size;
+
+			/*
+			 * Read ahead the following pages in the same segment, which are
+			 * flushed and could be appended to xlog buffer.
+			 */
+			depth = polar_xlog_buffer_read_ahead_depth(targetPagePtr);
+			end_lsn = targetPagePtr + (uint64) depth * XLOG_BLCKSZ;
+			end_lsn = Min(end_lsn, targetPagePtr - readOff + wal_segment_size);
+			end_lsn = Min(end_lsn, flushedUpto - (flushedUpto % XLOG_BLCKSZ));
+			end_lsn = Min(end_lsn, max_expected_lsn);
+
+			if (end_lsn > targetPagePtr + XLOG_BLCKSZ)
+			{
+				if (read_ahead_buf == NULL)
+					read_ahead_buf = MemoryContextAlloc(TopMemoryContext,
+														MAX_READ_AHEAD_XLOGS * XLOG_BLCKSZ);
+				read_buf = read_ahead_buf;
+				read_size = end_lsn - targetPagePtr;
+			}
+		}
+	}
+
+	read_rc = polar_pread(readFile, read_buf, read_size, (off_t) readOff);
+	save_errno = errno;
+
+	if (read_rc != read_size)
+	{
+		ereport(LOG,
+				(errmsg("Read size %d is not equal to size %d for xlog page %X/%X",
+						read_rc, read_size, LSN_FORMAT_ARGS(targetPagePtr))));
+	}
+	else if (enable_xlog_buffer)
+	{
+		XLogRecPtr	cur_page_lsn = targetPagePtr;
+		XLogRecPtr	end_page_lsn = targetPagePtr + read_size;
+		char	   *buffer = read_buf;
+		int			nappended = 0;
+
 		/*
 		 * startup process should consider the data replay lag of parallel
 		 * replayers and the flush lag of wal receiver process.
@@ -5461,11 +5504,23 @@ polar_xlog_page_read_internal(XLogRecPtr targetPagePtr, char *readBuf, uint32 si
 
 			if (cur_page_lsn + XLOG_BLCKSZ > flushedUpto)
 				len = flushedUpto - cur_page_lsn;
-			polar_xlog_buffer_append(cur_page_lsn, len, buffer);
+			if (polar_xlog_buffer_append(cur_page_lsn, len, buffer) &&
+				cur_page_lsn != targetPagePtr)
+				nappended++;
 
 			cur_page_lsn += XLOG_BLCKSZ;
 			buffer += XLOG_BLCKSZ;
 		}
+
+		if (size == XLOG_BLCKSZ)
+			polar_xlog_buffer_read_ahead_done(targetPagePtr, read_size / XLOG_BLCKSZ, nappended);
+	}
+
+	/* Return the requested page only */
+	if (read_buf != readBuf && read_rc >= (int) size)
+	{
+		memcpy(readBuf, read_buf, size);
+		read_rc = size;
 	}
 
 	errno = save_errno;
@@ -3523,9 +3523,10 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 								  !INSTR_TIME_IS_ZERO(usage->blk_write_time));
 		bool		has_temp_timing = (!INSTR_TIME_IS_ZERO(usage->temp_blk_read_time) ||
 									   !INSTR_TIME_IS_ZERO(usage->temp_blk_write_time));
+		bool		has_bulk_read = (usage->polar_bulk_read_calls_IO > 0);
 		bool		show_planning = (planning && (has_shared ||
 												  has_local || has_temp || has_timing ||
-												  has_temp_timing));
+												  has_temp_timing || has_bulk_read));
 
 		if (show_planning)
 		{
@@ -3620,6 +3621,15 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 			appendStringInfoChar(es->str, '\n');
 		}
 
+		/* POLAR: bulk read */
+		if (has_bulk_read)
+		{
+			ExplainIndentText(es);
+			appendStringInfo(es->str, "Bulk Read: calls=%lld blocks=%lld\n",
+							 (long long) usage->polar_bulk_read_calls_IO,
+							 (long long) usage->polar_bulk_read_blocks_IO);
+		}
+
 		if (show_planning)
 			es->indent--;
 	}
@@ -3660,6 +3670,12 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 								 INSTR_TIME_GET_MILLISEC(usage->temp_blk_write_time),
 								 3, es);
 		}
+
+		/* POLAR: bulk read */
+		ExplainPropertyInteger("Bulk Read Calls", NULL,
+							   usage->polar_bulk_read_calls_IO, es);
+		ExplainPropertyInteger("Bulk Read Blocks", NULL,
+							   usage->polar_bulk_read_blocks_IO, es);
 	}
 }
 
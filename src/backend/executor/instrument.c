@@ -239,6 +239,8 @@ BufferUsageAdd(BufferUsage *dst, const BufferUsage *add)
 	INSTR_TIME_ADD(dst->blk_write_time, add->blk_write_time);
 	INSTR_TIME_ADD(dst->temp_blk_read_time, add->temp_blk_read_time);
 	INSTR_TIME_ADD(dst->temp_blk_write_time, add->temp_blk_write_time);
+	dst->polar_bulk_read_calls_IO += add->polar_bulk_read_calls_IO;
+	dst->polar_bulk_read_blocks_IO += add->polar_bulk_read_blocks_IO;
 }
 
 /* dst += add - sub */
@@ -265,6 +267,10 @@ BufferUsageAccumDiff(BufferUsage *dst,
 						  add->temp_blk_read_time, sub->temp_blk_read_time);
 	INSTR_TIME_ACCUM_DIFF(dst->temp_blk_write_time,
 						  add->temp_blk_write_time, sub->temp_blk_write_time);
+	dst->polar_bulk_read_calls_IO +=
+		add->polar_bulk_read_calls_IO - sub->polar_bulk_read_calls_IO;
+	dst->polar_bulk_read_blocks_IO +=
+		add->polar_bulk_read_blocks_IO - sub->polar_bulk_read_blocks_IO;
 }
 
 /* helper functions for WAL usage accumulation */
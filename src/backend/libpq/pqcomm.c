@@ -49,6 +49,8 @@
  * message-level I/O
  *		pq_putmessage	- send a normal message (suppressed in COPY OUT mode)
  *		pq_putmessage_noblock - buffer a normal message (suppressed in COPY OUT)
+ *		polar_pq_putmessage_iov_noblock - like pq_putmessage_noblock, but the
+ *						message body is sent or buffered from iovec
  *
  *------------------------
  */
@@ -79,10 +81,14 @@
 #include "libpq/libpq.h"
 #include "miscadmin.h"
 #include "port/pg_bswap.h"
+#include "port/pg_iovec.h"
 #include "storage/ipc.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 
+/* POLAR */
+#include "libpq/polar_network_stats.h"
+
 /*
  * Cope with the various platform-specific ways to spell TCP keepalive socket
  * options.  This doesn't cover Windows, which as usual does its own thing.
@@ -1549,6 +1555,143 @@ socket_putmessage_noblock(char msgtype, const char *s, size_t len)
 								 * buffer */
 }
 
+/*
+ * POLAR: Send header and iov by one sendmsg() call from the caller's memory,
+ * if nothing is waiting in the output buffer and the connection is not
+ * encrypted.  The socket is in non-blocking mode, so it may take only a part
+ * of them.  Return the number of bytes sent.  Errors are not reported here,
+ * they show up again when the unsent part is flushed.
+ */
+static size_t
+polar_pq_sendmsg(char *header, size_t header_len, const struct iovec *iov, int iovcnt)
+{
+#ifndef WIN32
+	static struct iovec *msg_iov = NULL;
+	static int	msg_iov_size = 0;
+	struct msghdr msg;
+	ssize_t		n;
+
+	if (PqSendStart != PqSendPointer || iovcnt + 1 > IOV_MAX)
+		return 0;
+
+#ifdef USE_SSL
+	if (MyProcPort->ssl_in_use)
+		return 0;
+#endif
+#ifdef ENABLE_GSS
+	if (MyProcPort->gss && MyProcPort->gss->enc)
+		return 0;
+#endif
+
+	if (msg_iov_size < iovcnt + 1)
+	{
+		if (msg_iov != NULL)
+			pfree(msg_iov);
+
+		msg_iov_size = iovcnt + 1;
+		msg_iov = MemoryContextAlloc(TopMemoryContext, sizeof(struct iovec) * msg_iov_size);
+	}
+
+	msg_iov[0].iov_base = header;
+	msg_iov[0].iov_len = header_len;
+	memcpy(&msg_iov[1], iov, sizeof(struct iovec) * iovcnt);
+
+	MemSet(&msg, 0, sizeof(msg));
+	msg.msg_iov = msg_iov;
+	msg.msg_iovlen = iovcnt + 1;
+
+	do
+	{
+		n = sendmsg(MyProcPort->sock, &msg, 0);
+	} while (n < 0 && errno == EINTR);
+
+	if (n > 0)
+	{
+		polar_network_sendrecv_stat(POLAR_NETWORK_SEND_STAT, n);
+		return n;
+	}
+#endif
+
+	return 0;
+}
+
+/*
+ * POLAR: Put the bytes after the first *skip bytes of s into output buffer,
+ * and decrease *skip by the bytes skipped.
+ */
+static int
+polar_internal_putbytes_skip(const char *s, size_t len, size_t *skip)
+{
+	size_t		skipped = Min(len, *skip);
+
+	*skip -= skipped;
+
+	if (skipped == len)
+		return 0;
+
+	return internal_putbytes(s + skipped, len - skipped);
+}
+
+/* --------------------------------
+ *		polar_pq_putmessage_iov_noblock - like pq_putmessage_noblock, but the
+ *		message body is gathered from iovcnt pieces in iov
+ *
+ *		Pending output is flushed first if the socket takes it without
+ *		blocking.  Then if nothing is left in the output buffer and the
+ *		connection is not encrypted, the message is sent from iov directly,
+ *		and only the part which the socket doesn't take is copied into the
+ *		output buffer.  Otherwise the pieces are copied into the output
+ *		buffer.  Either way the caller can release the pieces as soon as
+ *		this returns.  Only for the socket, see walsender.
+ * --------------------------------
+ */
+void
+polar_pq_putmessage_iov_noblock(char msgtype, const struct iovec *iov, int iovcnt)
+{
+	int			res PG_USED_FOR_ASSERTS_ONLY = 0;
+	size_t		len = 0;
+	size_t		sent;
+	int			required;
+	char		header[1 + 4];
+	uint32		n32;
+	int			i;
+
+	Assert(msgtype != 0);
+	Assert(PqCommMethods == &PqCommSocketMethods);
+
+	for (i = 0; i < iovcnt; i++)
+		len += iov[i].iov_len;
+
+	(void) socket_flush_if_writable();
+
+	required = PqSendPointer + sizeof(header) + len;
+	if (required > PqSendBufferSize)
+	{
+		PqSendBuffer = repalloc(PqSendBuffer, required);
+		PqSendBufferSize = required;
+	}
+
+	if (PqCommBusy)
+		return;
+	PqCommBusy = true;
+
+	header[0] = msgtype;
+	n32 = pg_hton32((uint32) (len + 4));
+	memcpy(&header[1], &n32, 4);
+
+	sent = polar_pq_sendmsg(header, sizeof(header), iov, iovcnt);
+
+	/* Buffer the part which is not sent */
+	res |= polar_internal_putbytes_skip(header, sizeof(header), &sent);
+	for (i = 0; i < iovcnt; i++)
+		res |= polar_internal_putbytes_skip(iov[i].iov_base, iov[i].iov_len, &sent);
+
+	PqCommBusy = false;
+
+	Assert(res == 0);			/* should not fail when the message fits in
+								 * buffer */
+}
+
 /* --------------------------------
  *		pq_putmessage_v2 - send a message in protocol version 2
  *
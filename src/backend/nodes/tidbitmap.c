@@ -46,6 +46,7 @@
 #include "nodes/tidbitmap.h"
 #include "storage/lwlock.h"
 #include "utils/dsa.h"
+#include "utils/guc.h"
 
 /*
  * The maximum number of tuples per page is not large (typically 256 with
@@ -237,6 +238,8 @@ static void tbm_lossify(TIDBitmap *tbm);
 static int	tbm_comparator(const void *left, const void *right);
 static int	tbm_shared_comparator(const void *left, const void *right,
 								  void *arg);
+static void polar_tbm_set_nblocks(TBMIterator *iterator, TBMIterateResult *output,
+								  BlockNumber prev_blockno, int prev_nblocks);
 
 /* define hashtable mapping block numbers to PagetableEntry's */
 #define SH_USE_NONDEFAULT_ALLOCATOR
@@ -705,6 +708,7 @@ tbm_begin_iterate(TIDBitmap *tbm)
 	iterator->spageptr = 0;
 	iterator->schunkptr = 0;
 	iterator->schunkbit = 0;
+	iterator->output.polar_nblocks = 0;
 
 	/*
 	 * If we have a hashtable, create and fill the sorted page lists, unless
@@ -971,6 +975,8 @@ tbm_iterate(TBMIterator *iterator)
 {
 	TIDBitmap  *tbm = iterator->tbm;
 	TBMIterateResult *output = &(iterator->output);
+	BlockNumber prev_blockno = output->blockno;
+	int			prev_nblocks = output->polar_nblocks;
 
 	Assert(tbm->iterating == TBM_ITERATING_PRIVATE);
 
@@ -1012,6 +1018,7 @@ tbm_iterate(TBMIterator *iterator)
 			output->ntuples = -1;
 			output->recheck = true;
 			iterator->schunkbit++;
+			polar_tbm_set_nblocks(iterator, output, prev_blockno, prev_nblocks);
 			return output;
 		}
 	}
@@ -1033,6 +1040,7 @@ tbm_iterate(TBMIterator *iterator)
 		output->ntuples = ntuples;
 		output->recheck = page->recheck;
 		iterator->spageptr++;
+		polar_tbm_set_nblocks(iterator, output, prev_blockno, prev_nblocks);
 		return output;
 	}
 
@@ -1040,6 +1048,68 @@ tbm_iterate(TBMIterator *iterator)
 	return NULL;
 }
 
+/*
+ * POLAR: Count the blocks in the bitmap which follow blockno one by one,
+ * including blockno itself and at most max_nblocks, so bulk read can read
+ * them together. The iterator is not advanced.
+ */
+static int
+polar_tbm_consecutive_blocks(TBMIterator *iterator, BlockNumber blockno,
+							 int max_nblocks)
+{
+	TIDBitmap  *tbm = iterator->tbm;
+	int			spageptr = iterator->spageptr;
+	int			schunkptr = iterator->schunkptr;
+	int			schunkbit = iterator->schunkbit;
+	int			nblocks = 1;
+
+	while (nblocks < max_nblocks)
+	{
+		BlockNumber next = blockno + nblocks;
+
+		/* Like tbm_iterate, find the next set bit of lossy chunks */
+		while (schunkptr < tbm->nchunks)
+		{
+			tbm_advance_schunkbit(tbm->schunks[schunkptr], &schunkbit);
+			if (schunkbit < PAGES_PER_CHUNK)
+				break;
+			schunkptr++;
+			schunkbit = 0;
+		}
+
+		if (schunkptr < tbm->nchunks &&
+			tbm->schunks[schunkptr]->blockno + schunkbit == next)
+			schunkbit++;
+		else if (spageptr < tbm->npages && tbm->status != TBM_ONE_PAGE &&
+				 tbm->spages[spageptr]->blockno == next)
+			spageptr++;
+		else
+			break;
+
+		nblocks++;
+	}
+
+	return nblocks;
+}
+
+/*
+ * POLAR: Set the number of consecutive blocks of the output. The blocks
+ * counted for the previous output are still consecutive, count them again
+ * only when the previous run is used up.
+ */
+static void
+polar_tbm_set_nblocks(TBMIterator *iterator, TBMIterateResult *output,
+					  BlockNumber prev_blockno, int prev_nblocks)
+{
+	if (polar_bulk_read_size <= 1)
+		output->polar_nblocks = 1;
+	else if (prev_nblocks > 1 && prev_blockno + 1 == output->blockno)
+		output->polar_nblocks = prev_nblocks - 1;
+	else
+		output->polar_nblocks = polar_tbm_consecutive_blocks(iterator, output->blockno,
+															 polar_bulk_read_size);
+}
+
 /*
  *	tbm_shared_iterate - scan through next page of a TIDBitmap
  *
@@ -1104,6 +1174,7 @@ tbm_shared_iterate(TBMSharedIterator *iterator)
 			output->blockno = chunk_blockno;
 			output->ntuples = -1;
 			output->recheck = true;
+			output->polar_nblocks = 1;
 			istate->schunkbit++;
 
 			LWLockRelease(&istate->lock);
@@ -1121,6 +1192,7 @@ tbm_shared_iterate(TBMSharedIterator *iterator)
 		output->blockno = page->blockno;
 		output->ntuples = ntuples;
 		output->recheck = page->recheck;
+		output->polar_nblocks = 1;
 		istate->spageptr++;
 
 		LWLockRelease(&istate->lock);
@@ -40,6 +40,7 @@
 #include "access/polar_logindex_redo.h"
 #include "postmaster/polar_async_lock_replay.h"
 #include "postmaster/polar_parallel_bgwriter.h"
+#include "storage/polar_prefetch.h"
 
 /*
  * The postmaster's list of registered background workers, in private memory.
@@ -141,6 +142,9 @@ static const struct
 	},
 	{
 		"polar_alr_worker_main", polar_alr_worker_main
+	},
+	{
+		"polar_prefetch_worker_main", polar_prefetch_worker_main
 	}
 	/* POLAR end */
 };
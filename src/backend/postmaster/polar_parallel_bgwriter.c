@@ -123,9 +123,44 @@ polar_init_parallel_bgwriter(void)
 		pg_atomic_init_u32(&polar_parallel_bgwriter_info->current_workers, 0);
 		polar_parallel_bgwriter_info->read_worker_idx = 0;
 		polar_parallel_bgwriter_info->write_worker_idx = 0;
+
+		pg_atomic_init_u32(&polar_parallel_bgwriter_info->batch_size, 0);
+		SpinLockInit(&polar_parallel_bgwriter_info->control_lock);
+		polar_parallel_bgwriter_info->control_count = 0;
+		MemSet(polar_parallel_bgwriter_info->control_history, 0,
+			   sizeof(polar_parallel_bgwriter_info->control_history));
 	}
 }
 
+/*
+ * Get the number of buffers which each bgwriter syncs at most in one round,
+ * it's decided by the bgwriter controller if it's enabled.
+ */
+int
+polar_get_parallel_bgwriter_batch_size(void)
+{
+	uint32		batch_size = 0;
+
+	if (polar_parallel_bgwriter_enabled() && polar_parallel_bgwriter_info)
+		batch_size = pg_atomic_read_u32(&polar_parallel_bgwriter_info->batch_size);
+
+	return batch_size > 0 ? batch_size : polar_bgwriter_batch_size;
+}
+
+/* Remember one decision of the bgwriter controller, the oldest is replaced. */
+void
+polar_add_parallel_bgwriter_control_sample(polar_bgwriter_control_sample *sample)
+{
+	ParallelBgwriterInfo *info = polar_parallel_bgwriter_info;
+
+	pg_atomic_write_u32(&info->batch_size, sample->batch_size);
+
+	SpinLockAcquire(&info->control_lock);
+	info->control_history[info->control_count % POLAR_BGWRITER_CONTROL_HISTORY_SIZE] = *sample;
+	info->control_count++;
+	SpinLockRelease(&info->control_lock);
+}
+
 Size
 polar_parallel_bgwriter_shmem_size(void)
 {
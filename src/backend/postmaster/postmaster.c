@@ -145,6 +145,7 @@
 #include "access/polar_logindex_redo.h"
 #include "postmaster/polar_async_lock_replay.h"
 #include "storage/polar_fd.h"
+#include "storage/polar_prefetch.h"
 /* POLAR end */
 
 
@@ -1089,6 +1090,9 @@ PostmasterMain(int argc, char *argv[])
 	/* Register the polar logindex saver. */
 	polar_register_logindex_primary_saver();
 
+	/* POLAR: Register the prefetch workers. */
+	polar_register_prefetch_workers();
+
 	/*
 	 * process any libraries that should be preloaded at postmaster start
 	 */
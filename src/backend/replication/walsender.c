@@ -273,6 +273,8 @@ static void WalSndSegmentOpen(XLogReaderState *state, XLogSegNo nextSegNo,
 
 /* POLAR: Maximum XLOG meta in a WAL data message */
 #define POLAR_QUEUE_MAX_SEND_SIZE 1024
+/* POLAR: Maximum pieces of a WAL data message sent from the xlog queue */
+#define POLAR_QUEUE_MAX_SEND_IOV 256
 static polar_ringbuf_ref_t xlog_queue_ref =
 {
 	0
@@ -4249,7 +4251,9 @@ polar_replication_mode_str(polar_repl_mode_t mode)
  *
  * Read up to POLAR_QUEUE_MAX_SEND_SIZE or one whole packet bytes of XLOG meta or CLOG  that's been flushed to disk,
  * but not yet sent to the client, and buffer it in the libpq output
- * buffer.
+ * buffer. The packets are sent from the xlog queue memory directly when the
+ * libpq output buffer is empty, only the unsent part is copied into the
+ * libpq output buffer. They are popped from the queue after that.
  *
  * If there is no unsent WAL remaining, WalSndCaughtUp is set to true,
  * otherwise WalSndCaughtUp is set to false.
@@ -4264,6 +4268,10 @@ polar_send_physical_by_queue(polar_ringbuf_ref_t *ref)
 	ssize_t		send_bytes = 0;
 	size_t		pktlen = 0;
 	size_t		max_send_size;
+	struct iovec send_iov[POLAR_QUEUE_MAX_SEND_IOV];
+	int			send_iovcnt = 0;
+	int			send_npkts = 0;
+	size_t		next_pread = 0;
 	XLogRecPtr	max_send_ptr = InvalidXLogRecPtr;
 	static XLogRecPtr last_flush_ptr = InvalidXLogRecPtr;
 
@@ -4338,20 +4346,20 @@ polar_send_physical_by_queue(polar_ringbuf_ref_t *ref)
 	 * receiver decode data it read packet length first and then read packet
 	 * data, so buffer must have space to save packet data and one more
 	 * uint32, which save packet length.
+	 *
+	 * The packet length and data are saved in the same layout in the queue,
+	 * so the message is sent from the queue memory directly.  The queue
+	 * reference is kept strong until the message is sent or copied into
+	 * libpq output buffer, so that the packets can't be overwritten
+	 * meanwhile.
 	 */
 	max_send_size = Max((pktlen + sizeof(uint32)), POLAR_QUEUE_MAX_SEND_SIZE);
-	enlargeStringInfo(&output_message, max_send_size);
-
-	send_bytes = polar_xlog_send_queue_raw_data_pop(ref,
-													(uint8 *) &output_message.data[output_message.len],
-													max_send_size, &max_send_ptr);
-
-
-	if (!polar_ringbuf_clear_ref(ref))
-		elog(PANIC, "PolarDB: Failed to clear send queue reference");
 
-	output_message.len += send_bytes;
-	output_message.data[output_message.len] = '\0';
+	send_bytes = polar_xlog_send_queue_raw_data_peek(ref, &send_iov[1],
+													 POLAR_QUEUE_MAX_SEND_IOV - 1,
+													 &send_iovcnt, max_send_size,
+													 &max_send_ptr, &send_npkts,
+													 &next_pread);
 
 	/*
 	 * POLAR: Fill the max valid lsn and send timestamp last, so that it is
@@ -4361,7 +4369,15 @@ polar_send_physical_by_queue(polar_ringbuf_ref_t *ref)
 	pq_sendint64(&tmpbuf, GetCurrentTimestamp());
 	memcpy(&output_message.data[1 + sizeof(int64) + sizeof(int64)],
 		   tmpbuf.data, sizeof(int64));
-	pq_putmessage_noblock('d', output_message.data, output_message.len);
+
+	send_iov[0].iov_base = output_message.data;
+	send_iov[0].iov_len = output_message.len;
+	polar_pq_putmessage_iov_noblock('d', send_iov, send_iovcnt + 1);
+
+	polar_xlog_send_queue_raw_data_release(ref, send_npkts, next_pread);
+
+	if (!polar_ringbuf_clear_ref(ref))
+		elog(PANIC, "PolarDB: Failed to clear send queue reference");
 
 	if (send_bytes != 0)
 	{
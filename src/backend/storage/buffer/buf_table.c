@@ -9,6 +9,13 @@
  * in most cases the caller needs to adjust the buffer header contents
  * before the lock is released (see notes in README).
  *
+ * POLAR: When polar_enable_buffer_lockfree_lookup is on, the entries are also
+ * mirrored into an open addressing table which can be probed without any
+ * lock, see polar_buf_table_lookup_optimistic().  Each BufMappingLock
+ * partition owns a slice of that table with a sequence counter, writers
+ * still hold the partition lock exclusively, so there is only one writer of
+ * a slice at a time.
+ *
  *
  * Portions Copyright (c) 1996-2022, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -24,6 +31,10 @@
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 
+/* POLAR */
+#include "port/atomics.h"
+#include "utils/guc.h"
+
 /* entry for buffer lookup hashtable */
 typedef struct
 {
@@ -33,6 +44,42 @@ typedef struct
 
 static HTAB *SharedBufHash;
 
+/* POLAR: slot of the lock-free lookup table, id is -1 if slot is empty */
+typedef struct PolarBufLookupSlot
+{
+	BufferTag	key;
+	uint32		hashcode;		/* Hash code of key */
+	int			id;
+} PolarBufLookupSlot;
+
+/*
+ * POLAR: one slice of the lock-free lookup table per BufMappingLock
+ * partition.  version is odd while the slice is being changed.
+ */
+typedef struct PolarBufLookupPartition
+{
+	pg_atomic_uint32 version;
+	int			count;			/* Number of used slots */
+	int			skipped;		/* Inserts skipped because slice is full */
+} PolarBufLookupPartition;
+
+typedef union PolarBufLookupPartitionPadded
+{
+	PolarBufLookupPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} PolarBufLookupPartitionPadded;
+
+/* Lookups give up and let the caller take the lock after so many retries */
+#define POLAR_BUF_LOOKUP_MAX_RETRIES	8
+
+static PolarBufLookupPartitionPadded *polar_buf_lookup_partitions = NULL;
+static PolarBufLookupSlot *polar_buf_lookup_slots = NULL;
+static uint32 polar_buf_lookup_mask = 0;
+
+static uint32 polar_buf_lookup_slice_size(int size);
+static void polar_buf_lookup_insert(BufferTag *tagPtr, uint32 hashcode, int buf_id);
+static void polar_buf_lookup_delete(BufferTag *tagPtr, uint32 hashcode);
+
 
 /*
  * Estimate space needed for mapping hashtable
@@ -41,7 +88,19 @@ static HTAB *SharedBufHash;
 Size
 BufTableShmemSize(int size)
 {
-	return hash_estimate_size(size, sizeof(BufferLookupEnt));
+	Size		sz = hash_estimate_size(size, sizeof(BufferLookupEnt));
+
+	/* POLAR: lock-free lookup table */
+	if (polar_enable_buffer_lockfree_lookup)
+	{
+		sz = add_size(sz, mul_size(NUM_BUFFER_PARTITIONS,
+								   sizeof(PolarBufLookupPartitionPadded)));
+		sz = add_size(sz, mul_size(mul_size(NUM_BUFFER_PARTITIONS,
+											polar_buf_lookup_slice_size(size)),
+								   sizeof(PolarBufLookupSlot)));
+	}
+
+	return sz;
 }
 
 /*
@@ -64,6 +123,47 @@ InitBufTable(int size)
 								  size, size,
 								  &info,
 								  HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+	/* POLAR: lock-free lookup table */
+	if (polar_enable_buffer_lockfree_lookup)
+	{
+		uint32		slice_size = polar_buf_lookup_slice_size(size);
+		bool		found_partitions;
+		bool		found_slots;
+		int			i;
+
+		polar_buf_lookup_partitions = (PolarBufLookupPartitionPadded *)
+			ShmemInitStruct("Shared Buffer Lock-free Lookup Partitions",
+							NUM_BUFFER_PARTITIONS * sizeof(PolarBufLookupPartitionPadded),
+							&found_partitions);
+		polar_buf_lookup_slots = (PolarBufLookupSlot *)
+			ShmemInitStruct("Shared Buffer Lock-free Lookup Slots",
+							mul_size(NUM_BUFFER_PARTITIONS * slice_size,
+									 sizeof(PolarBufLookupSlot)),
+							&found_slots);
+		polar_buf_lookup_mask = slice_size - 1;
+
+		if (!found_partitions && !found_slots)
+		{
+			for (i = 0; i < NUM_BUFFER_PARTITIONS; i++)
+			{
+				PolarBufLookupPartition *part = &polar_buf_lookup_partitions[i].part;
+
+				pg_atomic_init_u32(&part->version, 0);
+				part->count = 0;
+				part->skipped = 0;
+			}
+
+			for (i = 0; i < NUM_BUFFER_PARTITIONS * slice_size; i++)
+			{
+				CLEAR_BUFFERTAG(polar_buf_lookup_slots[i].key);
+				polar_buf_lookup_slots[i].hashcode = 0;
+				polar_buf_lookup_slots[i].id = -1;
+			}
+		}
+		else
+			Assert(found_partitions && found_slots);
+	}
 }
 
 /*
@@ -136,6 +236,10 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 
 	result->id = buf_id;
 
+	/* POLAR */
+	if (polar_buf_lookup_slots != NULL)
+		polar_buf_lookup_insert(tagPtr, hashcode, buf_id);
+
 	return -1;
 }
 
@@ -159,4 +263,189 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 
 	if (!result)				/* shouldn't happen */
 		elog(ERROR, "shared buffer hash table corrupted");
+
+	/* POLAR */
+	if (polar_buf_lookup_slots != NULL)
+		polar_buf_lookup_delete(tagPtr, hashcode);
+}
+
+/* POLAR */
+
+/*
+ * Slots of one slice of the lock-free lookup table.  Keep the load factor
+ * of every slice below a half so that the probe sequences stay short.
+ */
+static uint32
+polar_buf_lookup_slice_size(int size)
+{
+	uint32		slice_size = 16;
+	int			expected = (size + NUM_BUFFER_PARTITIONS - 1) / NUM_BUFFER_PARTITIONS;
+
+	while (slice_size < (uint32) expected * 2)
+		slice_size <<= 1;
+
+	return slice_size;
+}
+
+#define polar_buf_lookup_partition(hashcode) \
+	(&polar_buf_lookup_partitions[BufTableHashPartition(hashcode)].part)
+
+#define polar_buf_lookup_slot(hashcode, i) \
+	(&polar_buf_lookup_slots[BufTableHashPartition(hashcode) * (polar_buf_lookup_mask + 1) + \
+							 ((i) & polar_buf_lookup_mask)])
+
+#define polar_buf_lookup_home(hashcode) ((hashcode) / NUM_BUFFER_PARTITIONS)
+
+/*
+ * polar_buf_lookup_insert
+ *		Mirror a new entry of the hashtable into the lock-free table.
+ *
+ * Linear probing is used.  When the slice is nearly full the entry is only
+ * kept in the hashtable, lookups of it fall back to the locked path.
+ *
+ * Caller must hold exclusive lock on BufMappingLock for tag's partition
+ */
+static void
+polar_buf_lookup_insert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
+{
+	PolarBufLookupPartition *part = polar_buf_lookup_partition(hashcode);
+	uint32		i = polar_buf_lookup_home(hashcode);
+
+	if (part->count >= (polar_buf_lookup_mask + 1) * 3 / 4)
+	{
+		part->skipped++;
+		return;
+	}
+
+	while (polar_buf_lookup_slot(hashcode, i)->id >= 0)
+		i++;
+
+	pg_atomic_fetch_add_u32(&part->version, 1);
+	polar_buf_lookup_slot(hashcode, i)->key = *tagPtr;
+	polar_buf_lookup_slot(hashcode, i)->hashcode = hashcode;
+	polar_buf_lookup_slot(hashcode, i)->id = buf_id;
+	part->count++;
+	pg_atomic_fetch_add_u32(&part->version, 1);
+}
+
+/*
+ * polar_buf_lookup_delete
+ *		Remove an entry from the lock-free table if it's there.
+ *
+ * The following entries of the probe sequence are shifted back so that no
+ * tombstone is needed.
+ *
+ * Caller must hold exclusive lock on BufMappingLock for tag's partition
+ */
+static void
+polar_buf_lookup_delete(BufferTag *tagPtr, uint32 hashcode)
+{
+	PolarBufLookupPartition *part = polar_buf_lookup_partition(hashcode);
+	uint32		i = polar_buf_lookup_home(hashcode);
+	uint32		j;
+	PolarBufLookupSlot *slot;
+
+	for (;; i++)
+	{
+		slot = polar_buf_lookup_slot(hashcode, i);
+		if (slot->id < 0)
+		{
+			/* It was skipped by polar_buf_lookup_insert */
+			if (part->skipped > 0)
+				part->skipped--;
+			return;
+		}
+		if (slot->hashcode == hashcode && BUFFERTAGS_EQUAL(slot->key, *tagPtr))
+			break;
+	}
+
+	pg_atomic_fetch_add_u32(&part->version, 1);
+
+	for (j = i + 1;; j++)
+	{
+		PolarBufLookupSlot *next = polar_buf_lookup_slot(hashcode, j);
+		uint32		home;
+
+		if (next->id < 0)
+			break;
+
+		/*
+		 * Move the entry to the hole if the hole is within its probe
+		 * sequence, i.e. its home slot is not in (i, j].
+		 */
+		home = polar_buf_lookup_home(next->hashcode);
+		if (((j - home) & polar_buf_lookup_mask) >= ((j - i) & polar_buf_lookup_mask))
+		{
+			*slot = *next;
+			slot = next;
+			i = j;
+		}
+	}
+
+	CLEAR_BUFFERTAG(slot->key);
+	slot->id = -1;
+	part->count--;
+
+	pg_atomic_fetch_add_u32(&part->version, 1);
+}
+
+/*
+ * polar_buf_table_lookup_optimistic
+ *		Lookup the given BufferTag without any lock; return buffer ID, or -1
+ *		if not found.
+ *
+ * The slice is probed between two reads of its version, and probed again if
+ * a writer changed it meanwhile.  The result is only a hint: the buffer may
+ * be reused for another page as soon as it's returned, so caller must pin the
+ * buffer and then check its tag.  -1 doesn't mean the page is not in the
+ * buffer pool, caller must lookup again with BufTableLookup() under the lock.
+ */
+int
+polar_buf_table_lookup_optimistic(BufferTag *tagPtr, uint32 hashcode)
+{
+	PolarBufLookupPartition *part;
+	int			retries;
+
+	if (polar_buf_lookup_slots == NULL)
+		return -1;
+
+	part = polar_buf_lookup_partition(hashcode);
+
+	for (retries = 0; retries < POLAR_BUF_LOOKUP_MAX_RETRIES; retries++)
+	{
+		uint32		version = pg_atomic_read_u32(&part->version);
+		uint32		i = polar_buf_lookup_home(hashcode);
+		uint32		n;
+		int			buf_id = -1;
+
+		if (version & 1)
+		{
+			pg_spin_delay();
+			continue;
+		}
+
+		pg_read_barrier();
+
+		for (n = 0; n <= polar_buf_lookup_mask; n++, i++)
+		{
+			volatile PolarBufLookupSlot *slot = polar_buf_lookup_slot(hashcode, i);
+			int			id = slot->id;
+
+			if (id < 0)
+				break;
+
+			if (slot->hashcode == hashcode && BUFFERTAGS_EQUAL(slot->key, *tagPtr))
+			{
+				buf_id = id;
+				break;
+			}
+		}
+
+		pg_read_barrier();
+
+		if (pg_atomic_read_u32(&part->version) == version)
+			return (buf_id >= 0 && buf_id < NBuffers) ? buf_id : -1;
+	}
+
+	return -1;
 }
@@ -1253,6 +1253,40 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
+	/*
+	 * POLAR: try to find the block without the mapping lock first. The buffer
+	 * may be reused for another page between the lookup and the pin, so its
+	 * tag must be checked again after it's pinned. Once pinned, nobody can
+	 * change its tag. If it doesn't match, take the lock as usual.
+	 */
+	buf_id = polar_buf_table_lookup_optimistic(&newTag, newHash);
+	if (buf_id >= 0)
+	{
+		bool		tag_matched;
+
+		buf = GetBufferDescriptor(buf_id);
+
+		valid = PinBuffer(buf, strategy);
+
+		buf_state = LockBufHdr(buf);
+		tag_matched = (buf_state & BM_TAG_VALID) && BUFFERTAGS_EQUAL(buf->tag, newTag);
+		UnlockBufHdr(buf, buf_state);
+
+		if (tag_matched)
+		{
+			*foundPtr = true;
+
+			/* Same as the locked path below */
+			if (!valid && StartBufferIO(buf, true))
+				*foundPtr = false;
+
+			return buf;
+		}
+
+		UnpinBuffer(buf, true);
+	}
+	/* POLAR end */
+
 	/* see if the block is in the buffer pool already */
 	LWLockAcquire(newPartitionLock, LW_SHARED);
 	buf_id = BufTableLookup(&newTag, newHash);
@@ -1313,7 +1347,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		 * Select a victim buffer.  The buffer is returned with its header
 		 * spinlock still held!
 		 */
-		buf = StrategyGetBuffer(strategy, &buf_state);
+		buf = StrategyGetBuffer(strategy, &buf_state, newHash);
 
 		/*
 		 * POLAR: only in bulk read, StrategyGetBuffer can return NULL. If
@@ -28,6 +28,81 @@
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
+/*
+ * POLAR: The buffers are swept by polar_buffer_sweep_partitions clock hands,
+ * buffer i belongs to sweep partition (i % partition_num). A backend takes
+ * the partitions round robin for its allocations, starting from one chosen by
+ * its pgprocno. So backends don't contend on a single clock hand, and all the
+ * partitions are recycled evenly even if only a few backends are busy.
+ *
+ * When polar_enable_buffer_2q is on, every partition also keeps a FIFO queue
+ * of its recently loaded buffers, which is the probationary queue (A1in) of
+ * 2Q, and the clock sweep works as the protected queue (Am). Buffers in the
+ * queue are evicted in FIFO order, even if they are referenced again in the
+ * queue, since such references are mostly correlated ones of the same scan.
+ * The tags of the evicted buffers are remembered in a ghost queue (A1out),
+ * and a page loaded again while its tag is in the ghost queue goes into the
+ * protected queue directly. So pages read only once by a large scan don't
+ * push frequently used pages out.
+ *
+ * The ghost queue keeps the hash codes of tags, and a page is looked up by
+ * a counting filter of them, so it may be taken as a ghost by mistake now and
+ * then. It's partitioned by the hash code, as the buffer which a page is
+ * loaded into is not known beforehand.
+ */
+/* Size of the probationary queue, as percent of the buffers of a partition */
+#define POLAR_BUFFER_2Q_PROBATION_PERCENT 25
+#define polar_probation_size(nbuffers) \
+	((int) ((int64) (nbuffers) * POLAR_BUFFER_2Q_PROBATION_PERCENT / 100) + 1)
+/* Size of the ghost queue, as percent of the buffers of a partition */
+#define POLAR_BUFFER_2Q_GHOST_PERCENT 50
+#define polar_ghost_size(nbuffers) \
+	((int) ((int64) (nbuffers) * POLAR_BUFFER_2Q_GHOST_PERCENT / 100) + 1)
+/* Counters of the ghost filter per ghost */
+#define POLAR_BUFFER_2Q_FILTER_RATIO 8
+/* Max number of pinned buffers to skip when evicting from the queue */
+#define POLAR_BUFFER_2Q_MAX_SKIP 8
+
+typedef struct
+{
+	/*
+	 * Clock sweep hand: index of next buffer of this partition to consider
+	 * grabbing. Note that this isn't a concrete buffer - we only ever
+	 * increase the value. So, to get an actual buffer, it needs to be used
+	 * modulo nbuffers, and mapped by polar_sweep_buffer_id().
+	 */
+	pg_atomic_uint32 nextVictimBuffer;
+
+	/* Complete cycles of the clock sweep, protected by buffer_strategy_lock */
+	uint32		completePasses;
+
+	int			nbuffers;		/* Number of buffers of this partition */
+
+	/* Spinlock: protects the probationary queue below */
+	slock_t		probation_lock;
+	int			probation_start;	/* Offset of the queue in polar_probation */
+	int			probation_size; /* Capacity of the queue */
+	int			probation_head; /* The oldest buffer of the queue */
+	int			probation_count;	/* Number of buffers in the queue */
+
+	/* Spinlock: protects the ghost queue below */
+	slock_t		ghost_lock;
+	int			ghost_start;	/* Offset of the queue in polar_ghost */
+	int			ghost_size;		/* Capacity of the queue */
+	int			ghost_head;		/* The oldest ghost of the queue */
+	int			ghost_count;	/* Number of ghosts in the queue */
+	int			filter_start;	/* Offset of the filter in polar_ghost_filter */
+	int			filter_size;	/* Number of counters of the filter */
+} PolarSweepPartition;
+
+typedef union PolarSweepPartitionPadded
+{
+	PolarSweepPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} PolarSweepPartitionPadded;
+
+#define polar_sweep_buffer_id(part_id, index) \
+	((index) * StrategyControl->partition_num + (part_id))
 
 /*
  * The shared freelist control information.
@@ -37,13 +112,6 @@ typedef struct
 	/* Spinlock: protects the values below */
 	slock_t		buffer_strategy_lock;
 
-	/*
-	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
-	 * this isn't a concrete buffer - we only ever increase the value. So, to
-	 * get an actual buffer, it needs to be used modulo NBuffers.
-	 */
-	pg_atomic_uint32 nextVictimBuffer;
-
 	int			firstFreeBuffer;	/* Head of list of unused buffers */
 	int			lastFreeBuffer; /* Tail of list of unused buffers */
 
@@ -56,7 +124,6 @@ typedef struct
 	 * Statistics.  These counters should be wide enough that they can't
 	 * overflow during a single bgwriter cycle.
 	 */
-	uint32		completePasses; /* Complete cycles of the clock sweep */
 	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
 
 	/*
@@ -64,11 +131,30 @@ typedef struct
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/* POLAR: clock sweep partitions */
+	int			partition_num;
+	PolarSweepPartitionPadded partition[POLAR_MAX_SWEEP_PARTITIONS];
 } BufferStrategyControl;
 
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
+/* POLAR: buffer ids of the probationary queues of all partitions */
+static int *polar_probation = NULL;
+
+/* POLAR: whether each buffer is in a probationary queue */
+static bool *polar_in_probation = NULL;
+
+/* POLAR: tag hash codes of the ghost queues of all partitions */
+static uint32 *polar_ghost = NULL;
+
+/* POLAR: counting filters of the ghost queues of all partitions */
+static uint16 *polar_ghost_filter = NULL;
+
+/* POLAR: number of clock sweeps done by this backend */
+static uint32 polar_sweep_count = 0;
+
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
  * This is currently the only kind of BufferAccessStrategy object, but someday
@@ -108,16 +194,23 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 									 uint32 *buf_state);
 static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
+static BufferDesc *polar_get_probation_victim(PolarSweepPartition *part,
+											  uint32 *buf_state);
+static void polar_add_probation_buffer(BufferAccessStrategy strategy,
+									   BufferDesc *buf, uint32 hashcode);
+static void polar_add_ghost(uint32 hashcode);
+static bool polar_is_ghost(uint32 hashcode);
 
 /*
  * ClockSweepTick - Helper routine for StrategyGetBuffer()
  *
- * Move the clock hand one buffer ahead of its current position and return the
- * id of the buffer now under the hand.
+ * Move the clock hand of the partition one buffer ahead of its current
+ * position and return the id of the buffer now under the hand.
  */
 static inline uint32
-ClockSweepTick(void)
+ClockSweepTick(int part_id)
 {
+	PolarSweepPartition *part = &StrategyControl->partition[part_id].part;
 	uint32		victim;
 
 	/*
@@ -126,14 +219,14 @@ ClockSweepTick(void)
 	 * apparent order.
 	 */
 	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+		pg_atomic_fetch_add_u32(&part->nextVictimBuffer, 1);
 
-	if (victim >= NBuffers)
+	if (victim >= part->nbuffers)
 	{
 		uint32		originalVictim = victim;
 
 		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		victim = victim % part->nbuffers;
 
 		/*
 		 * If we're the one that just caused a wraparound, force
@@ -161,17 +254,17 @@ ClockSweepTick(void)
 				 */
 				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
-				wrapped = expected % NBuffers;
+				wrapped = expected % part->nbuffers;
 
-				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+				success = pg_atomic_compare_exchange_u32(&part->nextVictimBuffer,
 														 &expected, wrapped);
 				if (success)
-					StrategyControl->completePasses++;
+					part->completePasses++;
 				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 			}
 		}
 	}
-	return victim;
+	return polar_sweep_buffer_id(part_id, victim);
 }
 
 /*
@@ -203,15 +296,19 @@ have_free_buffer(void)
  *	To ensure that no one else can pin the buffer before we do, we must
  *	return the buffer with the buffer header spinlock still held.
  *	POLAR: if reading bulk non-first page and most buffers are pinned. return NULL
- *	instead of log(error).
+ *	instead of log(error). hashcode is the one of the tag to be loaded, it
+ *	decides whether the buffer goes into the probationary queue.
  */
 BufferDesc *
-StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
+StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state,
+				  uint32 hashcode)
 {
 	BufferDesc *buf;
 	int			bgwprocno;
 	int			trycounter;
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+	int			first;
+	int			i;
 
 	/*
 	 * If given a strategy object, see whether it can select a buffer. We
@@ -312,6 +409,7 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 			{
 				if (strategy != NULL)
 					AddBufferToRing(strategy, buf);
+				polar_add_probation_buffer(strategy, buf, hashcode);
 				*buf_state = local_buf_state;
 				return buf;
 			}
@@ -319,36 +417,68 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 		}
 	}
 
-	/* Nothing on the freelist, so run the "clock sweep" algorithm */
-	trycounter = NBuffers;
+	/* POLAR: take the partitions round robin */
+	first = ((MyProc != NULL ? MyProc->pgprocno : 0) + polar_sweep_count++) %
+		StrategyControl->partition_num;
+
+	/* POLAR: evict the oldest buffer of the probationary queue */
+	buf = polar_get_probation_victim(&StrategyControl->partition[first].part,
+									 &local_buf_state);
+	if (buf != NULL)
+	{
+		if (strategy != NULL)
+			AddBufferToRing(strategy, buf);
+		polar_add_probation_buffer(strategy, buf, hashcode);
+		*buf_state = local_buf_state;
+		return buf;
+	}
+
+	/*
+	 * Nothing on the freelist, so run the "clock sweep" algorithm. POLAR: If
+	 * all the buffers of a partition are pinned, go on with the next one.
+	 */
+	i = 0;
+	trycounter = StrategyControl->partition[first].part.nbuffers;
 	for (;;)
 	{
-		buf = GetBufferDescriptor(ClockSweepTick());
+		int			part_id = (first + i) % StrategyControl->partition_num;
+
+		buf = GetBufferDescriptor(ClockSweepTick(part_id));
 
 		/*
 		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
 		 * it; decrement the usage_count (unless pinned) and keep scanning.
+		 * POLAR: The buffers in the probationary queue are left to the queue,
+		 * like the pinned ones.
 		 */
 		local_buf_state = LockBufHdr(buf);
 
-		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+			!(polar_enable_buffer_2q && polar_in_probation[buf->buf_id]))
 		{
 			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
 			{
 				local_buf_state -= BUF_USAGECOUNT_ONE;
 
-				trycounter = NBuffers;
+				trycounter = StrategyControl->partition[part_id].part.nbuffers;
 			}
 			else
 			{
 				/* Found a usable buffer */
 				if (strategy != NULL)
 					AddBufferToRing(strategy, buf);
+				polar_add_probation_buffer(strategy, buf, hashcode);
 				*buf_state = local_buf_state;
 				return buf;
 			}
 		}
-		else if (--trycounter == 0)
+		else if (--trycounter == 0 &&
+				 ++i < StrategyControl->partition_num)
+		{
+			/* POLAR: all buffers of this partition are pinned, try the next */
+			trycounter = StrategyControl->partition[(first + i) % StrategyControl->partition_num].part.nbuffers;
+		}
+		else if (trycounter == 0)
 		{
 			/*
 			 * We've scanned all the buffers without making any state changes,
@@ -409,24 +539,44 @@ StrategyFreeBuffer(BufferDesc *buf)
 int
 StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
 {
-	uint32		nextVictimBuffer;
-	int			result;
+	uint32		passes = 0;
+	int			result = 0;
+	double		min_progress = -1;
+	int			i;
 
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
-	result = nextVictimBuffer % NBuffers;
 
-	if (complete_passes)
+	/*
+	 * POLAR: Use the hand of the partition which is the least advanced. The
+	 * buffers of all partitions are interleaved, so the hands of the other
+	 * partitions are ahead of the same position of the buffer array. Every
+	 * backend allocates from all partitions round robin, so no partition is
+	 * left idle and the hands stay close to each other.
+	 */
+	for (i = 0; i < StrategyControl->partition_num; i++)
 	{
-		*complete_passes = StrategyControl->completePasses;
+		PolarSweepPartition *part = &StrategyControl->partition[i].part;
+		uint32		nextVictimBuffer = pg_atomic_read_u32(&part->nextVictimBuffer);
 
 		/*
 		 * Additionally add the number of wraparounds that happened before
 		 * completePasses could be incremented. C.f. ClockSweepTick().
 		 */
-		*complete_passes += nextVictimBuffer / NBuffers;
+		uint32		part_passes = part->completePasses + nextVictimBuffer / part->nbuffers;
+		uint32		index = nextVictimBuffer % part->nbuffers;
+		double		progress = part_passes + (double) index / part->nbuffers;
+
+		if (min_progress < 0 || progress < min_progress)
+		{
+			min_progress = progress;
+			passes = part_passes;
+			result = Min(polar_sweep_buffer_id(0, index), NBuffers - 1);
+		}
 	}
 
+	if (complete_passes)
+		*complete_passes = passes;
+
 	if (num_buf_alloc)
 	{
 		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
@@ -476,6 +626,19 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+	/* POLAR: size of the probationary queues, see StrategyInitialize */
+	size = add_size(size, mul_size(polar_probation_size(NBuffers) +
+								   POLAR_MAX_SWEEP_PARTITIONS, sizeof(int)));
+	size = add_size(size, mul_size(NBuffers, sizeof(bool)));
+
+	/* POLAR: size of the ghost queues and their filters */
+	size = add_size(size, mul_size(polar_ghost_size(NBuffers) +
+								   POLAR_MAX_SWEEP_PARTITIONS, sizeof(uint32)));
+	size = add_size(size, mul_size(mul_size(polar_ghost_size(NBuffers) +
+											POLAR_MAX_SWEEP_PARTITIONS,
+											POLAR_BUFFER_2Q_FILTER_RATIO),
+								   sizeof(uint16)));
+
 	return size;
 }
 
@@ -490,6 +653,10 @@ void
 StrategyInitialize(bool init)
 {
 	bool		found;
+	bool		found_probation;
+	bool		found_in_probation;
+	bool		found_ghost;
+	bool		found_ghost_filter;
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -511,12 +678,43 @@ StrategyInitialize(bool init)
 						sizeof(BufferStrategyControl),
 						&found);
 
+	polar_probation = (int *)
+		ShmemInitStruct("Buffer Strategy Probation",
+						mul_size(polar_probation_size(NBuffers) +
+								 POLAR_MAX_SWEEP_PARTITIONS, sizeof(int)),
+						&found_probation);
+
+	polar_in_probation = (bool *)
+		ShmemInitStruct("Buffer Strategy In Probation",
+						mul_size(NBuffers, sizeof(bool)),
+						&found_in_probation);
+
+	polar_ghost = (uint32 *)
+		ShmemInitStruct("Buffer Strategy Ghost",
+						mul_size(polar_ghost_size(NBuffers) +
+								 POLAR_MAX_SWEEP_PARTITIONS, sizeof(uint32)),
+						&found_ghost);
+
+	polar_ghost_filter = (uint16 *)
+		ShmemInitStruct("Buffer Strategy Ghost Filter",
+						mul_size(mul_size(polar_ghost_size(NBuffers) +
+										  POLAR_MAX_SWEEP_PARTITIONS,
+										  POLAR_BUFFER_2Q_FILTER_RATIO),
+								 sizeof(uint16)),
+						&found_ghost_filter);
+
 	if (!found)
 	{
+		int			probation_start;
+		int			ghost_start;
+		int			i;
+
 		/*
 		 * Only done once, usually in postmaster
 		 */
 		Assert(init);
+		Assert(!found_probation && !found_in_probation);
+		Assert(!found_ghost && !found_ghost_filter);
 
 		SpinLockInit(&StrategyControl->buffer_strategy_lock);
 
@@ -527,11 +725,42 @@ StrategyInitialize(bool init)
 		StrategyControl->firstFreeBuffer = 0;
 		StrategyControl->lastFreeBuffer = NBuffers - 1;
 
-		/* Initialize the clock sweep pointer */
-		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+		/* Initialize the clock sweep pointers, probationary and ghost queues */
+		StrategyControl->partition_num = Min(polar_buffer_sweep_partitions, NBuffers);
+		probation_start = 0;
+		ghost_start = 0;
+
+		for (i = 0; i < StrategyControl->partition_num; i++)
+		{
+			PolarSweepPartition *part = &StrategyControl->partition[i].part;
+
+			pg_atomic_init_u32(&part->nextVictimBuffer, 0);
+			part->completePasses = 0;
+			part->nbuffers = (NBuffers - i + StrategyControl->partition_num - 1) /
+				StrategyControl->partition_num;
+
+			SpinLockInit(&part->probation_lock);
+			part->probation_start = probation_start;
+			part->probation_size = polar_probation_size(part->nbuffers);
+			part->probation_head = 0;
+			part->probation_count = 0;
+			probation_start += part->probation_size;
+
+			SpinLockInit(&part->ghost_lock);
+			part->ghost_start = ghost_start;
+			part->ghost_size = polar_ghost_size(part->nbuffers);
+			part->ghost_head = 0;
+			part->ghost_count = 0;
+			part->filter_start = ghost_start * POLAR_BUFFER_2Q_FILTER_RATIO;
+			part->filter_size = part->ghost_size * POLAR_BUFFER_2Q_FILTER_RATIO;
+			ghost_start += part->ghost_size;
+		}
+
+		MemSet(polar_in_probation, 0, mul_size(NBuffers, sizeof(bool)));
+		MemSet(polar_ghost_filter, 0,
+			   mul_size(mul_size(ghost_start, POLAR_BUFFER_2Q_FILTER_RATIO), sizeof(uint16)));
 
 		/* Clear statistics */
-		StrategyControl->completePasses = 0;
 		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
 
 		/* No pending notification */
@@ -778,3 +1007,153 @@ polar_get_buffer_access_strategy_ring_size(BufferAccessStrategy strategy)
 }
 
 /* POLAR end */
+
+/*
+ * POLAR: Take the oldest buffer of the probationary queue of the partition as
+ * victim if it's not pinned, no matter whether it's referenced again since it
+ * was loaded. The pinned buffers are promoted to the protected part just by
+ * leaving the queue. Only evict from the queue when it's full, like 2Q which
+ * keeps the probationary queue at its target size. The tag of the victim is
+ * remembered as a ghost.
+ *
+ * Return the buffer with header spinlock held, or NULL.
+ */
+static BufferDesc *
+polar_get_probation_victim(PolarSweepPartition *part, uint32 *buf_state)
+{
+	int			i;
+
+	if (!polar_enable_buffer_2q)
+		return NULL;
+
+	for (i = 0; i < POLAR_BUFFER_2Q_MAX_SKIP; i++)
+	{
+		BufferDesc *buf;
+		uint32		local_buf_state;
+
+		SpinLockAcquire(&part->probation_lock);
+
+		if (part->probation_count < part->probation_size)
+		{
+			SpinLockRelease(&part->probation_lock);
+			return NULL;
+		}
+
+		buf = GetBufferDescriptor(polar_probation[part->probation_start + part->probation_head]);
+		part->probation_head = (part->probation_head + 1) % part->probation_size;
+		part->probation_count--;
+		polar_in_probation[buf->buf_id] = false;
+
+		SpinLockRelease(&part->probation_lock);
+
+		local_buf_state = LockBufHdr(buf);
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			if (local_buf_state & BM_TAG_VALID)
+				polar_add_ghost(BufTableHashCode(&buf->tag));
+
+			*buf_state = local_buf_state;
+			return buf;
+		}
+		UnlockBufHdr(buf, local_buf_state);
+	}
+
+	return NULL;
+}
+
+/*
+ * POLAR: Put the buffer which is going to be loaded into the probationary
+ * queue of its partition, unless the page to be loaded is a ghost, which goes
+ * into the protected part directly. Buffers reused by a ring are left alone,
+ * they are already recycled by the ring. If the queue is full, the oldest
+ * buffer leaves the queue and stays in the protected part.
+ */
+static void
+polar_add_probation_buffer(BufferAccessStrategy strategy, BufferDesc *buf,
+						   uint32 hashcode)
+{
+	PolarSweepPartition *part;
+
+	if (!polar_enable_buffer_2q || strategy != NULL)
+		return;
+
+	if (polar_is_ghost(hashcode))
+		return;
+
+	part = &StrategyControl->partition[buf->buf_id % StrategyControl->partition_num].part;
+
+	SpinLockAcquire(&part->probation_lock);
+
+	/* It's put on the freelist while in the queue, keep its place */
+	if (polar_in_probation[buf->buf_id])
+	{
+		SpinLockRelease(&part->probation_lock);
+		return;
+	}
+
+	if (part->probation_count == part->probation_size)
+	{
+		polar_in_probation[polar_probation[part->probation_start + part->probation_head]] = false;
+		part->probation_head = (part->probation_head + 1) % part->probation_size;
+		part->probation_count--;
+	}
+
+	polar_probation[part->probation_start +
+					(part->probation_head + part->probation_count) % part->probation_size] = buf->buf_id;
+	part->probation_count++;
+	polar_in_probation[buf->buf_id] = true;
+
+	SpinLockRelease(&part->probation_lock);
+}
+
+/*
+ * POLAR: The ghost queue and filter of a tag hash code. The hash code picks
+ * the partition, and the rest of it picks the counter of filter.
+ */
+#define polar_ghost_partition(hashcode) \
+	(&StrategyControl->partition[(hashcode) % StrategyControl->partition_num].part)
+#define polar_ghost_counter(part, hashcode) \
+	(&polar_ghost_filter[(part)->filter_start + \
+						 ((hashcode) / StrategyControl->partition_num) % (part)->filter_size])
+
+/*
+ * POLAR: Remember the tag hash code of a buffer evicted from the probationary
+ * queue. If the ghost queue is full, the oldest ghost is forgotten.
+ */
+static void
+polar_add_ghost(uint32 hashcode)
+{
+	PolarSweepPartition *part = polar_ghost_partition(hashcode);
+
+	SpinLockAcquire(&part->ghost_lock);
+
+	if (part->ghost_count == part->ghost_size)
+	{
+		uint32		oldest = polar_ghost[part->ghost_start + part->ghost_head];
+
+		(*polar_ghost_counter(part, oldest))--;
+		part->ghost_head = (part->ghost_head + 1) % part->ghost_size;
+		part->ghost_count--;
+	}
+
+	polar_ghost[part->ghost_start +
+				(part->ghost_head + part->ghost_count) % part->ghost_size] = hashcode;
+	part->ghost_count++;
+	(*polar_ghost_counter(part, hashcode))++;
+
+	SpinLockRelease(&part->ghost_lock);
+}
+
+/*
+ * POLAR: Whether the tag hash code may be in the ghost queue. The counter is
+ * read without lock, a stale value only decides the queue of one page.
+ */
+static bool
+polar_is_ghost(uint32 hashcode)
+{
+	PolarSweepPartition *part = polar_ghost_partition(hashcode);
+
+	return *((volatile uint16 *) polar_ghost_counter(part, hashcode)) > 0;
+}
+
+/* POLAR end */
@@ -33,6 +33,7 @@
 #include "storage/polar_copybuf.h"
 #include "storage/polar_fd.h"
 #include "storage/polar_flush.h"
+#include "storage/polar_prefetch.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 #include "utils/polar_log.h"
@@ -40,6 +41,10 @@
 
 #define BUF_WRITTEN             0x01
 #define STOP_PARALLEL_BGWRITER_DELAY_FACTOR 10
+/* Bounds of the normalized error and the capacity of bgwriter controller */
+#define POLAR_BGWRITER_CONTROL_MAX_ERROR 4.0
+#define POLAR_BGWRITER_CONTROL_MIN_SCALE 0.25
+#define POLAR_BGWRITER_CONTROL_MAX_SCALE 4.0
 
 #define polar_buffer_first_touch_after_copy(buf_hdr) \
 	(buf_hdr->copy_buffer && !(buf_hdr->polar_flags & POLAR_BUF_FIRST_TOUCHED_AFTER_COPY))
@@ -54,6 +59,23 @@ static int	evaluate_sync_buffer_num(uint64 lag, int bgwriter_flush_batch_size);
 static XLogRecPtr update_consistent_lsn_delta(XLogRecPtr cur_consistent_lsn);
 static uint64 polar_consistent_lsn_lag(XLogRecPtr cur_consistent_lsn);
 static int	polar_get_lru_batch(int *next_flush_buf_id);
+static int	polar_sync_coalesced_buffers(int *batch_buf, int num,
+										 WritebackContext *wb_context, int flags);
+static void polar_control_parallel_bgwriters(uint64 consistent_lag, int lru_ahead_lap);
+
+/*
+ * POLAR: The readahead window of bulk read. Blocks in [blockno, next) have
+ * been read or prefetched by the current sequential scan of the relation.
+ */
+typedef struct polar_bulk_read_window_t
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blockno;		/* the last block read by bulk read */
+	BlockNumber next;			/* the next block to prefetch */
+} polar_bulk_read_window_t;
+
+static polar_bulk_read_window_t polar_bulk_read_window = {{InvalidOid, InvalidOid, InvalidOid}, InvalidForkNumber, 0, 0};
 
 /* POLAR: bulk io */
 static Buffer polar_bulk_read_buffer_common(Relation reln, char relpersistence, ForkNumber forkNum,
@@ -148,38 +170,41 @@ polar_bg_buffer_sync(WritebackContext *wb_context, int flags)
 XLogRecPtr
 polar_cal_cur_consistent_lsn(void)
 {
-	BufferDesc *buf;
 	XLogRecPtr	clsn;
 	XLogRecPtr	lsn;
+	XLogRecPtr	oldest_lsn;
 
 	Assert(polar_flush_list_enabled());
 
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
-	if (polar_flush_list_is_empty())
-	{
-		if (unlikely(polar_bg_redo_state_is_parallel(polar_logindex_redo_instance)))
-			lsn = polar_logindex_replayed_oldest_lsn();
-		else if (unlikely(polar_should_launch_standby_instant_recovery()))
-			lsn = polar_bg_redo_get_replayed_lsn(polar_logindex_redo_instance);
-		else
-			lsn = polar_max_valid_lsn();
-		SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+	/*
+	 * Get the current lsn before checking flush list buckets one by one. The
+	 * buffer which is put into a checked bucket later gets an oldest lsn
+	 * which is not smaller than it.
+	 */
+	if (unlikely(polar_bg_redo_state_is_parallel(polar_logindex_redo_instance)))
+		lsn = polar_logindex_replayed_oldest_lsn();
+	else if (unlikely(polar_should_launch_standby_instant_recovery()))
+		lsn = polar_bg_redo_get_replayed_lsn(polar_logindex_redo_instance);
+	else
+		lsn = polar_max_valid_lsn();
 
+	oldest_lsn = polar_get_flush_list_oldest_lsn(lsn);
+
+	if (XLogRecPtrIsInvalid(oldest_lsn))
+	{
 		if (unlikely(polar_enable_debug))
 			elog(DEBUG1,
 				 "The flush list is empty, so use current insert lsn %X/%X as consistent lsn.",
 				 LSN_FORMAT_ARGS(lsn));
-
-		return lsn;
 	}
+	else
+		lsn = Min(lsn, oldest_lsn);
 
-	Assert(polar_flush_ctl->first_flush_buffer >= 0);
-
-	buf = GetBufferDescriptor(polar_flush_ctl->first_flush_buffer);
-	lsn = pg_atomic_read_u64((pg_atomic_uint64 *) &buf->oldest_lsn);
-
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
-
+	/*
+	 * Check copy buffers even if the flush list is empty, a buffer may be
+	 * off the list while polar_adjust_position_in_flush_list moves it, and
+	 * then only its copy buffer keeps the old oldest lsn.
+	 */
 	clsn = polar_copy_buffers_get_oldest_lsn();
 	if (!XLogRecPtrIsInvalid(clsn))
 		lsn = Min(lsn, clsn);
@@ -517,6 +542,7 @@ polar_buffer_sync(WritebackContext *wb_context,
 	static int *batch_buf = NULL;
 	XLogRecPtr	cur_consistent_lsn;
 	int			num_written = 0;
+	int			single_written = 0;
 	int			num_to_sync;
 	int			sync_count = 0;
 	uint64		sleep_lag;
@@ -577,7 +603,14 @@ polar_buffer_sync(WritebackContext *wb_context,
 		if (num == 0 || batch_buf == NULL)
 			break;
 
-		/* Sync buffers */
+		/* Sync buffers, write the adjacent blocks together if possible */
+		if (polar_bgwriter_max_coalesce_size > 1 && !polar_is_replica())
+		{
+			num_written += polar_sync_coalesced_buffers(batch_buf, num, wb_context, flags);
+			sync_count += num;
+			continue;
+		}
+
 		while (i < num)
 		{
 			BufferDesc *bufHdr = GetBufferDescriptor(batch_buf[i]);
@@ -597,12 +630,22 @@ polar_buffer_sync(WritebackContext *wb_context,
 
 			i++;
 			if (sync_state & BUF_WRITTEN)
+			{
 				num_written++;
+				single_written++;
+			}
 		}
 
 		sync_count += num;
 	}
 
+	/* Every buffer synced one by one is written by its own write call */
+	if (single_written > 0)
+	{
+		pg_atomic_fetch_add_u64(&polar_flush_ctl->write, single_written);
+		pg_atomic_fetch_add_u64(&polar_flush_ctl->write_blocks, single_written);
+	}
+
 	pg_atomic_fetch_add_u64(&polar_flush_ctl->flush_buffer_io.bgwriter_flush, num_written);
 
 	PendingBgWriterStats.buf_written_clean += num_written;
@@ -628,6 +671,307 @@ polar_buffer_sync(WritebackContext *wb_context,
 	return lag < sleep_lag;
 }
 
+/* A buffer got from flush list and its tag when it's got */
+typedef struct polar_sync_item
+{
+	BufferTag	tag;
+	int			buf_id;
+} polar_sync_item;
+
+#define ST_SORT sort_polar_sync_items
+#define ST_ELEMENT_TYPE polar_sync_item
+#define ST_COMPARE(a, b) buffertag_comparator(&a->tag, &b->tag)
+#define ST_SCOPE static
+#define ST_DEFINE
+#include <lib/sort_template.h>
+
+/*
+ * Write a group of buffers whose blocks are adjacent with one write call.
+ * The buffers are pinned, share locked and in bulk io progress, they are
+ * released here.
+ */
+static void
+polar_flush_buffer_group(BufferDesc **group, int count, XLogRecPtr flush_lsn,
+						 WritebackContext *wb_context)
+{
+	static char *write_buf = NULL;
+	BufferDesc *first = group[0];
+	ErrorContextCallback errcallback;
+	instr_time	io_start,
+				io_time;
+	SMgrRelation reln;
+	int			i;
+
+	Assert(polar_bulk_io_is_in_progress);
+	Assert(polar_bulk_io_in_progress_count == count);
+
+	if (write_buf == NULL)
+		write_buf = MemoryContextAllocIOAligned(TopMemoryContext,
+												POLAR_MAX_BULK_IO_SIZE * BLCKSZ, 0);
+
+	/* Setup error traceback support for ereport() */
+	errcallback.callback = shared_buffer_write_error_callback;
+	errcallback.arg = (void *) first;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	/* Force XLOG flush up to the greatest lsn of the permanent buffers */
+	if (!XLogRecPtrIsInvalid(flush_lsn))
+		XLogFlush(flush_lsn);
+
+	/*
+	 * Other processes might be updating hint bits, so pages are copied and
+	 * the checksum is set on the copy, as PageSetChecksumCopy does.
+	 */
+	for (i = 0; i < count; i++)
+	{
+		char	   *page = write_buf + i * BLCKSZ;
+
+		memcpy(page, BufHdrGetBlock(group[i]), BLCKSZ);
+		PageSetChecksumInplace((Page) page, group[i]->tag.blockNum);
+	}
+
+	reln = smgropen(first->tag.rnode, InvalidBackendId);
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+
+	polar_smgrbulkwrite(reln, first->tag.forkNum, first->tag.blockNum,
+						count, write_buf, false);
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_SUBTRACT(io_time, io_start);
+		pgstat_count_buffer_write_time(INSTR_TIME_GET_MICROSEC(io_time));
+		INSTR_TIME_ADD(pgBufferUsage.blk_write_time, io_time);
+	}
+
+	pgBufferUsage.shared_blks_written += count;
+
+	/* Bulk io must be terminated in the reverse order */
+	for (i = count - 1; i >= 0; i--)
+	{
+		BufferDesc *buf = group[i];
+		BufferTag	tag = buf->tag;
+
+		polar_free_copy_buffer(buf);
+		polar_reset_buffer_oldest_lsn(buf);
+		TerminateBufferIO(buf, true, 0);
+
+		LWLockRelease(BufferDescriptorGetContentLock(buf));
+		UnpinBuffer(buf, true);
+
+		ScheduleBufferTagForWriteback(wb_context, &tag);
+	}
+
+	polar_bulk_io_is_in_progress = false;
+
+	pg_atomic_fetch_add_u64(&polar_flush_ctl->write, 1);
+	pg_atomic_fetch_add_u64(&polar_flush_ctl->write_blocks, count);
+
+	/* Pop the error context stack */
+	error_context_stack = errcallback.previous;
+}
+
+/*
+ * Try to pin, lock and start io of the buffer to write it in a group, return
+ * false if it should be synced by SyncOneBuffer. *skip is set if it needn't
+ * be written at all.
+ */
+static bool
+polar_start_group_buffer(BufferDesc *buf, BufferTag *tag, XLogRecPtr oldest_apply_lsn,
+						 bool first_in_group, XLogRecPtr *flush_lsn, bool *skip)
+{
+	LWLock	   *content_lock = BufferDescriptorGetContentLock(buf);
+	uint32		buf_state;
+	XLogRecPtr	lsn;
+
+	*skip = false;
+
+	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+	ReservePrivateRefCountEntry();
+
+	/* It's clean, being flushed by others or replaced by another block */
+	buf_state = LockBufHdr(buf);
+	if (!BUFFERTAGS_EQUAL(buf->tag, *tag) ||
+		!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY) ||
+		(buf_state & BM_IO_IN_PROGRESS))
+	{
+		UnlockBufHdr(buf, buf_state);
+		*skip = true;
+		return false;
+	}
+
+	PinBuffer_Locked(buf);
+
+	/*
+	 * Do not wait for the content lock while holding others, and let
+	 * SyncOneBuffer deal with the buffers which need fullpage wal or copy
+	 * buffer, as FlushBuffer does.
+	 */
+	if (!LWLockConditionalAcquire(content_lock, LW_SHARED))
+	{
+		UnpinBuffer(buf, true);
+		return false;
+	}
+
+	lsn = BufferGetLSN(buf);
+	if (!polar_buffer_can_be_flushed(buf, oldest_apply_lsn, false) ||
+		(POLAR_LOGINDEX_ENABLE_FULLPAGE() &&
+		 !PageIsNew(BufHdrGetBlock(buf)) &&
+		 !XLogRecPtrIsInvalid(oldest_apply_lsn) &&
+		 lsn > oldest_apply_lsn &&
+		 buf->tag.forkNum == MAIN_FORKNUM))
+	{
+		LWLockRelease(content_lock);
+		UnpinBuffer(buf, true);
+		return false;
+	}
+
+	if (first_in_group)
+		polar_bulk_io_is_in_progress = true;
+
+	if (!StartBufferIO(buf, false))
+	{
+		if (first_in_group)
+			polar_bulk_io_is_in_progress = false;
+
+		LWLockRelease(content_lock);
+		UnpinBuffer(buf, true);
+		*skip = true;
+		return false;
+	}
+
+	/* To check if block content changes while flushing */
+	buf_state = LockBufHdr(buf);
+	lsn = BufferGetLSN(buf);
+	buf_state &= ~BM_JUST_DIRTIED;
+	UnlockBufHdr(buf, buf_state);
+
+	if ((buf_state & BM_PERMANENT) && lsn > *flush_lsn)
+		*flush_lsn = lsn;
+
+	return true;
+}
+
+/*
+ * polar_sync_coalesced_buffers - Sync a batch of buffers from flush list,
+ * and write the adjacent blocks with one write call.
+ *
+ * The batch is sorted by buffer tag, then runs of adjacent blocks within a
+ * segment are written together, at most polar_bgwriter_max_coalesce_size
+ * blocks once. Returns the number of buffers written.
+ */
+static int
+polar_sync_coalesced_buffers(int *batch_buf, int num,
+							 WritebackContext *wb_context, int flags)
+{
+	static polar_sync_item *items = NULL;
+	static int	items_size = 0;
+	BufferDesc *group[POLAR_MAX_BULK_IO_SIZE];
+	int			group_count = 0;
+	int			max_count = Min(polar_bgwriter_max_coalesce_size, POLAR_MAX_BULK_IO_SIZE);
+	XLogRecPtr	flush_lsn = InvalidXLogRecPtr;
+	XLogRecPtr	oldest_apply_lsn;
+	int			num_written = 0;
+	int			single_written = 0;
+	int			i;
+
+	if (items_size < num)
+	{
+		if (items)
+			pfree(items);
+
+		items = MemoryContextAlloc(TopMemoryContext, num * sizeof(polar_sync_item));
+		items_size = num;
+	}
+
+	if (polar_bulk_io_in_progress_buf == NULL)
+	{
+		Assert(polar_bulk_io_is_for_input == NULL);
+		polar_bulk_io_in_progress_buf = MemoryContextAlloc(TopMemoryContext,
+														   POLAR_MAX_BULK_IO_SIZE * sizeof(polar_bulk_io_in_progress_buf[0]));
+		polar_bulk_io_is_for_input = MemoryContextAlloc(TopMemoryContext,
+														POLAR_MAX_BULK_IO_SIZE * sizeof(polar_bulk_io_is_for_input[0]));
+	}
+
+	/* The tag is checked again with buffer header lock before writing */
+	for (i = 0; i < num; i++)
+	{
+		items[i].buf_id = batch_buf[i];
+		items[i].tag = GetBufferDescriptor(batch_buf[i])->tag;
+	}
+
+	sort_polar_sync_items(items, num);
+
+	oldest_apply_lsn = polar_get_oldest_apply_lsn();
+
+	for (i = 0; i < num; i++)
+	{
+		BufferDesc *buf = GetBufferDescriptor(items[i].buf_id);
+		BufferTag  *tag = &items[i].tag;
+		bool		skip;
+
+		/* Write the group if this block can't be appended to it */
+		if (group_count > 0)
+		{
+			BufferTag  *last = &group[group_count - 1]->tag;
+
+			if (group_count >= max_count ||
+				!RelFileNodeEquals(last->rnode, tag->rnode) ||
+				last->forkNum != tag->forkNum ||
+				last->blockNum + 1 != tag->blockNum ||
+				tag->blockNum % ((BlockNumber) RELSEG_SIZE) == 0)
+			{
+				polar_flush_buffer_group(group, group_count, flush_lsn, wb_context);
+				num_written += group_count;
+				group_count = 0;
+				flush_lsn = InvalidXLogRecPtr;
+			}
+		}
+
+		if (polar_start_group_buffer(buf, tag, oldest_apply_lsn, group_count == 0,
+									 &flush_lsn, &skip))
+		{
+			group[group_count++] = buf;
+			continue;
+		}
+
+		if (skip)
+			continue;
+
+		/* Release the locks of group before syncing this buffer alone */
+		if (group_count > 0)
+		{
+			polar_flush_buffer_group(group, group_count, flush_lsn, wb_context);
+			num_written += group_count;
+			group_count = 0;
+			flush_lsn = InvalidXLogRecPtr;
+		}
+
+		if (SyncOneBuffer(items[i].buf_id, false, wb_context, flags) & BUF_WRITTEN)
+		{
+			num_written++;
+			single_written++;
+		}
+	}
+
+	if (group_count > 0)
+	{
+		polar_flush_buffer_group(group, group_count, flush_lsn, wb_context);
+		num_written += group_count;
+	}
+
+	if (single_written > 0)
+	{
+		pg_atomic_fetch_add_u64(&polar_flush_ctl->write, single_written);
+		pg_atomic_fetch_add_u64(&polar_flush_ctl->write_blocks, single_written);
+	}
+
+	return num_written;
+}
+
 static XLogRecPtr
 update_consistent_lsn_delta(XLogRecPtr cur_consistent_lsn)
 {
@@ -692,6 +1036,7 @@ evaluate_sync_buffer_num(uint64 lag, int bgwriter_flush_batch_size)
 	uint64		max_lag;
 	double		cons_delta_per_worker;
 	int			current_workers = 0;
+	int			batch_size;
 
 	if (polar_parallel_bgwriter_enabled())
 		current_workers = CURRENT_PARALLEL_WORKERS;
@@ -699,11 +1044,13 @@ evaluate_sync_buffer_num(uint64 lag, int bgwriter_flush_batch_size)
 	cons_delta_per_worker = consistent_lsn_delta / (current_workers + 1);
 	sync_per_lsn = (double) prev_sync_count / (cons_delta_per_worker + 1);
 
+	batch_size = polar_get_parallel_bgwriter_batch_size();
+
 	/* Avoid overflow */
-	max_lag = polar_bgwriter_batch_size / (sync_per_lsn + 1);
+	max_lag = batch_size / (sync_per_lsn + 1);
 
 	if (lag > max_lag)
-		num_to_sync = polar_bgwriter_batch_size;
+		num_to_sync = batch_size;
 	else
 		num_to_sync = lag * sync_per_lsn;
 
@@ -727,13 +1074,26 @@ polar_adjust_parallel_bgwriters(uint64 consistent_lag, int lru_ahead_lap)
 	int			at_most_workers;
 	int			current_workers;
 
-	if (RecoveryInProgress() || consistent_lag <= 0 ||
-		!polar_parallel_bgwriter_enabled() ||
+	if (RecoveryInProgress() || !polar_parallel_bgwriter_enabled() ||
 		!polar_enable_dynamic_parallel_bgwriter)
 		return;
 
 	Assert(MyBackendType == B_BG_WRITER);
 
+	/* The feedback controller replaces the thresholds below if it's enabled */
+	if (polar_bgwriter_target_lag > 0)
+	{
+		polar_control_parallel_bgwriters(consistent_lag, lru_ahead_lap);
+		return;
+	}
+
+	/* Give back the batch size decided by controller */
+	if (pg_atomic_read_u32(&polar_parallel_bgwriter_info->batch_size) != 0)
+		pg_atomic_write_u32(&polar_parallel_bgwriter_info->batch_size, 0);
+
+	if (consistent_lag <= 0)
+		return;
+
 	/*
 	 * The consistent lsn does not be updated. It may be unhelpful to add or
 	 * stop parallel writers, so we do nothing.
@@ -819,6 +1179,150 @@ polar_adjust_parallel_bgwriters(uint64 consistent_lag, int lru_ahead_lap)
 	}
 }
 
+/*
+ * polar_control_parallel_bgwriters - Feedback control of parallel bgwriters.
+ *
+ * The error is the relative distance of consistent lag from
+ * polar_bgwriter_target_lag, or the relative shortage of buffers cleaned
+ * ahead of clock sweep if polar_bgwriter_target_clean_ratio is set, the
+ * larger one is used. The PID output is the extra flush capacity wanted in
+ * units of polar_parallel_flush_workers. Capacity is provided by the number
+ * of parallel workers first and the rest is provided by the batch size of
+ * each worker, because starting or stopping a worker is much more expensive
+ * than changing the batch size. Workers are still started or stopped one by
+ * one with the same delay as before to avoid oscillation.
+ */
+static void
+polar_control_parallel_bgwriters(uint64 consistent_lag, int lru_ahead_lap)
+{
+	static TimestampTz last_control_tz = 0;
+	static TimestampTz last_resize_tz = 0;
+	static double integral = 0;
+	static double last_error = 0;
+
+	TimestampTz now = GetCurrentTimestamp();
+	double		target_lag = (double) polar_bgwriter_target_lag * 1024 * 1024L;
+	double		dt = 0;
+	double		error;
+	double		derivative = 0;
+	double		integrated = 0;
+	double		output;
+	double		capacity;
+	double		min_capacity;
+	double		max_capacity;
+	double		clean_ratio = -1;
+	int			min_workers = polar_parallel_flush_workers;
+	int			max_workers = POLAR_MAX_BGWRITER_WORKERS;
+	int			current_workers = CURRENT_PARALLEL_WORKERS;
+	int			target_workers;
+	int			batch_size = 0;
+	long		delay;
+	polar_bgwriter_control_sample sample;
+
+	if (last_control_tz != 0)
+		dt = (double) (now - last_control_tz) / USECS_PER_SEC;
+	last_control_tz = now;
+
+	error = ((double) consistent_lag - target_lag) / target_lag;
+
+	if (polar_bgwriter_target_clean_ratio > 0 && polar_enable_flush_dispatcher &&
+		polar_lru_works_threshold > 0)
+	{
+		if (lru_ahead_lap == LRU_BUFFER_BEHIND)
+			clean_ratio = 0;
+		else
+			clean_ratio = Min((double) lru_ahead_lap / NBuffers, 1.0);
+
+		error = Max(error, (polar_bgwriter_target_clean_ratio - clean_ratio) /
+					polar_bgwriter_target_clean_ratio);
+	}
+
+	error = Min(error, POLAR_BGWRITER_CONTROL_MAX_ERROR);
+
+	/*
+	 * The consistent lsn does not move, more capacity does not help, so
+	 * don't let the integral grow.
+	 */
+	if (dt > 0)
+	{
+		derivative = (error - last_error) / dt;
+		if (error < 0 || consistent_lsn_delta != 0)
+			integrated = error * dt;
+		integral += integrated;
+	}
+	last_error = error;
+
+	output = polar_bgwriter_control_kp * error +
+		polar_bgwriter_control_ki * integral +
+		polar_bgwriter_control_kd * derivative;
+
+	min_capacity = min_workers * POLAR_BGWRITER_CONTROL_MIN_SCALE;
+	max_capacity = max_workers * POLAR_BGWRITER_CONTROL_MAX_SCALE;
+	capacity = min_workers * (1 + output);
+
+	/*
+	 * Anti-windup: stop integrating once the capacity is saturated, undo only
+	 * what was integrated by this step.
+	 */
+	if (capacity < min_capacity || capacity > max_capacity)
+	{
+		if ((capacity > max_capacity) == (error > 0))
+			integral -= integrated;
+		capacity = Max(min_capacity, Min(capacity, max_capacity));
+	}
+
+	target_workers = (int) capacity;
+	target_workers = Max(min_workers, Min(target_workers, max_workers));
+
+	if (polar_bgwriter_batch_size > 0)
+	{
+		double		scale = capacity / target_workers;
+
+		scale = Max(POLAR_BGWRITER_CONTROL_MIN_SCALE,
+					Min(scale, POLAR_BGWRITER_CONTROL_MAX_SCALE));
+		batch_size = Max((int) (polar_bgwriter_batch_size * scale), 1);
+	}
+
+	/* Start or stop at most one parallel background writer each time */
+	if (target_workers > current_workers && consistent_lsn_delta != 0)
+		delay = polar_parallel_new_bgwriter_threshold_time * 1000L;
+	else if (target_workers < current_workers)
+		delay = polar_parallel_new_bgwriter_threshold_time * 1000L *
+			STOP_PARALLEL_BGWRITER_DELAY_FACTOR;
+	else
+		delay = -1;
+
+	if (delay < 0)
+		last_resize_tz = 0;
+	else if (last_resize_tz == 0)
+		last_resize_tz = now;
+	else if (TimestampDifferenceExceeds(last_resize_tz, now, delay))
+	{
+		if (target_workers < current_workers)
+			polar_shutdown_parallel_bgwriter_workers(1);
+		else if (polar_new_parallel_bgwriter_useful())
+			polar_register_parallel_bgwriter_workers(1);
+		last_resize_tz = 0;
+	}
+
+	sample.time = now;
+	sample.consistent_lag = consistent_lag;
+	sample.clean_ratio = clean_ratio;
+	sample.error = error;
+	sample.integral = integral;
+	sample.derivative = derivative;
+	sample.output = output;
+	sample.workers = target_workers;
+	sample.batch_size = batch_size;
+	polar_add_parallel_bgwriter_control_sample(&sample);
+
+	if (polar_enable_debug)
+		elog(LOG,
+			 "Parallel bgwriter controller: lag " UINT64_FORMAT ", clean ratio %.3f, error %.3f, output %.3f, workers %d/%d, batch size %d",
+			 consistent_lag, clean_ratio, error, output, current_workers,
+			 target_workers, batch_size);
+}
+
 /*
  * polar_redo_set_buffer_oldest_lsn - Set the buffer oldest lsn when redo.
  *
@@ -1162,6 +1666,65 @@ polar_bulk_read_buffer_extended(Relation reln, ForkNumber forkNum, BlockNumber b
 	return buf;
 }
 
+/*
+ * polar_bulk_read_prefetch -- keep prefetching blocks ahead of bulk read.
+ *
+ * Called by sequential heap scan after it bulk reads blockNum with at most
+ * maxBlockCount blocks, and nblocks is where the scan stops. The bulk read
+ * itself is synchronous, so the scan used to stall whenever it reached a
+ * block which is not in shared buffers. Here we keep a window of
+ * polar_bulk_read_prefetch_distance blocks ahead of the scan position, and
+ * the prefetch workers bulk read them into shared buffers while the scan
+ * processes tuples. Every block is queued once as the window slides forward,
+ * by ranges of polar_bulk_read_size blocks. The window starts again when the
+ * scan moves to another relation or goes backward.
+ *
+ * Only permanent relations are prefetched, the workers can't read local
+ * buffers and they read blocks as permanent ones.
+ */
+void
+polar_bulk_read_prefetch(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
+						 BlockNumber maxBlockCount, BlockNumber nblocks)
+{
+	polar_bulk_read_window_t *window = &polar_bulk_read_window;
+	BlockNumber end;
+	BlockNumber count;
+
+	if (polar_bulk_read_prefetch_distance <= 0 || !polar_prefetch_enabled() ||
+		reln->rd_rel->relpersistence != RELPERSISTENCE_PERMANENT)
+		return;
+
+	if (!RelFileNodeEquals(window->rnode, reln->rd_node) ||
+		window->forknum != forkNum ||
+		blockNum < window->blockno ||
+		blockNum > window->next)
+	{
+		window->rnode = reln->rd_node;
+		window->forknum = forkNum;
+		window->next = blockNum;
+	}
+
+	window->blockno = blockNum;
+
+	/* The blocks read by this bulk read need no prefetch */
+	window->next = Max(window->next,
+					   blockNum + Min(maxBlockCount, Max(polar_bulk_read_size, 1)));
+
+	end = Min(nblocks, blockNum + polar_bulk_read_prefetch_distance);
+
+	while (window->next < end)
+	{
+		count = Min(end - window->next, Max(polar_bulk_read_size, 1));
+
+		/* The queue is full, try again when the scan moves forward */
+		if (!polar_prefetch_buffers(reln, reln->rd_node, forkNum, window->next, count))
+			break;
+
+		polar_pgstat_count_bulk_read_blocks_prefetch(reln, count);
+		window->next += count;
+	}
+}
+
 /*
  * polar_bulk_read_buffer_common -- common logic for bulk read multi buffer one time.
  *
@@ -1433,6 +1996,8 @@ repeat_read:
 
 		polar_pgstat_count_bulk_read_calls_IO(reln);
 		polar_pgstat_count_bulk_read_blocks_IO(reln, actual_bulk_io_count);
+		pgBufferUsage.polar_bulk_read_calls_IO++;
+		pgBufferUsage.polar_bulk_read_blocks_IO += actual_bulk_io_count;
 
 		if (track_io_timing)
 		{
@@ -29,6 +29,7 @@
 #include "storage/polar_copybuf.h"
 #include "storage/polar_bufmgr.h"
 #include "storage/polar_fd.h"
+#include "storage/proc.h"
 #include "utils/guc.h"
 #include "utils/timestamp.h"
 
@@ -36,8 +37,10 @@ CopyBufferControl *polar_copy_buffer_ctl;
 CopyBufferDescPadded *polar_copy_buffer_descriptors;
 char	   *polar_copy_buffer_blocks;
 
-static void init_copy_buffer_ctl(bool init);
+static void init_copy_buffer_ctl(bool init, int partition_num);
 static bool copy_buffer_alloc(BufferDesc *buf, XLogRecPtr oldest_apply_lsn);
+static CopyBufferDesc *copy_buffer_pop(CopyBufferPartition *part);
+static void copy_buffer_push(CopyBufferPartition *part, CopyBufferDesc *cbuf);
 
 #define start_copy_buffer_io(buf, for_input)	\
 	(polar_start_buffer_io_extend(buf, for_input, true))
@@ -77,6 +80,8 @@ polar_init_copy_buffer_pool(void)
 	else
 	{
 		int			i;
+		int			partition_num = Min(polar_copy_buffers,
+										POLAR_COPY_BUFFER_MAX_PARTITIONS);
 
 		/*
 		 * Initialize all the copy buffer headers.
@@ -94,23 +99,25 @@ polar_init_copy_buffer_pool(void)
 			cbuf->state = POLAR_COPY_BUFFER_UNUSED;
 
 			/*
-			 * Initially link all the buffers together as unused
+			 * Initially link all the buffers of the same partition together
+			 * as unused
 			 */
-			cbuf->free_next = i + 1;
+			if (i + partition_num < polar_copy_buffers)
+				cbuf->free_next = i + partition_num;
+			else
+				cbuf->free_next = FREENEXT_END_OF_LIST;
 		}
 
-		/* Correct last entry of linked list */
-		polar_get_copy_buffer_descriptor(polar_copy_buffers - 1)->free_next = FREENEXT_END_OF_LIST;
-
 		/* Initialize control structure */
-		init_copy_buffer_ctl(!found_copy_descs);
+		init_copy_buffer_ctl(!found_copy_descs, partition_num);
 	}
 }
 
 static void
-init_copy_buffer_ctl(bool init)
+init_copy_buffer_ctl(bool init, int partition_num)
 {
 	bool		found;
+	int			i;
 
 	polar_copy_buffer_ctl = (CopyBufferControl *)
 		ShmemInitStruct("Copy Buffer Status",
@@ -121,10 +128,25 @@ init_copy_buffer_ctl(bool init)
 		/* Only done once, usually in postmaster */
 		Assert(init);
 
-		SpinLockInit(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
+		polar_copy_buffer_ctl->partition_num = partition_num;
 
-		polar_copy_buffer_ctl->first_free_buffer = 0;
-		polar_copy_buffer_ctl->last_free_buffer = polar_copy_buffers - 1;
+		for (i = 0; i < POLAR_COPY_BUFFER_MAX_PARTITIONS; i++)
+		{
+			CopyBufferPartition *part = &polar_copy_buffer_ctl->partition[i].part;
+			int			size = 0;
+
+			/* Buffer i is the first one of partition i */
+			if (i < partition_num)
+				size = (polar_copy_buffers - i + partition_num - 1) / partition_num;
+
+			pg_atomic_init_u64(&part->free_head,
+							   polar_copy_buffer_free_head(size > 0 ? i : FREENEXT_END_OF_LIST, 0));
+			pg_atomic_init_u32(&part->free_count, size);
+			part->size = size;
+			pg_atomic_init_u64(&part->alloc_count, 0);
+			pg_atomic_init_u64(&part->remote_count, 0);
+			pg_atomic_init_u64(&part->empty_count, 0);
+		}
 
 		pg_atomic_init_u64(&polar_copy_buffer_ctl->flushed_count, 0);
 		pg_atomic_init_u64(&polar_copy_buffer_ctl->release_count, 0);
@@ -258,6 +280,8 @@ copy_buffer_alloc(BufferDesc *buf, XLogRecPtr oldest_apply_lsn)
 	CopyBufferDesc *cbuf;
 	uint32		buf_state;
 	XLogRecPtr	consistent_lsn;
+	int			home;
+	int			i;
 
 	/* Before copy, lock the buffer using io_in_progress lock like FlushBuffer */
 	if (!start_copy_buffer_io(buf, true))
@@ -285,14 +309,36 @@ copy_buffer_alloc(BufferDesc *buf, XLogRecPtr oldest_apply_lsn)
 			 LSN_FORMAT_ARGS(consistent_lsn));
 	}
 
-	/* Acquire the spinlock to remove element from the freelist */
-	SpinLockAcquire(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
+	/*
+	 * Allocate from the home partition of this backend first, then try the
+	 * other partitions one by one.
+	 */
+	home = MyProc != NULL ?
+		MyProc->pgprocno % polar_copy_buffer_ctl->partition_num : 0;
+	cbuf = NULL;
+
+	for (i = 0; i < polar_copy_buffer_ctl->partition_num; i++)
+	{
+		int			part_id = (home + i) % polar_copy_buffer_ctl->partition_num;
+		CopyBufferPartition *part = &polar_copy_buffer_ctl->partition[part_id].part;
+
+		cbuf = copy_buffer_pop(part);
+
+		if (cbuf != NULL)
+		{
+			pg_atomic_fetch_add_u64(&part->alloc_count, 1);
+			if (part_id != home)
+				pg_atomic_fetch_add_u64(&part->remote_count, 1);
+			break;
+		}
+
+		pg_atomic_fetch_add_u64(&part->empty_count, 1);
+	}
 
-	if (polar_copy_buffer_ctl->first_free_buffer < 0)
+	if (cbuf == NULL)
 	{
 		static TimestampTz last_log_time = 0;
 
-		SpinLockRelease(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
 		TerminateBufferIO(buf, false, 0);
 		pg_atomic_fetch_add_u64(&polar_copy_buffer_ctl->full_count, 1);
 
@@ -307,20 +353,6 @@ copy_buffer_alloc(BufferDesc *buf, XLogRecPtr oldest_apply_lsn)
 		return false;
 	}
 
-	cbuf = polar_get_copy_buffer_descriptor(polar_copy_buffer_ctl->first_free_buffer);
-
-	Assert(cbuf->free_next != FREENEXT_NOT_IN_LIST);
-
-	/* Unconditionally remove buffer from freelist */
-	polar_copy_buffer_ctl->first_free_buffer = cbuf->free_next;
-	cbuf->free_next = FREENEXT_NOT_IN_LIST;
-
-	/*
-	 * Release the lock so someone else can access the freelist while we check
-	 * out this buffer.
-	 */
-	SpinLockRelease(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
-
 	Assert(cbuf->state == POLAR_COPY_BUFFER_UNUSED);
 	Assert(!XLogRecPtrIsInvalid(buf->oldest_lsn));
 
@@ -386,16 +418,74 @@ polar_free_copy_buffer(BufferDesc *buf)
 	cbuf->state = POLAR_COPY_BUFFER_UNUSED;
 	cbuf->is_flushed = false;
 
-	/* Then put into the freelist */
-	SpinLockAcquire(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
+	/* Then put into the freelist of its partition */
+	copy_buffer_push(polar_copy_buffer_partition(cbuf), cbuf);
+}
+
+/*
+ * Remove the first copy buffer from the freelist of the partition, return
+ * NULL if the freelist is empty.
+ *
+ * The head is changed by compare and exchange, its counter makes sure that
+ * the free_next we read is still valid when the exchange succeeds.
+ */
+static CopyBufferDesc *
+copy_buffer_pop(CopyBufferPartition *part)
+{
+	uint64		head;
+	uint64		new_head;
+	CopyBufferDesc *cbuf;
+
+	head = pg_atomic_read_u64(&part->free_head);
+
+	for (;;)
+	{
+		int			id = polar_copy_buffer_free_head_id(head);
+
+		if (id < 0)
+			return NULL;
+
+		/* Read free_next after the head which points to it */
+		pg_read_barrier();
+
+		cbuf = polar_get_copy_buffer_descriptor(id);
+		new_head = polar_copy_buffer_free_head(((volatile CopyBufferDesc *) cbuf)->free_next,
+											   polar_copy_buffer_free_head_counter(head) + 1);
+
+		if (pg_atomic_compare_exchange_u64(&part->free_head, &head, new_head))
+			break;
+	}
+
+	Assert(cbuf->free_next != FREENEXT_NOT_IN_LIST);
+	cbuf->free_next = FREENEXT_NOT_IN_LIST;
+	pg_atomic_fetch_sub_u32(&part->free_count, 1);
+
+	return cbuf;
+}
+
+/* Put the copy buffer at the head of the freelist of the partition. */
+static void
+copy_buffer_push(CopyBufferPartition *part, CopyBufferDesc *cbuf)
+{
+	uint64		head;
+	uint64		new_head;
 
 	Assert(cbuf->free_next == FREENEXT_NOT_IN_LIST);
 
-	cbuf->free_next = polar_copy_buffer_ctl->first_free_buffer;
-	if (cbuf->free_next < 0)
-		polar_copy_buffer_ctl->last_free_buffer = cbuf->buf_id;
-	polar_copy_buffer_ctl->first_free_buffer = cbuf->buf_id;
-	SpinLockRelease(&polar_copy_buffer_ctl->copy_buffer_ctl_lock);
+	/*
+	 * Count it before it's visible in the freelist, so the counter never
+	 * drops below zero when someone pops it at once.
+	 */
+	pg_atomic_fetch_add_u32(&part->free_count, 1);
+
+	head = pg_atomic_read_u64(&part->free_head);
+
+	do
+	{
+		cbuf->free_next = polar_copy_buffer_free_head_id(head);
+		new_head = polar_copy_buffer_free_head(cbuf->buf_id,
+											   polar_copy_buffer_free_head_counter(head) + 1);
+	} while (!pg_atomic_compare_exchange_u64(&part->free_head, &head, new_head));
 }
 
 /* Like FlushBuffer, flush a copy buffer. */
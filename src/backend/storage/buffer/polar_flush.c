@@ -45,13 +45,12 @@
     (buf->flush_prev == POLAR_FLUSHNEXT_NOT_IN_LIST && \
 	 buf->flush_next == POLAR_FLUSHNEXT_NOT_IN_LIST)
 
-#define current_pos_is_unavailable() \
-	(polar_flush_ctl->current_pos == POLAR_FLUSHNEXT_NOT_IN_LIST)
-
 FlushControl *polar_flush_ctl = NULL;
 
-static void remove_one_buffer(BufferDesc *buf);
-static void append_one_buffer(BufferDesc *buf);
+static void insert_buffer(BufferDesc *buf, XLogRecPtr lsn);
+static FlushListPartition *lock_buffer_partition(BufferDesc *buf);
+static void remove_one_buffer(FlushListPartition *part, BufferDesc *buf);
+static void insert_one_buffer(FlushListPartition *part, BufferDesc *buf);
 
 /*
  * polar_flush_list_ctl_shmem_size
@@ -91,19 +90,33 @@ polar_init_flush_list_ctl(bool init)
 
 	if (!found)
 	{
+		int			i;
+
 		/* Only done once, usually in postmaster */
 		Assert(init);
 
 		pg_atomic_init_u32(&polar_flush_ctl->count, 0);
 
-		SpinLockInit(&polar_flush_ctl->flushlist_lock);
-		SpinLockInit(&polar_flush_ctl->lru_lock);
-		LWLockInitialize(&polar_flush_ctl->cbuflock, LWTRANCHE_POLAR_COPY_BUFFER);
+		for (i = 0; i < POLAR_FLUSH_LIST_BUCKETS * POLAR_FLUSH_LIST_PARTITIONS; i++)
+		{
+			FlushListPartition *part = &polar_flush_ctl->partition[i].part;
 
-		polar_flush_ctl->first_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
-		polar_flush_ctl->last_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
-		polar_flush_ctl->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
+			SpinLockInit(&part->flushlist_lock);
+			part->first_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+			part->last_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+			part->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
+		}
+
+		pg_atomic_init_u64(&polar_flush_ctl->start_lsn, InvalidXLogRecPtr);
+
+		LWLockInitialize(&polar_flush_ctl->batchlock, LWTRANCHE_POLAR_FLUSH_LIST_BATCH);
 		polar_flush_ctl->latest_flush_count = 0;
+		polar_flush_ctl->batch_bucket = 0;
+		polar_flush_ctl->batch_partition = 0;
+		polar_flush_ctl->batch_walked = 0;
+
+		SpinLockInit(&polar_flush_ctl->lru_lock);
+		LWLockInitialize(&polar_flush_ctl->cbuflock, LWTRANCHE_POLAR_COPY_BUFFER);
 
 		polar_flush_ctl->lru_buffer_id = 0;
 		polar_flush_ctl->lru_complete_passes = 0;
@@ -119,70 +132,193 @@ polar_init_flush_list_ctl(bool init)
 		pg_atomic_init_u64(&polar_flush_ctl->backend_flush, 0);
 		pg_atomic_init_u64(&polar_flush_ctl->vm_insert, 0);
 		pg_atomic_init_u64(&polar_flush_ctl->vm_remove, 0);
+		pg_atomic_init_u64(&polar_flush_ctl->write, 0);
+		pg_atomic_init_u64(&polar_flush_ctl->write_blocks, 0);
 	}
 	else
 		Assert(!init);
 }
 
+/*
+ * Restart walking the ring from the bucket of start lsn, caller should
+ * already acquired the batch lock.
+ */
+static void
+revert_batch_position(void)
+{
+	FlushListPartition *part = polar_flush_list_partition_by_no(polar_flush_ctl->batch_bucket,
+																polar_flush_ctl->batch_partition);
+	XLogRecPtr	start_lsn = pg_atomic_read_u64(&polar_flush_ctl->start_lsn);
+
+	SpinLockAcquire(&part->flushlist_lock);
+	part->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
+	SpinLockRelease(&part->flushlist_lock);
+
+	polar_flush_ctl->batch_bucket = polar_flush_list_bucket_no(start_lsn);
+	polar_flush_ctl->batch_partition = 0;
+	polar_flush_ctl->batch_walked = 0;
+	polar_flush_ctl->latest_flush_count = 0;
+}
+
 /*
  * polar_get_batch_flush_buffer
  *
  * Get a batch of buffers from flush list and do not remove it, FlushBuffer will
- * remove them from flush list.
+ * remove them from flush list. Buckets are walked from the one of start lsn,
+ * so the oldest buffers are flushed first. The partitions of a bucket are
+ * walked one by one, so a batch is ordered by oldest lsn only up to the lsn
+ * range of bucket.
  */
 int
 polar_get_batch_buffer(int *batch_buf, int bgwriter_flush_batch_size)
 {
 	int			num = 0;
-	int			buffer_id;
-	int			flush_count;
 
 	Assert(polar_flush_list_enabled());
 
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
-	if (polar_flush_list_is_empty())
+	LWLockAcquire(&polar_flush_ctl->batchlock, LW_EXCLUSIVE);
+
+	while (num < bgwriter_flush_batch_size &&
+		   polar_flush_ctl->batch_walked < POLAR_FLUSH_LIST_BUCKETS)
 	{
-		SpinLockRelease(&polar_flush_ctl->flushlist_lock);
-		return num;
+		FlushListPartition *part = polar_flush_list_partition_by_no(polar_flush_ctl->batch_bucket,
+																	polar_flush_ctl->batch_partition);
+		int			buffer_id;
+
+		/* Empty partition is never walked, skip it without lock */
+		if (part->first_flush_buffer == POLAR_FLUSHNEXT_END_OF_LIST &&
+			part->current_pos == POLAR_FLUSHNEXT_NOT_IN_LIST)
+			buffer_id = POLAR_FLUSHNEXT_END_OF_LIST;
+		else
+		{
+			SpinLockAcquire(&part->flushlist_lock);
+
+			buffer_id = part->current_pos;
+			if (buffer_id == POLAR_FLUSHNEXT_NOT_IN_LIST)
+				buffer_id = part->first_flush_buffer;
+
+			while (num < bgwriter_flush_batch_size &&
+				   buffer_id != POLAR_FLUSHNEXT_END_OF_LIST)
+			{
+				Assert(buffer_id != POLAR_FLUSHNEXT_NOT_IN_LIST);
+				batch_buf[num++] = buffer_id;
+				buffer_id = GetBufferDescriptor(buffer_id)->flush_next;
+			}
+
+			if (buffer_id == POLAR_FLUSHNEXT_END_OF_LIST)
+				part->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
+			else
+				part->current_pos = buffer_id;
+
+			SpinLockRelease(&part->flushlist_lock);
+		}
+
+		/* The partition is done, move to the next one */
+		if (buffer_id == POLAR_FLUSHNEXT_END_OF_LIST &&
+			++polar_flush_ctl->batch_partition == POLAR_FLUSH_LIST_PARTITIONS)
+		{
+			polar_flush_ctl->batch_partition = 0;
+			polar_flush_ctl->batch_bucket =
+				(polar_flush_ctl->batch_bucket + 1) % POLAR_FLUSH_LIST_BUCKETS;
+			polar_flush_ctl->batch_walked++;
+		}
 	}
 
-	flush_count = polar_flush_ctl->latest_flush_count;
-	if (current_pos_is_unavailable())
-		polar_flush_ctl->current_pos =
-			polar_flush_ctl->first_flush_buffer;
+	/*
+	 * If the whole ring is walked or latest flush count greater than
+	 * polar_bgwriter_max_batch_size, revert it to the bucket of start lsn.
+	 */
+	if (polar_flush_ctl->batch_walked >= POLAR_FLUSH_LIST_BUCKETS ||
+		(polar_flush_ctl->latest_flush_count + num) > polar_bgwriter_batch_size)
+		revert_batch_position();
+	else
+		polar_flush_ctl->latest_flush_count += num;
 
-	buffer_id = polar_flush_ctl->current_pos;
-	for (num = 0; num < bgwriter_flush_batch_size; num++)
-	{
-		Assert(buffer_id != POLAR_FLUSHNEXT_NOT_IN_LIST);
+	LWLockRelease(&polar_flush_ctl->batchlock);
 
-		if (buffer_id == POLAR_FLUSHNEXT_END_OF_LIST)
-			break;
+	if (num > 0)
+		pg_atomic_fetch_add_u64(&polar_flush_ctl->batch_read, 1);
 
-		batch_buf[num] = buffer_id;
-		buffer_id = GetBufferDescriptor(buffer_id)->flush_next;
-	}
+	return num;
+}
 
-	/*
-	 * If latest flush count greater than polar_bgwriter_max_batch_size,
-	 * revert it to first buffer.
-	 */
-	if (buffer_id == POLAR_FLUSHNEXT_END_OF_LIST ||
-		(flush_count + num) > polar_bgwriter_batch_size)
+/*
+ * polar_get_flush_list_oldest_lsn
+ *
+ * Return the smallest oldest lsn of buffers in flush list, or
+ * InvalidXLogRecPtr if there's no buffer whose oldest lsn is smaller than
+ * limit_lsn.
+ *
+ * Buckets are walked from the one of start lsn until a partition head within
+ * the lsn range of bucket is found, so it usually checks few buckets. Caller
+ * should make sure that the buffers put into flush list later have oldest
+ * lsn not smaller than limit_lsn, then start lsn is moved forward to skip
+ * the empty buckets next time.
+ */
+XLogRecPtr
+polar_get_flush_list_oldest_lsn(XLogRecPtr limit_lsn)
+{
+	XLogRecPtr	start_lsn;
+	XLogRecPtr	bucket_lsn;
+	XLogRecPtr	oldest_lsn = InvalidXLogRecPtr;
+	XLogRecPtr	new_start_lsn;
+	int			i;
+
+	Assert(polar_flush_list_enabled());
+
+	start_lsn = pg_atomic_read_u64(&polar_flush_ctl->start_lsn);
+	bucket_lsn = polar_flush_list_bucket_start(start_lsn);
+
+	for (i = 0; i < POLAR_FLUSH_LIST_BUCKETS && bucket_lsn <= limit_lsn;
+		 i++, bucket_lsn += POLAR_FLUSH_LIST_BUCKET_SIZE)
 	{
-		polar_flush_ctl->current_pos = polar_flush_ctl->first_flush_buffer;
-		polar_flush_ctl->latest_flush_count = 0;
+		bool		found = false;
+		int			j;
+
+		for (j = 0; j < POLAR_FLUSH_LIST_PARTITIONS; j++)
+		{
+			FlushListPartition *part = polar_flush_list_partition_by_no(polar_flush_list_bucket_no(bucket_lsn), j);
+			XLogRecPtr	lsn;
+
+			SpinLockAcquire(&part->flushlist_lock);
+
+			if (polar_flush_list_is_empty(part))
+			{
+				SpinLockRelease(&part->flushlist_lock);
+				continue;
+			}
+
+			Assert(part->first_flush_buffer >= 0);
+			lsn = polar_buffer_get_oldest_lsn(GetBufferDescriptor(part->first_flush_buffer));
+
+			SpinLockRelease(&part->flushlist_lock);
+
+			if (XLogRecPtrIsInvalid(oldest_lsn) || lsn < oldest_lsn)
+				oldest_lsn = lsn;
+
+			if (lsn < bucket_lsn + POLAR_FLUSH_LIST_BUCKET_SIZE)
+				found = true;
+		}
+
+		/*
+		 * A head is in this lap, and buffers in the former buckets are all
+		 * from later laps, so the smallest head of this bucket is the oldest
+		 * one.
+		 */
+		if (found)
+			break;
 	}
+
+	/* Move start lsn forward, if it's lowered by others, leave it */
+	if (XLogRecPtrIsInvalid(oldest_lsn))
+		new_start_lsn = limit_lsn;
 	else
-	{
-		polar_flush_ctl->current_pos = buffer_id;
-		polar_flush_ctl->latest_flush_count += num;
-	}
+		new_start_lsn = Min(oldest_lsn, limit_lsn);
 
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
-	pg_atomic_fetch_add_u64(&polar_flush_ctl->batch_read, 1);
+	if (new_start_lsn > start_lsn)
+		pg_atomic_compare_exchange_u64(&polar_flush_ctl->start_lsn, &start_lsn, new_start_lsn);
 
-	return num;
+	return oldest_lsn;
 }
 
 /*
@@ -193,13 +329,15 @@ polar_get_batch_buffer(int *batch_buf, int bgwriter_flush_batch_size)
 void
 polar_remove_buffer_from_flush_list(BufferDesc *buf)
 {
+	FlushListPartition *part;
+
 	if (!polar_flush_list_enabled())
 		return;
 
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
+	part = lock_buffer_partition(buf);
 	polar_buffer_set_oldest_lsn(buf, InvalidXLogRecPtr);
-	remove_one_buffer(buf);
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+	remove_one_buffer(part, buf);
+	SpinLockRelease(&part->flushlist_lock);
 
 	pg_atomic_fetch_sub_u32(&polar_flush_ctl->count, 1);
 	pg_atomic_fetch_add_u64(&polar_flush_ctl->remove, 1);
@@ -219,19 +357,10 @@ void
 polar_put_buffer_to_flush_list(BufferDesc *buf,
 							   XLogRecPtr lsn)
 {
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
-
 	/* The buffer must be not in flush list */
 	Assert(buffer_not_in_flush_list(buf));
 
-	/* Allocate the current insert lsn as a fake oldest lsn */
-	if (XLogRecPtrIsInvalid(lsn))
-		polar_buffer_set_fake_oldest_lsn(buf);
-	else
-		polar_buffer_set_oldest_lsn(buf, lsn);
-
-	append_one_buffer(buf);
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+	insert_buffer(buf, lsn);
 
 	/* Outside the spin lock to update statistic info. */
 	pg_atomic_fetch_add_u32(&polar_flush_ctl->count, 1);
@@ -250,35 +379,97 @@ polar_put_buffer_to_flush_list(BufferDesc *buf,
 void
 polar_adjust_position_in_flush_list(BufferDesc *buf)
 {
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
+	FlushListPartition *part;
 
 	/* Buffer must be in flush list */
 	Assert(!buffer_not_in_flush_list(buf));
-	polar_buffer_set_fake_oldest_lsn(buf);
 
 	/*
-	 * If it is the last one, its oldest lsn is the greatest, so do not need
-	 * to adjust its position.
+	 * Remove it from the partition of old oldest lsn and insert it into the
+	 * partition of new fake one. Its content is kept by copy buffer, so flush
+	 * list needn't hold it in the meantime.
 	 */
-	if (buf->flush_next != POLAR_FLUSHNEXT_END_OF_LIST)
+	part = lock_buffer_partition(buf);
+	remove_one_buffer(part, buf);
+	SpinLockRelease(&part->flushlist_lock);
+
+	insert_buffer(buf, InvalidXLogRecPtr);
+
+	pg_atomic_fetch_add_u64(&polar_flush_ctl->cbuf, 1);
+}
+
+/*
+ * Insert buffer into the partition of its oldest lsn. If lsn is invalid, the
+ * current insert lsn is allocated as a fake oldest lsn with partition lock,
+ * so who has checked the partition before will not miss a smaller lsn.
+ */
+static void
+insert_buffer(BufferDesc *buf, XLogRecPtr lsn)
+{
+	FlushListPartition *part;
+	XLogRecPtr	start_lsn;
+
+	for (;;)
 	{
-		Assert(buf->flush_next != POLAR_FLUSHNEXT_NOT_IN_LIST);
+		XLogRecPtr	oldest_lsn = XLogRecPtrIsInvalid(lsn) ? polar_fake_oldest_lsn() : lsn;
+
+		part = polar_flush_list_partition(oldest_lsn, buf->buf_id);
 
-		/* Not the tail, remove and append it into flush list */
-		remove_one_buffer(buf);
-		append_one_buffer(buf);
+		SpinLockAcquire(&part->flushlist_lock);
+
+		if (XLogRecPtrIsInvalid(lsn))
+		{
+			oldest_lsn = polar_fake_oldest_lsn();
+
+			/* Insert lsn moves to the next bucket, retry it */
+			if (unlikely(polar_flush_list_partition(oldest_lsn, buf->buf_id) != part))
+			{
+				SpinLockRelease(&part->flushlist_lock);
+				continue;
+			}
+		}
+
+		polar_buffer_set_oldest_lsn(buf, oldest_lsn);
+		insert_one_buffer(part, buf);
+
+		/* Walking the ring must start from this buffer if it's smaller */
+		start_lsn = pg_atomic_read_u64(&polar_flush_ctl->start_lsn);
+		while (oldest_lsn < start_lsn &&
+			   !pg_atomic_compare_exchange_u64(&polar_flush_ctl->start_lsn, &start_lsn, oldest_lsn))
+			;
+
+		SpinLockRelease(&part->flushlist_lock);
+		break;
 	}
+}
 
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
-	pg_atomic_fetch_add_u64(&polar_flush_ctl->cbuf, 1);
+/*
+ * Lock the partition which buffer belongs to. Oldest lsn is changed with
+ * buffer content lock, so it's stable here, we check it again after locking
+ * for safety.
+ */
+static FlushListPartition *
+lock_buffer_partition(BufferDesc *buf)
+{
+	for (;;)
+	{
+		FlushListPartition *part = polar_flush_list_partition(polar_buffer_get_oldest_lsn(buf), buf->buf_id);
+
+		SpinLockAcquire(&part->flushlist_lock);
+
+		if (likely(polar_flush_list_partition(polar_buffer_get_oldest_lsn(buf), buf->buf_id) == part))
+			return part;
+
+		SpinLockRelease(&part->flushlist_lock);
+	}
 }
 
 /*
- * Remove one buffer from flush list, caller should already acquired the
- * flush list lock.
+ * Remove one buffer from flush list partition, caller should already
+ * acquired the partition lock.
  */
 static void
-remove_one_buffer(BufferDesc *buf)
+remove_one_buffer(FlushListPartition *part, BufferDesc *buf)
 {
 	int			prev_flush_id;
 	int			next_flush_id;
@@ -289,7 +480,7 @@ remove_one_buffer(BufferDesc *buf)
 	Assert(!buffer_not_in_flush_list(buf));
 
 	/* Flushlist must be not empty */
-	Assert(!polar_flush_list_is_empty());
+	Assert(!polar_flush_list_is_empty(part));
 
 	prev_flush_id = buf->flush_prev;
 	next_flush_id = buf->flush_next;
@@ -301,8 +492,8 @@ remove_one_buffer(BufferDesc *buf)
 		next_flush_id == POLAR_FLUSHNEXT_END_OF_LIST)
 	{
 		/* Only this buffer in flush list */
-		polar_flush_ctl->first_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
-		polar_flush_ctl->last_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+		part->first_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+		part->last_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
 	}
 	else if (prev_flush_id == POLAR_FLUSHNEXT_END_OF_LIST &&
 			 next_flush_id != POLAR_FLUSHNEXT_END_OF_LIST)
@@ -310,7 +501,7 @@ remove_one_buffer(BufferDesc *buf)
 		/* First one, and has next buffer */
 		next_buf = GetBufferDescriptor(next_flush_id);
 		next_buf->flush_prev = prev_flush_id;
-		polar_flush_ctl->first_flush_buffer = next_flush_id;
+		part->first_flush_buffer = next_flush_id;
 	}
 	else if (prev_flush_id != POLAR_FLUSHNEXT_END_OF_LIST &&
 			 next_flush_id == POLAR_FLUSHNEXT_END_OF_LIST)
@@ -318,7 +509,7 @@ remove_one_buffer(BufferDesc *buf)
 		/* Last one, and has prev buffer */
 		prev_buf = GetBufferDescriptor(prev_flush_id);
 		prev_buf->flush_next = next_flush_id;
-		polar_flush_ctl->last_flush_buffer = prev_flush_id;
+		part->last_flush_buffer = prev_flush_id;
 	}
 	else
 	{
@@ -329,13 +520,15 @@ remove_one_buffer(BufferDesc *buf)
 		next_buf->flush_prev = prev_flush_id;
 	}
 
-	if (buf->buf_id == polar_flush_ctl->current_pos)
-	{
-		if (next_flush_id == POLAR_FLUSHNEXT_END_OF_LIST)
-			polar_flush_ctl->current_pos = polar_flush_ctl->first_flush_buffer;
-		else
-			polar_flush_ctl->current_pos = next_flush_id;
-	}
+	/*
+	 * Parallel workers continue from the next buffer, or the end of
+	 * partition. Empty partition is never being walked.
+	 */
+	if (buf->buf_id == part->current_pos)
+		part->current_pos = next_flush_id;
+
+	if (polar_flush_list_is_empty(part))
+		part->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
 
 	/* Remove buffer from flush list */
 	buf->flush_next = POLAR_FLUSHNEXT_NOT_IN_LIST;
@@ -343,37 +536,40 @@ remove_one_buffer(BufferDesc *buf)
 }
 
 /*
- * Append one buffer to flush list, caller should already acquired the
- * flush list lock.
+ * Insert one buffer into flush list partition by its oldest lsn, caller
+ * should already acquired the partition lock. Oldest lsn is almost
+ * increasing, so we search the position from the tail.
  */
 static void
-append_one_buffer(BufferDesc *buf)
+insert_one_buffer(FlushListPartition *part, BufferDesc *buf)
 {
+	int			prev_flush_id = part->last_flush_buffer;
+	int			next_flush_id = POLAR_FLUSHNEXT_END_OF_LIST;
+
 	if (unlikely(polar_enable_debug))
 		POLAR_LOG_BUFFER_DESC_WITH_FLUSHLIST(buf);
 
-	if (unlikely(polar_flush_list_is_empty()))
+	while (prev_flush_id != POLAR_FLUSHNEXT_END_OF_LIST)
 	{
-		buf->flush_next = POLAR_FLUSHNEXT_END_OF_LIST;
-		buf->flush_prev = POLAR_FLUSHNEXT_END_OF_LIST;
+		BufferDesc *prev_buf = GetBufferDescriptor(prev_flush_id);
 
-		polar_flush_ctl->first_flush_buffer = buf->buf_id;
-		polar_flush_ctl->last_flush_buffer = buf->buf_id;
-	}
-	else
-	{
-		BufferDesc *tail = GetBufferDescriptor(polar_flush_ctl->last_flush_buffer);
+		if (polar_buffer_get_oldest_lsn(prev_buf) <= polar_buffer_get_oldest_lsn(buf))
+			break;
 
-		if (unlikely(tail->oldest_lsn > buf->oldest_lsn))
-			elog(PANIC, "Append buffer with a small oldest lsn than last buffer in flush list.");
+		next_flush_id = prev_flush_id;
+		prev_flush_id = prev_buf->flush_prev;
+	}
 
-		Assert(tail->flush_next == POLAR_FLUSHNEXT_END_OF_LIST);
+	buf->flush_prev = prev_flush_id;
+	buf->flush_next = next_flush_id;
 
-		buf->flush_prev = tail->buf_id;
-		buf->flush_next = tail->flush_next;
-		tail->flush_next = buf->buf_id;
+	if (prev_flush_id == POLAR_FLUSHNEXT_END_OF_LIST)
+		part->first_flush_buffer = buf->buf_id;
+	else
+		GetBufferDescriptor(prev_flush_id)->flush_next = buf->buf_id;
 
-		/* Append at the tail */
-		polar_flush_ctl->last_flush_buffer = buf->buf_id;
-	}
+	if (next_flush_id == POLAR_FLUSHNEXT_END_OF_LIST)
+		part->last_flush_buffer = buf->buf_id;
+	else
+		GetBufferDescriptor(next_flush_id)->flush_prev = buf->buf_id;
 }
@@ -0,0 +1,449 @@
+/*-------------------------------------------------------------------------
+ *
+ * polar_prefetch.c
+ *	  Read blocks into shared buffers ahead of their users by background
+ *	  prefetch workers.
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * The storage has no asynchronous read interface, and posix_fadvise hint
+ * does nothing on shared storage. So the processes which know the blocks
+ * they will read soon, like sequential scan and parallel replay, put the
+ * block ranges into a shared queue, and the prefetch workers read them into
+ * shared buffers by bulk read meanwhile. When the process reaches a block,
+ * it's a buffer hit, or it waits for the IO which is in progress.
+ *
+ * The queue is a fixed size ring protected by a spinlock. A request is
+ * dropped when the queue is full, and a request which continues the last
+ * queued one of the same relation is merged into it, so the blocks can be
+ * read by one bulk read.
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/polar_prefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xlogutils.h"
+#include "executor/instrument.h"
+#include "libpq/pqsignal.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/condition_variable.h"
+#include "storage/fd.h"
+#include "storage/ipc.h"
+#include "storage/lmgr.h"
+#include "storage/polar_bufmgr.h"
+#include "storage/polar_prefetch.h"
+#include "storage/proc.h"
+#include "storage/procsignal.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+/* How long an idle worker sleeps before it checks the queue again */
+#define POLAR_PREFETCH_IDLE_TIMEOUT 10000	/* ms */
+
+/* How many latest requests are checked for the blocks queued already */
+#define POLAR_PREFETCH_DEDUP_DEPTH 8
+
+#define polar_prefetch_same_fork(req, relid, rnode, forknum) \
+	((req)->lockrelid.relId == (relid) && RelFileNodeEquals((req)->rnode, (rnode)) && \
+	 (req)->forknum == (forknum))
+
+int			polar_prefetch_workers = 0;
+
+polar_prefetch_ctl_t *polar_prefetch_ctl = NULL;
+
+Size
+polar_prefetch_shmem_size(void)
+{
+	if (polar_prefetch_workers <= 0)
+		return 0;
+
+	return sizeof(polar_prefetch_ctl_t);
+}
+
+void
+polar_prefetch_shmem_init(void)
+{
+	bool		found;
+	int			i;
+
+	if (polar_prefetch_workers <= 0)
+		return;
+
+	polar_prefetch_ctl = (polar_prefetch_ctl_t *)
+		ShmemInitStruct("polar prefetch control", sizeof(polar_prefetch_ctl_t), &found);
+
+	if (!found)
+	{
+		SpinLockInit(&polar_prefetch_ctl->lock);
+		polar_prefetch_ctl->head = 0;
+		polar_prefetch_ctl->tail = 0;
+
+		for (i = 0; i < POLAR_MAX_PREFETCH_WORKERS; i++)
+		{
+			polar_prefetch_ctl->workers[i].latch = NULL;
+			polar_prefetch_ctl->workers[i].idle = false;
+		}
+
+		pg_atomic_init_u64(&polar_prefetch_ctl->requested_blocks, 0);
+		pg_atomic_init_u64(&polar_prefetch_ctl->dropped_blocks, 0);
+		pg_atomic_init_u64(&polar_prefetch_ctl->read_blocks, 0);
+		pg_atomic_init_u64(&polar_prefetch_ctl->hit_blocks, 0);
+		pg_atomic_init_u64(&polar_prefetch_ctl->skipped_blocks, 0);
+		pg_atomic_init_u64(&polar_prefetch_ctl->failed_requests, 0);
+	}
+}
+
+/*
+ * Register the prefetch workers in postmaster. They start once the database
+ * is consistent, so they can read blocks in replica and standby too.
+ */
+void
+polar_register_prefetch_workers(void)
+{
+	BackgroundWorker worker;
+	int			i;
+
+	for (i = 0; i < polar_prefetch_workers; i++)
+	{
+		MemSet(&worker, 0, sizeof(BackgroundWorker));
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_ConsistentState;
+		worker.bgw_restart_time = 3;
+		worker.bgw_notify_pid = 0;
+		worker.bgw_main_arg = Int32GetDatum(i);
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN, "polar_prefetch_worker_main");
+		snprintf(worker.bgw_name, BGW_MAXLEN, "polar prefetch worker %d", i);
+		snprintf(worker.bgw_type, BGW_MAXLEN, "polar prefetch worker");
+		RegisterBackgroundWorker(&worker);
+	}
+}
+
+/*
+ * Queue a request to read nblocks blocks starting from blockno into shared
+ * buffers, and wake up an idle worker to do it. reln is the relation which
+ * the caller holds lock on, or NULL in recovery. Return false if the queue is
+ * full and the request is dropped.
+ */
+bool
+polar_prefetch_buffers(Relation reln, RelFileNode rnode, ForkNumber forknum,
+					   BlockNumber blockno, BlockNumber nblocks)
+{
+	polar_prefetch_ctl_t *ctl = polar_prefetch_ctl;
+	polar_prefetch_request_t *req;
+	Oid			relid = reln != NULL ? reln->rd_lockInfo.lockRelId.relId : InvalidOid;
+	Latch	   *latch = NULL;
+	bool		queued = true;
+	uint64		pos;
+	int			i;
+
+	Assert(polar_prefetch_enabled());
+
+	if (nblocks == 0)
+		return true;
+
+	SpinLockAcquire(&ctl->lock);
+
+	/*
+	 * The blocks may be queued already, it's common when a few pages are
+	 * modified by turns.
+	 */
+	for (pos = ctl->tail; pos > ctl->head && pos + POLAR_PREFETCH_DEDUP_DEPTH > ctl->tail; pos--)
+	{
+		req = &ctl->requests[(pos - 1) % POLAR_PREFETCH_QUEUE_SIZE];
+
+		if (polar_prefetch_same_fork(req, relid, rnode, forknum) &&
+			blockno >= req->blockno && blockno + nblocks <= req->blockno + req->nblocks)
+		{
+			SpinLockRelease(&ctl->lock);
+			return true;
+		}
+	}
+
+	req = ctl->tail > ctl->head ? &ctl->requests[(ctl->tail - 1) % POLAR_PREFETCH_QUEUE_SIZE] : NULL;
+
+	if (req != NULL && polar_prefetch_same_fork(req, relid, rnode, forknum) &&
+		req->blockno + req->nblocks == blockno && req->nblocks + nblocks <= POLAR_MAX_BULK_IO_SIZE)
+		req->nblocks += nblocks;
+	else if (ctl->tail - ctl->head < POLAR_PREFETCH_QUEUE_SIZE)
+	{
+		req = &ctl->requests[ctl->tail % POLAR_PREFETCH_QUEUE_SIZE];
+
+		if (reln != NULL)
+			req->lockrelid = reln->rd_lockInfo.lockRelId;
+		else
+		{
+			req->lockrelid.dbId = InvalidOid;
+			req->lockrelid.relId = InvalidOid;
+		}
+		req->rnode = rnode;
+		req->forknum = forknum;
+		req->blockno = blockno;
+		req->nblocks = nblocks;
+		ctl->tail++;
+	}
+	else
+		queued = false;
+
+	if (queued)
+	{
+		for (i = 0; i < polar_prefetch_workers; i++)
+		{
+			if (ctl->workers[i].idle && ctl->workers[i].latch != NULL)
+			{
+				ctl->workers[i].idle = false;
+				latch = ctl->workers[i].latch;
+				break;
+			}
+		}
+	}
+
+	SpinLockRelease(&ctl->lock);
+
+	if (queued)
+		pg_atomic_fetch_add_u64(&ctl->requested_blocks, nblocks);
+	else
+		pg_atomic_fetch_add_u64(&ctl->dropped_blocks, nblocks);
+
+	if (latch != NULL)
+		SetLatch(latch);
+
+	return queued;
+}
+
+/*
+ * Take the oldest request from the queue. If the queue is empty, mark the
+ * worker idle, so the next request wakes it up.
+ */
+static bool
+polar_prefetch_pop(int worker_id, polar_prefetch_request_t *req)
+{
+	polar_prefetch_ctl_t *ctl = polar_prefetch_ctl;
+	bool		found = false;
+
+	SpinLockAcquire(&ctl->lock);
+
+	if (ctl->head < ctl->tail)
+	{
+		*req = ctl->requests[ctl->head % POLAR_PREFETCH_QUEUE_SIZE];
+		ctl->head++;
+		found = true;
+	}
+	else
+		ctl->workers[worker_id].idle = true;
+
+	SpinLockRelease(&ctl->lock);
+
+	return found;
+}
+
+/*
+ * Read the blocks of one request into shared buffers. Each bulk read stops at
+ * the first block which is in shared buffers already, and the next one starts
+ * after the blocks it read.
+ */
+static void
+polar_prefetch_read(polar_prefetch_request_t *req)
+{
+	polar_prefetch_ctl_t *ctl = polar_prefetch_ctl;
+	bool		locked = false;
+	Relation	rel;
+	BlockNumber blockno = req->blockno;
+	BlockNumber end = req->blockno + req->nblocks;
+	BlockNumber nblocks;
+
+	/* Don't read the blocks after the relation is truncated or dropped */
+	if (OidIsValid(req->lockrelid.relId))
+	{
+		LOCKTAG		tag;
+
+		SET_LOCKTAG_RELATION(tag, req->lockrelid.dbId, req->lockrelid.relId);
+		if (LockAcquire(&tag, AccessShareLock, false, true) == LOCKACQUIRE_NOT_AVAIL)
+		{
+			pg_atomic_fetch_add_u64(&ctl->skipped_blocks, req->nblocks);
+			return;
+		}
+		locked = true;
+	}
+
+	rel = CreateFakeRelcacheEntry(req->rnode);
+
+	if (smgrexists(RelationGetSmgr(rel), req->forknum))
+		nblocks = smgrnblocks(RelationGetSmgr(rel), req->forknum);
+	else
+		nblocks = 0;
+
+	if (end > nblocks)
+	{
+		pg_atomic_fetch_add_u64(&ctl->skipped_blocks, end - Max(blockno, nblocks));
+		end = Max(blockno, nblocks);
+	}
+
+	while (blockno < end)
+	{
+		int64		blocks_read = pgBufferUsage.shared_blks_read;
+		int64		bulk_blocks_read = pgBufferUsage.polar_bulk_read_blocks_IO;
+		int64		bulk_reads = pgBufferUsage.polar_bulk_read_calls_IO;
+		Buffer		buffer;
+
+		CHECK_FOR_INTERRUPTS();
+
+		buffer = polar_bulk_read_buffer_extended(rel, req->forknum, blockno, RBM_NORMAL,
+												 NULL, end - blockno);
+		ReleaseBuffer(buffer);
+
+		/* The blocks after the first one are only counted by bulk read */
+		if (pgBufferUsage.polar_bulk_read_calls_IO > bulk_reads)
+			blocks_read = pgBufferUsage.polar_bulk_read_blocks_IO - bulk_blocks_read;
+		else
+			blocks_read = pgBufferUsage.shared_blks_read - blocks_read;
+
+		if (blocks_read > 0)
+		{
+			pg_atomic_fetch_add_u64(&ctl->read_blocks, blocks_read);
+			blockno += blocks_read;
+		}
+		else
+		{
+			pg_atomic_fetch_add_u64(&ctl->hit_blocks, 1);
+			blockno++;
+		}
+	}
+
+	FreeFakeRelcacheEntry(rel);
+
+	if (locked)
+		UnlockRelationId(&req->lockrelid, AccessShareLock);
+}
+
+/*
+ * polar_prefetch_worker_main - main entry point for the prefetch worker.
+ *
+ * Based on polar_parallel_bgwriter_worker_main.
+ */
+void
+polar_prefetch_worker_main(Datum main_arg)
+{
+	sigjmp_buf	local_sigjmp_buf;
+	MemoryContext prefetch_context;
+	int			worker_id = DatumGetInt32(main_arg);
+	polar_prefetch_request_t req;
+
+	Assert(worker_id >= 0 && worker_id < POLAR_MAX_PREFETCH_WORKERS);
+
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	pqsignal(SIGTERM, SignalHandlerForShutdownRequest);
+	pqsignal(SIGUSR1, procsignal_sigusr1_handler);
+
+	prefetch_context = AllocSetContextCreate(TopMemoryContext,
+											 "Prefetch Worker",
+											 ALLOCSET_DEFAULT_SIZES);
+	MemoryContextSwitchTo(prefetch_context);
+
+	/*
+	 * create resowner before sigsetjmp to avoid recreate error when exception
+	 * is encountered.
+	 */
+	CreateAuxProcessResourceOwner();
+
+	/*
+	 * If an exception is encountered, processing resumes here. The request
+	 * which failed is given up.
+	 *
+	 * See notes in bgwriter.c about the design of this coding.
+	 */
+	if (sigsetjmp(local_sigjmp_buf, 1) != 0)
+	{
+		/* Since not using PG_TRY, must reset error stack by hand */
+		error_context_stack = NULL;
+
+		/* Prevent interrupts while cleaning up */
+		HOLD_INTERRUPTS();
+
+		/* Report the error to the server log */
+		EmitErrorReport();
+
+		LWLockReleaseAll();
+		ConditionVariableCancelSleep();
+		AbortBufferIO();
+		UnlockBuffers();
+		ReleaseAuxProcessResources(false);
+		LockReleaseAll(DEFAULT_LOCKMETHOD, true);
+		AtEOXact_Buffers(false);
+		AtEOXact_SMgr();
+		AtEOXact_Files(false);
+		AtEOXact_HashTables(false);
+
+		MemoryContextSwitchTo(prefetch_context);
+		FlushErrorState();
+		MemoryContextResetAndDeleteChildren(prefetch_context);
+
+		pg_atomic_fetch_add_u64(&polar_prefetch_ctl->failed_requests, 1);
+
+		/* Now we can allow interrupts again */
+		RESUME_INTERRUPTS();
+
+		smgrcloseall();
+
+		/* Report wait end here, when there is no further possibility of wait */
+		pgstat_report_wait_end();
+	}
+
+	/* We can now handle ereport(ERROR) */
+	PG_exception_stack = &local_sigjmp_buf;
+
+	BackgroundWorkerUnblockSignals();
+
+	polar_prefetch_ctl->workers[worker_id].latch = MyLatch;
+
+	for (;;)
+	{
+		int			rc;
+
+		/* Clear any already-pending wakeups */
+		ResetLatch(MyLatch);
+
+		HandleMainLoopInterrupts();
+
+		while (polar_prefetch_pop(worker_id, &req))
+		{
+			polar_prefetch_read(&req);
+			MemoryContextReset(prefetch_context);
+		}
+
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+					   POLAR_PREFETCH_IDLE_TIMEOUT /* ms */ ,
+					   WAIT_EVENT_POLAR_PREFETCH_MAIN);
+
+		/*
+		 * We don't get smgr invalidations, so don't keep the files of the
+		 * relations which may be dropped open after being idle for a while.
+		 */
+		if (rc & WL_TIMEOUT)
+			smgrcloseall();
+	}
+}
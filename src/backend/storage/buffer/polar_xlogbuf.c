@@ -25,6 +25,7 @@
 
 #include "postgres.h"
 
+#include "access/polar_logindex_redo.h"
 #include "miscadmin.h"
 #include "storage/ipc.h"
 #include "storage/polar_xlogbuf.h"
@@ -41,17 +42,24 @@ static uint64 hit_count = 0;
 static uint64 io_count = 0;
 static uint64 others_append_count = 0;
 static uint64 startup_append_count = 0;
+static uint64 conflict_miss_count = 0;
+
+/* The read ahead state of this process */
+static XLogRecPtr read_ahead_next_lsn = InvalidXLogRecPtr;
+static int	read_ahead_depth = 1;
 
 #define POLAR_LOG_XLOG_BUFFER_STAT() \
 do \
 { \
 	ereport(LOG, \
 			errmsg("XLog Buffer Hit Ratio: total_count=%ld, hit_count=%ld(%lf), " \
-				   "io_count=%ld(%lf), others_append_count=%ld(%lf), startup_append_count=%ld(%lf)", \
+				   "io_count=%ld(%lf), others_append_count=%ld(%lf), startup_append_count=%ld(%lf), " \
+				   "conflict_miss_count=%ld(%lf)", \
 				   total_count, hit_count, (double) hit_count / (double) total_count, \
 				   io_count, (double) io_count / (double) total_count, \
 				   others_append_count, (double) others_append_count / (double) total_count, \
-				   startup_append_count, (double) startup_append_count / (double) total_count)); \
+				   startup_append_count, (double) startup_append_count / (double) total_count, \
+				   conflict_miss_count, (double) conflict_miss_count / (double) total_count)); \
 } while (0)
 
 static void
@@ -70,6 +78,7 @@ polar_init_xlog_buffer(char *prefix)
 				foundBlock,
 				foundLock;
 	Size		block_count;
+	Size		set_count;
 	char		name[MAXPGPATH];
 
 	if (polar_xlog_page_buffers <= 0 ||
@@ -77,6 +86,7 @@ polar_init_xlog_buffer(char *prefix)
 		return;
 
 	block_count = (Size) POLAR_XLOG_BUFFER_TOTAL_COUNT();
+	set_count = (Size) POLAR_XLOG_BUFFER_SET_COUNT();
 
 	sprintf(name, "%s CTL", prefix);
 	polar_xlog_buffer_ins = (polar_xlog_buffer_ctl)
@@ -99,7 +109,7 @@ polar_init_xlog_buffer(char *prefix)
 	sprintf(name, "%s Locks", prefix);
 	polar_xlog_buffer_ins->buffer_lock_array = (polar_lwlock_mini_padded *)
 		ShmemInitStruct(name,
-						block_count * sizeof(polar_lwlock_mini_padded),
+						set_count * sizeof(polar_lwlock_mini_padded),
 						&foundLock);
 
 	if (!IsUnderPostmaster)
@@ -115,13 +125,18 @@ polar_init_xlog_buffer(char *prefix)
 			buf->buf_id = i;
 			buf->start_lsn = InvalidXLogRecPtr;
 			buf->end_lsn = InvalidXLogRecPtr;
-			LWLockInitialize(polar_xlog_buffer_desc_get_lock(buf), LWTRANCHE_XLOG_BUFFER_CONTENT);
+			buf->evicted_lsn = InvalidXLogRecPtr;
 		}
 
+		for (i = 0; i < set_count; ++i)
+			LWLockInitialize(polar_xlog_buffer_set_get_lock(i), LWTRANCHE_XLOG_BUFFER_CONTENT);
+
 		pg_atomic_init_u64(&polar_xlog_buffer_ins->hit_count, 0);
 		pg_atomic_init_u64(&polar_xlog_buffer_ins->io_count, 0);
 		pg_atomic_init_u64(&polar_xlog_buffer_ins->others_append_count, 0);
 		pg_atomic_init_u64(&polar_xlog_buffer_ins->startup_append_count, 0);
+		pg_atomic_init_u64(&polar_xlog_buffer_ins->conflict_miss_count, 0);
+		pg_atomic_init_u64(&polar_xlog_buffer_ins->read_ahead_count, 0);
 	}
 	else
 		Assert(found && foundDesc && foundBlock && foundLock);
@@ -148,8 +163,8 @@ polar_xlog_buffer_shmem_size(void)
 	/* size of xlog buffer blocks */
 	size = add_size(size, mul_size(block_count, XLOG_BLCKSZ));
 
-	/* size of xlog buffer lock */
-	size = add_size(size, mul_size(block_count, sizeof(polar_lwlock_mini_padded)));
+	/* size of xlog buffer set lock */
+	size = add_size(size, mul_size(POLAR_XLOG_BUFFER_SET_COUNT(), sizeof(polar_lwlock_mini_padded)));
 	/* to allow aligning the above */
 	size = add_size(size, PG_CACHE_LINE_SIZE);
 
@@ -176,43 +191,141 @@ xlog_buffer_precheck(XLogRecPtr cur_page_lsn, int len)
 }
 
 /*
- * POLAR: Lookup the buffer page using lsn.
+ * POLAR: Get the consumers' cursor of xlog buffer, which is the start of the
+ * page replayed by background replay. The startup process and the backends
+ * read xlog after it, so the pages before it won't be read soon.
+ *
+ * Return InvalidXLogRecPtr if there's no cursor.
+ */
+static XLogRecPtr
+polar_xlog_buffer_cursor(void)
+{
+	XLogRecPtr	cursor;
+
+	if (polar_logindex_redo_instance == NULL)
+		return InvalidXLogRecPtr;
+
+	cursor = polar_bg_redo_get_replayed_lsn(polar_logindex_redo_instance);
+
+	return cursor - (cursor % XLOG_BLCKSZ);
+}
+
+/*
+ * POLAR: Choose the buffer in the set to keep xlog page of cur_page_lsn.
+ *
+ * Caller should hold the set lock.
  *
- * buf_id will be set when buffer matched or current buffer should be evicted.
- * When buffer should be evicted, buf_id will be set the id of evicted buffer,
- * and because requested page is not matched, so return false.
+ * The buffer is chosen as the following order:
+ * 1. The buffer which keeps the same page but with smaller valid size.
+ * 2. The empty buffer.
+ * 3. The oldest buffer whose page is older than cursor.
+ * 4. The buffer whose page is farthest from cursor, if the requested page
+ *	  is nearer. Without cursor, it's the oldest buffer if the requested page
+ *	  is newer.
  *
- * If buffer is matched, return true, otherwise return false.
- * Force to recheck xlog buffer after switch lock from LW_SHARED to LW_EXCLUSIVE,
- * then the buffer may be matched and returned with LW_EXCLUSIVE.
+ * Return -1 if the requested page should not be kept.
+ */
+static int
+polar_xlog_buffer_choose_victim(int first, XLogRecPtr cur_page_lsn, int len, XLogRecPtr cursor)
+{
+	int			buf_id;
+	int			empty = -1;
+	int			consumed = -1;
+	int			oldest = -1;
+	int			newest = -1;
+	polar_xlog_buffer_desc *buf;
+
+	for (buf_id = first; buf_id < first + POLAR_XLOG_BUFFER_WAYS; buf_id++)
+	{
+		buf = polar_get_xlog_buffer_desc(buf_id);
+
+		if (XLogRecPtrIsInvalid(buf->end_lsn))
+		{
+			if (empty < 0)
+				empty = buf_id;
+			continue;
+		}
+
+		if (buf->start_lsn == cur_page_lsn)
+		{
+			/* If buffer valid size is smaller than current data, replace it */
+			if (buf->end_lsn >= cur_page_lsn + len - 1)
+				return -1;
+
+			return buf_id;
+		}
+
+		if (oldest < 0 || buf->start_lsn < polar_get_xlog_buffer_desc(oldest)->start_lsn)
+			oldest = buf_id;
+
+		if (newest < 0 || buf->start_lsn > polar_get_xlog_buffer_desc(newest)->start_lsn)
+			newest = buf_id;
+
+		if (!XLogRecPtrIsInvalid(cursor) && buf->start_lsn < cursor &&
+			(consumed < 0 || buf->start_lsn < polar_get_xlog_buffer_desc(consumed)->start_lsn))
+			consumed = buf_id;
+	}
+
+	if (empty >= 0)
+		return empty;
+
+	if (consumed >= 0)
+		return consumed;
+
+	if (XLogRecPtrIsInvalid(cursor))
+		return (cur_page_lsn > polar_get_xlog_buffer_desc(oldest)->start_lsn) ? oldest : -1;
+
+	/* All pages in this set are after cursor, the consumed page is useless */
+	if (cur_page_lsn < cursor)
+		return -1;
+
+	return (cur_page_lsn < polar_get_xlog_buffer_desc(newest)->start_lsn) ? newest : -1;
+}
+
+/*
+ * POLAR: Lookup the buffer page using lsn.
+ *
+ * If buffer is matched, copy the page into cur_page and return true,
+ * otherwise return false.
  */
 bool
 polar_xlog_buffer_lookup(XLogRecPtr cur_page_lsn, int len, char *cur_page)
 {
 	polar_xlog_buffer_desc *buf;
+	int			set;
+	int			first;
 	int			buf_id;
 	bool		found = false;
+	bool		conflict = false;
 
 	xlog_buffer_precheck(cur_page_lsn, len);
 
 	total_count++;
 
-	buf_id = polar_get_xlog_buffer_id(cur_page_lsn);
-	Assert(buf_id >= 0);
-
-	buf = polar_get_xlog_buffer_desc(buf_id);
+	set = polar_get_xlog_buffer_set(cur_page_lsn);
+	Assert(set >= 0);
+	first = polar_get_xlog_buffer_set_first(set);
 
 	/* Obtain shared lock to check meta info */
-	LWLockAcquire(polar_xlog_buffer_desc_get_lock(buf), LW_SHARED);
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_SHARED);
 
-	if (buf->start_lsn == cur_page_lsn &&
-		buf->end_lsn >= (cur_page_lsn + len - 1))
+	for (buf_id = first; buf_id < first + POLAR_XLOG_BUFFER_WAYS; buf_id++)
 	{
-		memcpy(cur_page, polar_get_xlog_buffer(buf_id), len);
-		found = true;
+		buf = polar_get_xlog_buffer_desc(buf_id);
+
+		if (buf->start_lsn == cur_page_lsn &&
+			buf->end_lsn >= (cur_page_lsn + len - 1))
+		{
+			memcpy(cur_page, polar_get_xlog_buffer(buf_id), len);
+			found = true;
+			break;
+		}
+
+		if (!XLogRecPtrIsInvalid(buf->evicted_lsn) && buf->evicted_lsn == cur_page_lsn)
+			conflict = true;
 	}
 
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
 
 	if (found)
 	{
@@ -223,6 +336,12 @@ polar_xlog_buffer_lookup(XLogRecPtr cur_page_lsn, int len, char *cur_page)
 	{
 		io_count++;
 		pg_atomic_fetch_add_u64(&polar_xlog_buffer_ins->io_count, 1);
+
+		if (conflict)
+		{
+			conflict_miss_count++;
+			pg_atomic_fetch_add_u64(&polar_xlog_buffer_ins->conflict_miss_count, 1);
+		}
 	}
 
 	return found;
@@ -237,44 +356,51 @@ bool
 polar_xlog_buffer_append(XLogRecPtr cur_page_lsn, int len, char *cur_page)
 {
 	polar_xlog_buffer_desc *buf;
+	int			set;
+	int			first;
 	int			buf_id;
+	XLogRecPtr	cursor;
 
 	xlog_buffer_precheck(cur_page_lsn, len);
 
 	total_count++;
 
-	buf_id = polar_get_xlog_buffer_id(cur_page_lsn);
-	Assert(buf_id >= 0);
-	buf = polar_get_xlog_buffer_desc(buf_id);
+	set = polar_get_xlog_buffer_set(cur_page_lsn);
+	Assert(set >= 0);
+	first = polar_get_xlog_buffer_set_first(set);
+	cursor = polar_xlog_buffer_cursor();
 
 	/* Obtain shared lock to check meta info */
-	LWLockAcquire(polar_xlog_buffer_desc_get_lock(buf), LW_SHARED);
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_SHARED);
+	buf_id = polar_xlog_buffer_choose_victim(first, cur_page_lsn, len, cursor);
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
 
-	if ((buf->start_lsn == cur_page_lsn && buf->end_lsn >= (cur_page_lsn + len - 1)) ||
-		!polar_xlog_buffer_should_evict(buf, cur_page_lsn, len))
-	{
-		LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+	if (buf_id < 0)
 		return false;
-	}
 
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
-	LWLockAcquire(polar_xlog_buffer_desc_get_lock(buf), LW_EXCLUSIVE);
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_EXCLUSIVE);
 
 	/*
 	 * check again to prevent xlog buffer from being updated by other
 	 * processes
 	 */
-	if ((buf->start_lsn == cur_page_lsn && buf->end_lsn >= (cur_page_lsn + len - 1)) ||
-		!polar_xlog_buffer_should_evict(buf, cur_page_lsn, len))
+	buf_id = polar_xlog_buffer_choose_victim(first, cur_page_lsn, len, cursor);
+
+	if (buf_id < 0)
 	{
-		LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+		LWLockRelease(polar_xlog_buffer_set_get_lock(set));
 		return false;
 	}
 
+	buf = polar_get_xlog_buffer_desc(buf_id);
+
+	if (!XLogRecPtrIsInvalid(buf->end_lsn) && buf->start_lsn != cur_page_lsn)
+		buf->evicted_lsn = buf->start_lsn;
+
 	buf->start_lsn = cur_page_lsn;
 	buf->end_lsn = cur_page_lsn + len - 1;
 	memcpy(polar_get_xlog_buffer(buf_id), cur_page, len);
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
 
 	if (AmStartupProcess())
 	{
@@ -299,54 +425,101 @@ void
 polar_xlog_buffer_update(XLogRecPtr lsn)
 {
 	XLogRecPtr	page_off = lsn - (lsn % XLOG_BLCKSZ);
-	int			buf_id = polar_get_xlog_buffer_id(lsn);
+	int			set = polar_get_xlog_buffer_set(lsn);
+	int			first = polar_get_xlog_buffer_set_first(set);
+	int			buf_id;
 	polar_xlog_buffer_desc *buf = NULL;
 
-	Assert(buf_id >= 0);
+	Assert(set >= 0);
 
-	buf = polar_get_xlog_buffer_desc(buf_id);
-	LWLockAcquire(polar_xlog_buffer_desc_get_lock(buf), LW_EXCLUSIVE);
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_EXCLUSIVE);
 
-	/*
-	 * Ensure page buffer the expected one. While stream replication broken,
-	 * xlog page may be read by twophase related logic. After startup replay
-	 * all xlog at local storage, it will invalidation xlog buffer data
-	 * related to last record. In some situation, this invalidation operation
-	 * may enlarge xlog buffer size at page without more data filled, so it
-	 * may cause zero data being read by other twophase related operation
-	 * which will print ERROR log when cannot read record. So we add the check
-	 * here to ensure updated lsn not larger than original buffer meta info,
-	 * because this update func is only used while meet invalid xlog record.
-	 */
-	if (buf->start_lsn == page_off && buf->end_lsn > lsn)
-		buf->end_lsn = lsn;
+	for (buf_id = first; buf_id < first + POLAR_XLOG_BUFFER_WAYS; buf_id++)
+	{
+		buf = polar_get_xlog_buffer_desc(buf_id);
+
+		/*
+		 * Ensure page buffer the expected one. While stream replication
+		 * broken, xlog page may be read by twophase related logic. After
+		 * startup replay all xlog at local storage, it will invalidation xlog
+		 * buffer data related to last record. In some situation, this
+		 * invalidation operation may enlarge xlog buffer size at page without
+		 * more data filled, so it may cause zero data being read by other
+		 * twophase related operation which will print ERROR log when cannot
+		 * read record. So we add the check here to ensure updated lsn not
+		 * larger than original buffer meta info, because this update func is
+		 * only used while meet invalid xlog record.
+		 */
+		if (buf->start_lsn == page_off && buf->end_lsn > lsn)
+			buf->end_lsn = lsn;
+	}
 
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
 }
 
 /*
  * POLAR: Remove page from xlog buffer.
- *
- * If buffer is io-progress, it do nothing.
  */
 void
 polar_xlog_buffer_remove(XLogRecPtr lsn)
 {
 	XLogRecPtr	page_off = lsn - (lsn % XLOG_BLCKSZ);
-	int			buf_id = polar_get_xlog_buffer_id(lsn);
+	int			set = polar_get_xlog_buffer_set(lsn);
+	int			first = polar_get_xlog_buffer_set_first(set);
+	int			buf_id;
 	polar_xlog_buffer_desc *buf = NULL;
 
-	Assert(buf_id >= 0);
+	Assert(set >= 0);
 
-	buf = polar_get_xlog_buffer_desc(buf_id);
-	LWLockAcquire(polar_xlog_buffer_desc_get_lock(buf), LW_EXCLUSIVE);
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_EXCLUSIVE);
 
-	/* Ensure page buffer the expected one */
-	if (buf->start_lsn == page_off)
+	for (buf_id = first; buf_id < first + POLAR_XLOG_BUFFER_WAYS; buf_id++)
 	{
-		buf->start_lsn = InvalidXLogRecPtr;
-		buf->end_lsn = InvalidXLogRecPtr;
+		buf = polar_get_xlog_buffer_desc(buf_id);
+
+		/* Ensure page buffer the expected one */
+		if (buf->start_lsn == page_off)
+		{
+			buf->start_lsn = InvalidXLogRecPtr;
+			buf->end_lsn = InvalidXLogRecPtr;
+		}
 	}
 
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(buf));
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
+}
+
+/*
+ * POLAR: Get the number of xlog pages to read from page_lsn, which is called
+ * when the page is not found in xlog buffer.
+ *
+ * The depth is doubled when this process reads the page right after the pages
+ * it read last time, and it's reset to one page when the access is not
+ * sequential or the read ahead pages were evicted before they were used. It
+ * never exceeds the number of sets, so the pages read by one io don't evict
+ * each other.
+ */
+int
+polar_xlog_buffer_read_ahead_depth(XLogRecPtr page_lsn)
+{
+	int			max_depth = Min(MAX_READ_AHEAD_XLOGS, POLAR_XLOG_BUFFER_SET_COUNT());
+
+	if (page_lsn == read_ahead_next_lsn)
+		read_ahead_depth = Min(read_ahead_depth * 2, max_depth);
+	else
+		read_ahead_depth = 1;
+
+	return read_ahead_depth;
+}
+
+/*
+ * POLAR: Record that npages xlog pages were read from page_lsn, and nappended
+ * of them besides the requested one were appended to xlog buffer.
+ */
+void
+polar_xlog_buffer_read_ahead_done(XLogRecPtr page_lsn, int npages, int nappended)
+{
+	read_ahead_next_lsn = page_lsn + (XLogRecPtr) npages * XLOG_BLCKSZ;
+
+	if (nappended > 0)
+		pg_atomic_fetch_add_u64(&polar_xlog_buffer_ins->read_ahead_count, nappended);
 }
@@ -54,6 +54,7 @@
 /* POLAR */
 #include "access/polar_logindex_redo.h"
 #include "postmaster/polar_async_lock_replay.h"
+#include "storage/polar_prefetch.h"
 #include "storage/polar_rsc.h"
 #include "storage/polar_xlogbuf.h"
 /* POLAR end */
@@ -196,6 +197,9 @@ CalculateShmemSize(int *num_semaphores)
 	/* POLAR: add RSC shared memory size */
 	size = add_size(size, polar_rsc_shmem_size());
 
+	/* POLAR: add prefetch worker shared memory size */
+	size = add_size(size, polar_prefetch_shmem_size());
+
 	/*
 	 * NOTE NOTE NOTE: DO NOT ADD YOUR ADD_SIZE FUNCTION BELOW ME !!!
 	 *
@@ -415,6 +419,9 @@ CreateSharedMemoryAndSemaphores(void)
 	/* POLAR: init async lock replay share memory */
 	polar_alr_shmem_init();
 
+	/* POLAR: init prefetch worker share memory */
+	polar_prefetch_shmem_init();
+
 	/*
 	 * Set up lock manager
 	 */
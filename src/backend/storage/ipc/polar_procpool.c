@@ -69,6 +69,8 @@ typedef struct sub_task_ctl_t
 	uint64		remove_hold_task;
 	uint64		add_repeat_task;
 	uint64		remove_repeat_task;
+	uint64		steal_task;
+	uint64		skip_stolen_task;
 }			sub_task_ctl_t;
 
 #define NEXT_SCHED_PROC(ctl) \
@@ -92,6 +94,12 @@ typedef struct sub_task_ctl_t
 
 #define TASK_QUEUE_IS_EMPTY(proc) ((proc)->task_head == proc->task_tail && !proc->ring_full)
 
+/*
+ * Set in task claimed by the sub process which is stealing it, until it
+ * confirms the task is still the one it wants to steal.
+ */
+#define TASK_CLAIM_TENTATIVE (1U << 31)
+
 Size
 polar_calc_task_sched_shmem_size(Size parallel_num, Size task_node_size, Size task_queue_depth)
 {
@@ -105,6 +113,7 @@ polar_calc_task_sched_shmem_size(Size parallel_num, Size task_node_size, Size ta
 		size = offsetof(polar_task_sched_t, task_nodes);
 
 		size = add_size(size, mul_size(parallel_num, mul_size(task_node_size, task_queue_depth)));
+		size = add_size(size, mul_size(parallel_num, sizeof(polar_task_proc_state_t)));
 	}
 
 	return size;
@@ -137,6 +146,19 @@ polar_init_task_queue(polar_task_sched_t *sched)
 
 		p += sched->task_node_size;
 	}
+
+	for (i = 0; i < sched->total_proc; i++)
+	{
+		polar_task_proc_state_t *state = POLAR_SCHED_PROC_STATE(sched, i);
+
+		pg_atomic_init_u64(&state->added_seq, 0);
+		pg_atomic_init_u64(&state->fetched_seq, 0);
+		pg_atomic_init_u32(&state->fetch_idx, 0);
+		pg_atomic_init_u32(&state->idle, 0);
+	}
+
+	pg_atomic_init_u32(&sched->idle_proc_num, 0);
+	pg_atomic_init_u64(&sched->steal_task_num, 0);
 }
 
 polar_task_sched_t *
@@ -162,7 +184,10 @@ polar_create_proc_task_sched(const char *sched_name, Size parallel_num,
 		sched->run_arg = run_arg;
 		sched->added_seq = 0;
 		pg_atomic_init_u32(&sched->enable_shutdown, 0);
+		pg_atomic_init_u32(&sched->enable_work_steal, 0);
+		pg_atomic_init_u32(&sched->idle_proc_num, 0);
 		pg_atomic_init_u64(&sched->finished_seq, 0);
+		pg_atomic_init_u64(&sched->steal_task_num, 0);
 	}
 
 	return sched;
@@ -371,10 +396,77 @@ proc_add_repeat_task(sub_task_ctl_t * task_ctl, polar_task_node_t *task)
 	task_ctl->add_repeat_task++;
 }
 
+/*
+ * Take the task, so that no other sub process would handle it.
+ * Return false if it's already taken by other sub process.
+ *
+ * The claim by a stealer could be tentative and released soon, so wait for
+ * it to be confirmed or released.
+ */
+static bool
+sub_task_claim(sub_task_ctl_t * task_ctl, polar_task_node_t *task)
+{
+	uint32		expected = 0;
+
+	while (!pg_atomic_compare_exchange_u32(&task->claimed, &expected, task_ctl->sub_proc_id + 1))
+	{
+		if (!(expected & TASK_CLAIM_TENTATIVE))
+			return false;
+
+		pg_spin_delay();
+		expected = 0;
+	}
+
+	return true;
+}
+
+/*
+ * Take the task of other sub process, which is expected to be the running
+ * task with add_seq. The slot could be reused by its owner for a newer task
+ * between the check and the claim, so the task is checked again after it's
+ * claimed tentatively, and released if it's not the expected one.
+ */
+static bool
+sub_task_steal(sub_task_ctl_t * task_ctl, polar_task_node_t *task, uint64 add_seq)
+{
+	uint32		expected = 0;
+
+	if (!pg_atomic_compare_exchange_u32(&task->claimed, &expected,
+										(task_ctl->sub_proc_id + 1) | TASK_CLAIM_TENTATIVE))
+		return false;
+
+	if (task->add_seq != add_seq ||
+		POLAR_TASK_NODE_STATUS(task) != POLAR_TASK_NODE_RUNNING)
+	{
+		pg_atomic_write_u32(&task->claimed, 0);
+		return false;
+	}
+
+	pg_atomic_write_u32(&task->claimed, task_ctl->sub_proc_id + 1);
+
+	return true;
+}
+
+/*
+ * Move forward in our own ring and publish the position, so other sub
+ * processes know which tasks can be stolen and dispatcher knows which
+ * tasks can be reset.
+ */
+static void
+sub_task_advance_fetch(sub_task_ctl_t * task_ctl, polar_task_node_t *task)
+{
+	polar_task_proc_state_t *state = POLAR_SCHED_PROC_STATE(task_ctl->sched, task_ctl->sub_proc_id);
+
+	task_ctl->fetch_task_idx++;
+	task_ctl->max_fetch_seq = task->add_seq;
+
+	pg_atomic_write_u32(&state->fetch_idx, task_ctl->fetch_task_idx);
+	pg_atomic_write_u64(&state->fetched_seq, task_ctl->max_fetch_seq);
+}
+
 static polar_task_node_t *
 fetch_waiting_task_from_queue(sub_task_ctl_t * task_ctl)
 {
-	char	   *p = (char *) (task_ctl->sched->task_nodes);
 	polar_task_node_t *dst_task = NULL;
 	int			status;
 
@@ -383,9 +475,7 @@ fetch_waiting_task_from_queue(sub_task_ctl_t * task_ctl)
 		if (task_ctl->fetch_task_idx >= task_ctl->sched->task_queue_depth)
 			task_ctl->fetch_task_idx = 0;
 
-		dst_task = (polar_task_node_t *) (p +
-										  (task_ctl->sub_proc_id * task_ctl->sched->task_queue_depth + task_ctl->fetch_task_idx)
-										  * task_ctl->sched->task_node_size);
+		dst_task = POLAR_SCHED_RING_TASK_POINT(task_ctl->sched, task_ctl->sub_proc_id, task_ctl->fetch_task_idx);
 
 		/*
 		 * We fetch task from the ring queue, if add_seq == max_fetch_seq,
@@ -401,21 +491,33 @@ fetch_waiting_task_from_queue(sub_task_ctl_t * task_ctl)
 			pg_read_barrier();
 			status = POLAR_TASK_NODE_STATUS(dst_task);
 
-			if (status == POLAR_TASK_NODE_RUNNING)
+			/* Dispatcher is still adding this task */
+			if (status == POLAR_TASK_NODE_IDLE)
+				continue;
+
+			/*
+			 * The task in our ring could be stolen by other sub process, just
+			 * skip it. The hold task is claimed too, so it will be handled by
+			 * us when it's running.
+			 */
+			if (!sub_task_claim(task_ctl, dst_task))
+			{
+				sub_task_advance_fetch(task_ctl, dst_task);
+				task_ctl->skip_stolen_task++;
+			}
+			else if (status == POLAR_TASK_NODE_RUNNING)
 			{
-				task_ctl->fetch_task_idx++;
+				sub_task_advance_fetch(task_ctl, dst_task);
 				task_ctl->fetch_running_task++;
-				task_ctl->max_fetch_seq = dst_task->add_seq;
 
 				return dst_task;
 			}
 			else if (status == POLAR_TASK_NODE_HOLD)
 			{
 				proc_add_hold_task(task_ctl, dst_task);
-				task_ctl->fetch_task_idx++;
-				task_ctl->max_fetch_seq = dst_task->add_seq;
+				sub_task_advance_fetch(task_ctl, dst_task);
 			}
-			else if (status != POLAR_TASK_NODE_IDLE)
+			else
 			{
 				elog(PANIC, "Got unexpect task status %x in %s, which task is %p",
 					 status, PG_FUNCNAME_MACRO, dst_task);
@@ -428,6 +530,67 @@ fetch_waiting_task_from_queue(sub_task_ctl_t * task_ctl)
 	return NULL;
 }
 
+/*
+ * Steal running task from other sub processes' ring when we are idle.
+ * Only the task which is not fetched by its owner yet can be stolen.
+ * The running task's previous dependent task is already finished, so
+ * the replay order of the same tag is kept whoever handles it.
+ */
+static polar_task_node_t *
+steal_waiting_task(sub_task_ctl_t * task_ctl)
+{
+	polar_task_sched_t *sched = task_ctl->sched;
+	uint32		i;
+
+	for (i = 1; i < sched->total_proc; i++)
+	{
+		uint32		victim = (task_ctl->sub_proc_id + i) % sched->total_proc;
+		polar_task_proc_state_t *state = POLAR_SCHED_PROC_STATE(sched, victim);
+		uint64		fetched_seq = pg_atomic_read_u64(&state->fetched_seq);
+		uint32		idx;
+		Size		n;
+
+		if (pg_atomic_read_u64(&state->added_seq) <= fetched_seq)
+			continue;
+
+		idx = pg_atomic_read_u32(&state->fetch_idx);
+
+		/* Scan from the oldest task which is not fetched by its owner */
+		for (n = 0; n < sched->task_queue_depth; n++, idx++)
+		{
+			polar_task_node_t *task;
+			uint64		add_seq;
+			uint32		status;
+
+			if (idx >= sched->task_queue_depth)
+				idx = 0;
+
+			task = POLAR_SCHED_RING_TASK_POINT(sched, victim, idx);
+			add_seq = task->add_seq;
+
+			if (add_seq <= fetched_seq)
+				break;
+
+			pg_read_barrier();
+			status = POLAR_TASK_NODE_STATUS(task);
+
+			if (status == POLAR_TASK_NODE_IDLE)
+				break;
+
+			if (status == POLAR_TASK_NODE_RUNNING &&
+				sub_task_steal(task_ctl, task, add_seq))
+			{
+				task_ctl->steal_task++;
+				pg_atomic_fetch_add_u64(&sched->steal_task_num, 1);
+
+				return task;
+			}
+		}
+	}
+
+	return NULL;
+}
+
 static polar_task_node_t *
 fetch_waiting_task_node(sub_task_ctl_t * task_ctl)
 {
@@ -439,7 +602,26 @@ fetch_waiting_task_node(sub_task_ctl_t * task_ctl)
 	if ((task = fetch_waiting_task_from_hold_list(task_ctl)))
 		return task;
 
-	return fetch_waiting_task_from_queue(task_ctl);
+	if ((task = fetch_waiting_task_from_queue(task_ctl)))
+		return task;
+
+	if (polar_sched_work_steal_enabled(task_ctl->sched) && task_ctl->sched->total_proc > 1)
+		return steal_waiting_task(task_ctl);
+
+	return NULL;
+}
+
+static void
+sub_task_set_idle(sub_task_ctl_t * task_ctl, bool idle)
+{
+	polar_task_proc_state_t *state = POLAR_SCHED_PROC_STATE(task_ctl->sched, task_ctl->sub_proc_id);
+
+	pg_atomic_write_u32(&state->idle, idle ? 1 : 0);
+
+	if (idle)
+		pg_atomic_fetch_add_u32(&task_ctl->sched->idle_proc_num, 1);
+	else
+		pg_atomic_fetch_sub_u32(&task_ctl->sched->idle_proc_num, 1);
 }
 
 static bool
@@ -498,7 +680,7 @@ polar_sched_get_next_proc(polar_task_sched_ctl_t *ctl)
 }
 
 static int
-polar_sched_get_dst_proc(polar_task_sched_ctl_t *ctl, polar_task_node_t *node)
+polar_sched_get_dst_proc(polar_task_sched_ctl_t *ctl, polar_task_node_t *node, int32 prefer_proc)
 {
 	int32		proc_num = -1;
 	void	   *task_tag = ctl->sched->task_tag(node);
@@ -530,6 +712,14 @@ polar_sched_get_dst_proc(polar_task_sched_ctl_t *ctl, polar_task_node_t *node)
 		}
 	}
 
+	/*
+	 * The task doesn't depend on running task, so dispatch it to the
+	 * preferred process if it's started and has room
+	 */
+	if (proc_num == -1 && prefer_proc >= 0 && prefer_proc < ctl->sched->total_proc &&
+		ctl->sub_proc[prefer_proc].proc != NULL && !proc_task_queue_is_full(ctl, prefer_proc))
+		proc_num = prefer_proc;
+
 	if (proc_num == -1)
 		proc_num = polar_sched_get_next_proc(ctl);
 
@@ -570,6 +760,39 @@ polar_notify_task_proc(polar_task_sched_ctl_t *ctl, polar_task_node_t *task)
 	SetLatch(&proc->procLatch);
 }
 
+/*
+ * The running task is dispatched to a busy process, wake one idle process
+ * to steal it. If the idle process is missed, it will be woken when next
+ * task is dispatched.
+ */
+static void
+polar_notify_steal_proc(polar_task_sched_ctl_t *ctl, int32 busy_proc)
+{
+	polar_task_sched_t *sched = ctl->sched;
+	uint32		i;
+
+	if (pg_atomic_read_u32(&sched->idle_proc_num) == 0 ||
+		pg_atomic_read_u32(&POLAR_SCHED_PROC_STATE(sched, busy_proc)->idle) != 0)
+		return;
+
+	for (i = 0; i < sched->total_proc; i++)
+	{
+		uint32		proc_num = ctl->steal_proc;
+
+		ctl->steal_proc = (ctl->steal_proc + 1) % sched->total_proc;
+
+		if (proc_num == busy_proc || ctl->sub_proc[proc_num].proc == NULL)
+			continue;
+
+		if (pg_atomic_read_u32(&POLAR_SCHED_PROC_STATE(sched, proc_num)->idle) != 0)
+		{
+			SetLatch(&ctl->sub_proc[proc_num].proc->procLatch);
+			ctl->wake_steal_num++;
+			return;
+		}
+	}
+}
+
 static uint32
 polar_sched_add_task_hash_table(polar_task_sched_ctl_t *ctl, polar_task_node_t *node, polar_sub_proc_t *proc)
 {
@@ -654,6 +877,7 @@ polar_sched_proc_add_task(polar_task_sched_ctl_t *ctl, int32 dst_proc_num, polar
 
 	SpinLockInit(&dst_node->lock);
 
+	pg_atomic_write_u32(&dst_node->claimed, 0);
 	POLAR_TASK_NODE_INIT_STATUS(dst_node);
 	POLAR_UPDATE_TASK_NODE_PROC(dst_node, dst_proc_num);
 
@@ -663,8 +887,15 @@ polar_sched_proc_add_task(polar_task_sched_ctl_t *ctl, int32 dst_proc_num, polar
 	polar_sched_add_running_queue(ctl, dst_node);
 
 	if (polar_sched_add_task_hash_table(ctl, dst_node, proc) == POLAR_TASK_NODE_RUNNING)
+	{
 		polar_notify_task_proc(ctl, dst_node);
 
+		if (polar_sched_work_steal_enabled(sched))
+			polar_notify_steal_proc(ctl, dst_proc_num);
+	}
+
+	pg_atomic_write_u64(&POLAR_SCHED_PROC_STATE(sched, dst_proc_num)->added_seq, dst_node->add_seq);
+
 	polar_sched_proc_advance_ring(ctl, proc);
 	proc->running_tasks_num++;
 
@@ -674,11 +905,22 @@ polar_sched_proc_add_task(polar_task_sched_ctl_t *ctl, int32 dst_proc_num, polar
 
 polar_task_node_t *
 polar_sched_add_task(polar_task_sched_ctl_t *ctl, polar_task_node_t *task)
+{
+	return polar_sched_add_task_prefer(ctl, task, -1);
+}
+
+/*
+ * Add task and try to dispatch it to prefer_proc, unless it depends on the
+ * task which is dispatched to other process. The caller use it to make
+ * tasks which share the same input handled by the same process.
+ */
+polar_task_node_t *
+polar_sched_add_task_prefer(polar_task_sched_ctl_t *ctl, polar_task_node_t *task, int32 prefer_proc)
 {
 	polar_task_node_t *dst_node;
 	int32		dst_proc;
 
-	dst_proc = polar_sched_get_dst_proc(ctl, task);
+	dst_proc = polar_sched_get_dst_proc(ctl, task, prefer_proc);
 
 	if (dst_proc == -1)
 	{
@@ -824,6 +1066,7 @@ polar_sched_proc_reset_removed_tasks(polar_task_sched_ctl_t *ctl)
 	for (i = 0; i < sched->total_proc; i++)
 	{
 		polar_sub_proc_t *proc = &ctl->sub_proc[i];
+		polar_task_proc_state_t *state = POLAR_SCHED_PROC_STATE(sched, i);
 
 		while (!TASK_QUEUE_IS_EMPTY(proc))
 		{
@@ -832,6 +1075,13 @@ polar_sched_proc_reset_removed_tasks(polar_task_sched_ctl_t *ctl)
 			if (POLAR_TASK_NODE_STATUS(task) != POLAR_TASK_NODE_REMOVED)
 				break;
 
+			/*
+			 * The stolen task can't be reused until its owner fetched it,
+			 * otherwise the owner would lose its position in the ring.
+			 */
+			if (task->add_seq > pg_atomic_read_u64(&state->fetched_seq))
+				break;
+
 			POLAR_RESET_TASK_NODE(task);
 
 			polar_sched_proc_retreat_ring(ctl, proc);
@@ -982,17 +1232,20 @@ polar_sub_task_main(Datum main_arg)
 				timeout = 10;	/* ms */
 			}
 
+			sub_task_set_idle(&task_ctl, true);
 			rc = WaitLatch(MyLatch, evt, timeout, WAIT_EVENT_POLAR_SUB_TASK_MAIN);
+			sub_task_set_idle(&task_ctl, false);
 
 			if (rc & WL_LATCH_SET)
 				ResetLatch(MyLatch);
 		}
 	}
 
-	elog(LOG, "PolarDB proc pool exit subprocess %d for %s, fetch_running_task=%ld, add_hold_task=%ld, remove_hold_task=%ld, add_repeat_task=%ld, remove_repeat_task=%ld",
+	elog(LOG, "PolarDB proc pool exit subprocess %d for %s, fetch_running_task=%ld, add_hold_task=%ld, remove_hold_task=%ld, add_repeat_task=%ld, remove_repeat_task=%ld, steal_task=%ld, skip_stolen_task=%ld",
 		 task_ctl.sub_proc_id, task_ctl.sched->name,
 		 task_ctl.fetch_running_task, task_ctl.add_hold_task, task_ctl.remove_hold_task,
-		 task_ctl.add_repeat_task, task_ctl.remove_repeat_task);
+		 task_ctl.add_repeat_task, task_ctl.remove_repeat_task,
+		 task_ctl.steal_task, task_ctl.skip_stolen_task);
 
 	/*
 	 * From here on, elog(ERROR) should end with exit(1), not send control
@@ -1072,8 +1325,9 @@ polar_release_task_sched_ctl(polar_task_sched_ctl_t *ctl)
 		pfree(handle);
 	}
 
-	elog(LOG, "Release polar_task_sched_ctl_t, added_task_num=%ld, fail_add_task_num=%ld, finished_task_num=%ld, hold_task_num=%ld, reset_task_num=%ld",
-		 ctl->added_task_num, ctl->fail_add_task_num, ctl->finished_task_num, ctl->hold_task_num, ctl->reset_task_num);
+	elog(LOG, "Release polar_task_sched_ctl_t, added_task_num=%ld, fail_add_task_num=%ld, finished_task_num=%ld, hold_task_num=%ld, reset_task_num=%ld, wake_steal_num=%ld, steal_task_num=%ld",
+		 ctl->added_task_num, ctl->fail_add_task_num, ctl->finished_task_num, ctl->hold_task_num, ctl->reset_task_num,
+		 ctl->wake_steal_num, pg_atomic_read_u64(&sched->steal_task_num));
 
 	hash_destroy(ctl->task_hash);
 
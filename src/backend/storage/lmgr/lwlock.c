@@ -193,34 +193,38 @@ static const char *const BuiltinTrancheNames[] = {
 	/* POLAR BuiltinTrancheNames: */
 	/* LWTRANCHE_POLAR_COPY_BUFFER: */
 	"copy_buffer",
+	/* LWTRANCHE_POLAR_FLUSH_LIST_BATCH: */
+	"polar_flush_list_batch",
 	/* LWTRANCHE_LOGINDEX_MINI_TRANSACTION: */
 	"logindex_mini_transaction",
 	/* LWTRANCHE_LOGINDEX_MINI_TRANSACTION_TBL: */
 	"logindex_mini_transaction_tbl",
 	/* LWTRANCHE_WAL_LOGINDEX_MEM_TBL: */
 	"pg_logindex_mem",
-	/* LWTRANCHE_WAL_LOGINDEX_HASH_LOCK: */
-	"pg_logindex_hash",
 	/* LWTRANCHE_WAL_LOGINDEX_IO: */
 	"pg_logindex_io",
 	/* LWTRANCHE_WAL_LOGINDEX_FLUSH_ACTIVE_TBL: */
 	"pg_logindex_flush_active_tbl",
+	/* LWTRANCHE_WAL_LOGINDEX_OVERFLOW: */
+	"pg_logindex_overflow",
 	/* LWTRANCHE_WAL_LOGINDEX_BLOOM_LRU: */
 	"pg_logindex_bloom",
 	/* LWTRANCHE_FULLPAGE_LOGINDEX_MEM_TBL: */
 	"polar_fullpage_mem",
-	/* LWTRANCHE_FULLPAGE_LOGINDEX_HASH_LOCK: */
-	"polar_fullpage_hash",
 	/* LWTRANCHE_FULLPAGE_LOGINDEX_IO: */
 	"polar_fullpage_io",
 	/* LWTRANCHE_FULLPAGE_LOGINDEX_FLUSH_ACTIVE_TBL: */
 	"polar_fullpage_flush_active_tbl",
+	/* LWTRANCHE_FULLPAGE_LOGINDEX_OVERFLOW: */
+	"polar_fullpage_overflow",
 	/* LWTRANCHE_FULLPAGE_LOGINDEX_BLOOM_LRU: */
 	"polar_fullpage_bloom",
 	/* LWTRANCHE_FULLPAGE_FILE: */
 	"fullpage_file_lock",
 	/* LWTRANCHE_RELATION_SIZE_CACHE: */
 	"polar_rel_size_cache",
+	/* LWTRANCHE_POLAR_RECORD_CACHE: */
+	"polar_record_cache",
 	/* LWTRANCHE_POLAR_XLOG_QUEUE: */
 	"polar_xlog_queue",
 	/* LWTRANCHE_POLAR_CLOG_LOCAL_CACHE: */
@@ -31,6 +31,7 @@
 #include "storage/shmem.h"
 #include "storage/smgr.h"
 #include "storage/s_lock.h"
+#include "storage/spin.h"
 #include "utils/hsearch.h"
 #include "utils/rel.h"
 
@@ -55,6 +56,14 @@ static polar_rsc_shared_relation_t *rsc_ref_held = NULL;
 static polar_rsc_shared_relation_pool_t *rsc_pool = NULL;
 static HTAB *rsc_mappings = NULL;
 
+#define RSC_DB_PARTITION(dbnode) \
+	(&rsc_pool->db_partitions[(dbnode) % POLAR_RSC_DB_PARTITIONS])
+
+/* Number of shared relations dropped in each pass of polar_rsc_drop_entries */
+#define RSC_DROP_BATCH_SIZE			64
+
+static bool rsc_drop_entry(RelFileNode *rnode);
+
 size_t
 polar_rsc_shmem_size(void)
 {
@@ -100,11 +109,19 @@ polar_rsc_shmem_init(void)
 	if (!found)
 	{
 		pg_atomic_init_u32(&rsc_pool->next_sweep, 0);
+		for (i = 0; i < POLAR_RSC_DB_PARTITIONS; i++)
+		{
+			SpinLockInit(&rsc_pool->db_partitions[i].lock);
+			rsc_pool->db_partitions[i].head = -1;
+		}
 		for (i = 0; i < polar_rsc_shared_relations; i++)
 		{
 			pg_atomic_init_u32(&rsc_pool->entries[i].flags, 0);
 			pg_atomic_init_u64(&rsc_pool->entries[i].generation, 0);
 			rsc_pool->entries[i].usecount = 0;
+			rsc_pool->entries[i].db_linked = false;
+			rsc_pool->entries[i].db_prev = -1;
+			rsc_pool->entries[i].db_next = -1;
 		}
 	}
 
@@ -183,6 +200,18 @@ polar_rsc_search_by_ref(SMgrRelation reln, ForkNumber forknum)
 	{
 		BlockNumber result;
 
+		/*
+		 * The generation works like a sequence lock, it's bumped whenever the
+		 * shared relation is evicted or reused, so the value is read between
+		 * two checks of it without locking the shared relation.  Checking it
+		 * first avoids touching the shared relation which is already gone.
+		 */
+		if (pg_atomic_read_u64(&sr->generation) != reln->rsc_generation)
+		{
+			reln->rsc_ref = NULL;
+			return InvalidBlockNumber;
+		}
+
 		pg_read_barrier();
 
 		/* We can load int-sized values atomically without special measures. */
@@ -252,6 +281,16 @@ polar_rsc_search_by_mapping(SMgrRelation reln, ForkNumber forknum)
 	return result;
 }
 
+/*
+ * rsc_lru_pool_sweep
+ *
+ * Advance the clock hand until a shared relation whose usecount drops to
+ * zero is found, and return it locked.  The usecounts are decreased without
+ * locking the shared relations, they can be imprecise anyway, and a locked
+ * shared relation is skipped instead of waited for.  The hand moves at most
+ * polar_rsc_pool_sweep_times steps in each call, after that a random shared
+ * relation is taken, so a full pool never makes one backend walk all of it.
+ */
 static polar_rsc_shared_relation_t *
 rsc_lru_pool_sweep(void)
 {
@@ -260,27 +299,80 @@ rsc_lru_pool_sweep(void)
 	uint32		flags;
 	int			sr_used_count = 0;
 
-	for (;;)
+	while (sr_used_count++ < polar_rsc_pool_sweep_times)
 	{
-		/* Lock the next one in clock-hand order. */
 		index = pg_atomic_fetch_add_u32(&rsc_pool->next_sweep, 1) % polar_rsc_shared_relations;
 		sr = &rsc_pool->entries[index];
 
-		flags = polar_rsc_lock_entry(sr);
+		flags = pg_atomic_read_u32(&sr->flags);
+		if (flags & RSC_LOCKED)
+			continue;
 
-		if (--sr->usecount <= 0)
-			return sr;
-		if (++sr_used_count >= polar_rsc_pool_sweep_times)
-		{
-			polar_rsc_unlock_entry(sr, flags);
+		if ((flags & RSC_VALID) && --sr->usecount > 0)
+			continue;
 
-			sr = &rsc_pool->entries[random() % polar_rsc_shared_relations];
-			flags = polar_rsc_lock_entry(sr);
+		/* Looks like a victim, lock it and check again */
+		flags = polar_rsc_lock_entry(sr);
+		if (!(flags & RSC_VALID) || sr->usecount <= 0)
 			return sr;
-		}
 
 		polar_rsc_unlock_entry(sr, flags);
 	}
+
+	sr = &rsc_pool->entries[random() % polar_rsc_shared_relations];
+	polar_rsc_lock_entry(sr);
+	return sr;
+}
+
+/*
+ * Put the shared relation into the chain of its database partition, caller
+ * must hold the mapping lock of its rnode exclusively and the shared relation
+ * locked.
+ */
+static void
+rsc_db_link(polar_rsc_shared_relation_t *sr)
+{
+	polar_rsc_db_partition_t *part = RSC_DB_PARTITION(sr->rnode.dbNode);
+	int			index = sr - rsc_pool->entries;
+
+	Assert(!sr->db_linked);
+
+	SpinLockAcquire(&part->lock);
+	sr->db_prev = -1;
+	sr->db_next = part->head;
+	if (part->head >= 0)
+		rsc_pool->entries[part->head].db_prev = index;
+	part->head = index;
+	sr->db_linked = true;
+	SpinLockRelease(&part->lock);
+}
+
+/*
+ * Remove the shared relation from the chain of its database partition,
+ * caller must hold the mapping lock of its rnode exclusively and the shared
+ * relation locked while it's still valid.
+ */
+static void
+rsc_db_unlink(polar_rsc_shared_relation_t *sr)
+{
+	polar_rsc_db_partition_t *part;
+
+	if (!sr->db_linked)
+		return;
+
+	part = RSC_DB_PARTITION(sr->rnode.dbNode);
+
+	SpinLockAcquire(&part->lock);
+	if (sr->db_prev >= 0)
+		rsc_pool->entries[sr->db_prev].db_next = sr->db_next;
+	else
+		part->head = sr->db_next;
+	if (sr->db_next >= 0)
+		rsc_pool->entries[sr->db_next].db_prev = sr->db_prev;
+	sr->db_prev = -1;
+	sr->db_next = -1;
+	sr->db_linked = false;
+	SpinLockRelease(&part->lock);
 }
 
 static polar_rsc_shared_relation_t *
@@ -342,10 +434,13 @@ retry:
 
 	/*
 	 * Lock up the shared relation, and invalidate it for other processes by
-	 * bumping the generation.
+	 * bumping the generation.  Unlink it from its database chain before it
+	 * becomes invalid, otherwise a sweeping process could reuse and link it
+	 * to another chain under us.
 	 */
 	flags = polar_rsc_lock_entry(sr);
 	Assert(flags & RSC_VALID);
+	rsc_db_unlink(sr);
 	flags &= ~RSC_VALID;
 	pg_atomic_add_fetch_u64(&sr->generation, 1);
 	polar_rsc_unlock_entry(sr, flags);
@@ -510,6 +605,7 @@ rsc_evict:
 		pg_atomic_add_fetch_u64(&sr->generation, 1);
 		for (i = 0; i <= MAX_FORKNUM; i++)
 			sr->nblocks[i] = InvalidBlockNumber;
+		rsc_db_link(sr);
 		polar_rsc_unlock_entry(sr, RSC_VALID);
 		LWLockRelease(mapping_lock);
 
@@ -597,6 +693,15 @@ polar_rsc_update_if_exists_and_greater_than(RelFileNode *rnode,
 
 void
 polar_rsc_drop_entry(RelFileNode *rnode)
+{
+	rsc_drop_entry(rnode);
+}
+
+/*
+ * Drop the shared relation of rnode, return false if it's not in cache.
+ */
+static bool
+rsc_drop_entry(RelFileNode *rnode)
 {
 	polar_rsc_shared_relation_mapping_t *mapping;
 	polar_rsc_shared_relation_t *sr;
@@ -622,7 +727,8 @@ polar_rsc_drop_entry(RelFileNode *rnode)
 		Assert(flags & RSC_VALID);
 		for (forknum = 0; forknum <= MAX_FORKNUM; forknum++)
 			sr->nblocks[forknum] = InvalidBlockNumber;
-		/* Mark it invalid and drop the mapping. */
+		/* Unlink it while still valid, then mark it invalid. */
+		rsc_db_unlink(sr);
 		sr->usecount = 0;
 		polar_rsc_unlock_entry(sr, flags & ~RSC_VALID);
 
@@ -635,8 +741,17 @@ polar_rsc_drop_entry(RelFileNode *rnode)
 		pg_atomic_add_fetch_u64(&polar_rsc_global_stat->mapping_update_invalidate, 1);
 	}
 	LWLockRelease(mapping_lock);
+
+	return mapping != NULL;
 }
 
+/*
+ * polar_rsc_drop_entries
+ *
+ * Drop the shared relations of a database or a tablespace.  For a database,
+ * only the chain of its database partition is visited, in batches, because
+ * the spinlock of the partition can't be held while dropping.
+ */
 void
 polar_rsc_drop_entries(Oid dbnode, Oid spcnode)
 {
@@ -645,6 +760,37 @@ polar_rsc_drop_entries(Oid dbnode, Oid spcnode)
 	RelFileNode rnode;
 	polar_rsc_shared_relation_t *sr;
 
+	if (OidIsValid(dbnode) && !OidIsValid(spcnode))
+	{
+		polar_rsc_db_partition_t *part = RSC_DB_PARTITION(dbnode);
+		RelFileNode rnodes[RSC_DROP_BATCH_SIZE];
+		int			nrnodes;
+		int			ndropped;
+
+		do
+		{
+			nrnodes = 0;
+
+			SpinLockAcquire(&part->lock);
+			for (i = part->head; i >= 0 && nrnodes < RSC_DROP_BATCH_SIZE;
+				 i = rsc_pool->entries[i].db_next)
+			{
+				if (rsc_pool->entries[i].rnode.dbNode == dbnode)
+					rnodes[nrnodes++] = rsc_pool->entries[i].rnode;
+			}
+			SpinLockRelease(&part->lock);
+
+			ndropped = 0;
+			for (i = 0; i < nrnodes; i++)
+			{
+				if (rsc_drop_entry(&rnodes[i]))
+					ndropped++;
+			}
+		} while (ndropped > 0);
+
+		return;
+	}
+
 	for (i = 0; i < polar_rsc_shared_relations; i++)
 	{
 		sr = &rsc_pool->entries[i];
@@ -656,7 +802,7 @@ polar_rsc_drop_entries(Oid dbnode, Oid spcnode)
 		{
 			rnode = sr->rnode;
 			polar_rsc_unlock_entry(sr, flags);
-			polar_rsc_drop_entry(&rnode);
+			rsc_drop_entry(&rnode);
 		}
 		else
 			polar_rsc_unlock_entry(sr, flags);
@@ -684,6 +830,13 @@ polar_rsc_promote(void)
 	while ((mapping = hash_seq_search(&status)))
 		hash_search(rsc_mappings, &mapping->rnode, HASH_REMOVE, NULL);
 
+	for (i = 0; i < POLAR_RSC_DB_PARTITIONS; i++)
+	{
+		SpinLockAcquire(&rsc_pool->db_partitions[i].lock);
+		rsc_pool->db_partitions[i].head = -1;
+		SpinLockRelease(&rsc_pool->db_partitions[i].lock);
+	}
+
 	for (i = 0; i < polar_rsc_shared_relations; i++)
 	{
 		sr = &rsc_pool->entries[i];
@@ -692,6 +845,9 @@ polar_rsc_promote(void)
 
 		pg_atomic_add_fetch_u64(&sr->generation, 1);
 		sr->usecount = 0;
+		sr->db_linked = false;
+		sr->db_prev = -1;
+		sr->db_next = -1;
 		for (j = 0; j <= MAX_FORKNUM; j++)
 			sr->nblocks[j] = InvalidBlockNumber;
 
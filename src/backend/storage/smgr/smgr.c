@@ -71,6 +71,8 @@ typedef struct f_smgr
 										  BlockNumber blocknum, int blockCount, char *buffer, bool skipFsync);
 	void		(*polar_smgr_bulkread) (SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 										int blockCount, char *buffer);
+	void		(*polar_smgr_bulkwrite) (SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+										 int blockCount, char *buffer, bool skipFsync);
 	/* POLAR end */
 } f_smgr;
 
@@ -95,6 +97,7 @@ static const f_smgr smgrsw[] = {
 		/* POLAR: extend io */
 		.polar_smgr_bulkextend = polar_mdbulkextend,
 		.polar_smgr_bulkread = polar_mdbulkread,
+		.polar_smgr_bulkwrite = polar_mdbulkwrite,
 		/* POLAR end */
 	}
 };
@@ -617,6 +620,23 @@ polar_smgrbulkread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	smgrsw[reln->smgr_which].polar_smgr_bulkread(reln, forknum, blocknum, blockCount, buffer);
 }
 
+/*
+ *	polar_smgrbulkwrite() -- Write the supplied buffer out to multi adjacent
+ *						   blocks of a relation.
+ *
+ *		All blocks must be in the same segment and exist already, see
+ *		smgrwrite().
+ */
+void
+polar_smgrbulkwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+					int blockCount, char *buffer, bool skipFsync)
+{
+	Assert(blockCount >= 1);
+
+	smgrsw[reln->smgr_which].polar_smgr_bulkwrite(reln, forknum, blocknum, blockCount,
+												  buffer, skipFsync);
+}
+
 /*
  *	smgrprefetch() -- Initiate asynchronous read of the specified block of a relation.
  *
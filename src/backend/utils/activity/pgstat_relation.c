@@ -819,6 +819,7 @@ pgstat_relation_flush_cb(PgStat_EntryRef *entry_ref, bool nowait)
 	tabentry->polar_bulk_read_calls += lstats->t_counts.polar_t_bulk_read_calls;
 	tabentry->polar_bulk_read_calls_IO += lstats->t_counts.polar_t_bulk_read_calls_IO;
 	tabentry->polar_bulk_read_blocks_IO += lstats->t_counts.polar_t_bulk_read_blocks_IO;
+	tabentry->polar_bulk_read_blocks_prefetch += lstats->t_counts.polar_t_bulk_read_blocks_prefetch;
 
 	/* POLAR: create index bulk extend */
 	tabentry->polar_bulk_create_index_extends_times += lstats->t_counts.polar_t_bulk_create_index_extends_times;
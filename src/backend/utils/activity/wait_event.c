@@ -259,6 +259,9 @@ pgstat_get_wait_activity(WaitEventActivity w)
 		case WAIT_EVENT_ASYNC_LOCK_REPLAY_MAIN:
 			event_name = "AsyncLockReplayMain";
 			break;
+		case WAIT_EVENT_POLAR_PREFETCH_MAIN:
+			event_name = "PolarPrefetchMain";
+			break;
 			/* POLAR end */
 			/* no default case, so that compiler will warn */
 	}
@@ -125,6 +125,7 @@
 #include "commands/tablecmds.h"
 #include "common/username.h"
 #include "storage/polar_fd.h"
+#include "storage/polar_prefetch.h"
 #include "storage/polar_rsc.h"
 #include "storage/polar_xlogbuf.h"
 #include "utils/polar_local_cache.h"
@@ -178,6 +179,9 @@ char	   *GUC_check_errhint_string;
 
 /* POLAR: buffer manager */
 bool		polar_enable_strategy_reject_buffer;
+bool		polar_enable_buffer_2q;
+int			polar_buffer_sweep_partitions;
+bool		polar_enable_buffer_lockfree_lookup;
 bool		polar_hot_standby_enable_vm;
 bool		polar_enable_control_vm_flush;
 bool		polar_force_flush_buffer;
@@ -197,6 +201,12 @@ int			polar_parallel_new_bgwriter_threshold_lag;
 int			polar_parallel_new_bgwriter_threshold_time;
 int			polar_bgwriter_flush_batch_size;
 int			polar_bgwriter_batch_size;
+int			polar_bgwriter_max_coalesce_size;
+int			polar_bgwriter_target_lag;
+double		polar_bgwriter_target_clean_ratio;
+double		polar_bgwriter_control_kp;
+double		polar_bgwriter_control_ki;
+double		polar_bgwriter_control_kd;
 int			polar_lru_bgwriter_max_pages;
 int			polar_lru_batch_pages;
 int			polar_parallel_bgwriter_delay;
@@ -868,6 +878,7 @@ int			polar_min_bulk_extend_table_size = 0;
 bool		polar_enable_primary_recovery_bulk_extend = false;
 int			polar_bulk_extend_size = 0;
 int			polar_bulk_read_size = 0;
+int			polar_bulk_read_prefetch_distance = 64;
 int			polar_index_bulk_extend_size = 0;
 int			polar_index_create_bulk_extend_size = 0;
 
@@ -1316,6 +1327,16 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"polar_enable_parallel_replay_work_steal", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Enable idle parallel replay process to steal task from other processes."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_enable_parallel_replay_work_steal,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"polar_enable_replica_copydata_optimization", PGC_POSTMASTER, UNGROUPED,
 			gettext_noop("Enable copydata optimization when replica satrts."),
@@ -1455,6 +1476,28 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_enable_buffer_2q", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Evict shared buffers which are not referenced again since loaded first, like 2Q."),
+			gettext_noop("This keeps frequently used pages from being pushed out by large scans."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_enable_buffer_2q,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"polar_enable_buffer_lockfree_lookup", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Lookup shared buffers without taking the buffer mapping lock."),
+			gettext_noop("A lock-free copy of the buffer mapping table is kept in shared memory for lookups."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_UNCHANGABLE
+		},
+		&polar_enable_buffer_lockfree_lookup,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"polar_hot_standby_enable_vm", PGC_SIGHUP, UNGROUPED,
 			gettext_noop("Enable use visibilitymap when in hot_standby mode."),
@@ -3066,6 +3109,17 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_logindex_compress_table", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Save logindex table to segment file in compressed format."),
+			gettext_noop("Both compressed and uncompressed tables can be read whatever it is."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_logindex_compress_table,
+		false,
+		NULL, NULL, NULL
+	},
+
 
 	/* POLAR bool GUCs end */
 
@@ -3298,6 +3352,28 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_bgwriter_max_coalesce_size", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the max number of adjacent blocks bgwriter writes with one write, 0 or 1 turns off the write coalescing."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_max_coalesce_size,
+		0, 0, POLAR_MAX_BULK_IO_SIZE,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"polar_bgwriter_target_lag", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the consistent lsn lag which the parallel bgwriters are controlled to, 0 turns off the controller."),
+			NULL,
+			GUC_UNIT_MB | POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_target_lag,
+		0, 0, INT_MAX / 2,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"polar_lru_bgwriter_max_pages", PGC_SIGHUP, RESOURCES_BGWRITER,
 			gettext_noop("Sets max pages lru writer to scan."),
@@ -3439,6 +3515,16 @@ static struct config_int ConfigureNamesInt[] =
 		2, 0, INT_MAX / 2,
 		NULL, NULL, NULL
 	},
+	{
+		{"polar_logindex_record_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of shared cache for decoded xlog records used to replay pages. 0 means disabled."),
+			NULL,
+			GUC_UNIT_MB | POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_logindex_record_cache_size,
+		8, 0, 1024,
+		NULL, NULL, NULL
+	},
 	{
 		{"polar_logindex_mem_size", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Set the size for logindex memory table."),
@@ -3507,6 +3593,17 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_parallel_replay_prefetch_distance", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Set the number of pages to prefetch ahead of the dispatched tasks when do parallel replay."),
+			gettext_noop("The pages are read by prefetch workers, see polar_prefetch_workers. Zero disables prefetching."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_parallel_replay_prefetch_distance,
+		256, 0, 65536,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"polar_write_logindex_active_table_delay", PGC_SIGHUP, UNGROUPED,
 			gettext_noop("Time between walwriter write active logindex table."),
@@ -3562,6 +3659,30 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_logindex_search_fanout", PGC_SIGHUP, UNGROUPED,
+			gettext_noop("Set the max number of logindex file tables which are searched in one batch by page iterator."),
+			gettext_noop("Bloom data of these tables is checked together with one bloom page read. "
+						 "1 means to search file tables one by one."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_logindex_search_fanout,
+		1, 1, POLAR_LOGINDEX_MAX_SEARCH_FANOUT,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"polar_logindex_max_overflow_tables", PGC_SIGHUP, RESOURCES_MEM,
+			gettext_noop("Set the max number of logindex overflow tables which are allocated from dynamic shared memory."),
+			gettext_noop("When the memory table to be reused is not saved yet, it's moved to an overflow table "
+						 "instead of waiting for saving it. 0 disables overflow tables."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_logindex_max_overflow_tables,
+		0, 0, POLAR_LOGINDEX_MAX_OVERFLOW_TABLES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"polar_multixact_max_local_cache_segments", PGC_POSTMASTER, UNGROUPED,
 			gettext_noop("Set the maximum number of local segment file cache for multixact."),
@@ -3750,6 +3871,39 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"polar_bulk_read_prefetch_distance", PGC_USERSET, POLAR_BULK_READ_EXTEND,
+			gettext_noop("Sets the number of blocks to prefetch ahead of the scan position of bulk read."),
+			gettext_noop("Only sequential heap scans prefetch, the blocks are read by prefetch workers, see polar_prefetch_workers. Zero disables prefetching."),
+			GUC_UNIT_BLOCKS | POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bulk_read_prefetch_distance,
+		64, 0, RELSEG_SIZE,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"polar_prefetch_workers", PGC_POSTMASTER, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Sets the number of background workers which read blocks into shared buffers ahead of their users."),
+			gettext_noop("Parallel replay and sequential scans queue the blocks they will read for these workers. Zero disables prefetching."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_prefetch_workers,
+		0, 0, POLAR_MAX_PREFETCH_WORKERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"polar_buffer_sweep_partitions", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the number of clock sweep hands of shared buffers."),
+			gettext_noop("Each hand sweeps its own part of shared buffers, so backends don't contend on one hand."),
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_buffer_sweep_partitions,
+		1, 1, POLAR_MAX_SWEEP_PARTITIONS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"polar_xlog_page_buffers", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Sets the size of xlog buffer used by multi processes."),
@@ -5425,6 +5579,18 @@ static struct config_int ConfigureNamesInt[] =
 		POLAR_DEFAULT_XLOG_FILL_ZERO_SIZE, POLAR_MIN_XLOG_FILL_ZERO_SIZE, POLAR_MAX_XLOG_FILL_ZERO_SIZE,
 		NULL, NULL, NULL
 	},
+	{
+		{"polar_group_commit_target_latency", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Sets the target commit latency in microseconds of adaptive group commit."),
+			gettext_noop("When set, the delay before flushing WAL is derived from the measured "
+						 "flush latency and commit rate instead of commit_delay. 0 turns it off."),
+			POLAR_GUC_IS_CHANGABLE | POLAR_GUC_IS_INVISIBLE
+			/* we have no microseconds designation, so can't supply units here */
+		},
+		&polar_group_commit_target_latency,
+		0, 0, 1000000,
+		NULL, NULL, NULL
+	},
 	{
 		{"polar_instance_spec_mem", PGC_SIGHUP, DEVELOPER_OPTIONS,
 			gettext_noop("PolarDB instance specification for memory."),
@@ -5482,6 +5648,46 @@ static struct config_real ConfigureNamesReal[] =
 		0.2, 0.0, 0.4,
 		NULL, NULL, NULL
 	},
+	{
+		{"polar_bgwriter_target_clean_ratio", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the ratio of buffers cleaned ahead of clock sweep which the parallel bgwriters are controlled to, 0 means not controlled."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_target_clean_ratio,
+		0.0, 0.0, 1.0,
+		NULL, NULL, NULL
+	},
+	{
+		{"polar_bgwriter_control_kp", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the proportional gain of the parallel bgwriter controller."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_control_kp,
+		1.0, 0.0, 100.0,
+		NULL, NULL, NULL
+	},
+	{
+		{"polar_bgwriter_control_ki", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the integral gain of the parallel bgwriter controller."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_control_ki,
+		0.1, 0.0, 100.0,
+		NULL, NULL, NULL
+	},
+	{
+		{"polar_bgwriter_control_kd", PGC_SIGHUP, RESOURCES_BGWRITER,
+			gettext_noop("Sets the derivative gain of the parallel bgwriter controller."),
+			NULL,
+			POLAR_GUC_IS_INVISIBLE | POLAR_GUC_IS_CHANGABLE
+		},
+		&polar_bgwriter_control_kd,
+		0.0, 0.0, 100.0,
+		NULL, NULL, NULL
+	},
 	{
 		{"polar_instance_spec_cpu", PGC_SIGHUP, DEVELOPER_OPTIONS,
 			gettext_noop("PolarDB instance specification for cpu."),
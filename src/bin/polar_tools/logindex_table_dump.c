@@ -48,8 +48,10 @@ logindex_table_main(int argc, char **argv)
 	FILE	   *fp = NULL;
 	bool		succeed = false;
 	log_idx_table_data_t *table = NULL;
+	char	   *buf = NULL;
 	pg_crc32	crc;
-	int			ret;
+	size_t		ret = 0;
+	off_t		offset;
 
 	if (argc <= 1)
 	{
@@ -75,7 +77,8 @@ logindex_table_main(int argc, char **argv)
 	}
 
 	table = malloc(sizeof(log_idx_table_data_t));
-	if (!table)
+	buf = malloc(sizeof(log_idx_table_data_t));
+	if (!table || !buf)
 		goto end;
 
 	if (file_path == NULL)
@@ -88,21 +91,57 @@ logindex_table_main(int argc, char **argv)
 		goto end;
 	}
 
-	while ((ret = fread(table, 1, sizeof(log_idx_table_data_t), fp)) == sizeof(log_idx_table_data_t))
+	/*
+	 * Each table is saved in fixed position of the file, while compressed
+	 * table only occupies the head part of its position.
+	 */
+	for (offset = 0;; offset += sizeof(log_idx_table_data_t))
 	{
-		crc = table->crc;
-		table->crc = 0;
-		table->crc = log_index_calc_crc((unsigned char *) table, sizeof(log_idx_table_data_t));
+		const char *format;
+		uint32		size;
 
-		if (crc != table->crc)
-			fprintf(stderr, "The table crc is incorrect, got %u, expect %u\n", table->crc, crc);
+		if (fseeko(fp, offset, SEEK_SET) != 0)
+			break;
 
-		printf("idx_table_id=%ld min_lsn=%lX max_lsn=%lX prefix_lsn=%X crc=%u last_order=%u\n",
+		ret = fread(buf, 1, sizeof(log_idx_table_data_t), fp);
+
+		if (ret == 0)
+			break;
+
+		if (ret >= sizeof(log_idx_table_zip_header_t) && LOG_INDEX_TABLE_IS_ZIP(buf))
+		{
+			size = ((log_idx_table_zip_header_t *) buf)->size;
+			format = "compressed";
+
+			if (!log_index_decompress_table(buf, ret, table))
+			{
+				fprintf(stderr, "Failed to decompress table at offset %lu, size %u\n",
+						(unsigned long) offset, size);
+				continue;
+			}
+		}
+		else if (ret == sizeof(log_idx_table_data_t))
+		{
+			size = sizeof(log_idx_table_data_t);
+			format = "raw";
+			memcpy(table, buf, sizeof(log_idx_table_data_t));
+
+			crc = table->crc;
+			table->crc = 0;
+			table->crc = log_index_calc_crc((unsigned char *) table, sizeof(log_idx_table_data_t));
+
+			if (crc != table->crc)
+				fprintf(stderr, "The table crc is incorrect, got %u, expect %u\n", table->crc, crc);
+		}
+		else
+			break;
+
+		printf("idx_table_id=%ld min_lsn=%lX max_lsn=%lX prefix_lsn=%X crc=%u last_order=%u format=%s size=%u\n",
 			   table->idx_table_id, table->min_lsn, table->max_lsn, table->prefix_lsn,
-			   table->crc, table->last_order);
+			   table->crc, table->last_order, format, size);
 	}
 
-	if ((ret > 0 && ret != sizeof(log_idx_table_data_t)) || errno != 0)
+	if (ferror(fp) || (ret > 0 && ret != sizeof(log_idx_table_data_t) && !LOG_INDEX_TABLE_IS_ZIP(buf)))
 	{
 		fprintf(stderr, "Failed to read logindex table, errno=%d\n", errno);
 		goto end;
@@ -120,5 +159,8 @@ end:
 	if (table)
 		free(table);
 
+	if (buf)
+		free(buf);
+
 	return succeed ? 0 : -1;
 }
@@ -1068,6 +1068,9 @@ typedef struct BTScanOpaqueData
 	 */
 	int			markItemIndex;	/* itemIndex, or -1 if not valid */
 
+	/* POLAR: index size used by bulk read, or InvalidBlockNumber if unknown */
+	BlockNumber polar_nblocks;
+
 	/* keep these last in struct for efficiency */
 	BTScanPosData currPos;		/* current position data */
 	BTScanPosData markPos;		/* marked position, if any */
@@ -74,6 +74,15 @@ typedef enum
 extern int	polar_logindex_table_batch_size;
 extern int	polar_max_logindex_files;
 extern int	polar_trace_logindex_messages;
+extern int	polar_logindex_search_fanout;
+extern bool polar_logindex_compress_table;
+extern int	polar_logindex_max_overflow_tables;
+
+/* Max number of file tables which page iterator searches in one batch */
+#define POLAR_LOGINDEX_MAX_SEARCH_FANOUT (64)
+
+/* Max number of overflow tables for each logindex snapshot */
+#define POLAR_LOGINDEX_MAX_OVERFLOW_TABLES (1024)
 
 extern Size polar_logindex_shmem_size(uint64 logindex_mem_tbl_size, int bloom_blocks);
 
@@ -86,6 +95,8 @@ extern void polar_logindex_create_local_cache(logindex_snapshot_t logindex_snaps
 extern MemoryContext polar_logindex_memory_context(void);
 extern uint64 polar_logindex_mem_tbl_size(logindex_snapshot_t logindex_snapshot);
 extern uint64 polar_logindex_used_mem_tbl_size(logindex_snapshot_t logindex_snapshot);
+extern uint64 polar_logindex_overflow_tbl_size(logindex_snapshot_t logindex_snapshot);
+extern uint64 polar_logindex_overflow_count(logindex_snapshot_t logindex_snapshot);
 extern void polar_logindex_set_start_lsn(logindex_snapshot_t logindex_snapshot, XLogRecPtr start_lsn);
 extern XLogRecPtr polar_logindex_snapshot_init(logindex_snapshot_t logindex_snapshot, XLogRecPtr checkpoint_lsn,
 											   TimeLineID checkpoint_tli, bool read_only, bool flush_active_table);
@@ -35,6 +35,7 @@
 #include "storage/polar_fd.h"
 #include "storage/shmem.h"
 #include "storage/spin.h"
+#include "utils/dsa.h"
 #include "utils/guc.h"
 #include "utils/hsearch.h"
 #include "utils/palloc.h"
@@ -57,7 +58,6 @@
 /* Define macro for const config value */
 #define LOG_INDEX_MEM_TBL_SEG_NUM           4096
 #define LOG_INDEX_MEM_TBL_HASH_NUM          (LOG_INDEX_MEM_TBL_SEG_NUM/2)
-#define LOG_INDEX_MEM_TBL_HASH_LOCK_NUM     (LOG_INDEX_MEM_TBL_HASH_NUM/64)
 #define LOG_INDEX_MEM_TBL_HASH_PAGE(tag) \
 	(tag_hash(tag, sizeof(BufferTag)) % LOG_INDEX_MEM_TBL_HASH_NUM)
 
@@ -95,6 +95,15 @@
 #define LOG_INDEX_MEM_ITEM_IS(item, page_tag) \
 	(memcmp(&(item)->tag, page_tag, sizeof(BufferTag)) == 0)
 
+/*
+ * Hash slots of memory table are folded into cache line sized tag buckets.
+ */
+#define LOG_INDEX_TAG_BUCKET_SIZE           64
+#define LOG_INDEX_TAG_BUCKET_SLOTS          16
+#define LOG_INDEX_TAG_BUCKET_NUM            (LOG_INDEX_MEM_TBL_HASH_NUM/4)
+#define LOG_INDEX_TAG_BUCKET_NO(key)        ((key) % LOG_INDEX_TAG_BUCKET_NUM)
+#define LOG_INDEX_TAG_BUCKET(t, key)        (&(t)->tag_bucket[LOG_INDEX_TAG_BUCKET_NO(key)].bucket)
+
 #define LOG_INDEX_ITEM_SEG(t, seg) \
 	(((seg) == LOG_INDEX_TBL_INVALID_SEG) ? NULL : \
 	 &((t)->segment[(seg)-1].item_seg))
@@ -203,22 +212,27 @@
 /*
  * 1. Each memory table has one lwlock
  * 2. One lwlock for lru
- * 3. The hash lock size is LOG_INDEX_MEM_TBL_HASH_LOCK_NUM
- * 4. One lwlock for logindex meta io
- * 5. lwlock for flush active tbl, only used by fullpage snapshot now
+ * 3. One lwlock for logindex meta io
+ * 4. lwlock for flush active tbl, only used by fullpage snapshot now
+ * 5. One lwlock for overflow tables
+ *
+ * There's no lock for hash slots of active memory table. Only one process
+ * inserts lsn, and it fills a new item, segment or lsn before publishing it
+ * to the hash slot, tail_seg or number with a write barrier, so readers
+ * search the active table without lock.
  */
 #define LOG_INDEX_LWLOCK_NUM(mem_tbl_size) \
 	(mem_tbl_size + \
 	 1 + \
-	 LOG_INDEX_MEM_TBL_HASH_LOCK_NUM + \
+	 1 + \
 	 1 + \
 	 1)
 
 #define LOG_INDEX_MEMTBL_LOCK_OFFSET                (0)
 #define LOG_INDEX_BLOOM_LRU_LOCK_OFFSET             (LOG_INDEX_MEMTBL_LOCK_OFFSET + logindex_snapshot->mem_tbl_size)
-#define LOG_INDEX_HASH_LOCK_OFFSET                  (LOG_INDEX_BLOOM_LRU_LOCK_OFFSET + 1)
-#define LOG_INDEX_IO_LOCK_OFFSET                    (LOG_INDEX_HASH_LOCK_OFFSET + LOG_INDEX_MEM_TBL_HASH_LOCK_NUM)
+#define LOG_INDEX_IO_LOCK_OFFSET                    (LOG_INDEX_BLOOM_LRU_LOCK_OFFSET + 1)
 #define LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK_OFFSET      (LOG_INDEX_IO_LOCK_OFFSET + 1)
+#define LOG_INDEX_OVERFLOW_LOCK_OFFSET              (LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK_OFFSET + 1)
 
 #define LOG_INDEX_MEM_TBL_ARRAY_INDEX(t)            ((t) - logindex_snapshot->mem_table)
 
@@ -231,13 +245,12 @@
 #define LOG_INDEX_BLOOM_LRU_LOCK                    \
 	(&(logindex_snapshot->lwlock_array[LOG_INDEX_BLOOM_LRU_LOCK_OFFSET].lock))
 
-#define LOG_INDEX_HASH_LOCK(k)                      \
-	(&(logindex_snapshot->lwlock_array[((k) % LOG_INDEX_MEM_TBL_HASH_LOCK_NUM) + LOG_INDEX_HASH_LOCK_OFFSET].lock))
-
 #define LOG_INDEX_IO_LOCK                     \
 	(&(logindex_snapshot->lwlock_array[LOG_INDEX_IO_LOCK_OFFSET].lock))
 #define LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK                     \
 	(&(logindex_snapshot->lwlock_array[LOG_INDEX_FLUSH_ACTIVE_TBL_LOCK_OFFSET].lock))
+#define LOG_INDEX_OVERFLOW_LOCK                     \
+	(&(logindex_snapshot->lwlock_array[LOG_INDEX_OVERFLOW_LOCK_OFFSET].lock))
 
 #define LOG_INDEX_COPY_LSN_INFO(lsn_info, table, item, idx) \
 	do \
@@ -318,14 +331,83 @@ typedef struct log_idx_table_data_t
 	log_tbl_seg_t segment[LOG_INDEX_MEM_TBL_SEG_NUM];
 }			log_idx_table_data_t;
 
+/*
+ * Compressed table is saved in the same position of segment file as the
+ * uncompressed one, and it only occupies the head part of its position.
+ * The header is followed by idx_order, hash slots and segments, which are
+ * encoded as varint with lsn saved as delta to the previous one.
+ */
+#define LOG_INDEX_TABLE_ZIP_MAGIC           (0xC0DE1DB5)
+#define LOG_INDEX_TABLE_ZIP_READ_SIZE       (BLCKSZ)
+
+typedef struct log_idx_table_zip_header_t
+{
+	uint32		magic;
+	uint32		size;			/* size of header and encoded data */
+	pg_crc32	crc;			/* crc of header and encoded data */
+	pg_crc32	table_crc;		/* crc of the uncompressed table */
+	log_idx_table_id_t idx_table_id;
+	XLogRecPtr	min_lsn;
+	XLogRecPtr	max_lsn;
+	uint32		prefix_lsn;
+	uint32		last_order;
+	uint32		seg_num;		/* number of encoded segments */
+}			log_idx_table_zip_header_t;
+
+#define LOG_INDEX_TABLE_IS_ZIP(data) \
+	(((log_idx_table_zip_header_t *) (data))->magic == LOG_INDEX_TABLE_ZIP_MAGIC)
+
+/*
+ * Each item head of memory table is recorded in the tag bucket of its hash
+ * slot with one byte fingerprint. The fingerprint mixes the page tag hash
+ * with the slot position inside the bucket, so a fingerprint match is always
+ * an item of the searched slot. When the bucket is full, the new item is only
+ * linked in the hash slot and overflow is set, so searcher has to fall back
+ * to walk the item list.
+ */
+typedef struct log_tag_bucket_t
+{
+	uint8		fp[LOG_INDEX_TAG_BUCKET_SLOTS];
+	log_seg_id_t item[LOG_INDEX_TAG_BUCKET_SLOTS];
+	uint8		number;
+	bool		overflow;
+}			log_tag_bucket_t;
+
+typedef union log_tag_bucket_padded_t
+{
+	log_tag_bucket_t bucket;
+	char		padding[LOG_INDEX_TAG_BUCKET_SIZE];
+}			log_tag_bucket_padded_t;
+
 typedef struct log_mem_table_t
 {
 	log_seg_id_t free_head;
 	pg_atomic_uint32 state;
 	/* The following data will be saved to file */
 	log_idx_table_data_t data;
+	/* Tag buckets are only kept in memory and rebuilt after table is loaded */
+	log_tag_bucket_padded_t tag_bucket[LOG_INDEX_TAG_BUCKET_NUM];
 }			log_mem_table_t;
 
+/*
+ * When the memory table which is going to be reused is not saved yet, its
+ * content can be moved to an overflow table allocated from dsa, so the
+ * inserting process doesn't have to wait for saving it. Overflow tables are
+ * always the oldest unsaved tables, and they are saved and freed before any
+ * memory table is saved.
+ */
+#define LOG_INDEX_MAX_OVERFLOW_TBL_NUM      POLAR_LOGINDEX_MAX_OVERFLOW_TABLES
+
+typedef struct log_index_overflow_t
+{
+	log_idx_table_id_t min_tid; /* Table id of the first overflow table */
+	uint32		head;			/* Array index of the first overflow table */
+	uint32		num;			/* Number of overflow tables */
+	XLogRecPtr	max_lsn;		/* Max lsn of the last overflow table */
+	uint64		overflow_count; /* Times of moving table to overflow table */
+	dsa_pointer table[LOG_INDEX_MAX_OVERFLOW_TBL_NUM];
+}			log_index_overflow_t;
+
 typedef struct log_file_table_bloom_t
 {
 	log_idx_table_id_t idx_table_id;
@@ -388,6 +470,8 @@ typedef struct log_index_snapshot_t
 	uint64		max_allocated_seg_no;
 	polar_local_cache segment_cache;
 	struct Latch *bg_worker_latch;
+	char	   *overflow_area;	/* Place of dsa area for overflow tables */
+	log_index_overflow_t overflow;
 	log_mem_table_t mem_table[FLEXIBLE_ARRAY_MEMBER];
 }			log_index_snapshot_t;
 
@@ -474,6 +558,8 @@ log_index_calc_crc(unsigned char *data, size_t size)
 }
 
 extern log_item_head_t * log_index_tbl_find(BufferTag *tag, log_idx_table_data_t * table, uint32 key);
+extern log_item_head_t * log_index_mem_tbl_find(BufferTag *tag, log_mem_table_t * table, uint32 key);
+extern void log_index_mem_tbl_build_tag_bucket(log_mem_table_t * table);
 extern void log_index_insert_lsn(logindex_snapshot_t logindex_snapshot, log_index_lsn_t * lsn_info, uint32 key);
 extern XLogRecPtr log_index_item_max_lsn(log_idx_table_data_t * table, log_item_head_t * item);
 extern pg_crc32 log_index_calc_crc(unsigned char *data, size_t size);
@@ -485,6 +571,11 @@ extern log_file_table_bloom_t * log_index_get_tbl_bloom(logindex_snapshot_t logi
 extern bool log_index_get_meta(logindex_snapshot_t logindex_snapshot, log_index_meta_t * meta);
 extern void log_index_force_save_table(logindex_snapshot_t logindex_snapshot, log_mem_table_t * table);
 extern bool log_index_read_table_data(logindex_snapshot_t logindex_snapshot, log_idx_table_data_t * table, log_idx_table_id_t tid, int elevel);
+extern log_idx_table_data_t * log_index_read_overflow_table(logindex_snapshot_t logindex_snapshot, log_idx_table_id_t tid);
+extern void log_index_overflow_extend_meta(logindex_snapshot_t logindex_snapshot, log_index_meta_t * meta);
+
+extern uint32 log_index_compress_table(log_idx_table_data_t * table, char *buf);
+extern bool log_index_decompress_table(char *buf, uint32 size, log_idx_table_data_t * table);
 
 extern XLogRecPtr log_index_get_order_lsn(log_idx_table_data_t * table, uint32 order, log_index_lsn_t * lsn_info);
 
@@ -28,6 +28,7 @@
 #include "access/polar_logindex.h"
 #include "access/polar_mini_transaction.h"
 #include "access/polar_queue_manager.h"
+#include "access/polar_record_cache.h"
 #include "access/polar_rel_size_cache.h"
 #include "access/xlogreader.h"
 #include "catalog/pg_control.h"
@@ -36,9 +37,11 @@
 
 extern int	polar_logindex_mem_size;
 extern bool polar_enable_parallel_replay_standby_mode;
+extern bool polar_enable_parallel_replay_work_steal;
 extern bool polar_enable_replica_prewarm;
 extern int	polar_parallel_replay_task_queue_depth;
 extern int	polar_parallel_replay_proc_num;
+extern int	polar_parallel_replay_prefetch_distance;
 extern int	polar_logindex_max_local_cache_segments;
 extern int	polar_write_logindex_active_table_delay;
 extern int	polar_wait_old_version_page_timeout;
@@ -46,6 +49,7 @@ extern int	polar_bg_replay_batch_size;
 extern bool polar_enable_resolve_conflict;
 extern int	polar_logindex_bloom_blocks;
 extern int	polar_rel_size_cache_blocks;
+extern int	polar_logindex_record_cache_size;
 extern bool polar_force_change_checkpoint;
 extern bool polar_enable_fullpage_snapshot;
 extern int	polar_startup_replay_delay_size;
@@ -77,6 +81,7 @@ typedef struct polar_logindex_redo_ctl_data_t
 	logindex_snapshot_t fullpage_logindex_snapshot;
 	polar_ringbuf_t xlog_queue;
 	polar_rel_size_cache_t rel_size_cache;
+	polar_record_cache_t record_cache;
 
 	XLogRecPtr	xlog_replay_from;	/* Record the start lsn we replayed from. */
 
@@ -133,6 +138,14 @@ typedef struct polar_logindex_bg_redo_ctl_t
 	XLogReaderState *state;
 	XLogRecPtr	max_dispatched_lsn; /* The max lsn value which dispatched to
 									 * replay */
+	int32		dispatched_proc;	/* The process which max_dispatched_lsn
+									 * is dispatched to */
+	uint64		dispatched_num; /* The number of dispatched pages */
+	log_index_lsn_iter_t prefetch_iter; /* the iterator to prefetch pages
+										 * ahead of lsn_iter */
+	log_index_lsn_t *prefetch_page; /* current page need to prefetch */
+	uint64		prefetched_num; /* The number of pages passed by
+								 * prefetch_iter */
 	polar_task_sched_ctl_t *sched_ctl;
 } polar_logindex_bg_redo_ctl_t;
 
@@ -295,6 +308,7 @@ extern polar_logindex_bg_redo_ctl_t *polar_create_bg_redo_ctl(polar_logindex_red
 extern void polar_release_bg_redo_ctl(polar_logindex_bg_redo_ctl_t *ctl);
 extern void polar_reset_bg_replayed_lsn(polar_logindex_redo_ctl_t instance, XLogRecPtr oldest_redo_ptr);
 extern void polar_logindex_promote_xlog_queue(polar_logindex_redo_ctl_t instance);
+extern void polar_logindex_record_cache_invalidate(polar_logindex_redo_ctl_t instance);
 extern void polar_online_promote_data(polar_logindex_redo_ctl_t instance);
 extern void polar_standby_promote_data(polar_logindex_redo_ctl_t instance);
 extern void polar_wait_logindex_bg_stop_replay(polar_logindex_redo_ctl_t instance, Latch *latch);
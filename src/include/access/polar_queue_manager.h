@@ -54,6 +54,12 @@ extern int	polar_xlog_queue_buffers;
 #define POLAR_XLOG_QUEUE_RESERVE(queue, size) \
 	polar_ringbuf_pkt_reserve((queue), POLAR_XLOG_PKT_SIZE(size))
 
+#define POLAR_XLOG_QUEUE_RESERVE_NOSTAT(queue, size) \
+	polar_ringbuf_pkt_reserve_nostat((queue), POLAR_XLOG_PKT_SIZE(size))
+
+#define POLAR_XLOG_QUEUE_RESERVE_STAT(queue, size) \
+	polar_ringbuf_pkt_reserve_stat((queue), POLAR_XLOG_PKT_SIZE(size))
+
 #define POLAR_XLOG_QUEUE_DATA_KEEP_RATIO (0.6)
 
 #define POLAR_COPY_QUEUE_CONTENT(ref, offset, _dst, _size) \
@@ -76,6 +82,10 @@ extern void polar_standby_xlog_send_queue_push(polar_ringbuf_t queue, XLogReader
 extern Size polar_xlog_reserve_size(XLogRecData *rdata);
 
 extern ssize_t polar_xlog_send_queue_raw_data_pop(polar_ringbuf_ref_t *ref, uint8 *data, size_t size, XLogRecPtr *max_lsn);
+extern ssize_t polar_xlog_send_queue_raw_data_peek(polar_ringbuf_ref_t *ref, struct iovec *iov,
+												   int max_iov, int *iovcnt, size_t size,
+												   XLogRecPtr *max_lsn, int *npkts, size_t *next_pread);
+extern void polar_xlog_send_queue_raw_data_release(polar_ringbuf_ref_t *ref, int npkts, size_t next_pread);
 
 extern DecodedXLogRecord *polar_xlog_send_queue_record_pop(polar_ringbuf_t queue, XLogReaderState *state);
 extern void polar_xlog_send_queue_keep_data(polar_ringbuf_t queue);
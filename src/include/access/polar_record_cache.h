@@ -0,0 +1,83 @@
+/*-------------------------------------------------------------------------
+ *
+ * polar_record_cache.h
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/include/access/polar_record_cache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef POLAR_RECORD_CACHE_H
+#define POLAR_RECORD_CACHE_H
+
+#include "access/xlogreader.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+
+/*
+ * The decoded record cache keeps DecodedXLogRecord which is decoded when
+ * replay page, so the other process which replay the same record can copy
+ * it instead of reading and decoding it again. The cache is divided into
+ * partitions by the lsn of record, and each partition has its own lock,
+ * hash buckets and LRU list.
+ */
+#define POLAR_RECORD_CACHE_PARTITIONS   (16)
+#define POLAR_RECORD_CACHE_SLOT_SIZE    (BLCKSZ)
+#define POLAR_RECORD_CACHE_INVALID_SLOT (-1)
+
+typedef struct polar_record_cache_slot_t
+{
+	XLogRecPtr	lsn;			/* InvalidXLogRecPtr if this slot is free */
+	int32		hash_next;		/* Next slot in the same hash bucket */
+	int32		lru_prev;		/* Previous slot in LRU list */
+	int32		lru_next;		/* Next slot in LRU list or free list */
+	uint32		size;			/* Size of the decoded record */
+} polar_record_cache_slot_t;
+
+typedef struct polar_record_cache_partition_t
+{
+	polar_lwlock_mini_padded lock;
+	int32		first_slot;		/* Slots from first_slot belong to this
+								 * partition */
+	int32		slot_num;
+	int32		lru_head;		/* The most recently used slot */
+	int32		lru_tail;		/* The least recently used slot */
+	int32		free_head;
+} polar_record_cache_partition_t;
+
+typedef struct polar_record_cache_data_t
+{
+	int32		slot_num;
+	pg_atomic_uint64 hit;
+	pg_atomic_uint64 miss;
+	pg_atomic_uint64 insert;
+	pg_atomic_uint64 evict;
+	polar_record_cache_partition_t partition[POLAR_RECORD_CACHE_PARTITIONS];
+	int32		bucket[FLEXIBLE_ARRAY_MEMBER];	/* Hash buckets, each
+												 * partition use its own
+												 * range */
+} polar_record_cache_data_t;
+
+typedef polar_record_cache_data_t *polar_record_cache_t;
+
+extern Size polar_record_cache_shmem_size(int cache_size_mb);
+extern polar_record_cache_t polar_record_cache_shmem_init(const char *name, int cache_size_mb);
+extern bool polar_record_cache_read(polar_record_cache_t cache, XLogReaderState *state, XLogRecPtr lsn);
+extern void polar_record_cache_insert(polar_record_cache_t cache, XLogReaderState *state);
+extern void polar_record_cache_invalidate(polar_record_cache_t cache);
+
+#endif							/* POLAR_RECORD_CACHE_H */
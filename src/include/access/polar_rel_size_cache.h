@@ -69,6 +69,28 @@ typedef struct polar_rel_size_table_t
 	char		info[FLEXIBLE_ARRAY_MEMBER];
 } polar_rel_size_table_t;
 
+/*
+ * Tombstone index records the max lsn of truncate info for each relation and
+ * the max lsn of state for each database, which are saved in relation size
+ * tables. The database is recorded with InvalidOid relNode. If the lsn to
+ * check is not smaller than these lsn, then the block is valid and we don't
+ * need to search relation size tables.
+ *
+ * Logindex itself doesn't know relations, so the index is not consulted by
+ * memory table probes or table iterators. Dead entries are skipped by the
+ * replay code which checks the block before replaying: background replay
+ * skips the entries of truncated or dropped blocks, and page apply starts
+ * its page iterator after the truncate lsn.
+ */
+#define POLAR_REL_TOMBSTONE_NUM             (4096)
+#define POLAR_REL_TOMBSTONE_PROBE           (16)
+
+typedef struct polar_rel_tombstone_t
+{
+	RelFileNode node;
+	XLogRecPtr	lsn;
+} polar_rel_tombstone_t;
+
 typedef struct polar_rel_size_cache_data_t
 {
 	polar_lwlock_mini_padded lock;
@@ -76,6 +98,14 @@ typedef struct polar_rel_size_cache_data_t
 	uint32		active_mid;
 	uint32		min_tid;
 	uint32		table_size;
+	uint32		tombstone_num;
+	bool		tombstone_overflow; /* some tombstones are not recorded */
+	pg_atomic_uint64 skip_search;	/* checks which skip to search tables */
+	pg_atomic_uint64 search;	/* checks which have to search tables */
+	pg_atomic_uint64 skip_entry;	/* logindex entries not replayed by
+									 * background replay as the block is
+									 * truncated or dropped */
+	polar_rel_tombstone_t tombstone[POLAR_REL_TOMBSTONE_NUM];
 	char		table_data[FLEXIBLE_ARRAY_MEMBER];
 } polar_rel_size_cache_data_t;
 
@@ -98,6 +128,7 @@ extern void polar_record_rel_size(polar_rel_size_cache_t cache, XLogRecPtr lsn,
 extern void polar_record_rel_size_with_lock(polar_rel_size_cache_t cache, XLogRecPtr lsn, RelFileNode *node, ForkNumber fork, BlockNumber rel_size);
 extern bool polar_check_rel_block_valid_only(polar_rel_size_cache_t cache, XLogRecPtr lsn, BufferTag *tag);
 extern bool polar_check_rel_block_valid_and_lsn(polar_rel_size_cache_t cache, XLogRecPtr lsn, BufferTag *tag, XLogRecPtr *lsn_changed);
+extern bool polar_check_rel_block_valid_for_replay(polar_rel_size_cache_t cache, XLogRecPtr lsn, BufferTag *tag);
 extern void polar_truncate_rel_size_cache(polar_rel_size_cache_t cache, XLogRecPtr lsn);
 
 #endif
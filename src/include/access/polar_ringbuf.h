@@ -27,6 +27,7 @@
 #define POLAR_LOGINDEX_RINGBUF_H
 
 #include "port/atomics.h"
+#include "port/pg_iovec.h"
 #include "storage/lwlock.h"
 
 /*
@@ -193,10 +194,14 @@ extern void polar_ringbuf_release_ref(polar_ringbuf_ref_t *ref);
 extern bool polar_ringbuf_get_ref(polar_ringbuf_ref_t *ref);
 extern bool polar_ringbuf_clear_ref(polar_ringbuf_ref_t *ref);
 extern void polar_ringbuf_update_ref(polar_ringbuf_ref_t *ref);
+extern void polar_ringbuf_advance_ref(polar_ringbuf_ref_t *ref, size_t pread, int npkts);
 
 extern ssize_t polar_ringbuf_pkt_write(polar_ringbuf_t rbuf, size_t idx, int offset, uint8 *buf, size_t len);
 extern ssize_t polar_ringbuf_read_next_pkt(polar_ringbuf_ref_t *ref,
 										   int offset, uint8 *buf, size_t len);
+extern ssize_t polar_ringbuf_read_pkt(polar_ringbuf_t rbuf, size_t idx,
+									  int offset, uint8 *buf, size_t len);
+extern int	polar_ringbuf_pkt_iov(polar_ringbuf_t rbuf, size_t idx, struct iovec *iov);
 extern void polar_ringbuf_update_keep_data(polar_ringbuf_t rbuf);
 extern void polar_ringbuf_free_up(polar_ringbuf_t rbuf, size_t len, polar_interrupt_callback callback);
 extern void polar_ringbuf_auto_release_ref(polar_ringbuf_ref_t *ref);
@@ -241,37 +246,62 @@ polar_ringbuf_avail(polar_ringbuf_ref_t *ref)
 }
 
 /*
- * Reserve space from ring buffer for future write
+ * Reserve space from ring buffer for future write without counting it in
+ * statistics, so that it's as short as possible for callers who reserve
+ * under a heavily contended lock, see ReserveXLogInsertLocation().  They
+ * should call polar_ringbuf_pkt_reserve_stat() after releasing the lock.
  * This function should be protected by exclusive lock
  */
 static inline size_t
-polar_ringbuf_pkt_reserve(polar_ringbuf_t rbuf, size_t len)
+polar_ringbuf_pkt_reserve_nostat(polar_ringbuf_t rbuf, size_t len)
 {
 	size_t		idx = pg_atomic_read_u64(&rbuf->pwrite);
+	size_t		next = idx + len;
+
+	/* len is always less than size, avoid the division of modulo */
+	if (next >= rbuf->size)
+		next -= rbuf->size;
 
 	rbuf->data[idx] = POLAR_RINGBUF_PKT_FREE;
 
 	/* ensure set packet flag before update pwrite */
 	pg_write_barrier();
-	pg_atomic_write_u64(&rbuf->pwrite,
-						(idx + len) % rbuf->size);
+	pg_atomic_write_u64(&rbuf->pwrite, next);
+
+	return idx;
+}
 
+/*
+ * Count the space reserved by polar_ringbuf_pkt_reserve_nostat()
+ */
+static inline void
+polar_ringbuf_pkt_reserve_stat(polar_ringbuf_t rbuf, size_t len)
+{
 	pg_atomic_fetch_add_u64(&rbuf->prs.push_cnt, 1);
 	pg_atomic_fetch_add_u64(&rbuf->prs.total_written, len);
+}
+
+/*
+ * Reserve space from ring buffer for future write
+ * This function should be protected by exclusive lock
+ */
+static inline size_t
+polar_ringbuf_pkt_reserve(polar_ringbuf_t rbuf, size_t len)
+{
+	size_t		idx = polar_ringbuf_pkt_reserve_nostat(rbuf, len);
+
+	polar_ringbuf_pkt_reserve_stat(rbuf, len);
 
 	return idx;
 }
 
 /*
- * Check whether the next packet for this reference is ready
+ * Check whether the packet which starts from idx is ready
  * And return packet length when data is ready for read
  */
 static inline uint8
-polar_ringbuf_next_ready_pkt(polar_ringbuf_ref_t *ref, uint32 *pktlen)
+polar_ringbuf_ready_pkt(polar_ringbuf_t rbuf, size_t idx, uint32 *pktlen)
 {
-	polar_ringbuf_t rbuf = ref->rbuf;
-	size_t		idx = rbuf->slot[ref->slot].pread;
-
 	*pktlen = 0;
 
 	if ((rbuf->data[idx] & POLAR_RINGBUF_PKT_STATE_MASK) != POLAR_RINGBUF_PKT_READY)
@@ -285,6 +315,25 @@ polar_ringbuf_next_ready_pkt(polar_ringbuf_ref_t *ref, uint32 *pktlen)
 	return rbuf->data[idx] & POLAR_RINGBUF_PKT_TYPE_MASK;
 }
 
+/*
+ * Check whether the next packet for this reference is ready
+ * And return packet length when data is ready for read
+ */
+static inline uint8
+polar_ringbuf_next_ready_pkt(polar_ringbuf_ref_t *ref, uint32 *pktlen)
+{
+	return polar_ringbuf_ready_pkt(ref->rbuf, ref->rbuf->slot[ref->slot].pread, pktlen);
+}
+
+/*
+ * Get the start position of the packet after the one which starts from idx
+ */
+static inline size_t
+polar_ringbuf_next_pkt_pos(polar_ringbuf_t rbuf, size_t idx, uint32 pktlen)
+{
+	return (idx + POLAR_RINGBUF_PKTHDRSIZE + pktlen) % rbuf->size;
+}
+
 /*
  * Set packet data length.
  * The param idx is the start point of this packet
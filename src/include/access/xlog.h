@@ -59,6 +59,7 @@ extern PGDLLIMPORT int wal_decode_buffer_size;
 
 extern PGDLLIMPORT int CheckPointSegments;
 extern int	polar_wal_init_set_size;
+extern int	polar_group_commit_target_latency;
 
 /* xlog init zero file write size */
 #define POLAR_DEFAULT_XLOG_FILL_ZERO_SIZE 1024 * 1024
@@ -295,6 +296,25 @@ extern void polar_set_available_state(bool state);
 extern bool polar_get_available_state(void);
 extern XLogRecPtr polar_get_xlog_insert_ptr_nolock(void);
 
+/*
+ * POLAR: statistics of adaptive group commit, see XLogFlush.
+ */
+typedef struct PolarGroupCommitStat
+{
+	uint64		flush_count;	/* WAL flushes done by XLogFlush */
+	uint64		request_count;	/* flush requests covered by those flushes */
+	uint64		max_batch_size; /* most requests covered by one flush */
+	uint64		delay_count;	/* flushes delayed to wait for followers */
+	uint64		delay_time;		/* total delay in microseconds */
+	uint64		max_delay;		/* longest delay in microseconds */
+	double		flush_latency;	/* EWMA of flush latency in microseconds */
+	double		flush_latency_p99;	/* estimated p99 of flush latency */
+	double		request_rate;	/* EWMA of flush requests per microsecond */
+} PolarGroupCommitStat;
+
+extern void polar_get_group_commit_stat(PolarGroupCommitStat *stat);
+extern void polar_reset_group_commit_stat(void);
+
 /*
  * Routines used by xlogrecovery.c to call back into xlog.c during recovery.
  */
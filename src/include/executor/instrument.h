@@ -37,6 +37,9 @@ typedef struct BufferUsage
 	instr_time	blk_write_time; /* time spent writing blocks */
 	instr_time	temp_blk_read_time; /* time spent reading temp blocks */
 	instr_time	temp_blk_write_time;	/* time spent writing temp blocks */
+	/* POLAR: bulk read */
+	int64		polar_bulk_read_calls_IO;	/* # of bulk reads from storage */
+	int64		polar_bulk_read_blocks_IO;	/* # of blocks read by bulk reads */
 } BufferUsage;
 
 /*
@@ -82,6 +82,10 @@ extern int	pq_peekbyte(void);
 extern int	pq_getbyte_if_available(unsigned char *c);
 extern bool pq_buffer_has_data(void);
 extern int	pq_putmessage_v2(char msgtype, const char *s, size_t len);
+
+/* POLAR */
+struct iovec;
+extern void polar_pq_putmessage_iov_noblock(char msgtype, const struct iovec *iov, int iovcnt);
 extern bool pq_check_connection(void);
 
 /*
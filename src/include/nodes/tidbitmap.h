@@ -43,6 +43,8 @@ typedef struct TBMIterateResult
 	int			ntuples;		/* -1 indicates lossy result */
 	bool		recheck;		/* should the tuples be rechecked? */
 	/* Note: recheck is always true if ntuples < 0 */
+	/* POLAR: number of consecutive blocks from blockno for bulk read */
+	int			polar_nblocks;
 	OffsetNumber offsets[FLEXIBLE_ARRAY_MEMBER];
 } TBMIterateResult;
 
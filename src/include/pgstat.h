@@ -195,6 +195,7 @@ typedef struct PgStat_TableCounts
 	PgStat_Counter polar_t_bulk_read_calls;
 	PgStat_Counter polar_t_bulk_read_calls_IO;
 	PgStat_Counter polar_t_bulk_read_blocks_IO;
+	PgStat_Counter polar_t_bulk_read_blocks_prefetch;
 	/* POLAR end */
 
 	/* bulk create index extend times */
@@ -257,7 +258,7 @@ typedef struct PgStat_TableXactStatus
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BCA9
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BCAA
 
 typedef struct PgStat_ArchiverStats
 {
@@ -411,6 +412,8 @@ typedef struct PgStat_StatTabEntry
 	PgStat_Counter polar_bulk_read_calls_IO;
 	/* bulk read calls, IO read blocks counts */
 	PgStat_Counter polar_bulk_read_blocks_IO;
+	/* blocks queued for prefetch workers ahead of bulk read */
+	PgStat_Counter polar_bulk_read_blocks_prefetch;
 	/* POLAR end */
 
 	/* POLAR: bulk extend */
@@ -682,6 +685,11 @@ polar_stat_wait_obj_and_time_clear(void)
 		if ((rel)->pgstat_info != NULL)								            \
 		  (rel)->pgstat_info->t_counts.polar_t_bulk_read_blocks_IO += (n);      \
 	} while (0)
+#define polar_pgstat_count_bulk_read_blocks_prefetch(rel, n)			        	\
+	do {															            \
+		if ((rel)->pgstat_info != NULL)								            \
+		  (rel)->pgstat_info->t_counts.polar_t_bulk_read_blocks_prefetch += (n); \
+	} while (0)
 /* POLAR: end */
 
 
@@ -26,6 +26,7 @@
 #ifndef PALAR_PARALLEL_BGWRITER_H
 #define PALAR_PARALLEL_BGWRITER_H
 
+#include "datatype/timestamp.h"
 #include "utils/guc.h"
 #include "port/atomics.h"
 #include "postmaster/bgworker.h"
@@ -59,6 +60,23 @@ typedef enum flush_work_status_t
 #define POLAR_MAX_BGWRITER_WORKERS \
 	(DOUBLE_GUC_BGWRITER_WORKERS < MAX_NUM_OF_PARALLEL_BGWRITER ? DOUBLE_GUC_BGWRITER_WORKERS : MAX_NUM_OF_PARALLEL_BGWRITER)
 
+/* The number of latest decisions kept by the bgwriter controller */
+#define POLAR_BGWRITER_CONTROL_HISTORY_SIZE 128
+
+/* One decision of the bgwriter controller */
+typedef struct polar_bgwriter_control_sample
+{
+	TimestampTz time;
+	uint64		consistent_lag;
+	double		clean_ratio;	/* -1 if it's not controlled */
+	double		error;
+	double		integral;
+	double		derivative;
+	double		output;
+	int			workers;		/* Target number of parallel workers */
+	int			batch_size;		/* Target batch size of each worker */
+} polar_bgwriter_control_sample;
+
 typedef struct polar_flush_work_t
 {
 	BackgroundWorkerHandle handle;
@@ -79,6 +97,13 @@ typedef struct ParallelBgwriterInfo
 	pg_atomic_uint32 flush_workers[MAX_FLUSH_TASK];
 	pg_atomic_uint32 current_workers;
 
+	/* Batch size of each worker decided by controller, 0 if not decided */
+	pg_atomic_uint32 batch_size;
+
+	/* Spinlock: protects the decision history below */
+	slock_t		control_lock;
+	uint64		control_count;
+	polar_bgwriter_control_sample control_history[POLAR_BGWRITER_CONTROL_HISTORY_SIZE];
 } ParallelBgwriterInfo;
 
 extern ParallelBgwriterInfo *polar_parallel_bgwriter_info;
@@ -91,4 +116,6 @@ extern void polar_register_parallel_bgwriter_workers(int workers);
 extern void polar_shutdown_parallel_bgwriter_workers(int workers);
 extern void polar_check_parallel_bgwriter_worker(void);
 extern bool polar_new_parallel_bgwriter_useful(void);
+extern int	polar_get_parallel_bgwriter_batch_size(void);
+extern void polar_add_parallel_bgwriter_control_sample(polar_bgwriter_control_sample *sample);
 #endif							/* PALAR_PARALLEL_BGWRITER_H */
@@ -93,6 +93,9 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 extern bool polar_bulk_io_is_in_progress;
 extern int	polar_bulk_io_in_progress_count;
 
+/* POLAR: upper limit for polar_buffer_sweep_partitions */
+#define POLAR_MAX_SWEEP_PARTITIONS 64
+
 /* POLAR end */
 
 /* upper limit for effective_io_concurrency */
@@ -231,6 +231,7 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_PGSTATS_DATA,
 	/* POLAR */
 	LWTRANCHE_POLAR_COPY_BUFFER,
+	LWTRANCHE_POLAR_FLUSH_LIST_BATCH,
 	LWTRANCHE_LOGINDEX_MINI_TRANSACTION,
 	LWTRANCHE_LOGINDEX_MINI_TRANSACTION_TBL,
 
@@ -240,9 +241,9 @@ typedef enum BuiltinTrancheIds
 	 */
 	LWTRANCHE_WAL_LOGINDEX_BEGIN,
 	LWTRANCHE_WAL_LOGINDEX_MEM_TBL = LWTRANCHE_WAL_LOGINDEX_BEGIN,
-	LWTRANCHE_WAL_LOGINDEX_HASH_LOCK,
 	LWTRANCHE_WAL_LOGINDEX_IO,
 	LWTRANCHE_WAL_LOGINDEX_FLUSH_ACTIVE_TBL,
+	LWTRANCHE_WAL_LOGINDEX_OVERFLOW,
 	LWTRANCHE_WAL_LOGINDEX_BLOOM_LRU,
 	LWTRANCHE_WAL_LOGINDEX_END = LWTRANCHE_WAL_LOGINDEX_BLOOM_LRU,
 
@@ -253,14 +254,16 @@ typedef enum BuiltinTrancheIds
 	 */
 	LWTRANCHE_FULLPAGE_LOGINDEX_BEGIN,
 	LWTRANCHE_FULLPAGE_LOGINDEX_MEM_TBL = LWTRANCHE_FULLPAGE_LOGINDEX_BEGIN,
-	LWTRANCHE_FULLPAGE_LOGINDEX_HASH_LOCK,
 	LWTRANCHE_FULLPAGE_LOGINDEX_IO,
 	LWTRANCHE_FULLPAGE_LOGINDEX_FLUSH_ACTIVE_TBL,
+	LWTRANCHE_FULLPAGE_LOGINDEX_OVERFLOW,
 	LWTRANCHE_FULLPAGE_LOGINDEX_BLOOM_LRU,
 	LWTRANCHE_FULLPAGE_LOGINDEX_END = LWTRANCHE_FULLPAGE_LOGINDEX_BLOOM_LRU,
 	LWTRANCHE_FULLPAGE_FILE,
 	/* polar relation size cache for logindex */
 	LWTRANCHE_RELATION_SIZE_CACHE,
+	/* polar decoded record cache for logindex */
+	LWTRANCHE_POLAR_RECORD_CACHE,
 	/* polar xlog meta queue */
 	LWTRANCHE_POLAR_XLOG_QUEUE,
 	/* polar local cache */
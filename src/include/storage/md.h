@@ -54,4 +54,6 @@ extern void polar_mdbulkextend(SMgrRelation reln, ForkNumber forknum, BlockNumbe
 							   int blockCount, char *buffer, bool skipFsync);
 extern void polar_mdbulkread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 							 int blockCount, char *buffer);
+extern void polar_mdbulkwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+							  int blockCount, char *buffer, bool skipFsync);
 #endif							/* MD_H */
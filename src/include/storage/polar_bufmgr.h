@@ -64,6 +64,8 @@ extern Buffer polar_bulk_read_buffer(Relation reln, BlockNumber blockNum, BlockN
 extern Buffer polar_bulk_read_buffer_extended(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
 											  ReadBufferMode mode, BufferAccessStrategy strategy,
 											  BlockNumber maxBlockCount);
+extern void polar_bulk_read_prefetch(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
+									 BlockNumber maxBlockCount, BlockNumber nblocks);
 extern bool polar_is_future_page(BufferDesc *buf_hdr);
 extern bool polar_buffer_need_fullpage_snapshot(BufferDesc *buf_hdr, XLogRecPtr oldest_apply_lsn);
 #endif							/* POLAR_BUFMGR_H */
@@ -89,14 +89,50 @@ typedef union CopyBufferDescPadded
 #define polar_copy_buffer_enabled() \
 	(polar_enable_shared_storage_mode && polar_copy_buffers)
 
+/*
+ * The copy buffers are divided into partitions, buffer i belongs to
+ * partition (i % partition_num). Each partition has its own lock-free
+ * freelist, and a backend allocates from its home partition first.
+ */
+#define POLAR_COPY_BUFFER_MAX_PARTITIONS 16
+
+/*
+ * The head of freelist is a buffer id in the low 32 bits and a counter in
+ * the high 32 bits, the counter is increased by each change to avoid ABA
+ * problem of compare and exchange.
+ */
+#define polar_copy_buffer_free_head(id, counter) \
+	((((uint64) (counter)) << 32) | (uint32) (id))
+#define polar_copy_buffer_free_head_id(head) ((int) (uint32) (head))
+#define polar_copy_buffer_free_head_counter(head) ((uint32) ((head) >> 32))
+
+#define polar_copy_buffer_partition(cbuf) \
+	(&polar_copy_buffer_ctl->partition[(cbuf)->buf_id % polar_copy_buffer_ctl->partition_num].part)
+
+typedef struct CopyBufferPartition
+{
+	pg_atomic_uint64 free_head; /* Head of list of unused copy buffers */
+	pg_atomic_uint32 free_count;	/* Number of unused copy buffers */
+	int			size;			/* Number of copy buffers */
+
+	/* Statistic info */
+	pg_atomic_uint64 alloc_count;	/* Allocated from this partition */
+	pg_atomic_uint64 remote_count;	/* Allocated by backends of other
+									 * partitions */
+	pg_atomic_uint64 empty_count;	/* Found empty when allocating */
+} CopyBufferPartition;
+
+typedef union CopyBufferPartitionPadded
+{
+	CopyBufferPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} CopyBufferPartitionPadded;
+
 /* The copy buffer freelist control information. */
 typedef struct CopyBufferControl
 {
-	/* Spinlock: protects the values below */
-	slock_t		copy_buffer_ctl_lock;
-
-	int			first_free_buffer;	/* Head of list of unused copy buffers */
-	int			last_free_buffer;	/* Tail of list of unused copy buffers */
+	int			partition_num;
+	CopyBufferPartitionPadded partition[POLAR_COPY_BUFFER_MAX_PARTITIONS];
 
 	/* Statistic info */
 	pg_atomic_uint64 flushed_count;
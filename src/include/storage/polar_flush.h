@@ -33,9 +33,36 @@
 
 #define FLUSH_LIST_LEN (pg_atomic_read_u32(&polar_flush_ctl->count))
 
-#define polar_flush_list_is_empty() \
-    (polar_flush_ctl->first_flush_buffer == POLAR_FLUSHNEXT_END_OF_LIST && \
-    polar_flush_ctl->last_flush_buffer == POLAR_FLUSHNEXT_END_OF_LIST)
+/*
+ * The flush list is a ring of buckets keyed by oldest lsn, like a timer
+ * wheel. Each bucket covers POLAR_FLUSH_LIST_BUCKET_SIZE bytes of wal, and is
+ * divided into POLAR_FLUSH_LIST_PARTITIONS partitions by buffer id, so the
+ * backends dirtying buffers at the same time don't contend on the bucket of
+ * current insert lsn. Each partition is ordered by oldest lsn and protected
+ * by its own spinlock. When dirty buffers span more wal than the whole ring,
+ * a bucket holds buffers of several laps, so the lsn of partition head is
+ * compared with the lsn range of bucket when walking the ring.
+ */
+#define POLAR_FLUSH_LIST_BUCKETS (1024)
+#define POLAR_FLUSH_LIST_BUCKET_SIZE (1024 * 1024)
+#define POLAR_FLUSH_LIST_PARTITIONS (8)
+
+#define polar_flush_list_bucket_start(lsn) \
+	((lsn) - (lsn) % POLAR_FLUSH_LIST_BUCKET_SIZE)
+
+#define polar_flush_list_bucket_no(lsn) \
+	(((lsn) / POLAR_FLUSH_LIST_BUCKET_SIZE) % POLAR_FLUSH_LIST_BUCKETS)
+
+#define polar_flush_list_partition_by_no(bucket_no, part_no) \
+	(&polar_flush_ctl->partition[(bucket_no) * POLAR_FLUSH_LIST_PARTITIONS + (part_no)].part)
+
+#define polar_flush_list_partition(lsn, buf_id) \
+	polar_flush_list_partition_by_no(polar_flush_list_bucket_no(lsn), \
+									 (buf_id) % POLAR_FLUSH_LIST_PARTITIONS)
+
+#define polar_flush_list_is_empty(part) \
+    ((part)->first_flush_buffer == POLAR_FLUSHNEXT_END_OF_LIST && \
+    (part)->last_flush_buffer == POLAR_FLUSHNEXT_END_OF_LIST)
 
 #define polar_flush_list_enabled() \
 	(polar_enable_shared_storage_mode && polar_enable_flushlist)
@@ -65,21 +92,46 @@ typedef struct polar_sync_buffer_io
 } polar_sync_buffer_io;
 
 
-/* The shared flush list control information. */
-typedef struct FlushControl
+typedef struct FlushListPartition
 {
-	/* The number of buffers in flush list */
-	pg_atomic_uint32 count;
-
 	/* Spinlock: protects flushlist values below */
 	slock_t		flushlist_lock;
 
 	int			first_flush_buffer; /* Head of list of dirty buffers */
 	int			last_flush_buffer;	/* Tail of list of dirty buffers */
 	int			current_pos;	/* Parallel workers get buffer from this
-								 * position */
+								 * position, POLAR_FLUSHNEXT_NOT_IN_LIST if
+								 * the partition is not being walked */
+} FlushListPartition;
+
+typedef union FlushListPartitionPadded
+{
+	FlushListPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} FlushListPartitionPadded;
+
+/* The shared flush list control information. */
+typedef struct FlushControl
+{
+	/* The number of buffers in flush list */
+	pg_atomic_uint32 count;
+
+	FlushListPartitionPadded partition[POLAR_FLUSH_LIST_BUCKETS * POLAR_FLUSH_LIST_PARTITIONS];
+
+	/*
+	 * Walking the ring starts from this lsn, it's not greater than the
+	 * oldest lsn of any buffer in flush list.
+	 */
+	pg_atomic_uint64 start_lsn;
+
+	/* LWlock: protects batch values below */
+	LWLock		batchlock;
+
 	int			latest_flush_count; /* The number of buffers all parallel
 									 * bgwriters flushed latest */
+	int			batch_bucket;	/* The bucket parallel bgwriters walk */
+	int			batch_partition;	/* The partition of bucket they walk */
+	int			batch_walked;	/* The number of buckets walked */
 
 	/* LWlock: flush copy buffer */
 	LWLock		cbuflock;
@@ -101,11 +153,14 @@ typedef struct FlushControl
 	pg_atomic_uint64 backend_flush;
 	pg_atomic_uint64 vm_insert;
 	pg_atomic_uint64 vm_remove;
+	pg_atomic_uint64 write;		/* Write calls of flush list buffers */
+	pg_atomic_uint64 write_blocks;	/* Blocks written by those calls */
 } FlushControl;
 
 extern FlushControl *polar_flush_ctl;
 
 extern int	polar_get_batch_buffer(int *batch_buf, int bgwriter_flush_batch_size);
+extern XLogRecPtr polar_get_flush_list_oldest_lsn(XLogRecPtr limit_lsn);
 extern void polar_remove_buffer_from_flush_list(BufferDesc *buf);
 extern void polar_put_buffer_to_flush_list(BufferDesc *buf, XLogRecPtr lsn);
 extern void polar_adjust_position_in_flush_list(BufferDesc *buf);
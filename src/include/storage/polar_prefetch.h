@@ -0,0 +1,94 @@
+/*-------------------------------------------------------------------------
+ *
+ * polar_prefetch.h
+ *	  Read blocks into shared buffers ahead of their users by background
+ *	  prefetch workers.
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/include/storage/polar_prefetch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef POLAR_PREFETCH_H
+#define POLAR_PREFETCH_H
+
+#include "port/atomics.h"
+#include "storage/block.h"
+#include "storage/latch.h"
+#include "storage/relfilenode.h"
+#include "storage/s_lock.h"
+#include "utils/rel.h"
+
+/* The max number of prefetch workers */
+#define POLAR_MAX_PREFETCH_WORKERS 16
+
+/* The number of requests which can wait in the prefetch queue */
+#define POLAR_PREFETCH_QUEUE_SIZE 1024
+
+#define polar_prefetch_enabled() \
+	(polar_prefetch_workers > 0 && polar_prefetch_ctl != NULL)
+
+/*
+ * Read nblocks blocks starting from blockno. When lockrelid is valid, the
+ * worker holds AccessShareLock on the relation while reading, so the blocks
+ * can't be read after the relation is truncated or dropped.
+ */
+typedef struct polar_prefetch_request_t
+{
+	LockRelId	lockrelid;
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blockno;
+	BlockNumber nblocks;
+} polar_prefetch_request_t;
+
+typedef struct polar_prefetch_worker_t
+{
+	Latch	   *latch;
+	bool		idle;
+} polar_prefetch_worker_t;
+
+typedef struct polar_prefetch_ctl_t
+{
+	slock_t		lock;			/* protects the queue and workers */
+	uint64		head;			/* the next request to take */
+	uint64		tail;			/* the next request to add */
+	polar_prefetch_worker_t workers[POLAR_MAX_PREFETCH_WORKERS];
+
+	pg_atomic_uint64 requested_blocks;	/* blocks added to the queue */
+	pg_atomic_uint64 dropped_blocks;	/* blocks dropped as queue is full */
+	pg_atomic_uint64 read_blocks;	/* blocks read from storage */
+	pg_atomic_uint64 hit_blocks;	/* blocks already in shared buffers */
+	pg_atomic_uint64 skipped_blocks;	/* blocks of truncated or dropped
+										 * relations */
+	pg_atomic_uint64 failed_requests;	/* requests ended with error */
+
+	polar_prefetch_request_t requests[POLAR_PREFETCH_QUEUE_SIZE];
+} polar_prefetch_ctl_t;
+
+extern PGDLLIMPORT int polar_prefetch_workers;
+extern PGDLLIMPORT polar_prefetch_ctl_t *polar_prefetch_ctl;
+
+extern Size polar_prefetch_shmem_size(void);
+extern void polar_prefetch_shmem_init(void);
+extern void polar_register_prefetch_workers(void);
+extern void polar_prefetch_worker_main(Datum main_arg);
+
+extern bool polar_prefetch_buffers(Relation reln, RelFileNode rnode, ForkNumber forknum,
+								   BlockNumber blockno, BlockNumber nblocks);
+
+#endif							/* POLAR_PREFETCH_H */
@@ -69,6 +69,9 @@ typedef struct polar_task_node_t
 	Latch	   *next_latch;		/* Set this latch when task is finished */
 	uint64		add_seq;
 	uint64		finished_seq;
+	pg_atomic_uint32 claimed;	/* Non-zero when one sub process takes this
+								 * task, it's 1 + sub process id, with the
+								 * top bit set while it's tentative */
 	pg_atomic_uint32 task_status;	/* The first 16bit indicates which sub
 									 * process own this task; and the last
 									 * 16bit indicates the status of this task */
@@ -81,6 +84,7 @@ typedef struct polar_task_node_t
 		(node)->next_latch = NULL; \
 		(node)->add_seq = 0; \
 		(node)->finished_seq = 0; \
+		pg_atomic_init_u32(&(node)->claimed, 0); \
 		POLAR_TASK_NODE_INIT_STATUS(node); \
 	} while (0)
 
@@ -105,6 +109,20 @@ typedef bool (*polar_task_handle_cleanup) (void *run_arg);
 typedef void *(*polar_task_get_tag) (polar_task_node_t *);
 typedef void (*polar_dispatcher_handle_finished) (polar_task_node_t *, void *);
 
+/*
+ * The state of sub process which is shared with dispatcher and other sub
+ * processes. They are saved after task nodes in the shared memory.
+ */
+typedef struct polar_task_proc_state_t
+{
+	pg_atomic_uint64 added_seq;	/* add_seq of the last task dispatched to
+								 * this process */
+	pg_atomic_uint64 fetched_seq;	/* add_seq of the last task this process
+									 * fetched from its ring */
+	pg_atomic_uint32 fetch_idx;	/* Ring index this process will fetch next */
+	pg_atomic_uint32 idle;		/* This process is waiting for new task */
+} polar_task_proc_state_t;
+
 typedef struct polar_task_sched_t
 {
 	char		name[POLAR_TASK_NAME_MAX_LEN];
@@ -125,6 +143,10 @@ typedef struct polar_task_sched_t
 	uint64		added_seq;
 	pg_atomic_uint64 finished_seq;
 	pg_atomic_uint32 enable_shutdown;
+	pg_atomic_uint32 enable_work_steal; /* Idle process steal running task
+										 * from other processes' ring */
+	pg_atomic_uint32 idle_proc_num;
+	pg_atomic_uint64 steal_task_num;
 	polar_task_node_t task_nodes[FLEXIBLE_ARRAY_MEMBER];
 } polar_task_sched_t;
 
@@ -159,6 +181,10 @@ typedef struct polar_task_sched_ctl_t
 								 * when dispatch */
 	uint64		reset_task_num; /* Total number reset task's status to be idle
 								 * when it's finished */
+	uint32		steal_proc;		/* Try to wake this process to steal task
+								 * next time */
+	uint64		wake_steal_num; /* Total times to wake idle process to steal
+								 * task */
 	polar_dispatcher_handle_finished handle_finished;
 	void	   *finished_arg;
 	polar_sub_proc_t sub_proc[FLEXIBLE_ARRAY_MEMBER];
@@ -175,6 +201,7 @@ extern polar_task_sched_ctl_t *polar_create_task_sched_ctl(polar_task_sched_t *s
 extern void polar_sched_ctl_reg_handler(polar_task_sched_ctl_t *ctl, polar_dispatcher_handle_finished handle_finished, void *finished_arg);
 
 extern polar_task_node_t *polar_sched_add_task(polar_task_sched_ctl_t *ctl, polar_task_node_t *task);
+extern polar_task_node_t *polar_sched_add_task_prefer(polar_task_sched_ctl_t *ctl, polar_task_node_t *task, int32 prefer_proc);
 extern void polar_start_proc_pool(polar_task_sched_ctl_t *ctl);
 extern void polar_release_task_sched_ctl(polar_task_sched_ctl_t *ctl);
 extern int	polar_sched_remove_finished_task(polar_task_sched_ctl_t *ctl);
@@ -192,6 +219,18 @@ polar_sched_shutdown_enabled(polar_task_sched_t *sched)
 	return pg_atomic_read_u32(&sched->enable_shutdown) != 0;
 }
 
+static inline void
+polar_sched_enable_work_steal(polar_task_sched_t *sched, bool enable)
+{
+	pg_atomic_write_u32(&sched->enable_work_steal, enable ? 1 : 0);
+}
+
+static inline bool
+polar_sched_work_steal_enabled(polar_task_sched_t *sched)
+{
+	return pg_atomic_read_u32(&sched->enable_work_steal) != 0;
+}
+
 static inline bool
 polar_sched_empty_running_task(polar_task_sched_ctl_t *ctl)
 {
@@ -209,6 +248,13 @@ polar_sched_empty_running_task(polar_task_sched_ctl_t *ctl)
 			(task) = (polar_task_node_t *)(((char *)(task)) + (sched)->task_node_size); \
 	} while (0)
 
+#define POLAR_SCHED_RING_TASK_POINT(sched, proc_num, task_index) \
+	POLAR_SCHED_TASK_POINT(sched, (sched)->task_nodes, (proc_num) * (sched)->task_queue_depth + (task_index))
+
+#define POLAR_SCHED_PROC_STATE(sched, proc_num) \
+	((polar_task_proc_state_t *)(((char *)(sched)->task_nodes) + \
+								 (sched)->task_node_size * (sched)->task_queue_depth * (sched)->total_proc) + (proc_num))
+
 #define POLAR_SCHED_RUNNING_QUEUE_HEAD(sched) ((polar_task_node_t *)(((char *)sched->running_queue_head) - \
 																	 offsetof(polar_task_node_t, running_task)))
 #endif
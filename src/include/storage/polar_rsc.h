@@ -34,6 +34,7 @@
 #include "port/atomics.h"
 #include "storage/block.h"
 #include "storage/relfilenode.h"
+#include "storage/s_lock.h"
 #include "storage/smgr.h"
 #include "utils/relcache.h"
 
@@ -51,11 +52,30 @@ typedef struct polar_rsc_shared_relation_t
 	pg_atomic_uint32 flags;
 	pg_atomic_uint64 generation;	/* mapping change */
 	int64		usecount;		/* used for clock sweep */
+
+	/* POLAR: links in the chain of its database partition */
+	bool		db_linked;
+	int			db_prev;
+	int			db_next;
 } polar_rsc_shared_relation_t;
 
+/*
+ * POLAR: valid shared relations are chained by database, so that dropping a
+ * database only visits the shared relations of databases in the same
+ * partition.
+ */
+#define POLAR_RSC_DB_PARTITIONS		64
+
+typedef struct polar_rsc_db_partition_t
+{
+	slock_t		lock;			/* protects the chain */
+	int			head;			/* first shared relation, -1 if empty */
+} polar_rsc_db_partition_t;
+
 typedef struct polar_rsc_shared_relation_pool_t
 {
 	pg_atomic_uint32 next_sweep;
+	polar_rsc_db_partition_t db_partitions[POLAR_RSC_DB_PARTITIONS];
 	polar_rsc_shared_relation_t entries[FLEXIBLE_ARRAY_MEMBER];
 } polar_rsc_shared_relation_pool_t;
 
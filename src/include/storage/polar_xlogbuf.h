@@ -29,10 +29,15 @@
  * requested page, we will return buffer id and hold content lock of buffer.
  * Caller should release content lock after read or update buffer.
  *
- * For now, replace strategy is to reserve newer xlog pages than older ones. So
- * in polar_xlog_buffer_should_evict() we will check lsn from buffer meta and
- * requested page, if requested page is newer we will evict current buffer,
- * otherwise requested page should be obtained by io directly.
+ * Xlog buffer is a set associative cache. A xlog page can only be kept by one
+ * of POLAR_XLOG_BUFFER_WAYS buffers in the set which it's mapped to, and all
+ * buffers of one set are protected by the same lock.
+ *
+ * The replace strategy is aware of the consumers' cursor, which is the lsn
+ * replayed by background replay. Pages older than the cursor have been
+ * consumed and they are evicted first. Otherwise the page farthest from the
+ * cursor is evicted, because it will be read last. Without cursor, we reserve
+ * newer xlog pages than older ones. See polar_xlog_buffer_choose_victim().
  */
 
 #ifndef POLAR_XLOGBUF_H
@@ -60,12 +65,17 @@
 	 (polar_is_replica() || polar_bg_redo_state_is_parallel(polar_logindex_redo_instance)))
 
 #define POLAR_XLOG_BUFFER_TOTAL_COUNT() (polar_xlog_page_buffers * 1024 / (XLOG_BLCKSZ / 1024))
-#define polar_get_xlog_buffer_id(lsn) (((lsn) / XLOG_BLCKSZ) % POLAR_XLOG_BUFFER_TOTAL_COUNT())
+/* The number of buffers in one set, it always divides the total count */
+#define POLAR_XLOG_BUFFER_WAYS 4
+#define POLAR_XLOG_BUFFER_SET_COUNT() (POLAR_XLOG_BUFFER_TOTAL_COUNT() / POLAR_XLOG_BUFFER_WAYS)
+#define polar_get_xlog_buffer_set(lsn) (((lsn) / XLOG_BLCKSZ) % POLAR_XLOG_BUFFER_SET_COUNT())
+#define polar_get_xlog_buffer_set_first(set) ((set) * POLAR_XLOG_BUFFER_WAYS)
 #define polar_get_xlog_buffer_desc(buf_id) (&(polar_xlog_buffer_ins->buffer_descriptors[(buf_id)].desc))
 #define polar_get_xlog_buffer(buf_id) ((char *)(polar_xlog_buffer_ins->buffers + ((Size)(buf_id)) * XLOG_BLCKSZ))
-#define polar_xlog_buffer_desc_get_lock(buf) ((LWLock*)&(polar_xlog_buffer_ins->buffer_lock_array[(buf)->buf_id].lock))
+#define polar_xlog_buffer_set_get_lock(set) ((LWLock*)&(polar_xlog_buffer_ins->buffer_lock_array[(set)].lock))
 
 #define XLOGBUFFERDESC_PAD_TO_SIZE	(SIZEOF_VOID_P == 8 ? 64 : 1)
+/* The max number of xlog pages read ahead by one io */
 #define MAX_READ_AHEAD_XLOGS 200
 
 /*
@@ -89,6 +99,8 @@ typedef struct polar_xlog_buffer_desc
 	int			buf_id;			/* buffer index */
 	XLogRecPtr	start_lsn;
 	XLogRecPtr	end_lsn;
+	/* The last page evicted from this buffer, used to count conflict miss */
+	XLogRecPtr	evicted_lsn;
 } polar_xlog_buffer_desc;
 
 typedef union polar_xlog_buffer_desc_padded
@@ -106,6 +118,10 @@ typedef struct polar_xlog_buffer_ctl_t
 	pg_atomic_uint64 io_count;
 	pg_atomic_uint64 others_append_count;
 	pg_atomic_uint64 startup_append_count;
+	/* Missed pages which were evicted by other pages of the same set */
+	pg_atomic_uint64 conflict_miss_count;
+	/* Pages appended by read ahead besides the requested ones */
+	pg_atomic_uint64 read_ahead_count;
 } polar_xlog_buffer_ctl_t;
 typedef polar_xlog_buffer_ctl_t *polar_xlog_buffer_ctl;
 
@@ -121,29 +137,8 @@ extern bool polar_xlog_buffer_lookup(XLogRecPtr cur_page_lsn, int len, char *cur
 extern bool polar_xlog_buffer_append(XLogRecPtr cur_page_lsn, int len, char *cur_page);
 extern void polar_xlog_buffer_update(XLogRecPtr lsn);
 extern void polar_xlog_buffer_remove(XLogRecPtr lsn);
-
-static inline void
-polar_xlog_buffer_unlock(int buf_id)
-{
-	LWLockRelease(polar_xlog_buffer_desc_get_lock(polar_get_xlog_buffer_desc(buf_id)));
-}
-
-/*
- * POLAR: Judge whether evict the buffer page from desc or not.
- *
- * Caller should hold the desc lock.
- *
- * For now, if requested page is older than buffed page, it won't evict buffer.
- */
-static inline bool
-polar_xlog_buffer_should_evict(polar_xlog_buffer_desc *buf, XLogRecPtr lsn, int len)
-{
-	/* If buffer valid size is smaller than current data, evict it.  */
-	if (buf->end_lsn >= lsn + len - 1)
-		return false;
-
-	return true;
-}
+extern int	polar_xlog_buffer_read_ahead_depth(XLogRecPtr page_lsn);
+extern void polar_xlog_buffer_read_ahead_done(XLogRecPtr page_lsn, int npages, int nappended);
 
 static inline void
 polar_xlog_buffer_remove_range(XLogRecPtr start_lsn, XLogRecPtr end_lsn)
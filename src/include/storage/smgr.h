@@ -129,6 +129,8 @@ extern void polar_smgr_init_bulk_extend(SMgrRelation reln, ForkNumber forknum);
 extern void polar_smgr_clear_bulk_extend(SMgrRelation reln, ForkNumber forknum);
 extern void polar_smgrbulkread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 							   int blockCount, char *buffer);
+extern void polar_smgrbulkwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+								int blockCount, char *buffer, bool skipFsync);
 
 /* POLAR end */
 
@@ -341,6 +341,9 @@ extern PGDLLIMPORT bool trace_sort;
 
 /* POLAR: buffer manager */
 extern bool polar_enable_strategy_reject_buffer;
+extern bool polar_enable_buffer_2q;
+extern int	polar_buffer_sweep_partitions;
+extern bool polar_enable_buffer_lockfree_lookup;
 extern bool polar_hot_standby_enable_vm;
 extern bool polar_enable_control_vm_flush;
 extern bool polar_force_flush_buffer;
@@ -360,6 +363,12 @@ extern int	polar_parallel_new_bgwriter_threshold_lag;
 extern int	polar_parallel_new_bgwriter_threshold_time;
 extern int	polar_bgwriter_flush_batch_size;
 extern int	polar_bgwriter_batch_size;
+extern int	polar_bgwriter_max_coalesce_size;
+extern int	polar_bgwriter_target_lag;
+extern double polar_bgwriter_target_clean_ratio;
+extern double polar_bgwriter_control_kp;
+extern double polar_bgwriter_control_ki;
+extern double polar_bgwriter_control_kd;
 extern int	polar_lru_bgwriter_max_pages;
 extern int	polar_lru_batch_pages;
 extern int	polar_parallel_bgwriter_delay;
@@ -620,6 +629,7 @@ extern int	polar_min_bulk_extend_table_size;
 extern bool polar_enable_primary_recovery_bulk_extend;
 extern int	polar_bulk_extend_size;
 extern int	polar_bulk_read_size;
+extern int	polar_bulk_read_prefetch_distance;
 
 extern int	polar_index_bulk_extend_size;
 
@@ -51,7 +51,8 @@ typedef enum
 	WAIT_EVENT_LOGINDEX_BG_MAIN,
 	WAIT_EVENT_POLAR_SUB_TASK_MAIN,
 	WAIT_EVENT_LOGINDEX_SAVER_MAIN,
-	WAIT_EVENT_ASYNC_LOCK_REPLAY_MAIN
+	WAIT_EVENT_ASYNC_LOCK_REPLAY_MAIN,
+	WAIT_EVENT_POLAR_PREFETCH_MAIN
 	/* POLAR end */
 } WaitEventActivity;
 
@@ -0,0 +1,29 @@
+#!/bin/bash
+#
+# Lookup the same buffers from many sessions at once, with and without the
+# buffer mapping lock. The time per lookup of each way is written into the
+# server log by test_buffer_lookup_stress.
+#
+# Usage: lookup.sh [psql/pgbench connection options]
+#
+# Set polar_enable_buffer_lockfree_lookup = on and restart the server before
+# running this script, otherwise only the locked lookups are measured.
+
+CLIENTS=${CLIENTS:-32}
+LOOPS=${LOOPS:-1000}
+TRANSACTIONS=${TRANSACTIONS:-10}
+
+psql -q $* <<SQL || exit $?
+CREATE EXTENSION IF NOT EXISTS test_buffer;
+DROP TABLE IF EXISTS bench_lookup;
+CREATE TABLE bench_lookup (id int, val text);
+INSERT INTO bench_lookup SELECT i, repeat('x', 500) FROM generate_series(1, 20000) i;
+SQL
+
+echo "SELECT test_buffer_lookup_stress('bench_lookup', $LOOPS);" > /tmp/lookup_$$.sql
+
+pgbench -n -c $CLIENTS -j $CLIENTS -t $TRANSACTIONS -f /tmp/lookup_$$.sql $*
+ret=$?
+
+rm -f /tmp/lookup_$$.sql
+exit $ret
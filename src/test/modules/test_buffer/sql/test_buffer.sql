@@ -6,3 +6,16 @@ BEGIN;
 SET TRANSACTION ISOLATION LEVEL SERIALIZABLE, READ ONLY, DEFERRABLE;
 SELECT test_buffer();
 ABORT;
+
+-- Put fake buffers into a private flush list and remove them repeatedly
+SELECT test_flush_list_stress(100);
+
+-- Lookup buffers of a table with and without buffer mapping lock
+CREATE TABLE test_buffer_lookup_tbl (id int, val text);
+INSERT INTO test_buffer_lookup_tbl SELECT i, repeat('x', 500) FROM generate_series(1, 2000) i;
+SELECT test_buffer_lookup_stress('test_buffer_lookup_tbl', 100);
+DROP TABLE test_buffer_lookup_tbl;
+
+-- Move colliding entries of the lock-free lookup table around
+SELECT test_buffer_lookup_shift();
+SELECT test_buffer_lookup_churn(10000);
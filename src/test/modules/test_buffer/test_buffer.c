@@ -29,12 +29,15 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include "access/relation.h"
 #include "access/xlog.h"
+#include "access/xlogrecovery.h"
 #include "fmgr.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "postmaster/bgworker.h"
 #include "postmaster/postmaster.h"
+#include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
 #include "storage/polar_bufmgr.h"
@@ -44,11 +47,32 @@
 #include "utils/elog.h"
 #include "utils/memutils.h"
 #include "utils/ps_status.h"
+#include "utils/timestamp.h"
 
 PG_MODULE_MAGIC;
 
 #define CHECK_BUFFER_BATCH	100
 #define CHECK_BUFFER_COUNT	100
+#define STRESS_BUFFER_COUNT 1024
+#define STRESS_BATCH_SIZE	64
+#define STRESS_LSN_STEP		8192
+#define LOOKUP_BUFFER_COUNT 1024
+#define LOOKUP_SHIFT_ENTRIES 5
+#define LOOKUP_CHURN_PARTITIONS 4
+#define LOOKUP_CHURN_ENTRIES 3
+#define LOOKUP_CHURN_ROUNDS 16
+
+/*
+ * Fake entries of buffer mapping table for the lookup tests. The hash code
+ * is made up of the partition and the home slot in the lock-free lookup
+ * table, so that entries can be made to collide. The home slot after the
+ * last one of a slice is its first slot.
+ */
+#define LOOKUP_FAKE_HASH(part, home) \
+	((uint32) ((home) * NUM_BUFFER_PARTITIONS + (part)))
+#define LOOKUP_LAST_HOME (PG_UINT32_MAX / NUM_BUFFER_PARTITIONS)
+
+void		test_buffer_lookup_churn_main(Datum main_arg);
 
 static bool
 check_two_buffers(int front, int back)
@@ -71,31 +95,33 @@ check_two_buffers(int front, int back)
 }
 
 static void
-check_one_batch_buffer()
+check_one_batch_buffer(FlushListPartition *part)
 {
 	int			first,
 				last,
 				mid,
 				check = 0;
-	BufferDesc *mid_buf = NULL;
 	BufferDesc *first_buf = NULL;
 
 	/* Do not hold this lock too long. */
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
-	first = polar_flush_ctl->first_flush_buffer;
-	last = polar_flush_ctl->last_flush_buffer;
+	SpinLockAcquire(&part->flushlist_lock);
+	first = part->first_flush_buffer;
+	last = part->last_flush_buffer;
 
-	/* Flushlist is empty. */
+	/* Flushlist partition is empty. */
 	if (first == POLAR_FLUSHNEXT_END_OF_LIST)
 	{
 		Assert(last == POLAR_FLUSHNEXT_END_OF_LIST);
-		SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+		Assert(part->current_pos == POLAR_FLUSHNEXT_NOT_IN_LIST);
+		SpinLockRelease(&part->flushlist_lock);
 		return;
 	}
 
 	Assert(check_two_buffers(first, last));
 
-	/* Check #CHECK_BUFFER_COUNT buffers in flush list. */
+	/* Check #CHECK_BUFFER_COUNT buffers in flush list partition. */
+	first_buf = GetBufferDescriptor(first);
+	Assert(polar_flush_list_partition(polar_buffer_get_oldest_lsn(first_buf), first_buf->buf_id) == part);
 	mid = first_buf->flush_next;
 	Assert(mid != POLAR_FLUSHNEXT_NOT_IN_LIST);
 	while (mid != POLAR_FLUSHNEXT_END_OF_LIST &&
@@ -103,13 +129,13 @@ check_one_batch_buffer()
 	{
 		Assert(check_two_buffers(first, mid));
 		Assert(check_two_buffers(mid, last));
+		Assert(polar_flush_list_partition(polar_buffer_get_oldest_lsn(GetBufferDescriptor(mid)), mid) == part);
 		first = mid;
-		mid_buf = GetBufferDescriptor(mid);
-		mid = mid_buf->flush_next;
+		mid = GetBufferDescriptor(mid)->flush_next;
 		check++;
 	}
 
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+	SpinLockRelease(&part->flushlist_lock);
 }
 
 static void
@@ -117,27 +143,16 @@ check_consistent_lsn()
 {
 	XLogRecPtr	first_lsn;
 	XLogRecPtr	consistent_lsn;
-	int			first;
 
 	consistent_lsn = polar_get_consistent_lsn();
-
-	/* Do not hold this lock too much time. */
-	SpinLockAcquire(&polar_flush_ctl->flushlist_lock);
-	first = polar_flush_ctl->first_flush_buffer;
+	first_lsn = polar_get_flush_list_oldest_lsn(polar_max_valid_lsn());
 
 	/* Flushlist is empty. */
-	if (first == POLAR_FLUSHNEXT_END_OF_LIST)
-	{
-		SpinLockRelease(&polar_flush_ctl->flushlist_lock);
+	if (XLogRecPtrIsInvalid(first_lsn))
 		return;
-	}
 
-	first_lsn = polar_buffer_get_oldest_lsn(GetBufferDescriptor(first));
-	SpinLockRelease(&polar_flush_ctl->flushlist_lock);
-
-	Assert(!XLogRecPtrIsInvalid(first_lsn));
 	/* Check consistent lsn. */
-	if (!XLogRecPtrIsInvalid(consistent_lsn) && !XLogRecPtrIsInvalid(first_lsn))
+	if (!XLogRecPtrIsInvalid(consistent_lsn))
 		Assert(consistent_lsn <= first_lsn);
 }
 
@@ -148,7 +163,10 @@ check_some_buffers()
 
 	while (batch <= CHECK_BUFFER_BATCH)
 	{
-		check_one_batch_buffer();
+		int			i;
+
+		for (i = 0; i < POLAR_FLUSH_LIST_BUCKETS * POLAR_FLUSH_LIST_PARTITIONS; i++)
+			check_one_batch_buffer(&polar_flush_ctl->partition[i].part);
 		batch++;
 	}
 }
@@ -167,10 +185,22 @@ test_flushlist()
 static void
 test_copybuffer()
 {
+	int			i;
+	int			size = 0;
+
 	if (!polar_copy_buffer_enabled())
 		return;
 
 	Assert(polar_copy_buffer_ctl != NULL);
+	Assert(polar_copy_buffer_ctl->partition_num > 0 &&
+		   polar_copy_buffer_ctl->partition_num <= POLAR_COPY_BUFFER_MAX_PARTITIONS);
+
+	for (i = 0; i < polar_copy_buffer_ctl->partition_num; i++)
+		size += polar_copy_buffer_ctl->partition[i].part.size;
+
+	if (size != polar_copy_buffers)
+		elog(ERROR, "copy buffer partitions have %d buffers, expected %d",
+			 size, polar_copy_buffers);
 }
 
 PG_FUNCTION_INFO_V1(test_buffer);
@@ -191,3 +221,495 @@ test_buffer(PG_FUNCTION_ARGS)
 	test_copybuffer();
 	PG_RETURN_VOID();
 }
+
+/*
+ * Report the throughput of one kind of operation of a stress test, which
+ * was done count times since start.
+ */
+static void
+stress_report(const char *test, const char *op, TimestampTz start, uint64 count)
+{
+	long		secs;
+	int			usecs;
+	double		elapsed;
+
+	TimestampDifference(start, GetCurrentTimestamp(), &secs, &usecs);
+	elapsed = secs * 1000000.0 + usecs;
+
+	elog(LOG, "%s stress: %s " UINT64_FORMAT " times in %.0f us, %.3f us per op",
+		 test, op, count, elapsed, count > 0 ? elapsed / count : 0);
+}
+
+/*
+ * Initialize a private flush list control, like polar_init_flush_list_ctl()
+ * does for the shared one.
+ */
+static void
+stress_init_flush_list(FlushControl *ctl)
+{
+	int			i;
+
+	MemSet(ctl, 0, sizeof(FlushControl));
+
+	pg_atomic_init_u32(&ctl->count, 0);
+
+	for (i = 0; i < POLAR_FLUSH_LIST_BUCKETS * POLAR_FLUSH_LIST_PARTITIONS; i++)
+	{
+		FlushListPartition *part = &ctl->partition[i].part;
+
+		SpinLockInit(&part->flushlist_lock);
+		part->first_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+		part->last_flush_buffer = POLAR_FLUSHNEXT_END_OF_LIST;
+		part->current_pos = POLAR_FLUSHNEXT_NOT_IN_LIST;
+	}
+
+	pg_atomic_init_u64(&ctl->start_lsn, InvalidXLogRecPtr);
+	LWLockInitialize(&ctl->batchlock, LWTRANCHE_POLAR_FLUSH_LIST_BATCH);
+
+	pg_atomic_init_u64(&ctl->insert, 0);
+	pg_atomic_init_u64(&ctl->remove, 0);
+	pg_atomic_init_u64(&ctl->cbuf, 0);
+	pg_atomic_init_u64(&ctl->batch_read, 0);
+}
+
+/*
+ * Insert, remove, adjust and batch the fake buffers on the private flush
+ * list, and report the throughput of each kind of operation. The buffers are
+ * given increasing oldest lsn, STRESS_LSN_STEP apart, like the ones dirtied
+ * by a write workload.
+ */
+static void
+stress_flush_list(int loops)
+{
+	int			batch_buf[STRESS_BATCH_SIZE];
+	XLogRecPtr	lsn = GetXLogInsertRecPtr();
+	TimestampTz start;
+	int			loop;
+	int			i;
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+	{
+		for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+			polar_put_buffer_to_flush_list(GetBufferDescriptor(i), lsn + (XLogRecPtr) i * STRESS_LSN_STEP);
+		for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+			polar_remove_buffer_from_flush_list(GetBufferDescriptor(i));
+		lsn += (XLogRecPtr) STRESS_BUFFER_COUNT * STRESS_LSN_STEP;
+	}
+	stress_report("flush list", "insert and remove", start, (uint64) loops * STRESS_BUFFER_COUNT * 2);
+
+	for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+		polar_put_buffer_to_flush_list(GetBufferDescriptor(i), lsn + (XLogRecPtr) i * STRESS_LSN_STEP);
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+		polar_get_batch_buffer(batch_buf, STRESS_BATCH_SIZE);
+	stress_report("flush list", "get batch", start, (uint64) loops);
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+	{
+		if (polar_get_flush_list_oldest_lsn(PG_UINT64_MAX) != lsn)
+			elog(ERROR, "oldest lsn of flush list is not the one of first buffer");
+	}
+	stress_report("flush list", "oldest lsn", start, (uint64) loops);
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+	{
+		for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+			polar_adjust_position_in_flush_list(GetBufferDescriptor(i));
+	}
+	stress_report("flush list", "adjust", start, (uint64) loops * STRESS_BUFFER_COUNT);
+
+	check_some_buffers();
+
+	for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+		polar_remove_buffer_from_flush_list(GetBufferDescriptor(i));
+
+	if (pg_atomic_read_u32(&polar_flush_ctl->count) != 0)
+		elog(ERROR, "flush list is not empty after all buffers are removed");
+}
+
+PG_FUNCTION_INFO_V1(test_flush_list_stress);
+/*
+ * Run the flush list code on STRESS_BUFFER_COUNT fake buffers, which are put
+ * into a private flush list, so it doesn't race with the bgwriter and the
+ * checkpointer on the shared one. The buffer descriptors and the flush list
+ * control of this backend point to the private ones meanwhile, and the flush
+ * list is enabled in this backend only.
+ */
+Datum
+test_flush_list_stress(PG_FUNCTION_ARGS)
+{
+	int			loops = PG_GETARG_INT32(0);
+	BufferDescPadded *descs;
+	BufferDescPadded *saved_descs = BufferDescriptors;
+	FlushControl *saved_ctl = polar_flush_ctl;
+	bool		saved_shared_storage_mode = polar_enable_shared_storage_mode;
+	bool		saved_flushlist = polar_enable_flushlist;
+	int			i;
+
+	descs = palloc0(sizeof(BufferDescPadded) * STRESS_BUFFER_COUNT);
+	for (i = 0; i < STRESS_BUFFER_COUNT; i++)
+	{
+		BufferDesc *buf = &descs[i].bufferdesc;
+
+		buf->buf_id = i;
+		buf->tag.forkNum = MAIN_FORKNUM;
+		pg_atomic_init_u32(&buf->state, 0);
+		buf->oldest_lsn = InvalidXLogRecPtr;
+		buf->flush_next = POLAR_FLUSHNEXT_NOT_IN_LIST;
+		buf->flush_prev = POLAR_FLUSHNEXT_NOT_IN_LIST;
+	}
+
+	polar_flush_ctl = palloc(sizeof(FlushControl));
+	stress_init_flush_list(polar_flush_ctl);
+
+	PG_TRY();
+	{
+		BufferDescriptors = descs;
+		polar_enable_shared_storage_mode = true;
+		polar_enable_flushlist = true;
+
+		stress_flush_list(loops);
+	}
+	PG_FINALLY();
+	{
+		BufferDescriptors = saved_descs;
+		polar_flush_ctl = saved_ctl;
+		polar_enable_shared_storage_mode = saved_shared_storage_mode;
+		polar_enable_flushlist = saved_flushlist;
+	}
+	PG_END_TRY();
+
+	PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(test_buffer_lookup_stress);
+/*
+ * Lookup the pinned buffers of the relation in buffer mapping table many
+ * times, with and without the mapping lock, and report the throughput of
+ * each way. Run it from many sessions at once to see how the lookups scale.
+ */
+Datum
+test_buffer_lookup_stress(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	int			loops = PG_GETARG_INT32(1);
+	Relation	rel;
+	Buffer	   *buffers;
+	BufferTag  *tags;
+	uint32	   *hashes;
+	BlockNumber nblocks;
+	TimestampTz start;
+	uint64		hits = 0;
+	int			loop;
+	int			i;
+
+	rel = relation_open(relid, AccessShareLock);
+	nblocks = Min(RelationGetNumberOfBlocks(rel), LOOKUP_BUFFER_COUNT);
+
+	buffers = palloc(sizeof(Buffer) * nblocks);
+	tags = palloc(sizeof(BufferTag) * nblocks);
+	hashes = palloc(sizeof(uint32) * nblocks);
+
+	/* Keep the buffers pinned so that their mapping can't change */
+	for (i = 0; i < nblocks; i++)
+	{
+		buffers[i] = ReadBuffer(rel, i);
+		tags[i] = GetBufferDescriptor(buffers[i] - 1)->tag;
+		hashes[i] = BufTableHashCode(&tags[i]);
+	}
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+	{
+		for (i = 0; i < nblocks; i++)
+		{
+			LWLock	   *lock = BufMappingPartitionLock(hashes[i]);
+			int			buf_id;
+
+			LWLockAcquire(lock, LW_SHARED);
+			buf_id = BufTableLookup(&tags[i], hashes[i]);
+			LWLockRelease(lock);
+
+			if (buf_id != buffers[i] - 1)
+				elog(ERROR, "buffer %d is found as %d with mapping lock",
+					 buffers[i] - 1, buf_id);
+		}
+	}
+	stress_report("buffer lookup", "locked", start, (uint64) loops * nblocks);
+
+	start = GetCurrentTimestamp();
+	for (loop = 0; loop < loops; loop++)
+	{
+		for (i = 0; i < nblocks; i++)
+		{
+			int			buf_id = polar_buf_table_lookup_optimistic(&tags[i], hashes[i]);
+
+			if (buf_id >= 0)
+				hits++;
+
+			if (buf_id >= 0 && buf_id != buffers[i] - 1)
+				elog(ERROR, "buffer %d is found as %d without mapping lock",
+					 buffers[i] - 1, buf_id);
+		}
+	}
+	stress_report("buffer lookup", "lock-free", start, (uint64) loops * nblocks);
+
+	if (polar_enable_buffer_lockfree_lookup && hits == 0 && nblocks > 0)
+		elog(WARNING, "no buffer is found without mapping lock");
+
+	for (i = 0; i < nblocks; i++)
+		ReleaseBuffer(buffers[i]);
+
+	relation_close(rel, AccessShareLock);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Fake tags belong to no relation, so no backend looks them up but us. This
+ * relies on no real tag ever having InvalidOid as its tablespace, database
+ * and relfilenode. The fake entries are put into the live buffer mapping
+ * table and map to real buffer ids, which is harmless for the same reason.
+ * The block number of a fake tag is also used as its buffer id.
+ */
+static void
+lookup_fake_tag(BufferTag *tag, BlockNumber blockno)
+{
+	RelFileNode rnode = {InvalidOid, InvalidOid, InvalidOid};
+
+	INIT_BUFFERTAG(*tag, rnode, MAIN_FORKNUM, blockno);
+}
+
+PG_FUNCTION_INFO_V1(test_buffer_lookup_shift);
+/*
+ * Insert entries colliding in the lock-free lookup table, delete them one by
+ * one and check that the others are still found after the backward shifts.
+ * The last home slot of a slice is used, so the probes wrap around.
+ */
+Datum
+test_buffer_lookup_shift(PG_FUNCTION_ARGS)
+{
+	/* Home slots after the last one of the slice */
+	static const uint32 homes[LOOKUP_SHIFT_ENTRIES] = {0, 0, 1, 0, 2};
+	static const int deletes[LOOKUP_SHIFT_ENTRIES] = {0, 2, 1, 3, 4};
+	BufferTag	tags[LOOKUP_SHIFT_ENTRIES];
+	uint32		hashes[LOOKUP_SHIFT_ENTRIES];
+	bool		present[LOOKUP_SHIFT_ENTRIES];
+	LWLock	   *lock;
+	int			wrong = -1;
+	int			wrong_step = -1;
+	int			n;
+	int			i;
+
+	if (!polar_enable_buffer_lockfree_lookup)
+	{
+		elog(WARNING, "polar_enable_buffer_lockfree_lookup is off");
+		PG_RETURN_VOID();
+	}
+
+	for (i = 0; i < LOOKUP_SHIFT_ENTRIES; i++)
+	{
+		lookup_fake_tag(&tags[i], i);
+		hashes[i] = LOOKUP_FAKE_HASH(0, LOOKUP_LAST_HOME + homes[i]);
+		present[i] = true;
+	}
+
+	/* All entries are in one partition, nobody else changes it meanwhile */
+	lock = BufMappingPartitionLock(hashes[0]);
+	LWLockAcquire(lock, LW_EXCLUSIVE);
+
+	for (i = 0; i < LOOKUP_SHIFT_ENTRIES; i++)
+	{
+		if (BufTableInsert(&tags[i], hashes[i], i) >= 0 && wrong < 0)
+			wrong = i;
+	}
+
+	/* Don't error out before all of the fake entries are deleted */
+	for (n = 0; n <= LOOKUP_SHIFT_ENTRIES; n++)
+	{
+		for (i = 0; i < LOOKUP_SHIFT_ENTRIES && wrong < 0; i++)
+		{
+			if (polar_buf_table_lookup_optimistic(&tags[i], hashes[i]) !=
+				(present[i] ? i : -1))
+			{
+				wrong = i;
+				wrong_step = n;
+			}
+		}
+
+		if (n < LOOKUP_SHIFT_ENTRIES)
+		{
+			i = deletes[n];
+			BufTableDelete(&tags[i], hashes[i]);
+			present[i] = false;
+		}
+	}
+
+	LWLockRelease(lock);
+
+	if (wrong >= 0)
+		elog(ERROR, "entry %d is not found as expected without mapping lock after %d deletes",
+			 wrong, wrong_step);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Background worker of test_buffer_lookup_churn. Insert colliding entries
+ * into some slices and delete them again, the first deleted one makes the
+ * following entries shift back.
+ */
+void
+test_buffer_lookup_churn_main(Datum main_arg)
+{
+	static const uint32 homes[LOOKUP_CHURN_ENTRIES] = {0, 0, 1};
+	int			loops = DatumGetInt32(main_arg);
+	BufferTag	tags[LOOKUP_CHURN_PARTITIONS][LOOKUP_CHURN_ENTRIES];
+	uint32		hashes[LOOKUP_CHURN_PARTITIONS][LOOKUP_CHURN_ENTRIES];
+	int			loop;
+	int			p;
+	int			i;
+
+	BackgroundWorkerUnblockSignals();
+
+	for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+	{
+		for (i = 0; i < LOOKUP_CHURN_ENTRIES; i++)
+		{
+			lookup_fake_tag(&tags[p][i], LOOKUP_SHIFT_ENTRIES + LOOKUP_CHURN_PARTITIONS +
+							p * LOOKUP_CHURN_ENTRIES + i);
+			hashes[p][i] = LOOKUP_FAKE_HASH(p, LOOKUP_LAST_HOME + homes[i]);
+		}
+	}
+
+	for (loop = 0; loop < loops; loop++)
+	{
+		for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+		{
+			LWLock	   *lock = BufMappingPartitionLock(hashes[p][0]);
+
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			for (i = 0; i < LOOKUP_CHURN_ENTRIES; i++)
+				BufTableInsert(&tags[p][i], hashes[p][i], (int) tags[p][i].blockNum);
+			LWLockRelease(lock);
+
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			BufTableDelete(&tags[p][0], hashes[p][0]);
+			LWLockRelease(lock);
+
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			for (i = 1; i < LOOKUP_CHURN_ENTRIES; i++)
+				BufTableDelete(&tags[p][i], hashes[p][i]);
+			LWLockRelease(lock);
+		}
+	}
+}
+
+PG_FUNCTION_INFO_V1(test_buffer_lookup_churn);
+/*
+ * Lookup entries without the mapping lock while a background worker inserts
+ * and deletes colliding entries in the same slices of the lock-free lookup
+ * table. Our entries are placed behind the ones of the worker, so they are
+ * moved by its deletes and the lookups have to retry. A lookup may give up
+ * and return -1, but must never return the buffer of another entry.
+ */
+Datum
+test_buffer_lookup_churn(PG_FUNCTION_ARGS)
+{
+	int			loops = PG_GETARG_INT32(0);
+	BackgroundWorker worker;
+	BackgroundWorkerHandle *handle;
+	BufferTag	tags[LOOKUP_CHURN_PARTITIONS];
+	uint32		hashes[LOOKUP_CHURN_PARTITIONS];
+	pid_t		pid;
+	uint64		lookups = 0;
+	uint64		hits = 0;
+	int			wrong = -1;
+	int			wrong_id = -1;
+	int			n;
+	int			p;
+
+	if (!polar_enable_buffer_lockfree_lookup)
+	{
+		elog(WARNING, "polar_enable_buffer_lockfree_lookup is off");
+		PG_RETURN_VOID();
+	}
+
+	for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+	{
+		lookup_fake_tag(&tags[p], LOOKUP_SHIFT_ENTRIES + p);
+		hashes[p] = LOOKUP_FAKE_HASH(p, LOOKUP_LAST_HOME);
+	}
+
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	worker.bgw_restart_time = BGW_NEVER_RESTART;
+	sprintf(worker.bgw_library_name, "test_buffer");
+	sprintf(worker.bgw_function_name, "test_buffer_lookup_churn_main");
+	snprintf(worker.bgw_name, BGW_MAXLEN, "test_buffer_lookup_churn");
+	snprintf(worker.bgw_type, BGW_MAXLEN, "test_buffer_lookup_churn");
+	worker.bgw_main_arg = Int32GetDatum(loops);
+	worker.bgw_notify_pid = MyProcPid;
+
+	if (!RegisterDynamicBackgroundWorker(&worker, &handle))
+		elog(ERROR, "could not register background process");
+
+	if (WaitForBackgroundWorkerStartup(handle, &pid) != BGWH_STARTED)
+		elog(ERROR, "could not start background process");
+
+	do
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+		{
+			LWLock	   *lock = BufMappingPartitionLock(hashes[p]);
+
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			BufTableInsert(&tags[p], hashes[p], (int) tags[p].blockNum);
+			LWLockRelease(lock);
+		}
+
+		for (n = 0; n < LOOKUP_CHURN_ROUNDS; n++)
+		{
+			for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+			{
+				int			buf_id = polar_buf_table_lookup_optimistic(&tags[p], hashes[p]);
+
+				lookups++;
+				if (buf_id == (int) tags[p].blockNum)
+					hits++;
+				else if (buf_id >= 0 && wrong < 0)
+				{
+					wrong = tags[p].blockNum;
+					wrong_id = buf_id;
+				}
+			}
+		}
+
+		for (p = 0; p < LOOKUP_CHURN_PARTITIONS; p++)
+		{
+			LWLock	   *lock = BufMappingPartitionLock(hashes[p]);
+
+			LWLockAcquire(lock, LW_EXCLUSIVE);
+			BufTableDelete(&tags[p], hashes[p]);
+			LWLockRelease(lock);
+		}
+	} while (GetBackgroundWorkerPid(handle, &pid) != BGWH_STOPPED);
+
+	elog(LOG, "buffer lookup churn: " UINT64_FORMAT " lookups, " UINT64_FORMAT " hits",
+		 lookups, hits);
+
+	if (wrong >= 0)
+		elog(ERROR, "buffer %d is found as %d without mapping lock", wrong, wrong_id);
+
+	if (hits == 0)
+		elog(WARNING, "no buffer is found without mapping lock");
+
+	PG_RETURN_VOID();
+}
@@ -0,0 +1,66 @@
+#!/bin/bash
+#
+# Mixed OLTP and reporting workload to compare the hit rate of the hot table
+# with and without polar_enable_buffer_2q.
+#
+# Usage: benchmark.sh [psql/pgbench connection options]
+#
+# Make shared_buffers much smaller than bench_report and larger than the hot
+# part of pgbench_accounts, for example shared_buffers = 128MB with the
+# default sizes. polar_buffer_sweep_partitions needs a restart to change, so
+# set it before running this script. OLTP_WEIGHT and REPORT_WEIGHT set the
+# mix of the two scripts.
+
+SCALE=${SCALE:-20}
+REPORT_ROWS=${REPORT_ROWS:-2000000}
+REPORT_RANGE=${REPORT_RANGE:-50000}
+OLTP_WEIGHT=${OLTP_WEIGHT:-9}
+REPORT_WEIGHT=${REPORT_WEIGHT:-1}
+CLIENTS=${CLIENTS:-8}
+DURATION=${DURATION:-60}
+WARMUP=${WARMUP:-10}
+
+cd "$(dirname "$0")"
+
+pgbench -i -q -s $SCALE $* || exit $?
+
+psql -q $* <<SQL || exit $?
+DROP TABLE IF EXISTS bench_report;
+CREATE TABLE bench_report AS
+  SELECT i AS id, repeat('x', 200) AS filler FROM generate_series(1, $REPORT_ROWS) i;
+CREATE INDEX ON bench_report (id);
+VACUUM ANALYZE bench_report;
+SQL
+
+VARS="-D scale=$SCALE -D report_rows=$REPORT_ROWS -D report_range=$REPORT_RANGE"
+
+run()
+{
+  psql -q $* -c "ALTER SYSTEM SET polar_enable_buffer_2q = $policy" -c "SELECT pg_reload_conf()" >/dev/null || exit $?
+
+  # Warm up shared buffers with the same workload
+  pgbench -n -T $WARMUP -c $CLIENTS -j $CLIENTS $VARS \
+    -f oltp.sql@$OLTP_WEIGHT -f report.sql@$REPORT_WEIGHT $* >/dev/null || exit $?
+
+  psql -q $* -c "SELECT pg_stat_reset()" >/dev/null || exit $?
+
+  tps=`pgbench -n -T $DURATION -c $CLIENTS -j $CLIENTS $VARS \
+    -f oltp.sql@$OLTP_WEIGHT -f report.sql@$REPORT_WEIGHT $* 2>/dev/null | grep '^tps' | awk '{print $3}'`
+
+  # Wait for the backends of pgbench to report their statistics
+  sleep 1
+
+  hit=`psql -At $* -c "SELECT round(100.0 * sum(heap_blks_hit + idx_blks_hit) / nullif(sum(heap_blks_hit + heap_blks_read + idx_blks_hit + idx_blks_read), 0), 2) FROM pg_statio_user_tables WHERE relname = 'pgbench_accounts'"`
+
+  echo "| $policy | $hit | $tps |"
+}
+
+echo '| polar_enable_buffer_2q | pgbench_accounts hit rate (%) | tps |'
+echo '| ---------------------- | ----------------------------- | --- |'
+
+for policy in off on
+do
+  run $*
+done
+
+psql -q $* -c "ALTER SYSTEM RESET polar_enable_buffer_2q" -c "SELECT pg_reload_conf()" >/dev/null
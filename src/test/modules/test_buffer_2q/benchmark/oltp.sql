@@ -0,0 +1,7 @@
+-- Point lookups and updates on the hot part of pgbench_accounts
+\set aid random_gaussian(1, 100000 * :scale, 5.0)
+\set delta random(-5000, 5000)
+BEGIN;
+UPDATE pgbench_accounts SET abalance = abalance + :delta WHERE aid = :aid;
+SELECT abalance FROM pgbench_accounts WHERE aid = :aid;
+END;
@@ -0,0 +1,7 @@
+-- Reporting query which reads a range of bench_report larger than the hot
+-- set through its index. Index scans don't use a buffer ring like a large
+-- seq scan does, so the pages read only once compete with the hot pages.
+\set start random(1, :report_rows - :report_range)
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*), sum(length(filler)) FROM bench_report WHERE id BETWEEN :start AND :start + :report_range;
@@ -0,0 +1,32 @@
+-- Pages read only once by index range scans don't push hot pages out with 2Q
+CREATE TABLE test_2q_hot (id int, val text);
+INSERT INTO test_2q_hot SELECT i, repeat('x', 500) FROM generate_series(1, 100) i;
+CREATE TABLE test_2q_cold (id int, val text);
+INSERT INTO test_2q_cold SELECT i, repeat('x', 500) FROM generate_series(1, 60000) i;
+CREATE INDEX ON test_2q_cold (id);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+-- Read the hot table again after it leaves the probationary queue, so it's
+-- loaded into the protected part as a ghost
+DO $$
+BEGIN
+	FOR i IN 1..5 LOOP
+		PERFORM count(*) FROM test_2q_hot;
+		PERFORM count(*) FROM test_2q_cold WHERE id BETWEEN i * 10000 AND i * 10000 + 9999;
+	END LOOP;
+END $$;
+SELECT count(*), sum(length(val)) FROM test_2q_cold WHERE id BETWEEN 1 AND 60000;
+SELECT count(*), sum(length(val)) FROM test_2q_cold WHERE id BETWEEN 1 AND 60000;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+-- The pending counters may hold earlier transactions, so compare the reads
+-- before and after the scan within one transaction
+BEGIN;
+SELECT pg_stat_get_xact_blocks_fetched('test_2q_hot'::regclass) -
+	pg_stat_get_xact_blocks_hit('test_2q_hot'::regclass) AS hot_read \gset
+SELECT count(*) FROM test_2q_hot;
+SELECT pg_stat_get_xact_blocks_fetched('test_2q_hot'::regclass) -
+	pg_stat_get_xact_blocks_hit('test_2q_hot'::regclass) = :hot_read AS hot_cached;
+COMMIT;
+DROP TABLE test_2q_hot;
+DROP TABLE test_2q_cold;
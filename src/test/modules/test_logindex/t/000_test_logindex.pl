@@ -67,5 +67,14 @@ $ret =
   $node_primary->safe_psql($regress_db, 'select test_checkpoint_ringbuf();');
 is($ret, '0', 'succ to execute test_checkpoint_ringbuf()!');
 
+$ret = $node_primary->safe_psql($regress_db, 'select test_logindex_lookup();');
+is($ret, '0', 'succ to execute test_logindex_lookup()!');
+
+$ret = $node_primary->safe_psql($regress_db, 'select test_logindex_compress();');
+is($ret, '0', 'succ to execute test_logindex_compress()!');
+
+$ret = $node_primary->safe_psql($regress_db, 'select test_record_cache();');
+is($ret, '0', 'succ to execute test_record_cache()!');
+
 $node_primary->stop;
 done_testing();
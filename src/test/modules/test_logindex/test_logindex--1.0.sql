@@ -30,3 +30,15 @@ AS 'MODULE_PATHNAME' LANGUAGE C;
 CREATE FUNCTION test_checkpoint_ringbuf()
 RETURNS int4 STRICT
 AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_logindex_lookup()
+RETURNS int4 STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_logindex_compress()
+RETURNS int4 STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_record_cache()
+RETURNS int4 STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -48,6 +48,7 @@
 
 #define LSN_TEST_STEP 100
 #define TEST_MAX_BLOCK_NUMBER 10
+#define TEST_BENCH_PAGES 4096
 static pid_t bgwriter_pid = 0;
 static BackgroundWorkerHandle *bgwriter_handle;
 static bool shutdown_requested = false;
@@ -641,6 +642,26 @@ test_iterate_lsn(log_index_snapshot_t * logindex_snapshot)
 	test_iterate_release(logindex_snapshot);
 }
 
+/*
+ * Search file tables one by one and in batches of different size, the
+ * iterated lsn must be the same.
+ */
+static void
+test_iterate_lsn_fanout(log_index_snapshot_t * logindex_snapshot)
+{
+	int			fanout[] = {1, 2, 7, POLAR_LOGINDEX_MAX_SEARCH_FANOUT};
+	int			save_fanout = polar_logindex_search_fanout;
+	int			i;
+
+	for (i = 0; i < lengthof(fanout); i++)
+	{
+		polar_logindex_search_fanout = fanout[i];
+		test_iterate_lsn(logindex_snapshot);
+	}
+
+	polar_logindex_search_fanout = save_fanout;
+}
+
 static void
 test_save_memtable(log_index_snapshot_t * logindex_snapshot)
 {
@@ -778,6 +799,129 @@ test_change_lsn_prefix(log_index_snapshot_t * logindex_snapshot)
 	polar_logindex_release_lsn_iterator(lsn_iter);
 }
 
+/*
+ * Insert lsn like parsing wal, each record modifies one of the hot pages.
+ * Report the insert throughput and check the lsn iterator gets all of them.
+ */
+static void
+test_insert_lsn_bench(log_index_snapshot_t * logindex_snapshot)
+{
+	BufferTag	tag;
+	XLogRecPtr *prev_lsn = palloc0(sizeof(XLogRecPtr) * TEST_BENCH_PAGES);
+	XLogRecPtr	start_lsn = test_max_lsn;
+	uint32		total = LOG_INDEX_MEM_TBL_SEG_NUM * LOG_INDEX_ITEM_SEG_LSN_NUM * 4;
+	struct timespec start_time,
+				end_time;
+	long		cost;
+	log_index_lsn_iter_t lsn_iter;
+	uint32		i;
+
+	tag.rnode.spcNode = 200;
+	tag.rnode.dbNode = 11;
+	tag.rnode.relNode = 12;
+	tag.forkNum = MAIN_FORKNUM;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	for (i = 1; i <= total; i++)
+	{
+		uint32		page = (i * 7919) % TEST_BENCH_PAGES;
+
+		tag.blockNum = page;
+		test_max_lsn += LSN_TEST_STEP;
+		polar_logindex_add_lsn(logindex_snapshot, &tag, prev_lsn[page], test_max_lsn);
+		prev_lsn[page] = test_max_lsn;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	cost = (end_time.tv_sec - start_time.tv_sec) * 1000000000 +
+		(end_time.tv_nsec - start_time.tv_nsec);
+
+	ereport(LOG, (errmsg("insert %u lsn of %d pages, cost %ld, qps=%.2lf",
+						 total, TEST_BENCH_PAGES, cost, total / (cost / 1000000000.0))));
+
+	lsn_iter = polar_logindex_create_lsn_iterator(logindex_snapshot, start_lsn + LSN_TEST_STEP);
+	test_lsn_iterator(logindex_snapshot, lsn_iter, start_lsn + LSN_TEST_STEP, test_max_lsn);
+	polar_logindex_release_lsn_iterator(lsn_iter);
+
+	pfree(prev_lsn);
+}
+
+/*
+ * Insert lsn while background writer is stopped, so the tables to be reused
+ * are moved to overflow tables until the limit is reached, and then they are
+ * force saved. Check lsn can be read from overflow tables and saved tables.
+ */
+static void
+test_overflow_table(log_index_snapshot_t * logindex_snapshot)
+{
+	BufferTag	tag;
+	XLogRecPtr *prev_lsn = palloc0(sizeof(XLogRecPtr) * TEST_BENCH_PAGES);
+	XLogRecPtr	start_lsn = test_max_lsn;
+	uint64		overflow_count = polar_logindex_overflow_count(logindex_snapshot);
+	uint32		total = LOG_INDEX_MEM_TBL_SEG_NUM * LOG_INDEX_ITEM_SEG_LSN_NUM * 8;
+	XLogRecPtr	page_prev_lsn = InvalidXLogRecPtr;
+	uint32		page_lsn_num = 0;
+	log_index_lsn_iter_t lsn_iter;
+	log_index_page_iter_t page_iter;
+	log_index_lsn_t *lsn_info;
+	uint32		i;
+
+	polar_logindex_max_overflow_tables = 4;
+
+	tag.rnode.spcNode = 201;
+	tag.rnode.dbNode = 11;
+	tag.rnode.relNode = 12;
+	tag.forkNum = MAIN_FORKNUM;
+
+	for (i = 1; i <= total; i++)
+	{
+		uint32		page = (i * 7919) % TEST_BENCH_PAGES;
+
+		tag.blockNum = page;
+		test_max_lsn += LSN_TEST_STEP;
+		polar_logindex_add_lsn(logindex_snapshot, &tag, prev_lsn[page], test_max_lsn);
+		prev_lsn[page] = test_max_lsn;
+
+		if (page == 0)
+			page_lsn_num++;
+	}
+
+	Assert(polar_logindex_overflow_count(logindex_snapshot) > overflow_count);
+	Assert(polar_logindex_overflow_tbl_size(logindex_snapshot) <= polar_logindex_max_overflow_tables);
+
+	lsn_iter = polar_logindex_create_lsn_iterator(logindex_snapshot, start_lsn + LSN_TEST_STEP);
+	test_lsn_iterator(logindex_snapshot, lsn_iter, start_lsn + LSN_TEST_STEP, test_max_lsn);
+	polar_logindex_release_lsn_iterator(lsn_iter);
+
+	tag.blockNum = 0;
+	page_iter = polar_logindex_create_page_iterator(logindex_snapshot, &tag, start_lsn + LSN_TEST_STEP,
+													test_max_lsn, false);
+	Assert(page_iter->state == ITERATE_STATE_FINISHED);
+
+	while ((lsn_info = polar_logindex_page_iterator_next(page_iter)) != NULL)
+	{
+		Assert(lsn_info->prev_lsn == page_prev_lsn);
+		page_prev_lsn = lsn_info->lsn;
+		page_lsn_num--;
+	}
+
+	Assert(page_lsn_num == 0 && page_prev_lsn == prev_lsn[0]);
+	polar_logindex_release_page_iterator(page_iter);
+
+	/* Overflow tables are saved and freed before memory tables */
+	polar_logindex_flush_table(logindex_snapshot, InvalidXLogRecPtr, false);
+	Assert(polar_logindex_overflow_tbl_size(logindex_snapshot) == 0);
+
+	lsn_iter = polar_logindex_create_lsn_iterator(logindex_snapshot, start_lsn + LSN_TEST_STEP);
+	test_lsn_iterator(logindex_snapshot, lsn_iter, start_lsn + LSN_TEST_STEP, test_max_lsn);
+	polar_logindex_release_lsn_iterator(lsn_iter);
+
+	polar_logindex_max_overflow_tables = 0;
+	pfree(prev_lsn);
+}
+
 static bool
 test_logindex_table_flushable(log_mem_table_t * table, void *data)
 {
@@ -915,16 +1059,20 @@ test_logindex(PG_FUNCTION_ARGS)
 	test_insert_lsn_after_force_flush(logindex_snapshot);
 
 	test_insert_file_full(logindex_snapshot);
-	test_iterate_lsn(logindex_snapshot);
+	test_iterate_lsn_fanout(logindex_snapshot);
 	test_lsn_iterate_from_file(logindex_snapshot, start_lsn);
 
 	test_truncate_log(logindex_snapshot);
 
 	test_change_lsn_prefix(logindex_snapshot);
 
+	test_insert_lsn_bench(logindex_snapshot);
+
 	kill(bgwriter_pid, SIGTERM);
 	Assert(WaitForBackgroundWorkerShutdown(bgwriter_handle) == BGWH_STOPPED);
 
+	test_overflow_table(logindex_snapshot);
+
 	MemoryContextResetAndDeleteChildren(polar_logindex_memory_context());
 
 	PG_RETURN_INT32(0);
@@ -0,0 +1,156 @@
+/*-------------------------------------------------------------------------
+ *
+ * test_logindex_compress.c
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/test/modules/test_logindex/test_logindex_compress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/polar_logindex.h"
+#include "access/polar_logindex_internal.h"
+#include "fmgr.h"
+#include "test_module_init.h"
+
+#define TEST_COMPRESS_START_LSN 0x10000028000UL
+
+/*
+ * Fill table with pages whose lsn number is from 1 to 15, so some of
+ * pages have item head only and others have one or two item segments.
+ */
+static void
+test_compress_fill_table(log_idx_table_data_t * table)
+{
+	XLogRecPtr	lsn = TEST_COMPRESS_START_LSN;
+	log_seg_id_t free_seg = 1;
+	uint32		page = 0;
+
+	MemSet(table, 0, sizeof(log_idx_table_data_t));
+	table->idx_table_id = 65;
+	table->prefix_lsn = lsn >> 32;
+	table->min_lsn = lsn;
+
+	while (free_seg + 2 < LOG_INDEX_MEM_TBL_SEG_NUM)
+	{
+		log_seg_id_t head = free_seg++;
+		log_item_head_t *item = log_index_item_head(table, head);
+		uint32		key;
+		int			n = page % 15 + 1;
+		int			i;
+
+		item->head_seg = head;
+		item->tail_seg = head;
+		item->tag.rnode.spcNode = 1663;
+		item->tag.rnode.dbNode = 5;
+		item->tag.rnode.relNode = 16384 + page % 3;
+		item->tag.forkNum = MAIN_FORKNUM;
+		item->tag.blockNum = page;
+		item->prev_page_lsn = (page % 2) ? lsn - 0x1000 : InvalidXLogRecPtr;
+
+		key = LOG_INDEX_MEM_TBL_HASH_PAGE(&item->tag);
+		item->next_item = LOG_INDEX_TBL_SLOT_VALUE(table, key);
+		LOG_INDEX_TBL_SLOT_VALUE(table, key) = head;
+
+		for (i = 0; i < n; i++)
+		{
+			lsn += 0x58 + (i % 4) * 8;
+
+			if (i < LOG_INDEX_ITEM_HEAD_LSN_NUM)
+			{
+				item->suffix_lsn[item->number] = (uint32) lsn;
+				table->idx_order[table->last_order++] = head | (item->number << LOG_INDEX_ORDER_IDX_SHIFT);
+				item->number++;
+			}
+			else
+			{
+				log_item_seg_t *seg = log_index_item_seg(table, item->tail_seg);
+
+				if (item->tail_seg == head || seg->number == LOG_INDEX_ITEM_SEG_LSN_NUM)
+				{
+					log_seg_id_t seg_id = free_seg++;
+
+					seg = log_index_item_seg(table, seg_id);
+					seg->head_seg = head;
+					seg->prev_seg = item->tail_seg;
+
+					if (item->tail_seg == head)
+						item->next_seg = seg_id;
+					else
+						log_index_item_seg(table, item->tail_seg)->next_seg = seg_id;
+
+					item->tail_seg = seg_id;
+				}
+
+				seg->suffix_lsn[seg->number] = (uint32) lsn;
+				table->idx_order[table->last_order++] = item->tail_seg | (seg->number << LOG_INDEX_ORDER_IDX_SHIFT);
+				seg->number++;
+			}
+		}
+
+		page++;
+	}
+
+	table->max_lsn = lsn;
+	table->crc = log_index_calc_crc((unsigned char *) table, sizeof(log_idx_table_data_t));
+}
+
+PG_FUNCTION_INFO_V1(test_logindex_compress);
+/*
+ * Check compressed table can be decompressed to the same table, and
+ * corrupted compressed table is refused.
+ */
+Datum
+test_logindex_compress(PG_FUNCTION_ARGS)
+{
+	log_idx_table_data_t *table = palloc(sizeof(log_idx_table_data_t));
+	log_idx_table_data_t *result = palloc(sizeof(log_idx_table_data_t));
+	char	   *buf = palloc(sizeof(log_idx_table_data_t));
+	uint32		size;
+
+	/* Empty table */
+	MemSet(table, 0, sizeof(log_idx_table_data_t));
+	table->idx_table_id = 1;
+	size = log_index_compress_table(table, buf);
+	Assert(size > 0 && size < LOG_INDEX_TABLE_ZIP_READ_SIZE);
+	Assert(LOG_INDEX_TABLE_IS_ZIP(buf));
+	Assert(log_index_decompress_table(buf, size, result));
+	Assert(memcmp(table, result, sizeof(log_idx_table_data_t)) == 0);
+
+	/* Full table */
+	test_compress_fill_table(table);
+	size = log_index_compress_table(table, buf);
+	Assert(size > 0 && size < sizeof(log_idx_table_data_t));
+	Assert(log_index_decompress_table(buf, size, result));
+	Assert(memcmp(table, result, sizeof(log_idx_table_data_t)) == 0);
+
+	ereport(LOG, (errmsg("logindex table size=%lu, compressed size=%u, ratio=%.2lf",
+						 sizeof(log_idx_table_data_t), size,
+						 (double) sizeof(log_idx_table_data_t) / size)));
+
+	/* Truncated or corrupted table can't be decompressed */
+	Assert(!log_index_decompress_table(buf, size - 1, result));
+	buf[size / 2] ^= 0x1;
+	Assert(!log_index_decompress_table(buf, size, result));
+
+	pfree(buf);
+	pfree(result);
+	pfree(table);
+
+	PG_RETURN_INT32(0);
+}
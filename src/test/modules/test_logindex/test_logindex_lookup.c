@@ -0,0 +1,162 @@
+/*-------------------------------------------------------------------------
+ *
+ * test_logindex_lookup.c
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/test/modules/test_logindex/test_logindex_lookup.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <time.h>
+
+#include "access/polar_logindex.h"
+#include "access/polar_logindex_internal.h"
+#include "fmgr.h"
+#include "test_module_init.h"
+
+#define TEST_LOOKUP_LOOPS 100
+
+/* Number of pages searched in each loop, half of them don't exist */
+#define TEST_LOOKUP_PAGES ((LOG_INDEX_MEM_TBL_SEG_NUM - 1) * 2)
+
+static void
+test_lookup_set_tag(BufferTag *tag, uint32 i)
+{
+	tag->rnode.spcNode = 1663;
+	tag->rnode.dbNode = 5;
+	tag->rnode.relNode = 16384 + (i % 7);
+	tag->forkNum = MAIN_FORKNUM;
+	tag->blockNum = i * 31;
+}
+
+/*
+ * Fill a full memory table, every segment is an item head of one page.
+ */
+static void
+test_lookup_fill_table(log_mem_table_t * table)
+{
+	log_seg_id_t id;
+	BufferTag	tag;
+
+	MemSet(table, 0, sizeof(log_mem_table_t));
+	table->data.idx_table_id = 1;
+
+	for (id = 1; id < LOG_INDEX_MEM_TBL_SEG_NUM; id++)
+	{
+		log_item_head_t *item = log_index_item_head(&table->data, id);
+		uint32		key;
+
+		test_lookup_set_tag(&tag, id);
+		key = LOG_INDEX_MEM_TBL_HASH_PAGE(&tag);
+
+		item->head_seg = id;
+		item->tail_seg = id;
+		item->next_seg = LOG_INDEX_TBL_INVALID_SEG;
+		item->next_item = LOG_INDEX_TBL_SLOT_VALUE(&table->data, key);
+		item->tag = tag;
+		item->number = 1;
+		item->prev_page_lsn = InvalidXLogRecPtr;
+		item->suffix_lsn[0] = id;
+
+		LOG_INDEX_TBL_SLOT_VALUE(&table->data, key) = id;
+	}
+
+	table->free_head = LOG_INDEX_MEM_TBL_SEG_NUM;
+	log_index_mem_tbl_build_tag_bucket(table);
+}
+
+static long
+test_lookup_elapsed(struct timespec *start_time, struct timespec *end_time)
+{
+	return (end_time->tv_sec - start_time->tv_sec) * 1000000000L +
+		(end_time->tv_nsec - start_time->tv_nsec);
+}
+
+PG_FUNCTION_INFO_V1(test_logindex_lookup);
+/*
+ * Compare page lookup between walking item list of hash slot and
+ * probing tag buckets of memory table, and report their throughput.
+ */
+Datum
+test_logindex_lookup(PG_FUNCTION_ARGS)
+{
+	log_mem_table_t *table = palloc(sizeof(log_mem_table_t));
+	BufferTag  *tags = palloc(sizeof(BufferTag) * TEST_LOOKUP_PAGES);
+	uint32	   *keys = palloc(sizeof(uint32) * TEST_LOOKUP_PAGES);
+	struct timespec start_time,
+				end_time;
+	long		list_cost,
+				bucket_cost;
+	uint64		found = 0;
+	uint64		total = (uint64) TEST_LOOKUP_LOOPS * TEST_LOOKUP_PAGES;
+	int			i,
+				j;
+
+	test_lookup_fill_table(table);
+
+	for (i = 0; i < TEST_LOOKUP_PAGES; i++)
+	{
+		test_lookup_set_tag(&tags[i], i + 1);
+		keys[i] = LOG_INDEX_MEM_TBL_HASH_PAGE(&tags[i]);
+	}
+
+	/* Both lookup ways must return the same item */
+	for (i = 0; i < TEST_LOOKUP_PAGES; i++)
+	{
+		log_item_head_t *item = log_index_tbl_find(&tags[i], &table->data, keys[i]);
+
+		Assert(item == log_index_mem_tbl_find(&tags[i], table, keys[i]));
+		Assert((item != NULL) == (i + 1 < LOG_INDEX_MEM_TBL_SEG_NUM));
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	for (j = 0; j < TEST_LOOKUP_LOOPS; j++)
+	{
+		for (i = 0; i < TEST_LOOKUP_PAGES; i++)
+			found += (log_index_tbl_find(&tags[i], &table->data, keys[i]) != NULL);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	list_cost = Max(test_lookup_elapsed(&start_time, &end_time), 1);
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+	for (j = 0; j < TEST_LOOKUP_LOOPS; j++)
+	{
+		for (i = 0; i < TEST_LOOKUP_PAGES; i++)
+			found += (log_index_mem_tbl_find(&tags[i], table, keys[i]) != NULL);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	bucket_cost = Max(test_lookup_elapsed(&start_time, &end_time), 1);
+
+	Assert(found == (uint64) TEST_LOOKUP_LOOPS * (LOG_INDEX_MEM_TBL_SEG_NUM - 1) * 2);
+
+	ereport(LOG, (errmsg("logindex lookup %lu pages, item list cost=%ld, qps=%.2lf",
+						 total, list_cost, total / (list_cost / 1000000000.0))));
+	ereport(LOG, (errmsg("logindex lookup %lu pages, tag bucket cost=%ld, qps=%.2lf",
+						 total, bucket_cost, total / (bucket_cost / 1000000000.0))));
+
+	pfree(keys);
+	pfree(tags);
+	pfree(table);
+
+	PG_RETURN_INT32(0);
+}
@@ -239,6 +239,76 @@ test_rel_size_table_full(polar_rel_size_cache_t cache)
 	Assert(valid);
 }
 
+static void
+test_rel_tombstone(polar_rel_size_cache_t cache)
+{
+	RelFileNode node;
+	BufferTag	tag;
+	XLogRecPtr	lsn_changed;
+	uint64		skip_search,
+				search,
+				skip_entry;
+	bool		valid;
+
+	node.spcNode = 1;
+	node.dbNode = 2000;
+	node.relNode = 300;
+
+	tag.rnode = node;
+	tag.forkNum = MAIN_FORKNUM;
+	tag.blockNum = 10;
+
+	/* Relation without truncate info don't need to search tables */
+	skip_search = pg_atomic_read_u64(&cache->skip_search);
+	valid = polar_check_rel_block_valid_and_lsn(cache, 0x4000, &tag, &lsn_changed);
+	Assert(valid);
+	Assert(lsn_changed == 0x4000);
+	Assert(pg_atomic_read_u64(&cache->skip_search) == skip_search + 1);
+	Assert(!cache->tombstone_overflow);
+
+	/* Search tables if lsn is smaller than the relation's tombstone */
+	polar_record_rel_size_with_lock(cache, UINT64CONST(0xFFFFFF000), &node, MAIN_FORKNUM, 5);
+	search = pg_atomic_read_u64(&cache->search);
+	valid = polar_check_rel_block_valid_and_lsn(cache, 0x4000, &tag, &lsn_changed);
+	Assert(!valid);
+	Assert(lsn_changed == UINT64CONST(0xFFFFFF000));
+	Assert(pg_atomic_read_u64(&cache->search) == search + 1);
+
+	/* Other relations in the same database are not affected */
+	tag.rnode.relNode = 301;
+	skip_search = pg_atomic_read_u64(&cache->skip_search);
+	valid = polar_check_rel_block_valid_only(cache, 0x4000, &tag);
+	Assert(valid);
+	Assert(pg_atomic_read_u64(&cache->skip_search) == skip_search + 1);
+
+	/* Replay skips the entry of truncated block and counts it */
+	skip_entry = pg_atomic_read_u64(&cache->skip_entry);
+	valid = polar_check_rel_block_valid_for_replay(cache, 0x4000, &tag);
+	Assert(valid);
+	Assert(pg_atomic_read_u64(&cache->skip_entry) == skip_entry);
+
+	tag.rnode.relNode = 300;
+	valid = polar_check_rel_block_valid_for_replay(cache, 0x4000, &tag);
+	Assert(!valid);
+	Assert(pg_atomic_read_u64(&cache->skip_entry) == skip_entry + 1);
+	tag.rnode.relNode = 301;
+
+	/* Dropped database affects all of its relations */
+	polar_record_db_state_with_lock(cache, UINT64CONST(0xFFFFFF100), node.spcNode, node.dbNode, POLAR_DB_DROPED);
+	valid = polar_check_rel_block_valid_and_lsn(cache, UINT64CONST(0xFFFFFF010), &tag, &lsn_changed);
+	Assert(!valid);
+	Assert(lsn_changed == UINT64CONST(0xFFFFFF100));
+
+	/* Tombstones are rebuilt from the left tables after truncate */
+	polar_truncate_rel_size_cache(cache, UINT64CONST(0xFFFFFF000));
+	Assert(cache->tombstone_num > 0);
+	Assert(!cache->tombstone_overflow);
+
+	valid = polar_check_rel_block_valid_and_lsn(cache, UINT64CONST(0xFFFFFF010), &tag, &lsn_changed);
+	Assert(!valid);
+	Assert(lsn_changed == UINT64CONST(0xFFFFFF100));
+}
+
 PG_FUNCTION_INFO_V1(test_polar_rel_size_cache);
 /*
  * SQL-callable entry point to perform all tests.
@@ -257,6 +327,7 @@ test_polar_rel_size_cache(PG_FUNCTION_ARGS)
 
 	test_rel_exists(cache);
 	test_rel_size_table_full(cache);
+	test_rel_tombstone(cache);
 
 	PG_RETURN_VOID();
 }
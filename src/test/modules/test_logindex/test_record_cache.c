@@ -0,0 +1,148 @@
+/*-------------------------------------------------------------------------
+ *
+ * test_record_cache.c
+ *
+ * Copyright (c) 2024, Alibaba Group Holding Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * IDENTIFICATION
+ *	  src/test/modules/test_logindex/test_record_cache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/polar_record_cache.h"
+#include "access/xlog.h"
+#include "fmgr.h"
+#include "test_module_init.h"
+
+#define TEST_RECORD_CACHE_MB		(1)
+#define TEST_RECORD_CACHE_START_LSN	UINT64CONST(0x10000028000)
+
+/* Make a decoded record whose main data is filled with the low byte of lsn */
+static DecodedXLogRecord *
+test_make_record(XLogRecPtr lsn, uint32 data_len)
+{
+	Size		size = MAXALIGN(offsetof(DecodedXLogRecord, blocks)) + data_len;
+	DecodedXLogRecord *decoded = palloc0(size);
+
+	decoded->size = size;
+	decoded->lsn = lsn;
+	decoded->next_lsn = lsn + MAXALIGN(SizeOfXLogRecord + data_len);
+	decoded->header.xl_tot_len = SizeOfXLogRecord + data_len;
+	decoded->max_block_id = -1;
+	decoded->main_data = (char *) decoded + MAXALIGN(offsetof(DecodedXLogRecord, blocks));
+	decoded->main_data_len = data_len;
+	memset(decoded->main_data, (int) (lsn & 0xFF), data_len);
+
+	return decoded;
+}
+
+static void
+test_insert_record(polar_record_cache_t cache, XLogReaderState *state, XLogRecPtr lsn, uint32 data_len)
+{
+	DecodedXLogRecord *decoded = test_make_record(lsn, data_len);
+
+	XLogBeginRead(state, lsn);
+	state->record = decoded;
+	polar_record_cache_insert(cache, state);
+	state->record = NULL;
+	pfree(decoded);
+}
+
+static void
+test_check_record(polar_record_cache_t cache, XLogReaderState *state, XLogRecPtr lsn, uint32 data_len)
+{
+	DecodedXLogRecord *decoded;
+	uint32		i;
+
+	Assert(polar_record_cache_read(cache, state, lsn));
+	Assert(state->ReadRecPtr == lsn);
+
+	decoded = state->record;
+	Assert(decoded != NULL && decoded->lsn == lsn);
+	Assert(state->EndRecPtr == decoded->next_lsn);
+	Assert(decoded->main_data_len == data_len);
+	Assert(decoded->main_data > (char *) decoded &&
+		   decoded->main_data + data_len <= (char *) decoded + decoded->size);
+
+	for (i = 0; i < data_len; i++)
+		Assert((uint8) decoded->main_data[i] == (uint8) (lsn & 0xFF));
+}
+
+PG_FUNCTION_INFO_V1(test_record_cache);
+/*
+ * Check record can be read from cache after it's inserted, the least
+ * recently used record is evicted when the cache is full, and no record is
+ * left after the cache is invalidated.
+ */
+Datum
+test_record_cache(PG_FUNCTION_ARGS)
+{
+	polar_record_cache_t cache;
+	XLogReaderState *state;
+	XLogRecPtr	lsn = TEST_RECORD_CACHE_START_LSN;
+	uint64		miss;
+	int			i;
+
+	cache = polar_record_cache_shmem_init("test_record_cache", TEST_RECORD_CACHE_MB);
+	Assert(cache != NULL && cache->slot_num > 0);
+
+	state = XLogReaderAllocate(wal_segment_size, NULL, XL_ROUTINE(), NULL);
+	Assert(state != NULL);
+
+	/* Not cached record */
+	miss = pg_atomic_read_u64(&cache->miss);
+	Assert(!polar_record_cache_read(cache, state, lsn));
+	Assert(pg_atomic_read_u64(&cache->miss) == miss + 1);
+
+	test_insert_record(cache, state, lsn, 100);
+	test_check_record(cache, state, lsn, 100);
+
+	/* Record which is larger than slot is not cached */
+	test_insert_record(cache, state, lsn + 0x1000, POLAR_RECORD_CACHE_SLOT_SIZE);
+	Assert(!polar_record_cache_read(cache, state, lsn + 0x1000));
+
+	/* Fill the cache, and the first record must be evicted */
+	for (i = 1; i <= cache->slot_num * 8; i++)
+		test_insert_record(cache, state, lsn + i * 0x2000, 200);
+
+	Assert(pg_atomic_read_u64(&cache->evict) > 0);
+	Assert(!polar_record_cache_read(cache, state, lsn));
+	test_check_record(cache, state, lsn + cache->slot_num * 8 * 0x2000, 200);
+
+	/* Nothing is cached after invalidation, and the cache is still usable */
+	polar_record_cache_invalidate(cache);
+	Assert(!polar_record_cache_read(cache, state, lsn + cache->slot_num * 8 * 0x2000));
+	test_insert_record(cache, state, lsn, 100);
+	test_check_record(cache, state, lsn, 100);
+
+	XLogReaderFree(state);
+
+	PG_RETURN_INT32(0);
+}
+
+Size
+test_record_cache_request_shmem_size(void)
+{
+	return polar_record_cache_shmem_size(TEST_RECORD_CACHE_MB);
+}
+
+void
+test_record_cache_shmem_startup(void)
+{
+	Assert(polar_record_cache_shmem_init("test_record_cache", 0) == NULL);
+	Assert(polar_record_cache_shmem_init("test_record_cache", TEST_RECORD_CACHE_MB) != NULL);
+}
@@ -175,7 +175,30 @@ test_single_ringbuf()
 		for (i = 0; i < len; i++)
 			Assert(buf[i] == c);
 
-		polar_ringbuf_update_ref(&ref);
+		/* The packet length and data can be gathered from ring buffer */
+		{
+			struct iovec iov[2];
+			uint8		gathered[sizeof(uint32) + 16];
+			int			iovcnt = polar_ringbuf_pkt_iov(rbuf, idx, iov);
+			size_t		off = 0;
+
+			Assert(iovcnt == 1 || iovcnt == 2);
+			for (i = 0; i < iovcnt; i++)
+			{
+				memcpy(gathered + off, iov[i].iov_base, iov[i].iov_len);
+				off += iov[i].iov_len;
+			}
+
+			Assert(off == sizeof(uint32) + len);
+			Assert(memcmp(gathered, &pktlen, sizeof(uint32)) == 0);
+			for (i = 0; i < len; i++)
+				Assert(gathered[sizeof(uint32) + i] == c);
+		}
+
+		if (j % 2 == 0)
+			polar_ringbuf_update_ref(&ref);
+		else
+			polar_ringbuf_advance_ref(&ref, polar_ringbuf_next_pkt_pos(rbuf, idx, len), 1);
 		polar_ringbuf_update_keep_data(rbuf);
 		Assert(polar_ringbuf_free_size(rbuf) == rbuf->size - 1);
 		Assert(polar_ringbuf_avail(&ref) == 0);
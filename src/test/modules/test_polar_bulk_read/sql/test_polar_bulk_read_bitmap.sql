@@ -0,0 +1,122 @@
+SET client_min_messages = 'warning';
+CREATE EXTENSION IF NOT EXISTS test_polar_bulk_read;
+SET polar_bulk_read_size = 16;
+SET max_parallel_workers_per_gather = 0;
+
+create table bulk_read_bitmap_tbl(id int, filler text) with (autovacuum_enabled = off);
+--- a few rows per page, about 400 pages
+INSERT INTO bulk_read_bitmap_tbl select generate_series, repeat('x', 1000) from generate_series(1, 2800);
+CREATE INDEX bulk_read_bitmap_tbl_id_index ON bulk_read_bitmap_tbl(id);
+--- flush buffers of bulk_read_bitmap_tbl.
+--- only master exec checkpoint
+do language plpgsql $$
+    begin
+	    if (select not pg_is_in_recovery()) then
+	 	    checkpoint;
+  	    end if;
+    end
+$$;
+
+--- bulk reads of the top plan node, without the ones of its child
+create function bulk_read_explain(query text, out calls int, out blocks int)
+language plpgsql as $$
+declare
+    plan json;
+begin
+    execute 'explain (analyze, buffers, format json) ' || query into plan;
+    plan := plan->0->'Plan';
+    calls := (plan->>'Bulk Read Calls')::int;
+    blocks := (plan->>'Bulk Read Blocks')::int;
+    if plan->'Plans' is not null then
+        calls := calls - (plan->'Plans'->0->>'Bulk Read Calls')::int;
+        blocks := blocks - (plan->'Plans'->0->>'Bulk Read Blocks')::int;
+    end if;
+end
+$$;
+
+--- heap pages holding the rows matching cond
+create function bulk_read_pages(cond text) returns int
+language plpgsql as $$
+declare
+    pages int;
+begin
+    execute 'select count(distinct (ctid::text::point)[0]) from bulk_read_bitmap_tbl where ' || cond
+        into pages;
+    return pages;
+end
+$$;
+
+create function bulk_read_explain_text(query text) returns setof text
+language plpgsql as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze, buffers, costs off, timing off, summary off) ' || query
+    loop
+        if ln like '%Bulk Read:%' then
+            return next regexp_replace(btrim(ln), '\d+', 'N', 'g');
+        end if;
+    end loop;
+end
+$$;
+
+---------------------  bitmap heap scan ---------------------------
+SET enable_seqscan = off;
+SET enable_indexscan = off;
+
+--- one long run, read by several bulk reads, none past the end of the run
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select count(*), sum(id) from bulk_read_bitmap_tbl where id between 701 and 1400;
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select calls > 1 as batched, calls < blocks as batched_blocks,
+       blocks <= bulk_read_pages('id between 701 and 1400') as within_run
+  from bulk_read_explain('select id from bulk_read_bitmap_tbl where id between 701 and 1400');
+
+--- short runs with gaps between them, one bulk read for each run
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select count(*), sum(id) from bulk_read_bitmap_tbl
+  where id between 1401 and 1470 or id between 1701 and 1770 or id between 2001 and 2070;
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select calls,
+       blocks = bulk_read_pages('id between 1401 and 1470 or id between 1701 and 1770 or id between 2001 and 2070') as all_pages
+  from bulk_read_explain('select id from bulk_read_bitmap_tbl
+    where id between 1401 and 1470 or id between 1701 and 1770 or id between 2001 and 2070');
+
+--- pages far from each other are not bulk read
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select count(*), sum(id) from bulk_read_bitmap_tbl where id in (7, 707, 1407, 2107);
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select calls, blocks
+  from bulk_read_explain('select id from bulk_read_bitmap_tbl where id in (7, 707, 1407, 2107)');
+
+--- text format of explain
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select distinct * from bulk_read_explain_text('select id from bulk_read_bitmap_tbl
+    where id between 1401 and 1470 or id between 1701 and 1770 or id between 2001 and 2070');
+
+--- bulk read off
+SET polar_bulk_read_size = 0;
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl', 'main', 0);
+select calls, blocks
+  from bulk_read_explain('select id from bulk_read_bitmap_tbl where id between 701 and 1400');
+SET polar_bulk_read_size = 16;
+
+---------------------  btree leaf pages ---------------------------
+vacuum bulk_read_bitmap_tbl;
+SET enable_bitmapscan = off;
+SET enable_indexscan = on;
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl_id_index', 'main', 0);
+select count(*), sum(id) from bulk_read_bitmap_tbl where id between 1 and 2800;
+SELECT polar_drop_relation_buffers('bulk_read_bitmap_tbl_id_index', 'main', 0);
+select calls > 0 as bulk_read, calls < blocks as batched_blocks
+  from bulk_read_explain('select id from bulk_read_bitmap_tbl where id between 1 and 2800');
+
+RESET enable_bitmapscan;
+RESET enable_indexscan;
+RESET enable_seqscan;
+RESET max_parallel_workers_per_gather;
+RESET polar_bulk_read_size;
+DROP FUNCTION bulk_read_explain;
+DROP FUNCTION bulk_read_pages;
+DROP FUNCTION bulk_read_explain_text;
+DROP TABLE bulk_read_bitmap_tbl;
@@ -0,0 +1,80 @@
+SET client_min_messages = 'warning';
+CREATE EXTENSION IF NOT EXISTS test_polar_bulk_read;
+SET polar_bulk_read_size = 16;
+SET polar_bulk_read_prefetch_distance = 64;
+
+create table bulk_read_prefetch_tbl(id int8, value int8);
+--- about 1000 pages
+INSERT INTO bulk_read_prefetch_tbl select generate_series,generate_series from generate_series(0, 185 * 1000 - 1);
+--- flush buffers of bulk_read_prefetch_tbl.
+--- only master exec checkpoint
+do language plpgsql $$
+    begin
+	    if (select not pg_is_in_recovery()) then
+	 	    checkpoint;
+  	    end if;
+    end
+$$;
+
+---------------------  prefetch ahead of seq scan ---------------------------
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 0);
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+
+--- the second half is read by prefetched bulk read, the first half is in buffers
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 500);
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+
+--- prefetch distance larger than the relation
+SET polar_bulk_read_prefetch_distance = 4096;
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 0);
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+
+--- the window starts again for the next scan of the same relation
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+
+--- the scan stops at the second page, and the rest of the relation is queued
+CREATE EXTENSION IF NOT EXISTS polar_monitor;
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 0);
+SELECT polar_pg_stat_get_bulk_read_blocks_prefetch('bulk_read_prefetch_tbl'::regclass) AS blocks_prefetch \gset
+select count(*) from (select * from bulk_read_prefetch_tbl limit 200) t;
+SELECT pg_stat_force_next_flush();
+SELECT polar_pg_stat_get_bulk_read_blocks_prefetch('bulk_read_prefetch_tbl'::regclass) > :blocks_prefetch AS queued;
+
+--- wait for the prefetch workers to read them
+do language plpgsql $$
+    begin
+	    for i in 1..3000 loop
+		    exit when (select requested_blocks = read_blocks + hit_blocks + skipped_blocks from polar_prefetch_stat());
+		    perform pg_sleep(0.01);
+	    end loop;
+    end
+$$;
+select read_blocks > 0 AS prefetched, failed_requests from polar_prefetch_stat();
+
+--- all blocks are in buffers, the scan reads nothing from storage
+SELECT polar_pg_stat_get_bulk_read_calls_IO('bulk_read_prefetch_tbl'::regclass) AS calls_io \gset
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+SELECT pg_stat_force_next_flush();
+SELECT polar_pg_stat_get_bulk_read_calls_IO('bulk_read_prefetch_tbl'::regclass) = :calls_io AS no_io;
+
+--- index scan and vacuum don't prefetch, but still read correct pages
+vacuum bulk_read_prefetch_tbl;
+CREATE INDEX bulk_read_prefetch_tbl_id_index ON bulk_read_prefetch_tbl(id);
+do language plpgsql $$
+    begin
+	    if (select not pg_is_in_recovery()) then
+	 	    checkpoint;
+  	    end if;
+    end
+$$;
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 0);
+select sum(value) from bulk_read_prefetch_tbl where id between 1000 and 1999;
+
+--- prefetch off
+SET polar_bulk_read_prefetch_distance = 0;
+SELECT polar_drop_relation_buffers('bulk_read_prefetch_tbl', 'main', 0);
+select count(*), sum(value) from bulk_read_prefetch_tbl;
+
+RESET polar_bulk_read_prefetch_distance;
+RESET polar_bulk_read_size;
+DROP TABLE bulk_read_prefetch_tbl;
@@ -54,5 +54,11 @@ SELECT in_cache, main_cache
 SELECT test_polar_rsc_search_by_mapping(relfilenode)
     FROM pg_class WHERE relname = 'test_rsc';
 
+-- drop caches of current database
+SELECT test_polar_rsc_drop_entries();
+SELECT count(*)
+    FROM test_polar_rsc_stat_entries()
+    WHERE rel_node = (SELECT relfilenode FROM pg_class WHERE relname = 'test_rsc') AND in_cache = true;
+
 DROP TABLE test_rsc;
 DROP EXTENSION test_polar_rsc;
@@ -35,3 +35,7 @@ AS 'MODULE_PATHNAME' LANGUAGE C;
 CREATE FUNCTION test_polar_rsc_update_entry(IN oid)
 RETURNS int
 AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_polar_rsc_drop_entries()
+RETURNS void
+AS 'MODULE_PATHNAME' LANGUAGE C;
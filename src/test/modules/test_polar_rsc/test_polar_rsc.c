@@ -107,3 +107,12 @@ test_polar_rsc_update_entry(PG_FUNCTION_ARGS)
 
 	PG_RETURN_UINT32(nblocks);
 }
+
+PG_FUNCTION_INFO_V1(test_polar_rsc_drop_entries);
+Datum
+test_polar_rsc_drop_entries(PG_FUNCTION_ARGS)
+{
+	polar_rsc_drop_entries(MyDatabaseId, InvalidOid);
+
+	PG_RETURN_VOID();
+}
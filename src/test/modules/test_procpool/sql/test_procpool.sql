@@ -9,3 +9,8 @@ SELECT test_procpool(1000000);
 SELECT pg_reload_conf();
 SELECT test_procpool(1000000);
 SELECT test_procpool(100000);
+-- Skewed workload with or without work steal
+SELECT test_procpool_skew(2000, false);
+SELECT test_procpool_skew(2000, true);
+-- Tasks of a group are dispatched to the preferred process
+SELECT test_procpool_prefer(1000);
@@ -6,3 +6,11 @@
 CREATE FUNCTION test_procpool(INTEGER)
 RETURNS bigint 
 AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_procpool_skew(INTEGER, BOOLEAN)
+RETURNS bigint
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_procpool_prefer(INTEGER)
+RETURNS bigint
+AS 'MODULE_PATHNAME' LANGUAGE C;
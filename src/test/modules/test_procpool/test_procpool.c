@@ -43,18 +43,27 @@ PG_MODULE_MAGIC;
 
 #define TEST_MAX_TASK_NODES_NUM (8)
 #define TEST_TASK_QUEUE_DEPTH (32)
+#define TEST_TASK_KEY_NUM (256)
+
+/* In skewed workload, every other task is for the hot key */
+#define TEST_SKEW_HOT_KEY (0)
+#define TEST_SKEW_TASK_COST (100)	/* us */
 
 typedef struct test_calc_task_node_t
 {
 	polar_task_node_t node;
 	uint32		key;
 	uint32		index;
+	uint32		cost;			/* Sleep time in us when handle this task */
 	uint64		value;
 }			test_calc_task_node_t;
 
 static shmem_request_hook_type prev_shmem_request_hook = NULL;
 static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
 
+/* The last handled index of each key, check tasks are handled in order */
+static uint32 *test_key_last_index = NULL;
+
 void		_PG_init(void);
 
 static bool
@@ -63,6 +72,12 @@ test_node_handle_task(polar_task_sched_t *sched, polar_task_node_t *task)
 	test_calc_task_node_t *task_node = (test_calc_task_node_t *) task;
 	uint64		i = task_node->index;
 
+	Assert(test_key_last_index[task_node->key] < task_node->index);
+	test_key_last_index[task_node->key] = task_node->index;
+
+	if (task_node->cost > 0)
+		pg_usleep(task_node->cost);
+
 	task_node->value = i * (i + 1);
 
 	return true;
@@ -141,8 +156,30 @@ test_node_create_task_ctl(void)
 	return ctl;
 }
 
+static void
+test_wait_running_tasks(polar_task_sched_ctl_t *ctl)
+{
+	int			rc;
+	int			removed;
+
+	while (!polar_sched_empty_running_task(ctl))
+	{
+		removed = polar_sched_remove_finished_task(ctl);
+
+		if (removed <= 0)
+		{
+			rc = WaitLatch(MyLatch, WL_LATCH_SET | WL_POSTMASTER_DEATH,
+						   -1, WAIT_EVENT_POLAR_SUB_TASK_MAIN);
+			Assert(!(rc & WL_POSTMASTER_DEATH));
+
+			if (rc & WL_LATCH_SET)
+				ResetLatch(MyLatch);
+		}
+	}
+}
+
 static uint64
-test_multi_calc(polar_task_sched_ctl_t *ctl, int max_calc_num)
+test_multi_calc(polar_task_sched_ctl_t *ctl, int max_calc_num, bool skew)
 {
 	uint32		i = 1;
 	uint64		n = max_calc_num;
@@ -152,12 +189,23 @@ test_multi_calc(polar_task_sched_ctl_t *ctl, int max_calc_num)
 	int			removed;
 
 	total = 0;
+	MemSet(test_key_last_index, 0, sizeof(uint32) * TEST_TASK_KEY_NUM);
 
 	do
 	{
 		bool		added;
 
-		node.key = i % 256;
+		if (!skew)
+		{
+			node.key = i % TEST_TASK_KEY_NUM;
+			node.cost = 0;
+		}
+		else
+		{
+			node.key = (i % 2) ? TEST_SKEW_HOT_KEY : (i / 2) % (TEST_TASK_KEY_NUM - 1) + 1;
+			node.cost = TEST_SKEW_TASK_COST;
+		}
+
 		node.index = i;
 		node.value = 0;
 
@@ -180,20 +228,7 @@ test_multi_calc(polar_task_sched_ctl_t *ctl, int max_calc_num)
 	}
 	while (i <= max_calc_num);
 
-	while (!polar_sched_empty_running_task(ctl))
-	{
-		removed = polar_sched_remove_finished_task(ctl);
-
-		if (removed <= 0)
-		{
-			rc = WaitLatch(MyLatch, WL_LATCH_SET | WL_POSTMASTER_DEATH,
-						   -1, WAIT_EVENT_POLAR_SUB_TASK_MAIN);
-			Assert(!(rc & WL_POSTMASTER_DEATH));
-
-			if (rc & WL_LATCH_SET)
-				ResetLatch(MyLatch);
-		}
-	}
+	test_wait_running_tasks(ctl);
 
 	Assert(total == expected);
 
@@ -218,13 +253,128 @@ test_procpool(PG_FUNCTION_ARGS)
 
 	polar_start_proc_pool(ctl);
 
-	value = test_multi_calc(ctl, max_calc_num);
+	value = test_multi_calc(ctl, max_calc_num, false);
 
 	polar_release_task_sched_ctl(ctl);
 
 	return value;
 }
 
+PG_FUNCTION_INFO_V1(test_procpool_skew);
+/*
+ * Dispatch skewed workload, half of the tasks are for one hot key and
+ * the others are spread over the other keys. Report the elapsed time
+ * with or without work steal.
+ */
+Datum
+test_procpool_skew(PG_FUNCTION_ARGS)
+{
+	int			max_calc_num = PG_GETARG_INT32(0);
+	bool		work_steal = PG_GETARG_BOOL(1);
+	struct timespec start_time,
+				end_time;
+	long		elapsed;
+	uint64		value;
+	polar_task_sched_ctl_t *ctl = test_node_create_task_ctl();
+
+	polar_sched_enable_work_steal(ctl->sched, work_steal);
+	polar_start_proc_pool(ctl);
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	value = test_multi_calc(ctl, max_calc_num, true);
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+	elapsed = (end_time.tv_sec - start_time.tv_sec) * 1000000L +
+		(end_time.tv_nsec - start_time.tv_nsec) / 1000;
+
+	ereport(LOG, (errmsg("procpool skewed workload tasks=%d, work_steal=%d, steal_task_num=%lu, elapsed=%ldus",
+						 max_calc_num, work_steal,
+						 pg_atomic_read_u64(&ctl->sched->steal_task_num), elapsed)));
+
+	polar_sched_enable_work_steal(ctl->sched, false);
+	polar_release_task_sched_ctl(ctl);
+
+	return value;
+}
+
+/*
+ * Add a task with the key and return the process which it's dispatched to.
+ * Running tasks are not removed, so the dependency of tasks is kept. Wait
+ * if no process is started yet.
+ */
+static int32
+test_add_task_prefer(polar_task_sched_ctl_t *ctl, uint32 key, uint32 index, int32 prefer_proc)
+{
+	test_calc_task_node_t node;
+	polar_task_node_t *dst_node;
+
+	node.key = key;
+	node.index = index;
+	node.cost = 0;
+	node.value = 0;
+
+	while ((dst_node = polar_sched_add_task_prefer(ctl, (polar_task_node_t *) &node, prefer_proc)) == NULL)
+		pg_usleep(1000L);
+
+	return POLAR_TASK_NODE_PROC(dst_node);
+}
+
+PG_FUNCTION_INFO_V1(test_procpool_prefer);
+/*
+ * Dispatch groups of tasks like the pages of one record in parallel replay.
+ * The tasks of a group prefer the process of the group's first task, unless
+ * they depend on the running task in another process.
+ */
+Datum
+test_procpool_prefer(PG_FUNCTION_ARGS)
+{
+	int			groups = PG_GETARG_INT32(0);
+	uint32		index = 1;
+	uint64		expected = 0;
+	int			g;
+	polar_task_sched_ctl_t *ctl = test_node_create_task_ctl();
+
+	polar_start_proc_pool(ctl);
+
+	total = 0;
+	MemSet(test_key_last_index, 0, sizeof(uint32) * TEST_TASK_KEY_NUM);
+
+	for (g = 0; g < groups; g++)
+	{
+		uint32		key = (g * 4) % TEST_TASK_KEY_NUM;
+		int32		proc;
+		int32		dep_proc;
+		int32		dst_proc;
+
+		/* The task of key is still running after this task is dispatched */
+		dep_proc = test_add_task_prefer(ctl, key, index++, -1);
+
+		/* The first task of this group is dispatched to any process */
+		proc = test_add_task_prefer(ctl, key + 1, index++, -1);
+
+		/* The other tasks of this group follow the first one */
+		dst_proc = test_add_task_prefer(ctl, key + 2, index++, proc);
+		Assert(dst_proc == proc);
+		dst_proc = test_add_task_prefer(ctl, key + 3, index++, proc);
+		Assert(dst_proc == proc);
+
+		/* The task which depends on running task ignores the preferred one */
+		dst_proc = test_add_task_prefer(ctl, key, index++, proc);
+		Assert(dst_proc == dep_proc);
+
+		test_wait_running_tasks(ctl);
+	}
+
+	for (g = 1; g < index; g++)
+		expected += (uint64) g * (g + 1);
+
+	Assert(total == expected);
+
+	polar_release_task_sched_ctl(ctl);
+
+	PG_RETURN_INT64(total);
+}
+
 static void
 test_procpool_shmem_request(void)
 {
@@ -236,6 +386,7 @@ test_procpool_shmem_request(void)
 	sz = polar_calc_task_sched_shmem_size(TEST_MAX_TASK_NODES_NUM,
 										  sizeof(test_calc_task_node_t),
 										  TEST_TASK_QUEUE_DEPTH);
+	sz = add_size(sz, sizeof(uint32) * TEST_TASK_KEY_NUM);
 	RequestAddinShmemSpace(sz);
 }
 
@@ -243,6 +394,7 @@ static void
 test_procpool_shmem_startup(void)
 {
 	polar_task_sched_t *sched;
+	bool		found;
 
 	sched = polar_create_proc_task_sched("polar_test_procpool",
 										 TEST_MAX_TASK_NODES_NUM,
@@ -251,6 +403,12 @@ test_procpool_shmem_startup(void)
 										 &total);
 	if (sched == NULL)
 		ereport(PANIC, errmsg("failed to create procpool!"));
+
+	test_key_last_index = ShmemInitStruct("polar_test_procpool_key_index",
+										  sizeof(uint32) * TEST_TASK_KEY_NUM,
+										  &found);
+	if (!found)
+		MemSet(test_key_last_index, 0, sizeof(uint32) * TEST_TASK_KEY_NUM);
 }
 
 void
@@ -0,0 +1,27 @@
+#!/bin/bash
+#
+# Push small records into the xlog send queue from 1 to 128 sessions at once,
+# and print the number of pushes per second for each number of writers.
+#
+# Usage: push.sh [psql/pgbench connection options]
+#
+# The queue is only used when logindex is enabled on the primary, see
+# polar_logindex_mem_size.
+
+LOOPS=${LOOPS:-1000}
+DURATION=${DURATION:-30}
+
+psql -q $* -c "CREATE EXTENSION IF NOT EXISTS test_xlog_buffer" || exit $?
+
+echo "SELECT test_xlog_queue_push($LOOPS);" > /tmp/push_$$.sql
+
+echo '| writers | pushes per second |'
+echo '| ------- | ----------------- |'
+
+for writers in 1 2 4 8 16 32 64 128
+do
+  tps=`pgbench -n -c $writers -j $writers -T $DURATION -f /tmp/push_$$.sql $* 2>/dev/null | grep '^tps' | awk '{print $3}'`
+  echo "| $writers | `echo "$tps * $LOOPS" | bc` |"
+done
+
+rm -f /tmp/push_$$.sql
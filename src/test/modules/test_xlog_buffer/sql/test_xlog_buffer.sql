@@ -9,3 +9,6 @@ SELECT test_xlog_buffer();
 ABORT;
 
 RESET client_min_messages;
+
+-- Push small records into xlog queue repeatedly
+SELECT test_xlog_queue_push(1000);
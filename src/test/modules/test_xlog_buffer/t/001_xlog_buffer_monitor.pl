@@ -81,6 +81,11 @@ $result = $node_standby->safe_psql('postgres',
 );
 is($result, qq(t|t|t|t), 'check standby');
 
+$result = $node_standby->safe_psql('postgres',
+	"select conflict_miss_count >= 0, conflict_miss_count <= io_count, read_ahead_count >= 0 from polar_xlog_buffer_stat_info();"
+);
+is($result, qq(t|t|t), 'check standby conflict miss and read ahead');
+
 $node_primary->stop();
 $node_replica->stop();
 $node_standby->stop;
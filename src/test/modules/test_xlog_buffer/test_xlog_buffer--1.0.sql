@@ -6,3 +6,7 @@
 CREATE FUNCTION test_xlog_buffer()
 RETURNS pg_catalog.void STRICT
 AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_xlog_queue_push(loops int4)
+RETURNS pg_catalog.void STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
@@ -32,9 +32,12 @@
 #include "access/polar_logindex_redo.h"
 #include "access/xlog.h"
 #include "access/xlogreader.h"
+#include "access/xloginsert.h"
 #include "access/xlogutils.h"
+#include "catalog/pg_control.h"
 #include "executor/spi.h"
 #include "tcop/tcopprot.h"
+#include "utils/timestamp.h"
 #include "utils/snapmgr.h"
 #include "storage/polar_xlogbuf.h"
 
@@ -51,6 +54,37 @@ PG_FUNCTION_INFO_V1(test_xlog_buffer);
 
 void		_PG_init(void);
 
+/*
+ * Find the buffer which keeps the page containing this lsn by walking the set
+ * it's mapped to. Return -1 if the page is not kept in xlog buffer.
+ */
+static int
+find_xlog_buffer(XLogRecPtr lsn)
+{
+	XLogRecPtr	page_off = lsn - (lsn % XLOG_BLCKSZ);
+	int			set = polar_get_xlog_buffer_set(lsn);
+	int			first = polar_get_xlog_buffer_set_first(set);
+	int			buf_id;
+	int			result = -1;
+
+	LWLockAcquire(polar_xlog_buffer_set_get_lock(set), LW_SHARED);
+
+	for (buf_id = first; buf_id < first + POLAR_XLOG_BUFFER_WAYS; buf_id++)
+	{
+		polar_xlog_buffer_desc *buf = polar_get_xlog_buffer_desc(buf_id);
+
+		if (buf->start_lsn == page_off && !XLogRecPtrIsInvalid(buf->end_lsn))
+		{
+			result = buf_id;
+			break;
+		}
+	}
+
+	LWLockRelease(polar_xlog_buffer_set_get_lock(set));
+
+	return result;
+}
+
 static void
 test_xlog_buffer_shmem_request(void)
 {
@@ -99,6 +133,7 @@ test_xlog_buffer_api(void)
 	XLogRecPtr	lsn;
 	char	   *one_xlog_block = NULL;
 	char		cur_page[XLOG_BLCKSZ];
+	uint64		conflict;
 
 	one_xlog_block = palloc0(XLOG_BLCKSZ);
 	Assert(one_xlog_block != NULL);
@@ -150,7 +185,11 @@ test_xlog_buffer_api(void)
 	}
 	check_xlog_buffer_stat_info();
 
-	/* search all xlog buffer blocks again, but no one will be matched */
+	/*
+	 * search all xlog buffer blocks again, but no one will be matched, and
+	 * all of them are conflict miss except the first page with invalid lsn
+	 */
+	conflict = pg_atomic_read_u64(&polar_xlog_buffer_ins->conflict_miss_count);
 	for (lsn = 0L; lsn < 64 * 1024 * 1024; lsn += XLOG_BLCKSZ)
 	{
 		if (polar_xlog_buffer_lookup(lsn, XLOG_BLOCK_VALID_LEN, cur_page))
@@ -158,6 +197,9 @@ test_xlog_buffer_api(void)
 		io++;
 	}
 	check_xlog_buffer_stat_info();
+	if (pg_atomic_read_u64(&polar_xlog_buffer_ins->conflict_miss_count) - conflict !=
+		64 * 1024 * 1024 / XLOG_BLCKSZ - 1)
+		ereport(PANIC, errmsg("Unexpected conflict miss count!"));
 
 	/* failed to update xlog buffer valid length */
 	polar_xlog_buffer_update(2L);
@@ -199,6 +241,114 @@ test_xlog_buffer_api(void)
 	check_xlog_buffer_stat_info();
 }
 
+/*
+ * Fill one set of xlog buffer, and check which page is evicted with consumers'
+ * cursor.
+ */
+static void
+test_xlog_buffer_victim(void)
+{
+	/* pages with distance of stride are in the same set */
+	XLogRecPtr	stride = (XLogRecPtr) POLAR_XLOG_BUFFER_SET_COUNT() * XLOG_BLCKSZ;
+	XLogRecPtr	base = 1024 * stride;
+	XLogRecPtr	lsn;
+	char	   *one_xlog_block = NULL;
+	char		cur_page[XLOG_BLCKSZ];
+	uint64		conflict = pg_atomic_read_u64(&polar_xlog_buffer_ins->conflict_miss_count);
+
+	one_xlog_block = palloc0(XLOG_BLCKSZ);
+	memset(one_xlog_block, 'D', XLOG_BLCKSZ);
+
+	Assert(POLAR_XLOG_BUFFER_WAYS == 4);
+	Assert(polar_logindex_redo_instance == NULL);
+	polar_logindex_redo_instance = palloc0(sizeof(polar_logindex_redo_ctl_data_t));
+	polar_bg_redo_set_replayed_lsn(polar_logindex_redo_instance, base + 2 * stride);
+
+	/* fill the set, and the first two pages are consumed */
+	if (!polar_xlog_buffer_append(base, XLOG_BLCKSZ, one_xlog_block) ||
+		!polar_xlog_buffer_append(base + stride, XLOG_BLCKSZ, one_xlog_block) ||
+		!polar_xlog_buffer_append(base + 2 * stride, XLOG_BLCKSZ, one_xlog_block) ||
+		!polar_xlog_buffer_append(base + 4 * stride, XLOG_BLCKSZ, one_xlog_block))
+		ereport(PANIC, errmsg("Failed to fill xlog buffer set!"));
+	append += 4;
+
+	/* the oldest consumed page is evicted first */
+	if (!polar_xlog_buffer_append(base + 5 * stride, XLOG_BLCKSZ, one_xlog_block))
+		ereport(PANIC, errmsg("Failed to append!"));
+	append++;
+	if (polar_xlog_buffer_lookup(base, XLOG_BLCKSZ, cur_page))
+		ereport(PANIC, errmsg("Unexpected found!"));
+	io++;
+	if (!polar_xlog_buffer_lookup(base + stride, XLOG_BLCKSZ, cur_page))
+		ereport(PANIC, errmsg("Unexpected unfound!"));
+	hit++;
+
+	/* then the other consumed page */
+	if (!polar_xlog_buffer_append(base + 6 * stride, XLOG_BLCKSZ, one_xlog_block))
+		ereport(PANIC, errmsg("Failed to append!"));
+	append++;
+
+	/* neither the farthest page nor the consumed page will be kept */
+	if (polar_xlog_buffer_append(base + 7 * stride, XLOG_BLCKSZ, one_xlog_block) ||
+		polar_xlog_buffer_append(base + stride, XLOG_BLCKSZ, one_xlog_block))
+		ereport(PANIC, errmsg("Unexpected appended!"));
+
+	/* the nearer page evicts the farthest one */
+	if (!polar_xlog_buffer_append(base + 3 * stride, XLOG_BLCKSZ, one_xlog_block))
+		ereport(PANIC, errmsg("Failed to append!"));
+	append++;
+	if (polar_xlog_buffer_lookup(base + 6 * stride, XLOG_BLCKSZ, cur_page))
+		ereport(PANIC, errmsg("Unexpected found!"));
+	io++;
+	if (!polar_xlog_buffer_lookup(base + 3 * stride, XLOG_BLCKSZ, cur_page) ||
+		memcmp(cur_page, one_xlog_block, XLOG_BLCKSZ) != 0)
+		ereport(PANIC, errmsg("Unexpected xlog page in xlog buffer!"));
+	hit++;
+
+	check_xlog_buffer_stat_info();
+	if (pg_atomic_read_u64(&polar_xlog_buffer_ins->conflict_miss_count) - conflict != 2)
+		ereport(PANIC, errmsg("Unexpected conflict miss count!"));
+
+	for (lsn = base; lsn <= base + 7 * stride; lsn += stride)
+		polar_xlog_buffer_remove(lsn);
+
+	pfree(polar_logindex_redo_instance);
+	polar_logindex_redo_instance = NULL;
+	pfree(one_xlog_block);
+}
+
+/*
+ * Read ahead depth is doubled while reading sequentially, and it's reset
+ * when the access isn't sequential.
+ */
+static void
+test_xlog_buffer_read_ahead(void)
+{
+	XLogRecPtr	lsn = 64 * 1024 * 1024;
+	int			max_depth = Min(MAX_READ_AHEAD_XLOGS, POLAR_XLOG_BUFFER_SET_COUNT());
+	int			expected = 1;
+	int			depth;
+	int			i;
+
+	for (i = 0; i < 10; i++)
+	{
+		depth = polar_xlog_buffer_read_ahead_depth(lsn);
+		if (depth != expected)
+			ereport(PANIC, errmsg("Unexpected read ahead depth %d, expected %d", depth, expected));
+
+		polar_xlog_buffer_read_ahead_done(lsn, depth, 0);
+		lsn += (XLogRecPtr) depth * XLOG_BLCKSZ;
+		expected = Min(expected * 2, max_depth);
+	}
+
+	Assert(depth == max_depth);
+
+	/* skip one page */
+	depth = polar_xlog_buffer_read_ahead_depth(lsn + XLOG_BLCKSZ);
+	if (depth != 1)
+		ereport(PANIC, errmsg("Unexpected read ahead depth %d, expected 1", depth));
+}
+
 static void
 spi_execute_sql(char *sql)
 {
@@ -318,9 +468,8 @@ test_read_record(void)
 	/* the first page of segment file woule be read to varify header */
 	io++;
 	test_xlog_read_record(xlogreader, flush_lsn, false);
-	buf_id = polar_get_xlog_buffer_id(xlogreader->EndRecPtr);
-	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.start_lsn == InvalidXLogRecPtr);
-	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.end_lsn == InvalidXLogRecPtr);
+	buf_id = find_xlog_buffer(xlogreader->EndRecPtr);
+	Assert(buf_id < 0);
 
 	/* second loop of XLogReadRecord with max bg_replayed_lsn */
 	polar_bg_redo_set_replayed_lsn(polar_logindex_redo_instance, flush_lsn);
@@ -328,7 +477,8 @@ test_read_record(void)
 	io++;
 	append++;
 	test_xlog_read_record(xlogreader, flush_lsn, true);
-	buf_id = polar_get_xlog_buffer_id(xlogreader->EndRecPtr);
+	buf_id = find_xlog_buffer(xlogreader->EndRecPtr);
+	Assert(buf_id >= 0);
 	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.start_lsn == flush_lsn - (flush_lsn % XLOG_BLCKSZ));
 	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.end_lsn == flush_lsn - 1);
 
@@ -358,7 +508,8 @@ test_read_record(void)
 	hit++;
 	polar_bg_redo_set_replayed_lsn(polar_logindex_redo_instance, flush_lsn);
 	test_xlog_read_record(xlogreader, flush_lsn, true);
-	buf_id = polar_get_xlog_buffer_id(xlogreader->EndRecPtr);
+	buf_id = find_xlog_buffer(xlogreader->EndRecPtr);
+	Assert(buf_id >= 0);
 	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.start_lsn == flush_lsn - (flush_lsn % XLOG_BLCKSZ));
 	Assert(polar_xlog_buffer_ins->buffer_descriptors[buf_id].desc.end_lsn == flush_lsn - 1);
 
@@ -388,8 +539,47 @@ test_xlog_buffer(PG_FUNCTION_ARGS)
 	IsUnderPostmaster = true;
 
 	test_xlog_buffer_api();
+	test_xlog_buffer_victim();
+	test_xlog_buffer_read_ahead();
 	test_read_record();
 
 	polar_xlog_buffer_ins = prev_xlog_buffer_ins;
 	PG_RETURN_VOID();
 }
+
+PG_FUNCTION_INFO_V1(test_xlog_queue_push);
+/*
+ * Insert small records into WAL many times, each of them is pushed into the
+ * xlog send queue when logindex is enabled, and report the throughput. Run
+ * it from many sessions at once to see how the queue reservation scales.
+ */
+Datum
+test_xlog_queue_push(PG_FUNCTION_ARGS)
+{
+	int			loops = PG_GETARG_INT32(0);
+	char		payload[16];
+	TimestampTz start;
+	long		secs;
+	int			usecs;
+	double		elapsed;
+	int			i;
+
+	MemSet(payload, 0, sizeof(payload));
+
+	start = GetCurrentTimestamp();
+	for (i = 0; i < loops; i++)
+	{
+		XLogBeginInsert();
+		XLogRegisterData(payload, sizeof(payload));
+		XLogInsert(RM_XLOG_ID, XLOG_NOOP);
+	}
+
+	TimestampDifference(start, GetCurrentTimestamp(), &secs, &usecs);
+	elapsed = secs * 1000000.0 + usecs;
+
+	elog(LOG, "xlog queue push: %d times in %.0f us, %.3f us per op, queue is %s",
+		 loops, elapsed, loops > 0 ? elapsed / loops : 0,
+		 polar_logindex_redo_instance ? "enabled" : "disabled");
+
+	PG_RETURN_VOID();
+}
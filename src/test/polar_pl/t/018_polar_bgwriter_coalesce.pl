@@ -0,0 +1,102 @@
+#!/usr/bin/perl
+
+# 018_polar_bgwriter_coalesce.pl
+#	  Test that bgwriter writes adjacent dirty blocks of flush list together
+#	  and the pages written that way are read back correctly.
+#
+# Copyright (c) 2024, Alibaba Group Holding Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# IDENTIFICATION
+#	  src/test/polar_pl/t/018_polar_bgwriter_coalesce.pl
+
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->polar_init_primary;
+$node_primary->append_conf('postgresql.conf', 'bgwriter_delay = 10ms');
+$node_primary->start;
+
+$node_primary->safe_psql('postgres',
+	'CREATE EXTENSION IF NOT EXISTS polar_monitor;');
+
+$node_primary->safe_psql('postgres',
+	'alter system set polar_bgwriter_max_coalesce_size = 16;');
+$node_primary->reload;
+$node_primary->poll_query_until('postgres',
+	'show polar_bgwriter_max_coalesce_size', '16')
+  or die "timed out waiting for polar_bgwriter_max_coalesce_size";
+
+# Blocks of the table and its index are dirtied one after another
+$node_primary->safe_psql('postgres',
+	q[create table coalesce_tbl(id int8, value int8);
+	  create index coalesce_tbl_id_idx on coalesce_tbl(id);]);
+$node_primary->safe_psql('postgres',
+	q[INSERT INTO coalesce_tbl select generate_series, generate_series from generate_series(1, 185 * 2000);]
+);
+
+my $expected = $node_primary->safe_psql('postgres',
+	q[select count(*), sum(value) from coalesce_tbl;]);
+is($expected, '370000|68450185000', 'data loaded');
+
+# Wait until bgwriter writes some of them with one write call
+ok( $node_primary->poll_query_until(
+		'postgres',
+		q[select write_blocks > write from polar_flush_write_stat();]),
+	'bgwriter coalesces writes of adjacent blocks');
+
+# Pages written by bgwriter are not dirty any more, so neither the
+# checkpoint nor the shutdown writes them again. After restart they are read
+# back from what the coalesced writes left in storage.
+$node_primary->safe_psql('postgres', 'checkpoint;');
+$node_primary->restart;
+
+is( $node_primary->safe_psql(
+		'postgres', q[select count(*), sum(value) from coalesce_tbl;]),
+	$expected,
+	'heap pages written by coalesced writes are read back');
+
+is( $node_primary->safe_psql(
+		'postgres',
+		q[set enable_seqscan = off; set enable_bitmapscan = off;
+		  select count(*), sum(value) from coalesce_tbl where id between 1 and 370000;]
+	),
+	$expected,
+	'index pages written by coalesced writes are read back');
+
+# Modify the pages again, so they are coalesced once more over the old ones
+$node_primary->safe_psql('postgres',
+	q[update coalesce_tbl set value = value + 1 where id % 2 = 0;]);
+my $old_write = $node_primary->safe_psql('postgres',
+	q[select write from polar_flush_write_stat();]);
+ok( $node_primary->poll_query_until(
+		'postgres',
+		qq[select write > $old_write and write_blocks > write from polar_flush_write_stat();]
+	),
+	'bgwriter writes the updated blocks');
+
+$node_primary->safe_psql('postgres', 'checkpoint;');
+$node_primary->restart;
+
+is( $node_primary->safe_psql(
+		'postgres', q[select count(*), sum(value) from coalesce_tbl;]),
+	'370000|68450370000',
+	'updated pages written by coalesced writes are read back');
+
+$node_primary->stop;
+done_testing();
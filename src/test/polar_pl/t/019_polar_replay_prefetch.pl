@@ -0,0 +1,88 @@
+#!/usr/bin/perl
+
+# 019_polar_replay_prefetch.pl
+#	  Test the pages replayed by parallel replay in standby are prefetched
+#	  by prefetch workers.
+#
+# Copyright (c) 2024, Alibaba Group Holding Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# IDENTIFICATION
+#	  src/test/polar_pl/t/019_polar_replay_prefetch.pl
+
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->polar_init_primary;
+$node_primary->append_conf('postgresql.conf', 'checkpoint_timeout = 3600');
+
+my $node_standby = PostgreSQL::Test::Cluster->new('standby');
+$node_standby->polar_init_standby($node_primary);
+$node_standby->append_conf('postgresql.conf', 'checkpoint_timeout = 3600');
+$node_standby->append_conf('postgresql.conf',
+	'polar_enable_parallel_replay_standby_mode = on');
+$node_standby->append_conf('postgresql.conf', 'polar_prefetch_workers = 2');
+$node_standby->append_conf('postgresql.conf',
+	'polar_parallel_replay_prefetch_distance = 256');
+
+$node_primary->start;
+$node_primary->polar_create_slot($node_standby->name);
+$node_standby->start;
+$node_standby->polar_drop_all_slots;
+
+$node_primary->safe_psql('postgres',
+	'CREATE EXTENSION IF NOT EXISTS polar_monitor;');
+$node_primary->safe_psql('postgres',
+	q[create table prefetch_tbl(id int8, value int8);
+	  INSERT INTO prefetch_tbl select generate_series, generate_series from generate_series(1, 185 * 2000);]
+);
+$node_primary->safe_psql('postgres', 'checkpoint;');
+
+my $lsn = $node_primary->lsn('insert');
+$node_primary->wait_for_catchup($node_standby->name, 'replay', $lsn, 't',
+	't', 300);
+
+# Write the pages to storage of standby, so they are not in the buffer pool
+# after restart and have to be read by the replay
+$node_standby->safe_psql('postgres', 'checkpoint;');
+$node_standby->restart;
+
+# Replay after restart may prefetch some pages already
+my $read_blocks = $node_standby->safe_psql('postgres',
+	q[select read_blocks from polar_prefetch_stat();]);
+
+$node_primary->safe_psql('postgres',
+	q[update prefetch_tbl set value = value + 1;]);
+$lsn = $node_primary->lsn('insert');
+$node_primary->wait_for_catchup($node_standby->name, 'replay', $lsn, 't',
+	't', 300);
+
+ok( $node_standby->safe_psql(
+		'postgres',
+		qq[select read_blocks > $read_blocks and failed_requests = 0 from polar_prefetch_stat();]
+	) eq 't',
+	'pages replayed by parallel replay are read by prefetch workers');
+
+is( $node_standby->safe_psql(
+		'postgres', q[select count(*), sum(value) from prefetch_tbl;]),
+	'370000|68450555000',
+	'standby replays the prefetched pages');
+
+$node_standby->stop;
+$node_primary->stop;
+done_testing();
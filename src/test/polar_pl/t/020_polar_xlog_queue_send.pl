@@ -0,0 +1,89 @@
+#!/usr/bin/perl
+
+# 020_polar_xlog_queue_send.pl
+#	  Test walsender sends xlog meta to replica from the xlog queue, and
+#	  keeps up with the replica after its walreceiver is paused.
+#
+# Copyright (c) 2024, Alibaba Group Holding Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# IDENTIFICATION
+#	  src/test/polar_pl/t/020_polar_xlog_queue_send.pl
+
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $regress_db = 'postgres';
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->polar_init_primary;
+
+# Log the lsn sent from xlog queue
+$node_primary->append_conf('postgresql.conf', 'polar_enable_debug = on');
+
+my $node_replica = PostgreSQL::Test::Cluster->new('replica');
+$node_replica->polar_init_replica($node_primary);
+
+$node_primary->start;
+$node_primary->polar_create_slot($node_replica->name);
+$node_replica->start;
+
+$node_primary->safe_psql($regress_db, q[create table test(a int);]);
+$node_primary->safe_psql($regress_db,
+	q[insert into test(a) select generate_series(1, 100000);]);
+$node_primary->wait_for_catchup($node_replica, 'replay',
+	$node_primary->lsn('insert'));
+
+is( $node_replica->safe_psql($regress_db, q[select count(*), sum(a) from test;]),
+	'100000|5000050000',
+	'replica replays xlog meta sent from xlog queue');
+
+# Server log is written by logging collector
+my $sent_from_queue = 0;
+foreach my $file (glob($node_primary->data_dir . '/log/*.log'))
+{
+	if (slurp_file($file) =~ qr/Sent lsn [0-9A-F\/]+ from queue/)
+	{
+		$sent_from_queue = 1;
+		last;
+	}
+}
+ok($sent_from_queue, 'walsender sends xlog meta from xlog queue');
+
+# Pause walreceiver while primary writes, so messages sent from the xlog
+# queue pile up in the socket or libpq output buffer until it is resumed
+my $walreceiver_pid = $node_replica->find_child('walreceiver');
+isnt($walreceiver_pid, '0', 'find walreceiver of replica');
+kill 'STOP', $walreceiver_pid;
+
+$node_primary->safe_psql($regress_db,
+	q[insert into test(a) select generate_series(100001, 200000);]);
+$node_primary->safe_psql($regress_db, q[update test set a = a + 1;]);
+$node_primary->safe_psql($regress_db, q[select pg_sleep(1);]);
+
+kill 'CONT', $walreceiver_pid;
+
+$node_primary->wait_for_catchup($node_replica, 'replay',
+	$node_primary->lsn('insert'));
+
+is( $node_replica->safe_psql($regress_db, q[select count(*), sum(a) from test;]),
+	'200000|20000300000',
+	'replica replays xlog meta after walreceiver is resumed');
+
+$node_replica->stop;
+$node_primary->stop;
+done_testing();
@@ -0,0 +1,89 @@
+#!/usr/bin/perl
+
+# 021_polar_group_commit.pl
+#	  Test adaptive group commit delays WAL flush under concurrent committers,
+#	  and the delay stays within polar_group_commit_target_latency.
+#
+# Copyright (c) 2024, Alibaba Group Holding Limited
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# IDENTIFICATION
+#	  src/test/polar_pl/t/021_polar_group_commit.pl
+
+use strict;
+use warnings;
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $regress_db = 'postgres';
+my $target_latency = 10000;
+
+my $node_primary = PostgreSQL::Test::Cluster->new('primary');
+$node_primary->polar_init_primary;
+
+# Group commit doesn't delay without fsync
+$node_primary->append_conf(
+	'postgresql.conf', qq[
+	fsync = on
+	polar_group_commit_target_latency = $target_latency
+]);
+$node_primary->start;
+
+$node_primary->safe_psql($regress_db,
+	'CREATE EXTENSION IF NOT EXISTS polar_monitor;');
+$node_primary->safe_psql($regress_db, 'create table group_commit_test(a int);');
+
+my $script = q{insert into group_commit_test values (1);};
+
+# One committer has no follower to wait for
+$node_primary->safe_psql($regress_db, 'select polar_group_commit_stat_reset();');
+$node_primary->pgbench('-n -c 1 -j 1 -T 3', 0, [qr{processed: [1-9]}],
+	[qr{^$}], 'pgbench with one committer',
+	{ '001_group_commit_one' => $script });
+
+# Only flushes of other processes racing with the committer may be delayed
+is( $node_primary->safe_psql(
+		$regress_db,
+		q[select flush_count > 0, delay_count * 10 < flush_count
+		  from polar_group_commit_stat();]),
+	't|t',
+	'flush is hardly delayed with one committer');
+
+# Concurrent committers are batched by the delay
+$node_primary->safe_psql($regress_db, 'select polar_group_commit_stat_reset();');
+$node_primary->pgbench('-n -c 16 -j 4 -T 5', 0, [qr{processed: [1-9]}],
+	[qr{^$}], 'pgbench with concurrent committers',
+	{ '002_group_commit_concurrent' => $script });
+
+note "group commit stat: "
+  . $node_primary->safe_psql($regress_db,
+	q[select * from polar_group_commit_stat();]);
+
+is( $node_primary->safe_psql(
+		$regress_db,
+		q[select delay_count > 0, delay_time_us > 0, max_batch_size > 1
+		  from polar_group_commit_stat();]),
+	't|t|t',
+	'flush is delayed to wait for concurrent committers');
+
+is( $node_primary->safe_psql(
+		$regress_db,
+		qq[select max_delay_us > 0 and max_delay_us < $target_latency
+		  from polar_group_commit_stat();]),
+	't',
+	'flush delay stays within the target latency');
+
+$node_primary->stop;
+done_testing();